@@ -1,6 +1,8 @@
 #pragma once
 
 #include "assets/asset_types.h"
+#include "assets/asset_pack.h"
+#include "platform/filewatch.h"
 
 #include "common.h"
 #include "core/arena.h"
@@ -19,6 +21,8 @@ typedef struct asset_entry {
 	UUID id;
 	String full_path;
 	uint64_t last_modified;
+	// Bumped every time the file changes on disk after it was tracked
+	uint32_t revision;
 } AssetEntry;
 
 typedef struct asset_store {
@@ -28,6 +32,10 @@ typedef struct asset_store {
 	String asset_directory;
 	AssetEntry *assets[ASSET_TYPE_MAX];
 	uint32_t asset_counts[ASSET_TYPE_MAX];
+
+	// Cooked assets, consulted before the loose files when mounted
+	AssetPack pack;
+	FileWatch *watch;
 } AssetStore;
 
 ENGINE_API AssetStore asset_store_make(Arena *arena);
@@ -41,6 +49,24 @@ ENGINE_API bool asset_store_deserialize(AssetStore *store, String src);
 
 ENGINE_API UUID asset_store_register(AssetStore *store, AssetType type, String key);
 
+// Packs every tracked file under its id, in memory assets are skipped. Scenes are packed as their cooked .mesh
+// when there is one, so run the cooker first
+ENGINE_API bool asset_store_pack(AssetStore *store, String output, bool compress);
+ENGINE_API bool asset_store_mount_pack(AssetStore *store, String path);
+ENGINE_API void asset_store_unmount_pack(AssetStore *store);
+
+// Starts watching the asset directory for edits, see asset_store_poll_changes
+ENGINE_API bool asset_store_watch(AssetStore *store);
+ENGINE_API void asset_store_unwatch(AssetStore *store);
+// Entries whose files were written since the last call, newly created files are tracked first.
+// Returns a dynamic array allocated from arena, NULL when nothing changed
+ENGINE_API AssetEntry **asset_store_poll_changes(AssetStore *store, Arena *arena);
+
+// Contents of the asset at key. A view into the mounted pack when the asset is stored uncompressed,
+// otherwise decompressed or read from the loose file into arena. Untracked keys are read as paths,
+// and assets edited since they were tracked always come from the loose file
+ENGINE_API Buffer asset_store_read(AssetStore *store, Arena *arena, String key);
+
 ENGINE_API UUID asset_store_find(AssetStore *store, AssetType type, String key);
 ENGINE_API UUID asset_store_find_shader(AssetStore *store, String key);
 ENGINE_API UUID asset_store_find_model(AssetStore *store, String key);
@@ -0,0 +1,198 @@
+#include "asset_pack.h"
+
+#include "common.h"
+#include "core/arena.h"
+#include "core/debug.h"
+#include "core/hash.h"
+#include "core/logger.h"
+#include "core/lz4.h"
+#include "core/strings.h"
+
+#include "platform/filesystem.h"
+
+#include <stdlib.h>
+
+static inline bool asset_pack_section_valid(Buffer file, uint64_t offset, uint64_t size) {
+	return offset <= file.size && size <= file.size - offset;
+}
+
+bool asset_pack_open(AssetPack *pack, String path) {
+	*pack = (AssetPack){ 0 };
+
+	Buffer file = filesystem_map(path);
+	if (file.pointer == NULL)
+		return false;
+
+	AssetPackHeader *header = (AssetPackHeader *)file.pointer;
+	bool valid = file.size >= sizeof(AssetPackHeader) &&
+		header->magic == ASSET_PACK_MAGIC &&
+		header->version == ASSET_PACK_VERSION &&
+		header->file_size == file.size &&
+		(header->toc_offset % alignof(AssetPackEntry)) == 0 &&
+		asset_pack_section_valid(file, header->toc_offset, sizeof(AssetPackEntry) * (uint64_t)header->entry_count);
+
+	AssetPackEntry *entries = (AssetPackEntry *)(file.pointer + (valid ? header->toc_offset : 0));
+	for (uint32_t index = 0; valid && index < header->entry_count; ++index) {
+		AssetPackEntry *entry = &entries[index];
+		// Stored blobs own the terminating zero byte after them too
+		uint64_t terminator = entry->compression == ASSET_PACK_COMPRESSION_NONE ? 1 : 0;
+		valid = asset_pack_section_valid(file, entry->offset, entry->stored_size + terminator) &&
+			(entry->offset % ASSET_PACK_ALIGNMENT) == 0 &&
+			(index == 0 || entries[index - 1].id < entry->id) &&
+			(entry->compression == ASSET_PACK_COMPRESSION_LZ4 || (entry->compression == ASSET_PACK_COMPRESSION_NONE && entry->stored_size == entry->size));
+	}
+
+	if (valid == false) {
+		LOG_ERROR("AssetPack: '%.*s' is not a valid version %d pack", SARG(path), ASSET_PACK_VERSION);
+		filesystem_unmap(file);
+		return false;
+	}
+
+	pack->mapping = file;
+	pack->entries = entries;
+	pack->entry_count = header->entry_count;
+
+	LOG_INFO("AssetPack: Mapped '%.*s', %u assets", SARG(path), pack->entry_count);
+	return true;
+}
+
+void asset_pack_close(AssetPack *pack) {
+	filesystem_unmap(pack->mapping);
+	*pack = (AssetPack){ 0 };
+}
+
+AssetPackEntry *asset_pack_find(AssetPack *pack, UUID id) {
+	uint32_t low = 0, high = pack->entry_count;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (pack->entries[middle].id < id)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	return low < pack->entry_count && pack->entries[low].id == id ? &pack->entries[low] : NULL;
+}
+
+Buffer asset_pack_read(AssetPack *pack, Arena *arena, UUID id) {
+	AssetPackEntry *entry = asset_pack_find(pack, id);
+	if (entry == NULL)
+		return (Buffer){ 0 };
+
+	// NOTE: Null terminated like filesystem_read so text assets can be handed straight to parsers
+	uint8_t *stored = pack->mapping.pointer + entry->offset;
+	if (entry->compression == ASSET_PACK_COMPRESSION_NONE) {
+		if (stored[entry->size] != '\0') {
+			LOG_ERROR("AssetPack: Blob for asset %llu isn't terminated", (unsigned long long)id);
+			return (Buffer){ 0 };
+		}
+		return buffer_make(stored, entry->size);
+	}
+
+	size_t mark = arena_mark(arena);
+	uint8_t *data = arena_push(arena, entry->size + 1, 16, false);
+	if (lz4_decompress(stored, entry->stored_size, data, entry->size) == false) {
+		LOG_ERROR("AssetPack: Corrupt blob for asset %llu", (unsigned long long)id);
+		arena_rewind(arena, mark);
+		return (Buffer){ 0 };
+	}
+	data[entry->size] = '\0';
+
+	return buffer_make(data, entry->size);
+}
+
+static int asset_pack_input_compare(const void *a, const void *b) {
+	UUID lhs = ((const AssetPackInput *)a)->id, rhs = ((const AssetPackInput *)b)->id;
+	return (lhs > rhs) - (lhs < rhs);
+}
+
+bool asset_pack_write(String path, AssetPackInput *inputs, uint32_t count, bool compress) {
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+
+	AssetPackInput *sorted = arena_push_count(scratch.arena, count, AssetPackInput);
+	memory_copy_count(sorted, inputs, count);
+	qsort(sorted, count, sizeof(*sorted), asset_pack_input_compare);
+
+	AssetPackHeader *header = arena_push_struct(scratch.arena, AssetPackHeader);
+	AssetPackEntry *entries = arena_push_count(scratch.arena, count, AssetPackEntry);
+	uint8_t **blobs = arena_push_count(scratch.arena, count, uint8_t *);
+
+	*header = (AssetPackHeader){
+		.magic = ASSET_PACK_MAGIC,
+		.version = ASSET_PACK_VERSION,
+		.entry_count = count,
+		.toc_offset = sizeof(AssetPackHeader),
+	};
+
+	uint64_t offset = alignup(sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * (uint64_t)count, ASSET_PACK_ALIGNMENT);
+	for (uint32_t index = 0; index < count; ++index) {
+		AssetPackInput *input = &sorted[index];
+		if (index > 0 && sorted[index - 1].id == input->id) {
+			LOG_ERROR("AssetPack: Duplicate asset id %llu", (unsigned long long)input->id);
+			arena_scratch_end(scratch);
+			return false;
+		}
+
+		AssetPackEntry *entry = &entries[index];
+		*entry = (AssetPackEntry){
+			.id = input->id,
+			.offset = offset,
+			.stored_size = input->data.size,
+			.size = input->data.size,
+			.content_hash = hash64_content(input->data.pointer, input->data.size, 0),
+			.type = input->type,
+			.compression = ASSET_PACK_COMPRESSION_NONE,
+		};
+		blobs[index] = input->data.pointer;
+
+		if (compress && input->data.size) {
+			size_t capacity = lz4_compress_bound(input->data.size);
+			uint8_t *compressed = arena_push(scratch.arena, capacity, 1, false);
+			size_t compressed_size = lz4_compress(input->data.pointer, input->data.size, compressed, capacity);
+
+			if (compressed_size && compressed_size < input->data.size - input->data.size / 8) {
+				entry->compression = ASSET_PACK_COMPRESSION_LZ4;
+				entry->stored_size = compressed_size;
+				blobs[index] = compressed;
+				arena_pop(scratch.arena, capacity - compressed_size);
+			} else
+				arena_pop(scratch.arena, capacity);
+		}
+
+		// The padding up to the next blob is zeroes, stored blobs always get at least one as their terminator
+		uint64_t terminator = entry->compression == ASSET_PACK_COMPRESSION_NONE ? 1 : 0;
+		offset = alignup(offset + entry->stored_size + terminator, ASSET_PACK_ALIGNMENT);
+	}
+	header->file_size = offset;
+
+	// Write next to the destination and rename over it, a running game keeps its mapping of the old pack
+	String temp_path = string_format(scratch.arena, "%.*s.tmp", SARG(path));
+	File file = filesystem_open(temp_path, FILE_MODE_WRITE_BINARY);
+	if (file.handle == NULL) {
+		arena_scratch_end(scratch);
+		return false;
+	}
+
+	static uint8_t padding[ASSET_PACK_ALIGNMENT];
+	bool written = file_write(&file, sizeof(AssetPackHeader), 1, header) == 1 &&
+		file_write(&file, sizeof(AssetPackEntry), count, entries) == count;
+
+	uint64_t position = sizeof(AssetPackHeader) + sizeof(AssetPackEntry) * (uint64_t)count;
+	for (uint32_t index = 0; written && index <= count; ++index) {
+		uint64_t blob_offset = index < count ? entries[index].offset : header->file_size;
+		uint64_t padding_size = blob_offset - position;
+		written = padding_size == 0 || file_write(&file, padding_size, 1, padding) == 1;
+
+		if (written && index < count && entries[index].stored_size)
+			written = file_write(&file, entries[index].stored_size, 1, blobs[index]) == 1;
+		position = blob_offset + (index < count ? entries[index].stored_size : 0);
+	}
+	file_close(&file);
+
+	bool result = written && filesystem_rename(temp_path, path);
+	if (result == false)
+		LOG_ERROR("AssetPack: Failed to write '%.*s'", SARG(path));
+
+	arena_scratch_end(scratch);
+	return result;
+}
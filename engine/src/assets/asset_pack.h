@@ -0,0 +1,58 @@
+#pragma once
+
+#include "common.h"
+#include "core/arena.h"
+#include "core/identifiers.h"
+#include "core/strings.h"
+
+// NOTE: Bump whenever the layout below changes, packs with another version are rejected
+#define ASSET_PACK_VERSION 3
+#define ASSET_PACK_MAGIC 0x314B4150 // "PAK1"
+// Blobs start on page boundaries so views into the mapping are page aligned
+#define ASSET_PACK_ALIGNMENT KiB(4)
+
+typedef enum {
+	ASSET_PACK_COMPRESSION_NONE,
+	ASSET_PACK_COMPRESSION_LZ4,
+} AssetPackCompression;
+
+typedef struct {
+	uint32_t magic, version;
+	uint64_t file_size;
+
+	uint32_t entry_count, padding;
+	uint64_t toc_offset;
+} AssetPackHeader;
+
+// Table of contents entry, the table is sorted by id
+typedef struct {
+	UUID id;
+	uint64_t offset, stored_size;
+	uint64_t size, content_hash;
+	uint32_t type, compression;
+} AssetPackEntry;
+
+typedef struct {
+	Buffer mapping;
+
+	AssetPackEntry *entries;
+	uint32_t entry_count;
+} AssetPack;
+
+typedef struct {
+	UUID id;
+	uint32_t type;
+	Buffer data;
+} AssetPackInput;
+
+// Maps the whole pack, the TOC and every blob are validated against the file size up front
+ENGINE_API bool asset_pack_open(AssetPack *pack, String path);
+ENGINE_API void asset_pack_close(AssetPack *pack);
+
+ENGINE_API AssetPackEntry *asset_pack_find(AssetPack *pack, UUID id);
+// Stored blobs are returned as a view into the mapping, compressed ones are decoded into arena.
+// Either way data[size] is '\0' like filesystem_read, the writer keeps a zero byte after every stored blob
+ENGINE_API Buffer asset_pack_read(AssetPack *pack, Arena *arena, UUID id);
+
+// Blobs are LZ4 compressed when compress is set and it saves at least an eighth, otherwise stored as is
+ENGINE_API bool asset_pack_write(String path, AssetPackInput *inputs, uint32_t count, bool compress);
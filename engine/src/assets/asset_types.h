@@ -97,4 +97,7 @@ typedef struct scene_source {
 
 	uint8_t *indices;
 	size_t indices_size;
+
+	// Set when loaded from a .mesh cache, the pointers above reference it until importer_unload_scene
+	Buffer mapping;
 } SceneSource;
@@ -22,21 +22,39 @@ static const char *extensions[ASSET_TYPE_MAX][8] = {
 	[ASSET_TYPE_shader] = { "glsl", "spv" },
 };
 
+// Cooker outputs and bookkeeping that live next to the sources but aren't assets themselves
+static const char *ignored_extensions[] = { "mesh", "pak", "tmp", "cookdb", NULL };
+static const char *ignored_files[] = { "asset_manifest.json", NULL };
+
 static AssetType file_extension_to_asset_type(String extension);
 static String asset_type_to_string(AssetType type);
 static AssetType asset_type_from_string(String type);
 
+static bool asset_file_ignored(String path) {
+	String extension = stringpath_extension(path), filename = stringpath_filename(path);
+	for (uint32_t index = 0; ignored_extensions[index]; ++index)
+		if (string_equals(extension, string_wrap(ignored_extensions[index])))
+			return true;
+	for (uint32_t index = 0; ignored_files[index]; ++index)
+		if (string_equals(filename, string_wrap(ignored_files[index])))
+			return true;
+
+	return false;
+}
+
 bool asset_store_track_directory(AssetStore *store, String directory) {
 	ArenaTemp scratch = arena_scratch_begin(store->arena);
 
-	ASSERT(store->asset_directory.length == 0);
-	store->asset_directory = string_copy(store->arena, directory);
+	// NOTE: Already set when tracking on top of a deserialized manifest
+	if (store->asset_directory.length == 0)
+		store->asset_directory = string_copy(store->arena, directory);
 	StringList file_list = filesystem_directory_files(scratch.arena, directory, true);
 	StringNode *file = file_list.first;
 
 	logger_indent();
 	while (file) {
-		asset_store_track_file(store, file->string);
+		if (asset_file_ignored(file->string) == false)
+			asset_store_track_file(store, file->string);
 
 		file = file->next;
 	}
@@ -79,7 +97,13 @@ bool asset_store_track_file(AssetStore *store, String file_path) {
 
 	AssetType type = file_extension_to_asset_type(stringpath_extension(file_path));
 
-	AssetEntry *entry = asset_map_push(store, type, asset_path_key(store, file_path, true));
+	String key = asset_path_key(store, file_path, true);
+	if (arena_trie_find(&store->trie, buffer_wrap_string(key), AssetEntry)) {
+		arena_scratch_end(scratch);
+		return false;
+	}
+
+	AssetEntry *entry = asset_map_push(store, type, key);
 	/* arena_trienode_push(&store->trie, buffer_wrap_string(asset_path_key(store, file_path, false)))->payload = entry; */
 
 	if (entry->full_path.length == 0) {
@@ -152,6 +176,118 @@ UUID asset_store_register(AssetStore *store, AssetType type, String key) {
 	return entry->id;
 }
 
+bool asset_store_pack(AssetStore *store, String output, bool compress) {
+	ArenaTemp scratch = arena_scratch_begin(store->arena);
+
+	AssetPackInput *inputs = NULL;
+	for (uint32_t type = 0; type < ASSET_TYPE_MAX; ++type) {
+		for (uint32_t entry_index = 0; entry_index < store->asset_counts[type]; ++entry_index) {
+			AssetEntry *entry = store->assets[type] + entry_index;
+			if (string_find_first(entry->full_path, S("in_memory")) != -1)
+				continue;
+
+			// NOTE: Scenes ship as the .mesh the cooker built, importer_load_gltf_scene_memory takes either form
+			String path = entry->full_path;
+			if (type == ASSET_TYPE_geometry) {
+				String cooked = importer_mesh_cache_path(scratch.arena, entry->full_path);
+				if (file_exists(cooked))
+					path = cooked;
+				else
+					LOG_WARN("AssetStore: '%.*s' isn't cooked, packing the source", SARG(entry->full_path));
+			}
+
+			Buffer data = filesystem_map(path);
+			if (data.pointer == NULL && file_exists(path) == false) {
+				LOG_WARN("AssetStore: Skipping missing asset '%.*s'", SARG(path));
+				continue;
+			}
+
+			arena_darray_put(scratch.arena, inputs, AssetPackInput, { .id = entry->id, .type = type, .data = data });
+		}
+	}
+
+	uint32_t count = arena_array_count(inputs);
+	bool result = asset_pack_write(output, inputs, count, compress);
+	if (result)
+		LOG_INFO("AssetStore: Packed %u assets into '%.*s'", count, SARG(output));
+
+	for (uint32_t index = 0; index < count; ++index)
+		filesystem_unmap(inputs[index].data);
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
+bool asset_store_mount_pack(AssetStore *store, String path) {
+	asset_store_unmount_pack(store);
+	return asset_pack_open(&store->pack, path);
+}
+
+void asset_store_unmount_pack(AssetStore *store) {
+	if (store->pack.mapping.pointer)
+		asset_pack_close(&store->pack);
+}
+
+Buffer asset_store_read(AssetStore *store, Arena *arena, String key) {
+	AssetEntry *entry = arena_trie_find(&store->trie, buffer_wrap_string(key), AssetEntry);
+	if (entry && entry->revision == 0 && store->pack.mapping.pointer) {
+		Buffer result = asset_pack_read(&store->pack, arena, entry->id);
+		if (result.pointer)
+			return result;
+	}
+
+	return filesystem_read(arena, entry ? entry->full_path : key);
+}
+
+bool asset_store_watch(AssetStore *store) {
+	if (store->watch)
+		return true;
+
+	store->watch = filewatch_make(store->arena, FILEWATCH_DEBOUNCE_MS);
+	if (store->watch == NULL)
+		return false;
+
+	return filewatch_add(store->watch, store->asset_directory, true);
+}
+
+void asset_store_unwatch(AssetStore *store) {
+	if (store->watch == NULL)
+		return;
+
+	filewatch_destroy(store->watch);
+	store->watch = NULL;
+}
+
+AssetEntry **asset_store_poll_changes(AssetStore *store, Arena *arena) {
+	if (store->watch == NULL)
+		return NULL;
+
+	ArenaTemp scratch = arena_scratch_begin(arena);
+	StringList changes = filewatch_poll(store->watch, scratch.arena);
+
+	AssetEntry **result = NULL;
+	for (StringNode *change = changes.first; change; change = change->next) {
+		if (asset_file_ignored(change->string))
+			continue;
+
+		String key = asset_path_key(store, change->string, true);
+		AssetEntry *entry = arena_trie_find(&store->trie, buffer_wrap_string(key), AssetEntry);
+		if (entry)
+			entry->revision++;
+		else if (asset_store_track_file(store, change->string))
+			entry = arena_trie_find(&store->trie, buffer_wrap_string(key), AssetEntry);
+
+		if (entry == NULL)
+			continue;
+
+		entry->last_modified = filesystem_last_modified(entry->full_path);
+		arena_darray_put(arena, result, AssetEntry *, entry);
+	}
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
 bool asset_store_deserialize(AssetStore *store, String src) {
 	ArenaTemp scratch = arena_scratch_begin(store->arena);
 	JsonNode *root = json_parse(scratch.arena, string_wrap_buffer(filesystem_read(scratch.arena, src)));
@@ -257,6 +393,8 @@ UUID asset_store_find_image(AssetStore *store, String key) {
 }
 
 bool asset_store_clear_cache(AssetStore *store) {
+	// NOTE: The watch lives in the store's arena, its thread has to be gone before that is reset
+	asset_store_unwatch(store);
 	arena_reset(store->arena);
 	LOG_INFO("AssetStore: Cache cleared. All tracking lost.");
 
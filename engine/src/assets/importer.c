@@ -3,6 +3,7 @@
 #include "common.h"
 #include "core/arena.h"
 #include "core/debug.h"
+#include "core/hash.h"
 #include "core/logger.h"
 #include "core/strings.h"
 
@@ -18,23 +19,20 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+	#include <immintrin.h>
+#endif
 
 #define MATERIAL_PROPERTY_COUNT 9
 
 // static void calculate_tangents(Vertex *vertices, uint32_t vertex_count, uint32_t *indices, uint32_t index_count);
 /* static ImageSource *find_loaded_texture(const cgltf_data *data, SModel *scene, const cgltf_texture *gltf_tex); */
 
-Font importer_load_font_ex(Arena *arena, String path, float font_size, uint32_t codepoint_count, const int32_t *codepoints) { // custom code points not implemented yet
-	ArenaTemp scratch = arena_scratch_begin(arena);
+static Font font_load(Arena *arena, Buffer file, float font_size, uint32_t codepoint_count, const int32_t *codepoints) { // custom code points not implemented yet
 	Font result = { 0 };
 
-	Buffer file = filesystem_read(arena, path);
-	if (file.size == 0) {
-		LOG_WARN("%s - failed to load font: %.*s", __func__, SARG(path));
-		arena_scratch_end(scratch);
-		return result;
-	}
-
 	stbtt_fontinfo font_info = { 0 };
 	if (stbtt_InitFont(&font_info, file.pointer, 0)) {
 		float scale_factor = stbtt_ScaleForPixelHeight(&font_info, (float)font_size);
@@ -108,10 +106,24 @@ Font importer_load_font_ex(Arena *arena, String path, float font_size, uint32_t
 			*dst++ = *src++;
 		}
 	} else {
-		LOG_WARN("%s - failed to process font data");
+		LOG_WARN("%s - failed to process font data", __func__);
 	}
 
-	arena_temp_end(scratch);
+	return result;
+}
+
+Font importer_load_font_ex(Arena *arena, String path, float font_size, uint32_t codepoint_count, const int32_t *codepoints) {
+	ArenaTemp scratch = arena_scratch_begin(arena);
+
+	Buffer file = filesystem_read(scratch.arena, path);
+	if (file.size == 0) {
+		LOG_WARN("%s - failed to load font: %.*s", __func__, SARG(path));
+		arena_scratch_end(scratch);
+		return (Font){ 0 };
+	}
+
+	Font result = font_load(arena, file, font_size, codepoint_count, codepoints);
+	arena_scratch_end(scratch);
 	return result;
 }
 
@@ -120,6 +132,15 @@ Font importer_load_font(Arena *arena, String path, float font_size) {
 	return result;
 }
 
+Font importer_load_font_memory(Arena *arena, Buffer file, float font_size) {
+	if (file.size == 0) {
+		LOG_WARN("%s - empty font data", __func__);
+		return (Font){ 0 };
+	}
+
+	return font_load(arena, file, font_size, 0, NULL);
+}
+
 ShaderSource importer_load_shader(Arena *arena, String vertex_path, String fragment_path) {
 	Buffer vfile = filesystem_read(arena, vertex_path);
 	Buffer ffile = filesystem_read(arena, fragment_path);
@@ -173,13 +194,409 @@ static MaterialProperty default_properties[MATERIAL_PROPERTY_COUNT] = {
 	{ .name = { .chars = "emissive_factor", .length = 15 }, .type = PROPERTY_TYPE_FLOAT3, .as.float32x3 = { 1.0f, 1.0f, 1.0f } },
 };
 
-SceneSource importer_load_gltf_scene(Arena *arena, String path) {
+typedef struct {
+	const float *position, *normal, *uv0, *tangent;
+} VertexStreams;
+
+// Returns the accessor's floats as a tightly packed stream, pointing straight into the glTF buffer when the
+// layout already matches and unpacking into the arena otherwise. Missing attributes come back zeroed
+static const float *accessor_float_stream(Arena *arena, cgltf_accessor *accessor, uint32_t count, uint32_t components) {
+	if (accessor == NULL || cgltf_num_components(accessor->type) != components)
+		return arena_push_count(arena, count * components, float);
+
+	if (accessor->is_sparse == false && accessor->buffer_view && accessor->normalized == false &&
+		accessor->component_type == cgltf_component_type_r_32f && accessor->stride == components * sizeof(float))
+		return (const float *)(cgltf_buffer_view_data(accessor->buffer_view) + accessor->offset);
+
+	float *stream = arena_push(arena, sizeof(float) * count * components, 16, false);
+	cgltf_accessor_unpack_floats(accessor, stream, count * components);
+	return stream;
+}
+
+static Interval3 vertex_streams_interleave(VertexStreams source, Vertex3 *vertices, uint32_t count) {
+	Interval3 bounds = {
+		.min = float3_fill(FLOAT_MAX),
+		.max = float3_fill(FLOAT_MIN),
+	};
+	uint32_t index = 0;
+
+#if defined(__SSE2__)
+	// NOTE: Vertex3 is three 16 byte lanes { p.xyz n.x }, { n.yz uv }, { t.xyzw }. The last vertex goes
+	// through the scalar path since the 4-wide loads of position and normal read one float past it
+	__m128 min = _mm_set1_ps(FLOAT_MAX), max = _mm_set1_ps(FLOAT_MIN);
+	for (; index + 1 < count; ++index) {
+		__m128 position = _mm_loadu_ps(source.position + index * 3);
+		__m128 normal = _mm_loadu_ps(source.normal + index * 3);
+		__m128 uv0 = _mm_castpd_ps(_mm_load_sd((const double *)(source.uv0 + index * 2)));
+		__m128 tangent = _mm_loadu_ps(source.tangent + index * 4);
+
+		__m128 pz_nx = _mm_shuffle_ps(position, normal, _MM_SHUFFLE(0, 0, 2, 2));
+		float *dst = (float *)&vertices[index];
+		_mm_store_ps(dst + 0, _mm_shuffle_ps(position, pz_nx, _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_store_ps(dst + 4, _mm_shuffle_ps(normal, uv0, _MM_SHUFFLE(1, 0, 2, 1)));
+		_mm_store_ps(dst + 8, tangent);
+
+		min = _mm_min_ps(min, position);
+		max = _mm_max_ps(max, position);
+	}
+
+	alignas(16) float lanes[2][4];
+	_mm_store_ps(lanes[0], min);
+	_mm_store_ps(lanes[1], max);
+	bounds.min = (float3){ lanes[0][0], lanes[0][1], lanes[0][2] };
+	bounds.max = (float3){ lanes[1][0], lanes[1][1], lanes[1][2] };
+#endif
+
+	for (; index < count; ++index) {
+		Vertex3 *dst = &vertices[index];
+		memory_copy(&dst->position, source.position + index * 3, sizeof(float) * 3);
+		memory_copy(&dst->normal, source.normal + index * 3, sizeof(float) * 3);
+		memory_copy(&dst->uv0, source.uv0 + index * 2, sizeof(float) * 2);
+		memory_copy(&dst->tangent, source.tangent + index * 4, sizeof(float) * 4);
+
+		bounds.min = float3_min(bounds.min, dst->position);
+		bounds.max = float3_max(bounds.max, dst->position);
+	}
+
+	return bounds;
+}
+
+static void accessor_unpack_indices(cgltf_accessor *accessor, uint32_t *indices, uint32_t count) {
+	bool packed = accessor->is_sparse == false && accessor->buffer_view && accessor->stride == cgltf_component_size(accessor->component_type);
+	if (packed == false) {
+		cgltf_accessor_unpack_indices(accessor, indices, sizeof(uint32_t), count);
+		return;
+	}
+
+	const uint8_t *data = cgltf_buffer_view_data(accessor->buffer_view) + accessor->offset;
+	if (accessor->component_type == cgltf_component_type_r_32u) {
+		memory_copy(indices, data, sizeof(uint32_t) * count);
+		return;
+	}
+
+	if (accessor->component_type != cgltf_component_type_r_16u) {
+		cgltf_accessor_unpack_indices(accessor, indices, sizeof(uint32_t), count);
+		return;
+	}
+
+	const uint16_t *src = (const uint16_t *)data;
+	uint32_t index = 0;
+#if defined(__SSE2__)
+	__m128i zero = _mm_setzero_si128();
+	for (; index + 8 <= count; index += 8) {
+		__m128i packed16 = _mm_loadu_si128((const __m128i *)(src + index));
+		_mm_storeu_si128((__m128i *)(indices + index), _mm_unpacklo_epi16(packed16, zero));
+		_mm_storeu_si128((__m128i *)(indices + index + 4), _mm_unpackhi_epi16(packed16, zero));
+	}
+#endif
+	for (; index < count; ++index)
+		indices[index] = src[index];
+}
+
+// NOTE: Parallel imports may write the same output, each writes a temporary of its own and renames it into place
+static String temp_path_make(Arena *arena, String path) {
+	static uint32_t counter = 0;
+	uint32_t unique = __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+	return string_format(arena, "%.*s.%d.%u.tmp", SARG(path), (int)getpid(), unique);
+}
+
+#define MESH_CACHE_MAGIC 0x4853454D // "MESH"
+#define MESH_CACHE_ALIGNMENT 16
+
+typedef struct {
+	uint32_t magic, version;
+	uint64_t source_hash;
+	uint64_t file_size;
+
+	uint32_t mesh_count, material_count, image_count, property_count;
+
+	uint64_t meshes_offset, mesh_to_material_offset, bounds_offset;
+	uint64_t properties_offset, images_offset;
+	uint64_t vertices_offset, vertices_size;
+	uint64_t indices_offset, indices_size;
+} MeshCacheHeader;
+
+typedef struct {
+	uint64_t vertex_offset, index_offset;
+	uint32_t vertex_size, vertex_count;
+	uint32_t index_size, index_count;
+} MeshCacheMesh;
+
+typedef struct {
+	uint64_t offset, size;
+	int32_t width, height, channels, padding;
+} MeshCacheImage;
+
+typedef struct {
+	uint32_t type, padding[3];
+	uint8_t value[16];
+} MeshCacheProperty;
+
+String importer_mesh_cache_path(Arena *arena, String source_path) {
+	String extension = stringpath_extension(source_path);
+	size_t stem_length = source_path.length - (extension.length ? extension.length + 1 : 0);
+	return string_format(arena, "%.*s.mesh", (int)stem_length, source_path.chars);
+}
+
+static inline bool mesh_cache_section_valid(Buffer file, uint64_t offset, uint64_t size) {
+	return offset <= file.size && size <= file.size - offset && (offset % MESH_CACHE_ALIGNMENT) == 0;
+}
+
+// Geometry, bounds and pixels point straight into file, only the small per mesh/material tables are built in the arena.
+// A source_hash of 0 accepts the cache whatever it was built from
+static bool mesh_cache_parse(Arena *arena, Buffer file, uint64_t source_hash, SceneSource *out_scene) {
+	MeshCacheHeader *header = (MeshCacheHeader *)file.pointer;
+	bool valid = file.size >= sizeof(MeshCacheHeader) &&
+		header->magic == MESH_CACHE_MAGIC &&
+		header->version == IMPORTER_VERSION &&
+		(source_hash == 0 || header->source_hash == source_hash) &&
+		header->file_size == file.size &&
+		header->property_count == MATERIAL_PROPERTY_COUNT &&
+		mesh_cache_section_valid(file, header->meshes_offset, sizeof(MeshCacheMesh) * header->mesh_count) &&
+		mesh_cache_section_valid(file, header->mesh_to_material_offset, sizeof(uint32_t) * header->mesh_count) &&
+		mesh_cache_section_valid(file, header->bounds_offset, sizeof(Interval3) * header->mesh_count) &&
+		mesh_cache_section_valid(file, header->properties_offset, sizeof(MeshCacheProperty) * header->property_count * header->material_count) &&
+		mesh_cache_section_valid(file, header->images_offset, sizeof(MeshCacheImage) * header->image_count) &&
+		mesh_cache_section_valid(file, header->vertices_offset, header->vertices_size) &&
+		mesh_cache_section_valid(file, header->indices_offset, header->indices_size);
+
+	MeshCacheMesh *meshes = (MeshCacheMesh *)((uint8_t *)file.pointer + (valid ? header->meshes_offset : 0));
+	for (uint32_t index = 0; valid && index < header->mesh_count; ++index) {
+		valid = (uint64_t)meshes[index].vertex_size * meshes[index].vertex_count <= header->vertices_size - MIN(meshes[index].vertex_offset, header->vertices_size) &&
+			(uint64_t)meshes[index].index_size * meshes[index].index_count <= header->indices_size - MIN(meshes[index].index_offset, header->indices_size);
+	}
+
+	MeshCacheImage *images = (MeshCacheImage *)((uint8_t *)file.pointer + (valid ? header->images_offset : 0));
+	for (uint32_t index = 0; valid && index < header->image_count; ++index)
+		valid = mesh_cache_section_valid(file, images[index].offset, images[index].size);
+
+	if (valid == false)
+		return false;
+
+	uint8_t *base = file.pointer;
+
+	out_scene->vertices = base + header->vertices_offset;
+	out_scene->vertices_size = header->vertices_size;
+	out_scene->indices = base + header->indices_offset;
+	out_scene->indices_size = header->indices_size;
+
+	out_scene->mesh_count = header->mesh_count;
+	out_scene->meshes = arena_push_count(arena, header->mesh_count, MeshSource);
+	out_scene->mesh_to_material = (uint32_t *)(base + header->mesh_to_material_offset);
+	out_scene->bounding_boxes = (Interval3 *)(base + header->bounds_offset);
+	for (uint32_t index = 0; index < header->mesh_count; ++index) {
+		out_scene->meshes[index] = (MeshSource){
+			.vertices = out_scene->vertices + meshes[index].vertex_offset,
+			.vertex_size = meshes[index].vertex_size,
+			.vertex_count = meshes[index].vertex_count,
+			.indices = out_scene->indices + meshes[index].index_offset,
+			.index_size = meshes[index].index_size,
+			.index_count = meshes[index].index_count,
+		};
+	}
+
+	MeshCacheProperty *properties = (MeshCacheProperty *)(base + header->properties_offset);
+	out_scene->material_count = header->material_count;
+	out_scene->materials = arena_push_count(arena, header->material_count, MaterialSource);
+	for (uint32_t material_index = 0; material_index < header->material_count; ++material_index) {
+		MaterialSource *dst = &out_scene->materials[material_index];
+		dst->property_count = header->property_count;
+		dst->properties = arena_push_count(arena, dst->property_count, MaterialProperty);
+		memory_copy(dst->properties, default_properties, sizeof(default_properties));
+
+		for (uint32_t property_index = 0; property_index < dst->property_count; ++property_index) {
+			MeshCacheProperty *src = &properties[material_index * header->property_count + property_index];
+			dst->properties[property_index].type = src->type;
+			memory_copy(&dst->properties[property_index].as, src->value, sizeof_member(MaterialProperty, as));
+		}
+	}
+
+	out_scene->image_count = header->image_count;
+	out_scene->images = arena_push_count(arena, header->image_count, ImageSource);
+	for (uint32_t index = 0; index < header->image_count; ++index) {
+		out_scene->images[index] = (ImageSource){
+			.pixels = images[index].size ? base + images[index].offset : NULL,
+			.width = images[index].width,
+			.height = images[index].height,
+			.channels = images[index].channels,
+		};
+	}
+
+	return true;
+}
+
+static bool mesh_cache_load(Arena *arena, String cache_path, uint64_t source_hash, SceneSource *out_scene) {
+	Buffer file = filesystem_map(cache_path);
+	if (file.pointer == NULL)
+		return false;
+
+	if (mesh_cache_parse(arena, file, source_hash, out_scene) == false) {
+		LOG_INFO("Discarding stale mesh cache '%.*s'", SARG(cache_path));
+		filesystem_unmap(file);
+		return false;
+	}
+
+	out_scene->mapping = file;
+	return true;
+}
+
+static void mesh_cache_write(String cache_path, uint64_t source_hash, SceneSource *scene) {
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+
+	// NOTE: Laid out in scratch exactly as it sits on disk, offsets are relative to the header
+	MeshCacheHeader *header = arena_push(scratch.arena, sizeof(MeshCacheHeader), MESH_CACHE_ALIGNMENT, true);
+	uint8_t *base = (uint8_t *)header;
+#define MESH_CACHE_PUSH(size) ((uint8_t *)arena_push(scratch.arena, (size), MESH_CACHE_ALIGNMENT, true))
+
+	*header = (MeshCacheHeader){
+		.magic = MESH_CACHE_MAGIC,
+		.version = IMPORTER_VERSION,
+		.source_hash = source_hash,
+		.mesh_count = scene->mesh_count,
+		.material_count = scene->material_count,
+		.image_count = scene->image_count,
+		.property_count = MATERIAL_PROPERTY_COUNT,
+	};
+
+	MeshCacheMesh *meshes = (MeshCacheMesh *)MESH_CACHE_PUSH(sizeof(MeshCacheMesh) * scene->mesh_count);
+	header->meshes_offset = (uint8_t *)meshes - base;
+	for (uint32_t index = 0; index < scene->mesh_count; ++index) {
+		MeshSource *src = &scene->meshes[index];
+		meshes[index] = (MeshCacheMesh){
+			.vertex_offset = src->vertices - scene->vertices,
+			.index_offset = src->indices - scene->indices,
+			.vertex_size = src->vertex_size,
+			.vertex_count = src->vertex_count,
+			.index_size = src->index_size,
+			.index_count = src->index_count,
+		};
+	}
+
+	uint8_t *mesh_to_material = MESH_CACHE_PUSH(sizeof(uint32_t) * scene->mesh_count);
+	memory_copy(mesh_to_material, scene->mesh_to_material, sizeof(uint32_t) * scene->mesh_count);
+	header->mesh_to_material_offset = mesh_to_material - base;
+
+	uint8_t *bounds = MESH_CACHE_PUSH(sizeof(Interval3) * scene->mesh_count);
+	memory_copy(bounds, scene->bounding_boxes, sizeof(Interval3) * scene->mesh_count);
+	header->bounds_offset = bounds - base;
+
+	MeshCacheProperty *properties = (MeshCacheProperty *)MESH_CACHE_PUSH(sizeof(MeshCacheProperty) * MATERIAL_PROPERTY_COUNT * scene->material_count);
+	header->properties_offset = (uint8_t *)properties - base;
+	for (uint32_t material_index = 0; material_index < scene->material_count; ++material_index) {
+		MaterialSource *src = &scene->materials[material_index];
+		for (uint32_t property_index = 0; property_index < MIN(src->property_count, MATERIAL_PROPERTY_COUNT); ++property_index) {
+			MeshCacheProperty *dst = &properties[material_index * MATERIAL_PROPERTY_COUNT + property_index];
+			dst->type = src->properties[property_index].type;
+			memory_copy(dst->value, &src->properties[property_index].as, sizeof_member(MaterialProperty, as));
+		}
+	}
+
+	MeshCacheImage *images = (MeshCacheImage *)MESH_CACHE_PUSH(sizeof(MeshCacheImage) * scene->image_count);
+	header->images_offset = (uint8_t *)images - base;
+	for (uint32_t index = 0; index < scene->image_count; ++index) {
+		ImageSource *src = &scene->images[index];
+		size_t size = src->pixels ? (size_t)src->width * src->height * src->channels : 0;
+		uint8_t *pixels = MESH_CACHE_PUSH(size);
+		if (size)
+			memory_copy(pixels, src->pixels, size);
+
+		images[index] = (MeshCacheImage){
+			.offset = pixels - base,
+			.size = size,
+			.width = src->width,
+			.height = src->height,
+			.channels = src->channels,
+		};
+	}
+
+	uint8_t *vertices = MESH_CACHE_PUSH(scene->vertices_size);
+	memory_copy(vertices, scene->vertices, scene->vertices_size);
+	header->vertices_offset = vertices - base;
+	header->vertices_size = scene->vertices_size;
+
+	uint8_t *indices = MESH_CACHE_PUSH(scene->indices_size);
+	memory_copy(indices, scene->indices, scene->indices_size);
+	header->indices_offset = indices - base;
+	header->indices_size = scene->indices_size;
+
+	// The file ends on the alignment too, pad with zeroes that were actually pushed
+	size_t end = (uint8_t *)scratch.arena->base + scratch.arena->offset - base;
+	arena_push(scratch.arena, alignup(end, MESH_CACHE_ALIGNMENT) - end, 1, true);
+#undef MESH_CACHE_PUSH
+
+	header->file_size = (uint8_t *)scratch.arena->base + scratch.arena->offset - base;
+
+	// Write next to the destination and rename over it, a crash mid-write never leaves a truncated cache behind
+	String temp_path = temp_path_make(scratch.arena, cache_path);
+	File file = filesystem_open(temp_path, FILE_MODE_WRITE_BINARY);
+	if (file.handle == NULL) {
+		arena_scratch_end(scratch);
+		return;
+	}
+
+	size_t written = file_write(&file, header->file_size, 1, base);
+	file_close(&file);
+	if (written != 1 || filesystem_rename(temp_path, cache_path) == false) {
+		LOG_WARN("Failed to write mesh cache '%.*s'", SARG(cache_path));
+		remove(temp_path.chars);
+	}
+
+	arena_scratch_end(scratch);
+}
+
+void importer_unload_scene(SceneSource *scene) {
+	filesystem_unmap(scene->mapping);
+	scene->mapping = (Buffer){ 0 };
+}
+
+// Covers the scene file and every external buffer and image it references, editing any of them misses the cache.
+// source is the scene file when the caller already has it in memory, otherwise it's mapped from path
+static uint64_t source_hash_compute(String path, Buffer source) {
+	Buffer mapping = { 0 };
+	if (source.pointer == NULL)
+		source = mapping = filesystem_map(path);
+	if (source.pointer == NULL)
+		return 0;
+
+	uint64_t hash = hash64_content(source.pointer, source.size, 0);
+	filesystem_unmap(mapping);
+
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+	StringList dependencies = importer_gltf_dependencies(scratch.arena, path);
+	for (StringNode *node = dependencies.first; node; node = node->next) {
+		Buffer dependency = filesystem_map(node->string);
+		// NOTE: A missing dependency hashes its path instead, the key changes again once the file shows up
+		if (dependency.pointer)
+			hash = hash64_content(dependency.pointer, dependency.size, hash);
+		else
+			hash = hash64_content(node->string.chars, node->string.length, ~hash);
+		filesystem_unmap(dependency);
+	}
+
+	arena_scratch_end(scratch);
+	return hash ? hash : 1;
+}
+
+static SceneSource gltf_scene_import(Arena *arena, String path, Buffer source, bool use_cache) {
 	SceneSource result = { 0 };
 	result.path = string_copy(arena, path);
 
+	uint64_t source_hash = source_hash_compute(path, source);
+
+	ArenaTemp cache_scratch = arena_scratch_begin(arena);
+	String cache_path = importer_mesh_cache_path(cache_scratch.arena, path);
+	if (use_cache && source_hash && mesh_cache_load(arena, cache_path, source_hash, &result)) {
+		LOG_INFO("Loaded %.*s from mesh cache", SARG(path));
+		arena_scratch_end(cache_scratch);
+		return result;
+	}
+
 	cgltf_options options = { 0 };
 	cgltf_data *data = NULL;
-	cgltf_result cgltf_result = cgltf_parse_file(&options, path.chars, &data);
+	// NOTE: Parsed from memory the GLB binary chunk points into source, so it has to outlive the import
+	cgltf_result cgltf_result = source.pointer
+		? cgltf_parse(&options, source.pointer, source.size, &data)
+		: cgltf_parse_file(&options, path.chars, &data);
 
 	if (cgltf_result == cgltf_result_success)
 		cgltf_result = cgltf_load_buffers(&options, data, path.chars);
@@ -217,13 +634,29 @@ SceneSource importer_load_gltf_scene(Arena *arena, String path) {
 				else
 					ASSERT_MESSAGE(false, "Expected png or jpeg");
 
-				String output_path = string_format(arena, "%s/%s.%s", directory.chars, name.chars, extension);
+				// NOTE: Decode straight from the buffer view, the PNG on disk only exists so the asset store can track it
+				uint8_t *pixels = stbi_load_from_memory(buffer_data, src->buffer_view->size, &dst->width, &dst->height, &dst->channels, 4);
+				if (pixels == NULL) {
+					LOG_ERROR("Failed to decode embedded image [ %s ]", name.chars);
+					*dst = (ImageSource){ 0 };
+					continue;
+				}
+
+				dst->channels = 4;
+				dst->pixels = arena_push_copy(arena, pixels, dst->width * dst->height * dst->channels, 1);
+
+				// NOTE: Embedded image names are shared between scenes imported in parallel, the existence check only
+				// saves work and the rename keeps a racing writer from ever exposing a half written file
+				String output_path = string_format(scratch.arena, "%s/%s.%s", directory.chars, name.chars, extension);
 				if (file_exists(output_path) == false) {
-					dst->pixels = stbi_load_from_memory(buffer_data, src->buffer_view->size, &dst->width, &dst->height, &dst->channels, 4);
-					stbi_write_png(output_path.chars, dst->width, dst->height, 4, dst->pixels, STBI_default);
-					stbi_image_free(dst->pixels);
-				} else
-					*dst = importer_load_image(scratch.arena, output_path);
+					String temp_path = temp_path_make(scratch.arena, output_path);
+					if (stbi_write_png(temp_path.chars, dst->width, dst->height, 4, pixels, STBI_default) == 0 ||
+						filesystem_rename(temp_path, output_path) == false) {
+						LOG_WARN("Failed to write embedded image '%.*s'", SARG(output_path));
+						remove(temp_path.chars);
+					}
+				}
+				stbi_image_free(pixels);
 			}
 		}
 
@@ -285,8 +718,9 @@ SceneSource importer_load_gltf_scene(Arena *arena, String path) {
 		result.mesh_to_material = arena_push_count(arena, result.mesh_count, uint32_t);
 		result.bounding_boxes = arena_push_count(arena, result.mesh_count, Interval3);
 
-		result.vertices = arena_push(arena, result.vertices_size, 64, true);
-		result.indices = arena_push(arena, result.indices_size, 64, true);
+		// NOTE: Every byte is written below, Vertex3 has no padding
+		result.vertices = arena_push(arena, result.vertices_size, 64, false);
+		result.indices = arena_push(arena, result.indices_size, 64, false);
 
 		size_t vertices_offset = 0;
 		size_t indices_offset = 0;
@@ -303,8 +737,6 @@ SceneSource importer_load_gltf_scene(Arena *arena, String path) {
 
 				// TODO: Per mesh bounding box instead of per primitive?
 				Interval3 *interval = &result.bounding_boxes[primitive_global_index];
-				interval->min = float3_fill(FLOAT_MAX);
-				interval->max = float3_fill(FLOAT_MIN);
 
 				ASSERT(primitive->attributes && primitive->attributes->data && primitive->indices);
 				mesh->vertex_count = primitive->attributes->data->count;
@@ -313,46 +745,44 @@ SceneSource importer_load_gltf_scene(Arena *arena, String path) {
 				mesh->vertices = result.vertices + vertices_offset;
 				vertices_offset += mesh->vertex_count * mesh->vertex_size;
 
+				cgltf_accessor *positions = NULL, *normals = NULL, *uvs = NULL, *tangents = NULL;
 				for (uint32_t attribute_index = 0; attribute_index < primitive->attributes_count; ++attribute_index) {
 					cgltf_attribute *attribute = &primitive->attributes[attribute_index];
-					cgltf_accessor *accessor = attribute->data;
-
-					ASSERT(accessor->count == mesh->vertex_count);
+					ASSERT(attribute->data->count == mesh->vertex_count);
 
-					size_t offset = 0;
 					switch (attribute->type) {
 						case cgltf_attribute_type_position:
-							offset = offsetof(Vertex3, position);
+							positions = attribute->data;
 							break;
 						case cgltf_attribute_type_normal:
-							offset = offsetof(Vertex3, normal);
+							normals = attribute->data;
 							break;
 						case cgltf_attribute_type_tangent:
-							offset = offsetof(Vertex3, tangent);
+							tangents = attribute->data;
 							break;
 						case cgltf_attribute_type_texcoord:
-							offset = offsetof(Vertex3, uv0);
+							if (attribute->index == 0)
+								uvs = attribute->data;
 							break;
 						/* case cgltf_attribute_type_color: */
 						/* case cgltf_attribute_type_joints: */
 						/* case cgltf_attribute_type_weights: */
 						default:
 							LOG_WARN("Unsupported attribute type");
-							continue;
 							break;
 					}
-
-					uint8_t *vertices = mesh->vertices;
-					for (uint32_t vertex_index = 0; vertex_index < accessor->count; ++vertex_index, vertices += mesh->vertex_size) {
-						cgltf_accessor_read_float(accessor, vertex_index, (void *)(vertices + offset), cgltf_num_components(accessor->type));
-						if (attribute->type == cgltf_attribute_type_position) {
-							float3 position = *((float3 *)vertices);
-							interval->min = float3_min(interval->min, position);
-							interval->max = float3_max(interval->max, position);
-						}
-					}
 				}
 
+				ArenaTemp streams = arena_temp_begin(scratch.arena);
+				VertexStreams source = {
+					.position = accessor_float_stream(streams.arena, positions, mesh->vertex_count, 3),
+					.normal = accessor_float_stream(streams.arena, normals, mesh->vertex_count, 3),
+					.uv0 = accessor_float_stream(streams.arena, uvs, mesh->vertex_count, 2),
+					.tangent = accessor_float_stream(streams.arena, tangents, mesh->vertex_count, 4),
+				};
+				*interval = vertex_streams_interleave(source, (Vertex3 *)mesh->vertices, mesh->vertex_count);
+				arena_temp_end(streams);
+
 				// Indices
 				cgltf_accessor *accessor = primitive->indices;
 
@@ -362,7 +792,7 @@ SceneSource importer_load_gltf_scene(Arena *arena, String path) {
 				mesh->indices = result.indices + indices_offset;
 				indices_offset += mesh->index_size * mesh->index_count;
 
-				size_t written = cgltf_accessor_unpack_indices(accessor, mesh->indices, mesh->index_size, mesh->index_count);
+				accessor_unpack_indices(accessor, (uint32_t *)mesh->indices, mesh->index_count);
 			}
 		}
 
@@ -396,14 +826,87 @@ SceneSource importer_load_gltf_scene(Arena *arena, String path) {
 			/* pstate->components[entity] = COMPONENT_FLAG_DRAWABLE; */
 		}
 
+		if (source_hash)
+			mesh_cache_write(cache_path, source_hash, &result);
 	} else
 		LOG_ERROR("Failed to load '%.*s'", SARG(path));
 
 	cgltf_free(data);
+	arena_scratch_end(scratch);
+	arena_scratch_end(cache_scratch);
 
 	return result;
 }
 
+SceneSource importer_load_gltf_scene(Arena *arena, String path) {
+	return gltf_scene_import(arena, path, (Buffer){ 0 }, true);
+}
+
+SceneSource importer_load_gltf_scene_memory(Arena *arena, String path, Buffer file) {
+	SceneSource result = { .path = string_copy(arena, path) };
+	if (file.size == 0) {
+		LOG_ERROR("Failed to load '%.*s', no scene data", SARG(path));
+		return result;
+	}
+
+	// NOTE: Packs carry the cooked .mesh in place of the scene file, trusted as is since the sources may not ship
+	if (mesh_cache_parse(arena, file, 0, &result)) {
+		LOG_INFO("Loaded %.*s cooked", SARG(path));
+		return result;
+	}
+
+	return gltf_scene_import(arena, path, file, true);
+}
+
+SceneSource importer_reload_gltf_scene(Arena *arena, String path) {
+	return gltf_scene_import(arena, path, (Buffer){ 0 }, false);
+}
+
+bool importer_cook_gltf_scene(Arena *arena, String path) {
+	ArenaTemp scratch = arena_scratch_begin(arena);
+
+	SceneSource scene = gltf_scene_import(scratch.arena, path, (Buffer){ 0 }, false);
+	importer_unload_scene(&scene);
+
+	// NOTE: The cache is only written when the import succeeds, so a cache matching the source means it cooked
+	uint64_t source_hash = source_hash_compute(path, (Buffer){ 0 });
+
+	SceneSource cached = { 0 };
+	bool result = source_hash && mesh_cache_load(scratch.arena, importer_mesh_cache_path(scratch.arena, path), source_hash, &cached);
+	importer_unload_scene(&cached);
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
+StringList importer_gltf_dependencies(Arena *arena, String path) {
+	StringList result = { 0 };
+
+	cgltf_options options = { 0 };
+	cgltf_data *data = NULL;
+	if (cgltf_parse_file(&options, path.chars, &data) != cgltf_result_success)
+		return result;
+
+	ArenaTemp scratch = arena_scratch_begin(arena);
+	String directory = string_copy(scratch.arena, stringpath_directory(path));
+
+	// Only external files, embedded data and data: URIs are covered by the source itself
+	uint32_t uri_count = data->buffers_count + data->images_count;
+	for (uint32_t index = 0; index < uri_count; ++index) {
+		const char *uri = index < data->buffers_count ? data->buffers[index].uri : data->images[index - data->buffers_count].uri;
+		if (uri == NULL || strncmp(uri, "data:", 5) == 0)
+			continue;
+
+		String decoded = string_copy(scratch.arena, string_wrap(uri));
+		decoded.length = cgltf_decode_uri(decoded.chars);
+		stringlist_push(arena, &result, stringpath_join(arena, directory, decoded));
+	}
+
+	cgltf_free(data);
+	arena_scratch_end(scratch);
+	return result;
+}
+
 /* bool importer_load_gltf(Arena *arena, String path, ModelSource *out_model) { */
 /* 	cgltf_options options = { 0 }; */
 /* 	cgltf_data *data = NULL; */
@@ -9,8 +9,26 @@
 
 struct arena;
 
+// NOTE: Bump whenever the import output changes so stale .mesh files get rebuilt
+#define IMPORTER_VERSION 2
+
 /* ENGINE_API Font importer_load_font_ex(Arena *arena, String path, float font_size, uint32_t codepoint_count, const int32_t *codepoints); */ // Doesn't work for arbitrary codepoints yet
 ENGINE_API Font importer_load_font(Arena *arena, String path, float font_size);
+// The font file already in memory, e.g. from asset_store_read
+ENGINE_API Font importer_load_font_memory(Arena *arena, Buffer file, float font_size);
 ENGINE_API ShaderSource importer_load_shader(Arena *arena, String vertex_path, String fragment_path);
 ENGINE_API ImageSource importer_load_image(Arena *arena, String path);
 ENGINE_API SceneSource importer_load_gltf_scene(Arena *arena, String path);
+// Scene file already in memory, e.g. from asset_store_read, it has to outlive the scene. External buffers and
+// images still resolve relative to path, and the .mesh cache next to path is used the same way.
+// file can also be a cooked .mesh, as asset packs carry them, in which case the scene is read straight from it
+ENGINE_API SceneSource importer_load_gltf_scene_memory(Arena *arena, String path, Buffer file);
+// Always imports from the source files and refreshes the .mesh cache, for assets edited while running
+ENGINE_API SceneSource importer_reload_gltf_scene(Arena *arena, String path);
+ENGINE_API void importer_unload_scene(SceneSource *scene);
+
+// Imports the scene ignoring any existing cache and reports whether a fresh .mesh cache was written
+ENGINE_API bool importer_cook_gltf_scene(Arena *arena, String path);
+ENGINE_API String importer_mesh_cache_path(Arena *arena, String source_path);
+// External files the scene reads besides itself (buffers and images referenced by URI)
+ENGINE_API StringList importer_gltf_dependencies(Arena *arena, String path);
@@ -34,6 +34,14 @@
 	#define alignas(X) __attribute((aligned(X)))
 #endif
 
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+	#define thread_local _Thread_local
+#elif defined(_MSC_VER)
+	#define thread_local __declspec(thread)
+#else
+	#define thread_local __thread
+#endif
+
 #define sizeof_member(type, member) (sizeof(((type *)0)->member))
 #define countof(array) (sizeof(array) / sizeof((array)[0]))
 #define indexof(array, ptr) (uint32_t)(ptr - array)
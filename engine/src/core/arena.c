@@ -7,11 +7,36 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 
-Arena scratch_arenas[2] = { 0 };
+#define HUGEPAGE_SIZE MiB(2)
+
+static bool arena_commit(Arena *arena, size_t end);
+static void arena_decommit(Arena *arena, size_t position);
+
+// NOTE: One pair per thread, reserved lazily on first use so threads that never ask for scratch pay nothing
+static thread_local Arena scratch_arenas[2] = { 0 };
 
 Arena arena_make(size_t size) { return (Arena){ .base = malloc(size), .capacity = size }; }
 
+Arena arena_reserve(size_t size, ArenaFlags flags) {
+	size_t granule = FLAG_GET(flags, ARENA_FLAG_HUGEPAGES) ? HUGEPAGE_SIZE : ARENA_COMMIT_GRANULE;
+	size = alignup(size, granule);
+
+	void *base = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (base == MAP_FAILED) {
+		LOG_ERROR("Arena: failed to reserve %zu bytes of address space", size);
+		return (Arena){ 0 };
+	}
+
+#ifdef MADV_HUGEPAGE
+	if (FLAG_GET(flags, ARENA_FLAG_HUGEPAGES) && madvise(base, size, MADV_HUGEPAGE) != 0)
+		LOG_WARN("Arena: MADV_HUGEPAGE rejected, falling back to regular pages");
+#endif
+
+	return (Arena){ .base = base, .capacity = size, .flags = flags | ARENA_FLAG_RESERVE };
+}
+
 Arena *arena_partition(Arena *arena, size_t size) {
 	Arena *sub = arena_push_struct(arena, Arena);
 	sub->base = arena_push(arena, size, 1, true);
@@ -20,12 +45,12 @@ Arena *arena_partition(Arena *arena, size_t size) {
 }
 
 void arena_destroy(Arena *arena) {
-	if (arena->base)
+	if (arena->base && FLAG_GET(arena->flags, ARENA_FLAG_RESERVE))
+		munmap(arena->base, arena->capacity);
+	else if (arena->base)
 		free(arena->base);
 
-	arena->base = NULL;
-	arena->offset = 0;
-	arena->capacity = 0;
+	*arena = (Arena){ 0 };
 }
 
 void *arena_push(Arena *arena, size_t size, size_t alignment, bool zero_memory) {
@@ -40,6 +65,13 @@ void *arena_push(Arena *arena, size_t size, size_t alignment, bool zero_memory)
 		return NULL;
 	}
 
+	if (arena->offset + padding + size > arena->committed && FLAG_GET(arena->flags, ARENA_FLAG_RESERVE)) {
+		if (arena_commit(arena, arena->offset + padding + size) == false) {
+			ASSERT_MESSAGE(false, "ARENA_COMMIT_FAILED");
+			return NULL;
+		}
+	}
+
 	if (zero_memory)
 		memory_zero((void *)aligned, size);
 
@@ -59,6 +91,9 @@ void arena_pop(Arena *arena, size_t size) {
 
 void arena_rewind(Arena *arena, size_t position) {
 	arena->offset = position > arena->capacity ? arena->capacity : position;
+
+	if (FLAG_GET(arena->flags, ARENA_FLAG_RESERVE))
+		arena_decommit(arena, arena->offset);
 }
 
 size_t arena_mark(Arena *arena) {
@@ -66,7 +101,13 @@ size_t arena_mark(Arena *arena) {
 }
 
 void arena_reset(Arena *arena) {
-	memory_zero(arena->base, arena->offset);
+	if (FLAG_GET(arena->flags, ARENA_FLAG_RESERVE)) {
+		// NOTE: Decommitted pages come back zeroed, only clear what stays resident
+		arena_decommit(arena, 0);
+		memory_zero(arena->base, MIN(arena->offset, arena->committed));
+	} else
+		memory_zero(arena->base, arena->offset);
+
 	arena->offset = 0;
 }
 
@@ -80,15 +121,44 @@ void arena_temp_end(ArenaTemp temp) {
 
 ArenaTemp arena_scratch_begin(Arena *conflict) {
 	if (scratch_arenas[0].base == NULL) {
-		// TODO: Lower this back down
-		scratch_arenas[0] = arena_make(MiB(256));
-		scratch_arenas[1] = arena_make(MiB(256));
+		scratch_arenas[0] = arena_reserve(GiB(4), ARENA_FLAG_NONE);
+		scratch_arenas[1] = arena_reserve(GiB(4), ARENA_FLAG_NONE);
 	}
 
 	Arena *selected = conflict == &scratch_arenas[0] ? &scratch_arenas[1] : &scratch_arenas[0];
 	return arena_temp_begin(selected);
 }
 
+void arena_scratch_release(void) {
+	arena_destroy(&scratch_arenas[0]);
+	arena_destroy(&scratch_arenas[1]);
+}
+
+static bool arena_commit(Arena *arena, size_t end) {
+	size_t granule = FLAG_GET(arena->flags, ARENA_FLAG_HUGEPAGES) ? HUGEPAGE_SIZE : ARENA_COMMIT_GRANULE;
+	size_t target = MIN(alignup(end, granule), arena->capacity);
+
+	if (mprotect((uint8_t *)arena->base + arena->committed, target - arena->committed, PROT_READ | PROT_WRITE) != 0) {
+		LOG_ERROR("Arena: failed to commit %zu bytes", target - arena->committed);
+		return false;
+	}
+
+	arena->committed = target;
+	return true;
+}
+
+static void arena_decommit(Arena *arena, size_t position) {
+	size_t granule = FLAG_GET(arena->flags, ARENA_FLAG_HUGEPAGES) ? HUGEPAGE_SIZE : ARENA_COMMIT_GRANULE;
+	size_t keep = alignup(position + ARENA_DECOMMIT_THRESHOLD, granule);
+	if (keep >= arena->committed)
+		return;
+
+	uint8_t *start = (uint8_t *)arena->base + keep;
+	madvise(start, arena->committed - keep, MADV_DONTNEED);
+	mprotect(start, arena->committed - keep, PROT_NONE);
+	arena->committed = keep;
+}
+
 ArenaTrieNode *arena_trienode_ensure(Arena *arena, ArenaTrieNode **root, Buffer key, const char *debug_type_name) {
 	ArenaTrieNode **node = root;
 
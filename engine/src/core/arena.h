@@ -1,9 +1,25 @@
 #pragma once
 
 #include "common.h"
+
+typedef enum {
+	ARENA_FLAG_NONE = 0,
+	// Backed by a reserved virtual range, pages are committed on demand by arena_push
+	ARENA_FLAG_RESERVE = 1 << 0,
+	// Hint the kernel to back the reservation with transparent huge pages
+	ARENA_FLAG_HUGEPAGES = 1 << 1,
+} ArenaFlags;
+
+// NOTE: Rewinding more than this below the committed high-water mark returns the pages to the OS
+#define ARENA_COMMIT_GRANULE KiB(64)
+#define ARENA_DECOMMIT_THRESHOLD MiB(64)
+
 typedef struct arena {
 	size_t offset, capacity;
 	void *base;
+
+	size_t committed;
+	uint32_t flags;
 } Arena;
 typedef struct {
 	struct arena *arena;
@@ -11,10 +27,11 @@ typedef struct {
 } ArenaTemp;
 
 Arena arena_make(size_t size);
+ENGINE_API Arena arena_reserve(size_t size, ArenaFlags flags);
 ENGINE_API Arena *arena_partition(Arena *arena, size_t size);
 static inline Arena arena_wrap(void *buffer, size_t size) { return (Arena){ .base = buffer, .capacity = size }; }
 static inline Arena arena_wrap_buffer(Buffer buffer) { return (Arena){ .base = buffer.pointer, .capacity = buffer.size }; }
-void arena_destroy(Arena *arena);
+ENGINE_API void arena_destroy(Arena *arena);
 
 #define arena_wrap_struct(s) \
 	(Arena) { .base = (s), .capacity = sizeof(*(s)) }
@@ -35,6 +52,8 @@ ENGINE_API ArenaTemp arena_temp_begin(Arena *arena);
 ENGINE_API void arena_temp_end(ArenaTemp temp);
 
 ENGINE_API ArenaTemp arena_scratch_begin(Arena *conflict);
+// Unmaps the calling thread's scratch arenas, call before a worker thread exits
+ENGINE_API void arena_scratch_release(void);
 static inline void arena_scratch_end(ArenaTemp scratch) { arena_temp_end(scratch); }
 
 #define arena_put(arena, T, ...)                                        \
@@ -1,6 +1,30 @@
 #include "cmath.h"
 #include "core/logger.h"
 
+// NOTE: SSE is the baseline on x86-64, AVX2/FMA paths are only compiled in with ENABLE_AVX2 (-mavx2 -mfma).
+// CMATH_SCALAR keeps the plain C paths, tests/cmath_scalar.c builds them as the reference for the SIMD ones
+#if defined(__SSE__) && !defined(CMATH_SCALAR)
+	#define CMATH_SSE
+#endif
+#if defined(__AVX2__) && defined(__FMA__) && !defined(CMATH_SCALAR)
+	#define CMATH_AVX2
+#endif
+
+#if defined(CMATH_SSE)
+	#include <immintrin.h>
+
+	#define SHUFFLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(w, z, y, x))
+	#define SPLAT(v, i) SHUFFLE(v, i, i, i, i)
+
+static inline __m128 madd_ps(__m128 a, __m128 b, __m128 c) {
+	#if defined(__FMA__)
+	return _mm_fmadd_ps(a, b, c);
+	#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+	#endif
+}
+#endif
+
 bool float2_equal(float2 a, float2 b) {
 	bool result = a.x == b.x && a.y == b.y;
 
@@ -185,37 +209,158 @@ float4x4 float4x4_identity(void) {
 }
 
 float4x4 float4x4_multiply(float4x4 lhs, float4x4 rhs) {
-	float4x4 result = { 0 };
-
-#define MAT4_DOT(row, col)                                  \
-	(lhs.elements[0 + row] * rhs.elements[col * 4 + 0] +    \
-		lhs.elements[4 + row] * rhs.elements[col * 4 + 1] + \
-		lhs.elements[8 + row] * rhs.elements[col * 4 + 2] + \
-		lhs.elements[12 + row] * rhs.elements[col * 4 + 3])
-
-	result.elements[0] = MAT4_DOT(0, 0);
-	result.elements[4] = MAT4_DOT(0, 1);
-	result.elements[8] = MAT4_DOT(0, 2);
-	result.elements[12] = MAT4_DOT(0, 3);
-
-	result.elements[1] = MAT4_DOT(1, 0);
-	result.elements[5] = MAT4_DOT(1, 1);
-	result.elements[9] = MAT4_DOT(1, 2);
-	result.elements[13] = MAT4_DOT(1, 3);
-
-	result.elements[2] = MAT4_DOT(2, 0);
-	result.elements[6] = MAT4_DOT(2, 1);
-	result.elements[10] = MAT4_DOT(2, 2);
-	result.elements[14] = MAT4_DOT(2, 3);
-
-	result.elements[3] = MAT4_DOT(3, 0);
-	result.elements[7] = MAT4_DOT(3, 1);
-	result.elements[11] = MAT4_DOT(3, 2);
-	result.elements[15] = MAT4_DOT(3, 3);
-
-#undef MAT4_DOT
+	float4x4 result;
+	float4x4_multiply_into(&result, &lhs, &rhs);
+	return result;
+}
+
+void float4x4_multiply_into(float4x4 *out, const float4x4 *lhs, const float4x4 *rhs) {
+#if defined(CMATH_AVX2)
+	// Two result columns per iteration, each 128-bit lane broadcasts from its own rhs column
+	__m256 l0 = _mm256_broadcast_ps((const __m128 *)&lhs->elements[0]);
+	__m256 l1 = _mm256_broadcast_ps((const __m128 *)&lhs->elements[4]);
+	__m256 l2 = _mm256_broadcast_ps((const __m128 *)&lhs->elements[8]);
+	__m256 l3 = _mm256_broadcast_ps((const __m128 *)&lhs->elements[12]);
+
+	for (uint32_t column = 0; column < 4; column += 2) {
+		__m256 r = _mm256_loadu_ps(&rhs->elements[column * 4]);
+		__m256 result = _mm256_mul_ps(l0, _mm256_permute_ps(r, 0x00));
+		result = _mm256_fmadd_ps(l1, _mm256_permute_ps(r, 0x55), result);
+		result = _mm256_fmadd_ps(l2, _mm256_permute_ps(r, 0xAA), result);
+		result = _mm256_fmadd_ps(l3, _mm256_permute_ps(r, 0xFF), result);
+		_mm256_storeu_ps(&out->elements[column * 4], result);
+	}
+#elif defined(CMATH_SSE)
+	__m128 l0 = _mm_loadu_ps(&lhs->elements[0]);
+	__m128 l1 = _mm_loadu_ps(&lhs->elements[4]);
+	__m128 l2 = _mm_loadu_ps(&lhs->elements[8]);
+	__m128 l3 = _mm_loadu_ps(&lhs->elements[12]);
+
+	for (uint32_t column = 0; column < 4; ++column) {
+		__m128 r = _mm_loadu_ps(&rhs->elements[column * 4]);
+		__m128 result = _mm_mul_ps(l0, SPLAT(r, 0));
+		result = madd_ps(l1, SPLAT(r, 1), result);
+		result = madd_ps(l2, SPLAT(r, 2), result);
+		result = madd_ps(l3, SPLAT(r, 3), result);
+		_mm_storeu_ps(&out->elements[column * 4], result);
+	}
+#else
+	float4x4 result;
+
+	#define MAT4_DOT(row, col)                                   \
+		(lhs->elements[0 + row] * rhs->elements[col * 4 + 0] +    \
+			lhs->elements[4 + row] * rhs->elements[col * 4 + 1] + \
+			lhs->elements[8 + row] * rhs->elements[col * 4 + 2] + \
+			lhs->elements[12 + row] * rhs->elements[col * 4 + 3])
+
+	for (uint32_t col = 0; col < 4; ++col) {
+		for (uint32_t row = 0; row < 4; ++row)
+			result.elements[col * 4 + row] = MAT4_DOT(row, col);
+	}
 
-	return result;
+	#undef MAT4_DOT
+
+	*out = result;
+#endif
+}
+
+float4x4 float4x4_inverse(float4x4 m) {
+	float4x4 result;
+	if (float4x4_inverse_into(&result, &m) == false)
+		return float4x4_identity();
+	return result;
+}
+
+bool float4x4_inverse_into(float4x4 *out, const float4x4 *m) {
+#if defined(CMATH_SSE)
+	// Block-wise inverse over the four 2x2 sub-matrices. Works on columns as if they were rows,
+	// inverse(transpose(M)) == transpose(inverse(M)) so storing the rows back as columns is correct
+	__m128 c0 = _mm_loadu_ps(&m->elements[0]);
+	__m128 c1 = _mm_loadu_ps(&m->elements[4]);
+	__m128 c2 = _mm_loadu_ps(&m->elements[8]);
+	__m128 c3 = _mm_loadu_ps(&m->elements[12]);
+
+	__m128 A = _mm_movelh_ps(c0, c1);
+	__m128 B = _mm_movehl_ps(c1, c0);
+	__m128 C = _mm_movelh_ps(c2, c3);
+	__m128 D = _mm_movehl_ps(c3, c2);
+
+	// (|A| |B| |C| |D|)
+	__m128 determinants = _mm_sub_ps(
+		_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+		_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+	__m128 det_a = SPLAT(determinants, 0);
+	__m128 det_b = SPLAT(determinants, 1);
+	__m128 det_c = SPLAT(determinants, 2);
+	__m128 det_d = SPLAT(determinants, 3);
+
+	// 2x2 helpers on row-major { m00 m01 m10 m11 }: A*B, adj(A)*B and A*adj(B)
+	#define MAT2_MUL(a, b) _mm_add_ps(_mm_mul_ps((a), SHUFFLE(b, 0, 3, 0, 3)), _mm_mul_ps(SHUFFLE(a, 1, 0, 3, 2), SHUFFLE(b, 2, 1, 2, 1)))
+	#define MAT2_ADJ_MUL(a, b) _mm_sub_ps(_mm_mul_ps(SHUFFLE(a, 3, 3, 0, 0), (b)), _mm_mul_ps(SHUFFLE(a, 1, 1, 2, 2), SHUFFLE(b, 2, 3, 0, 1)))
+	#define MAT2_MUL_ADJ(a, b) _mm_sub_ps(_mm_mul_ps((a), SHUFFLE(b, 3, 0, 3, 0)), _mm_mul_ps(SHUFFLE(a, 1, 0, 3, 2), SHUFFLE(b, 2, 1, 2, 1)))
+
+	__m128 d_c = MAT2_ADJ_MUL(D, C);
+	__m128 a_b = MAT2_ADJ_MUL(A, B);
+	__m128 X = _mm_sub_ps(_mm_mul_ps(det_d, A), MAT2_MUL(B, d_c));
+	__m128 W = _mm_sub_ps(_mm_mul_ps(det_a, D), MAT2_MUL(C, a_b));
+	__m128 Y = _mm_sub_ps(_mm_mul_ps(det_b, C), MAT2_MUL_ADJ(D, a_b));
+	__m128 Z = _mm_sub_ps(_mm_mul_ps(det_c, B), MAT2_MUL_ADJ(A, d_c));
+
+	#undef MAT2_MUL
+	#undef MAT2_ADJ_MUL
+	#undef MAT2_MUL_ADJ
+
+	// |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+	__m128 trace = _mm_mul_ps(a_b, SHUFFLE(d_c, 0, 2, 1, 3));
+	trace = _mm_add_ps(trace, _mm_movehl_ps(trace, trace));
+	trace = _mm_add_ss(trace, SPLAT(trace, 1));
+	__m128 det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), SPLAT(trace, 0));
+
+	float determinant = _mm_cvtss_f32(det_m);
+	if (determinant == 0.0f)
+		return false;
+
+	__m128 reciprocal = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+	X = _mm_mul_ps(X, reciprocal);
+	Y = _mm_mul_ps(Y, reciprocal);
+	Z = _mm_mul_ps(Z, reciprocal);
+	W = _mm_mul_ps(W, reciprocal);
+
+	_mm_storeu_ps(&out->elements[0], _mm_shuffle_ps(X, Y, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_storeu_ps(&out->elements[4], _mm_shuffle_ps(X, Y, _MM_SHUFFLE(0, 2, 0, 2)));
+	_mm_storeu_ps(&out->elements[8], _mm_shuffle_ps(Z, W, _MM_SHUFFLE(1, 3, 1, 3)));
+	_mm_storeu_ps(&out->elements[12], _mm_shuffle_ps(Z, W, _MM_SHUFFLE(0, 2, 0, 2)));
+	return true;
+#else
+	const float *e = m->elements;
+	float inverse[16];
+
+	inverse[0] = e[5] * e[10] * e[15] - e[5] * e[11] * e[14] - e[9] * e[6] * e[15] + e[9] * e[7] * e[14] + e[13] * e[6] * e[11] - e[13] * e[7] * e[10];
+	inverse[4] = -e[4] * e[10] * e[15] + e[4] * e[11] * e[14] + e[8] * e[6] * e[15] - e[8] * e[7] * e[14] - e[12] * e[6] * e[11] + e[12] * e[7] * e[10];
+	inverse[8] = e[4] * e[9] * e[15] - e[4] * e[11] * e[13] - e[8] * e[5] * e[15] + e[8] * e[7] * e[13] + e[12] * e[5] * e[11] - e[12] * e[7] * e[9];
+	inverse[12] = -e[4] * e[9] * e[14] + e[4] * e[10] * e[13] + e[8] * e[5] * e[14] - e[8] * e[6] * e[13] - e[12] * e[5] * e[10] + e[12] * e[6] * e[9];
+	inverse[1] = -e[1] * e[10] * e[15] + e[1] * e[11] * e[14] + e[9] * e[2] * e[15] - e[9] * e[3] * e[14] - e[13] * e[2] * e[11] + e[13] * e[3] * e[10];
+	inverse[5] = e[0] * e[10] * e[15] - e[0] * e[11] * e[14] - e[8] * e[2] * e[15] + e[8] * e[3] * e[14] + e[12] * e[2] * e[11] - e[12] * e[3] * e[10];
+	inverse[9] = -e[0] * e[9] * e[15] + e[0] * e[11] * e[13] + e[8] * e[1] * e[15] - e[8] * e[3] * e[13] - e[12] * e[1] * e[11] + e[12] * e[3] * e[9];
+	inverse[13] = e[0] * e[9] * e[14] - e[0] * e[10] * e[13] - e[8] * e[1] * e[14] + e[8] * e[2] * e[13] + e[12] * e[1] * e[10] - e[12] * e[2] * e[9];
+	inverse[2] = e[1] * e[6] * e[15] - e[1] * e[7] * e[14] - e[5] * e[2] * e[15] + e[5] * e[3] * e[14] + e[13] * e[2] * e[7] - e[13] * e[3] * e[6];
+	inverse[6] = -e[0] * e[6] * e[15] + e[0] * e[7] * e[14] + e[4] * e[2] * e[15] - e[4] * e[3] * e[14] - e[12] * e[2] * e[7] + e[12] * e[3] * e[6];
+	inverse[10] = e[0] * e[5] * e[15] - e[0] * e[7] * e[13] - e[4] * e[1] * e[15] + e[4] * e[3] * e[13] + e[12] * e[1] * e[7] - e[12] * e[3] * e[5];
+	inverse[14] = -e[0] * e[5] * e[14] + e[0] * e[6] * e[13] + e[4] * e[1] * e[14] - e[4] * e[2] * e[13] - e[12] * e[1] * e[6] + e[12] * e[2] * e[5];
+	inverse[3] = -e[1] * e[6] * e[11] + e[1] * e[7] * e[10] + e[5] * e[2] * e[11] - e[5] * e[3] * e[10] - e[9] * e[2] * e[7] + e[9] * e[3] * e[6];
+	inverse[7] = e[0] * e[6] * e[11] - e[0] * e[7] * e[10] - e[4] * e[2] * e[11] + e[4] * e[3] * e[10] + e[8] * e[2] * e[7] - e[8] * e[3] * e[6];
+	inverse[11] = -e[0] * e[5] * e[11] + e[0] * e[7] * e[9] + e[4] * e[1] * e[11] - e[4] * e[3] * e[9] - e[8] * e[1] * e[7] + e[8] * e[3] * e[5];
+	inverse[15] = e[0] * e[5] * e[10] - e[0] * e[6] * e[9] - e[4] * e[1] * e[10] + e[4] * e[2] * e[9] + e[8] * e[1] * e[6] - e[8] * e[2] * e[5];
+
+	float determinant = e[0] * inverse[0] + e[1] * inverse[4] + e[2] * inverse[8] + e[3] * inverse[12];
+	if (determinant == 0.0f)
+		return false;
+
+	float reciprocal = 1.0f / determinant;
+	for (uint32_t index = 0; index < 16; ++index)
+		out->elements[index] = inverse[index] * reciprocal;
+	return true;
+#endif
 }
 
 float4x4 float4x4_translate(float4x4 m, float3 t) {
@@ -345,17 +490,25 @@ float4x4 float4x4_scaling(float3 scale) {
 }
 
 float4x4 float4x4_compose(float3 position, float3 rotation, float3 scale) {
-	float4x4 result = { 0 };
+	float4x4 result;
+	float4x4_compose_into(&result, position, rotation, scale);
+	return result;
+}
 
-	float4x4 T = float4x4_translation(position);
-	float4x4 S = float4x4_scaling(scale);
-	float4x4 rotation_x = float4x4_rotation(deg2radf(rotation.x), FLOAT3_X);
-	float4x4 rotation_y = float4x4_rotation(deg2radf(rotation.y), FLOAT3_Y);
-	float4x4 rotation_z = float4x4_rotation(deg2radf(rotation.z), FLOAT3_Z);
-	float4x4 R = float4x4_multiply(rotation_z, float4x4_multiply(rotation_y, rotation_x));
+void float4x4_compose_into(float4x4 *out, float3 position, float3 rotation, float3 scale) {
+	// T * Rz * Ry * Rx * S written out directly instead of four matrix multiplies
+	float sx = sinf(deg2radf(rotation.x)), cx = cosf(deg2radf(rotation.x));
+	float sy = sinf(deg2radf(rotation.y)), cy = cosf(deg2radf(rotation.y));
+	float sz = sinf(deg2radf(rotation.z)), cz = cosf(deg2radf(rotation.z));
 
-	result = float4x4_multiply(T, float4x4_multiply(R, S));
-	return result;
+	// clang-format off
+	*out = (float4x4){{
+	  [0] = cy * cz * scale.x,                  [4] = (sx * sy * cz - cx * sz) * scale.y, [8]  = (cx * sy * cz + sx * sz) * scale.z, [12] = position.x,
+	  [1] = cy * sz * scale.x,                  [5] = (sx * sy * sz + cx * cz) * scale.y, [9]  = (cx * sy * sz - sx * cz) * scale.z, [13] = position.y,
+	  [2] = -sy * scale.x,                      [6] = sx * cy * scale.y,                  [10] = cx * cy * scale.z,                  [14] = position.z,
+	  [3] = 0.0f,                               [7] = 0.0f,                               [11] = 0.0f,                               [15] = 1.0f
+	}};
+	// clang-format on
 }
 
 float3 float4x4_transform(float4x4 m, float4 v) {
@@ -367,6 +520,18 @@ float3 float4x4_transform(float4x4 m, float4 v) {
 
 	return result;
 }
+
+// NOTE: Plain C on purpose, splatting the point and storing the lanes back out cost more than the three dot products
+float3 float4x4_transform_point(const float4x4 *m, float3 point) {
+	float3 result = {
+		m->elements[0] * point.x + m->elements[4] * point.y + m->elements[8] * point.z + m->elements[12],
+		m->elements[1] * point.x + m->elements[5] * point.y + m->elements[9] * point.z + m->elements[13],
+		m->elements[2] * point.x + m->elements[6] * point.y + m->elements[10] * point.z + m->elements[14],
+	};
+
+	return result;
+}
+
 float4x4 float4x4_perspective(float fovy_radians, float aspect, float near_z, float far_z) {
 	float4x4 result = { 0 };
 
@@ -106,6 +106,12 @@ static inline float4 float4_from_float3(float3 v) { return (float4){ v.x, v.y, v
 
 ENGINE_API float4x4 float4x4_identity(void);
 ENGINE_API float4x4 float4x4_multiply(float4x4 lhs, float4x4 rhs);
+// out may alias lhs or rhs
+ENGINE_API void float4x4_multiply_into(float4x4 *out, const float4x4 *lhs, const float4x4 *rhs);
+
+// Singular matrices return the identity, float4x4_inverse_into reports them and leaves out untouched
+ENGINE_API float4x4 float4x4_inverse(float4x4 m);
+ENGINE_API bool float4x4_inverse_into(float4x4 *out, const float4x4 *m);
 
 ENGINE_API float4x4 float4x4_translate(float4x4 matrix, float3 translation);
 ENGINE_API float4x4 float4x4_rotate(float4x4 matrix, float angle_radians, float3 axis);
@@ -116,7 +122,9 @@ ENGINE_API float4x4 float4x4_rotation(float angle, float3 axis);
 ENGINE_API float4x4 float4x4_scaling(float3 scale);
 
 ENGINE_API float4x4 float4x4_compose(float3 position, float3 rotation, float3 scale);
+ENGINE_API void float4x4_compose_into(float4x4 *out, float3 position, float3 rotation, float3 scale);
 ENGINE_API float3 float4x4_transform(float4x4 m, float4 v);
+ENGINE_API float3 float4x4_transform_point(const float4x4 *m, float3 point);
 
 ENGINE_API float4x4 float4x4_perspective(float fovy_radians, float aspect,
 	float near_z, float far_z);
@@ -0,0 +1,194 @@
+#include "frustum.h"
+
+// NOTE: Boxes are tested 4 at a time in SoA form, the remainder goes through the scalar path
+#if defined(__SSE__)
+	#include <immintrin.h>
+
+static inline __m128 madd_ps(__m128 a, __m128 b, __m128 c) {
+	#if defined(__FMA__)
+	return _mm_fmadd_ps(a, b, c);
+	#else
+	return _mm_add_ps(_mm_mul_ps(a, b), c);
+	#endif
+}
+
+static inline __m128 abs_ps(__m128 v) {
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+#endif
+
+static float4 plane_normalize(float4 plane) {
+	float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+	if (length < EPSILON)
+		return plane;
+
+	float inverse = 1.0f / length;
+	return (float4){ plane.x * inverse, plane.y * inverse, plane.z * inverse, plane.w * inverse };
+}
+
+Frustum frustum_make(const float4x4 *view_projection) {
+	const float *m = view_projection->elements;
+
+	// Column major, row i is (m[i], m[4 + i], m[8 + i], m[12 + i])
+	float4 rows[4];
+	for (uint32_t index = 0; index < 4; ++index)
+		rows[index] = (float4){ m[index], m[4 + index], m[8 + index], m[12 + index] };
+
+	Frustum result = { 0 };
+	result.planes[FRUSTUM_PLANE_LEFT] = (float4){ rows[3].x + rows[0].x, rows[3].y + rows[0].y, rows[3].z + rows[0].z, rows[3].w + rows[0].w };
+	result.planes[FRUSTUM_PLANE_RIGHT] = (float4){ rows[3].x - rows[0].x, rows[3].y - rows[0].y, rows[3].z - rows[0].z, rows[3].w - rows[0].w };
+	result.planes[FRUSTUM_PLANE_BOTTOM] = (float4){ rows[3].x + rows[1].x, rows[3].y + rows[1].y, rows[3].z + rows[1].z, rows[3].w + rows[1].w };
+	result.planes[FRUSTUM_PLANE_TOP] = (float4){ rows[3].x - rows[1].x, rows[3].y - rows[1].y, rows[3].z - rows[1].z, rows[3].w - rows[1].w };
+	// Vulkan depth range, 0 <= z <= w
+	result.planes[FRUSTUM_PLANE_NEAR] = rows[2];
+	result.planes[FRUSTUM_PLANE_FAR] = (float4){ rows[3].x - rows[2].x, rows[3].y - rows[2].y, rows[3].z - rows[2].z, rows[3].w - rows[2].w };
+
+	for (uint32_t index = 0; index < FRUSTUM_PLANE_COUNT; ++index)
+		result.planes[index] = plane_normalize(result.planes[index]);
+
+	return result;
+}
+
+Interval3 interval3_transform(const float4x4 *world, Interval3 local) {
+	const float *m = world->elements;
+
+	float3 center = {
+		(local.min.x + local.max.x) * 0.5f,
+		(local.min.y + local.max.y) * 0.5f,
+		(local.min.z + local.max.z) * 0.5f,
+	};
+	float3 extent = {
+		(local.max.x - local.min.x) * 0.5f,
+		(local.max.y - local.min.y) * 0.5f,
+		(local.max.z - local.min.z) * 0.5f,
+	};
+
+	float3 world_center = {
+		m[0] * center.x + m[4] * center.y + m[8] * center.z + m[12],
+		m[1] * center.x + m[5] * center.y + m[9] * center.z + m[13],
+		m[2] * center.x + m[6] * center.y + m[10] * center.z + m[14],
+	};
+	float3 world_extent = {
+		fabsf(m[0]) * extent.x + fabsf(m[4]) * extent.y + fabsf(m[8]) * extent.z,
+		fabsf(m[1]) * extent.x + fabsf(m[5]) * extent.y + fabsf(m[9]) * extent.z,
+		fabsf(m[2]) * extent.x + fabsf(m[6]) * extent.y + fabsf(m[10]) * extent.z,
+	};
+
+	return (Interval3){
+		.min = float3_subtract(world_center, world_extent),
+		.max = float3_add(world_center, world_extent),
+	};
+}
+
+bool frustum_test_box(const Frustum *frustum, Interval3 box) {
+	float3 center = {
+		(box.min.x + box.max.x) * 0.5f,
+		(box.min.y + box.max.y) * 0.5f,
+		(box.min.z + box.max.z) * 0.5f,
+	};
+	float3 extent = {
+		(box.max.x - box.min.x) * 0.5f,
+		(box.max.y - box.min.y) * 0.5f,
+		(box.max.z - box.min.z) * 0.5f,
+	};
+
+	for (uint32_t index = 0; index < FRUSTUM_PLANE_COUNT; ++index) {
+		float4 plane = frustum->planes[index];
+
+		float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+		float radius = fabsf(plane.x) * extent.x + fabsf(plane.y) * extent.y + fabsf(plane.z) * extent.z;
+		if (distance + radius < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+uint32_t frustum_cull_boxes(
+	const Frustum *frustum,
+	const Interval3 *bounds, const float4x4 *worlds, uint32_t count,
+	uint32_t *out_visible, CullStats *stats) {
+	uint32_t visible_count = 0;
+	uint32_t index = 0;
+
+#if defined(__SSE__)
+	__m128 plane_x[FRUSTUM_PLANE_COUNT], plane_y[FRUSTUM_PLANE_COUNT], plane_z[FRUSTUM_PLANE_COUNT], plane_w[FRUSTUM_PLANE_COUNT];
+	__m128 plane_abs_x[FRUSTUM_PLANE_COUNT], plane_abs_y[FRUSTUM_PLANE_COUNT], plane_abs_z[FRUSTUM_PLANE_COUNT];
+	for (uint32_t plane_index = 0; plane_index < FRUSTUM_PLANE_COUNT; ++plane_index) {
+		float4 plane = frustum->planes[plane_index];
+		plane_x[plane_index] = _mm_set1_ps(plane.x);
+		plane_y[plane_index] = _mm_set1_ps(plane.y);
+		plane_z[plane_index] = _mm_set1_ps(plane.z);
+		plane_w[plane_index] = _mm_set1_ps(plane.w);
+		plane_abs_x[plane_index] = abs_ps(plane_x[plane_index]);
+		plane_abs_y[plane_index] = abs_ps(plane_y[plane_index]);
+		plane_abs_z[plane_index] = abs_ps(plane_z[plane_index]);
+	}
+
+	__m128 half = _mm_set1_ps(0.5f);
+	for (; index + 4 <= count; index += 4) {
+		// World space center/extent of each box, one box per register
+		__m128 centers[4], extents[4];
+		for (uint32_t lane = 0; lane < 4; ++lane) {
+			const Interval3 *box = &bounds[index + lane];
+			const float *m = worlds[index + lane].elements;
+
+			__m128 min = _mm_setr_ps(box->min.x, box->min.y, box->min.z, 0.0f);
+			__m128 max = _mm_setr_ps(box->max.x, box->max.y, box->max.z, 0.0f);
+			__m128 local_center = _mm_mul_ps(_mm_add_ps(min, max), half);
+			__m128 local_extent = _mm_mul_ps(_mm_sub_ps(max, min), half);
+
+			__m128 column0 = _mm_loadu_ps(&m[0]);
+			__m128 column1 = _mm_loadu_ps(&m[4]);
+			__m128 column2 = _mm_loadu_ps(&m[8]);
+
+			__m128 center = madd_ps(column0, _mm_shuffle_ps(local_center, local_center, _MM_SHUFFLE(0, 0, 0, 0)), _mm_loadu_ps(&m[12]));
+			center = madd_ps(column1, _mm_shuffle_ps(local_center, local_center, _MM_SHUFFLE(1, 1, 1, 1)), center);
+			center = madd_ps(column2, _mm_shuffle_ps(local_center, local_center, _MM_SHUFFLE(2, 2, 2, 2)), center);
+
+			__m128 extent = _mm_mul_ps(abs_ps(column0), _mm_shuffle_ps(local_extent, local_extent, _MM_SHUFFLE(0, 0, 0, 0)));
+			extent = madd_ps(abs_ps(column1), _mm_shuffle_ps(local_extent, local_extent, _MM_SHUFFLE(1, 1, 1, 1)), extent);
+			extent = madd_ps(abs_ps(column2), _mm_shuffle_ps(local_extent, local_extent, _MM_SHUFFLE(2, 2, 2, 2)), extent);
+
+			centers[lane] = center;
+			extents[lane] = extent;
+		}
+
+		// To SoA, after the transpose register 0 holds x of all four boxes and so on
+		_MM_TRANSPOSE4_PS(centers[0], centers[1], centers[2], centers[3]);
+		_MM_TRANSPOSE4_PS(extents[0], extents[1], extents[2], extents[3]);
+
+		__m128 outside = _mm_setzero_ps();
+		for (uint32_t plane_index = 0; plane_index < FRUSTUM_PLANE_COUNT; ++plane_index) {
+			__m128 distance = madd_ps(plane_x[plane_index], centers[0], plane_w[plane_index]);
+			distance = madd_ps(plane_y[plane_index], centers[1], distance);
+			distance = madd_ps(plane_z[plane_index], centers[2], distance);
+
+			__m128 radius = _mm_mul_ps(plane_abs_x[plane_index], extents[0]);
+			radius = madd_ps(plane_abs_y[plane_index], extents[1], radius);
+			radius = madd_ps(plane_abs_z[plane_index], extents[2], radius);
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+		}
+
+		uint32_t outside_mask = (uint32_t)_mm_movemask_ps(outside);
+		for (uint32_t lane = 0; lane < 4; ++lane) {
+			if ((outside_mask & (1u << lane)) == 0)
+				out_visible[visible_count++] = index + lane;
+		}
+	}
+#endif
+
+	for (; index < count; ++index) {
+		if (frustum_test_box(frustum, interval3_transform(&worlds[index], bounds[index])))
+			out_visible[visible_count++] = index;
+	}
+
+	if (stats) {
+		stats->tested += count;
+		stats->visible += visible_count;
+		stats->culled += count - visible_count;
+	}
+
+	return visible_count;
+}
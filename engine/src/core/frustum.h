@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common.h"
+#include "core/cmath.h"
+
+typedef enum {
+	FRUSTUM_PLANE_LEFT,
+	FRUSTUM_PLANE_RIGHT,
+	FRUSTUM_PLANE_BOTTOM,
+	FRUSTUM_PLANE_TOP,
+	FRUSTUM_PLANE_NEAR,
+	FRUSTUM_PLANE_FAR,
+
+	FRUSTUM_PLANE_COUNT,
+} FrustumPlane;
+
+// NOTE: Planes are xyz = normal, w = distance, a point p is inside when dot(normal, p) + w >= 0
+typedef struct {
+	float4 planes[FRUSTUM_PLANE_COUNT];
+} Frustum;
+
+typedef struct {
+	uint32_t tested, visible, culled;
+} CullStats;
+
+// Expects Vulkan clip space (z in [0, w]), works for both perspective and orthographic projections
+ENGINE_API Frustum frustum_make(const float4x4 *view_projection);
+
+// World space bounds of a local box, transformed by an affine matrix
+ENGINE_API Interval3 interval3_transform(const float4x4 *world, Interval3 local);
+
+ENGINE_API bool frustum_test_box(const Frustum *frustum, Interval3 box);
+
+// Transforms bounds[i] by worlds[i] and writes the indices of boxes touching the frustum to out_visible, in order.
+// out_visible needs room for count indices, stats is optional and accumulates
+ENGINE_API uint32_t frustum_cull_boxes(
+	const Frustum *frustum,
+	const Interval3 *bounds, const float4x4 *worlds, uint32_t count,
+	uint32_t *out_visible, CullStats *stats);
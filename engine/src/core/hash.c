@@ -0,0 +1,78 @@
+#include "hash.h"
+
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t rotl64(uint64_t value, uint32_t count) {
+	return (value << count) | (value >> (64 - count));
+}
+
+static inline uint64_t read64(const uint8_t *pointer) {
+	uint64_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+static inline uint32_t read32(const uint8_t *pointer) {
+	uint32_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+static inline uint64_t xxh64_round(uint64_t accumulator, uint64_t input) {
+	accumulator += input * PRIME64_2;
+	return rotl64(accumulator, 31) * PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge(uint64_t accumulator, uint64_t value) {
+	accumulator ^= xxh64_round(0, value);
+	return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t hash64_content(const void *data, size_t size, uint64_t seed) {
+	const uint8_t *cursor = data, *end = cursor + size;
+	uint64_t result;
+
+	if (size >= 32) {
+		uint64_t lanes[4] = { seed + PRIME64_1 + PRIME64_2, seed + PRIME64_2, seed, seed - PRIME64_1 };
+		for (; end - cursor >= 32; cursor += 32) {
+			lanes[0] = xxh64_round(lanes[0], read64(cursor));
+			lanes[1] = xxh64_round(lanes[1], read64(cursor + 8));
+			lanes[2] = xxh64_round(lanes[2], read64(cursor + 16));
+			lanes[3] = xxh64_round(lanes[3], read64(cursor + 24));
+		}
+
+		result = rotl64(lanes[0], 1) + rotl64(lanes[1], 7) + rotl64(lanes[2], 12) + rotl64(lanes[3], 18);
+		for (uint32_t index = 0; index < 4; ++index)
+			result = xxh64_merge(result, lanes[index]);
+	} else
+		result = seed + PRIME64_5;
+
+	result += size;
+
+	for (; end - cursor >= 8; cursor += 8) {
+		result ^= xxh64_round(0, read64(cursor));
+		result = rotl64(result, 27) * PRIME64_1 + PRIME64_4;
+	}
+	if (end - cursor >= 4) {
+		result ^= (uint64_t)read32(cursor) * PRIME64_1;
+		result = rotl64(result, 23) * PRIME64_2 + PRIME64_3;
+		cursor += 4;
+	}
+	for (; cursor < end; ++cursor) {
+		result ^= *cursor * PRIME64_5;
+		result = rotl64(result, 11) * PRIME64_1;
+	}
+
+	result ^= result >> 33;
+	result *= PRIME64_2;
+	result ^= result >> 29;
+	result *= PRIME64_3;
+	result ^= result >> 32;
+	return result;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "common.h"
+
+// XXH64, 8 bytes per step instead of hash64's 1, meant for hashing whole files
+ENGINE_API uint64_t hash64_content(const void *data, size_t size, uint64_t seed);
@@ -0,0 +1,338 @@
+#define _GNU_SOURCE
+#include "jobs.h"
+
+#include "common.h"
+#include "core/arena.h"
+#include "core/debug.h"
+#include "core/logger.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define cpu_relax() _mm_pause()
+#else
+	#define cpu_relax() ((void)0)
+#endif
+
+#define JOB_SPIN_COUNT 256
+
+typedef struct {
+	PFN_job function;
+	void *user_data;
+	JobCounter *counter;
+} Job;
+
+// NOTE: Chase-Lev deque. The owning thread pushes and pops at the bottom, every other thread steals from the top
+typedef struct {
+	alignas(64) int64_t top;
+	alignas(64) int64_t bottom;
+	Job *jobs;
+} JobQueue;
+
+typedef struct {
+	PFN_job_range function;
+	void *user_data;
+	uint32_t start, end;
+} JobRange;
+
+struct JobState {
+	JobQueue queues[MAX_JOB_WORKERS + 1];
+	pthread_t threads[MAX_JOB_WORKERS];
+	uint32_t worker_count;
+
+	int32_t running;
+	int32_t sleeping;
+	sem_t wake;
+};
+
+static JobState *state;
+static thread_local int32_t thread_index = -1;
+static thread_local uint32_t steal_seed = 0;
+
+static bool job_queue_push(JobQueue *queue, Job job);
+static bool job_queue_pop(JobQueue *queue, Job *out_job);
+static bool job_queue_steal(JobQueue *queue, Job *out_job);
+
+static bool job_acquire(Job *out_job);
+static void job_execute(Job *job);
+static void *job_worker_main(void *user_data);
+static void job_range_execute(void *user_data);
+
+JobState *job_system_startup(Arena *arena, uint32_t worker_count, bool pin_threads) {
+	if (worker_count == 0) {
+		long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+		worker_count = core_count > 1 ? (uint32_t)core_count - 1 : 1;
+	}
+	worker_count = MIN(worker_count, MAX_JOB_WORKERS);
+
+	state = arena_push_struct(arena, JobState);
+	state->worker_count = worker_count;
+	state->running = true;
+
+	for (uint32_t index = 0; index <= worker_count; ++index)
+		state->queues[index].jobs = arena_push_count(arena, JOB_QUEUE_CAPACITY, Job);
+
+	if (sem_init(&state->wake, 0, 0) != 0) {
+		LOG_ERROR("Jobs: failed to create wake semaphore");
+		state = NULL;
+		return NULL;
+	}
+
+	thread_index = 0;
+	steal_seed = 0x9E3779B9u;
+
+	long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+	for (uint32_t index = 0; index < worker_count; ++index) {
+		if (pthread_create(&state->threads[index], NULL, job_worker_main, (void *)(uintptr_t)(index + 1)) != 0) {
+			LOG_ERROR("Jobs: failed to create worker thread %d", index + 1);
+			state->worker_count = index;
+			break;
+		}
+
+		if (pin_threads && core_count > 0) {
+			cpu_set_t cpu_set;
+			CPU_ZERO(&cpu_set);
+			CPU_SET((index + 1) % core_count, &cpu_set);
+			if (pthread_setaffinity_np(state->threads[index], sizeof(cpu_set), &cpu_set) != 0)
+				LOG_WARN("Jobs: failed to pin worker %d to core %d", index + 1, (index + 1) % core_count);
+		}
+	}
+
+	LOG_INFO("Jobs: %d workers started", state->worker_count);
+	return state;
+}
+
+bool job_system_shutdown(void) {
+	if (state == NULL)
+		return false;
+
+	__atomic_store_n(&state->running, false, __ATOMIC_SEQ_CST);
+	for (uint32_t index = 0; index < state->worker_count; ++index)
+		sem_post(&state->wake);
+
+	for (uint32_t index = 0; index < state->worker_count; ++index)
+		pthread_join(state->threads[index], NULL);
+
+	sem_destroy(&state->wake);
+	state = NULL;
+	return true;
+}
+
+uint32_t job_thread_count(void) {
+	return state ? state->worker_count + 1 : 1;
+}
+
+uint32_t job_thread_index(void) {
+	return thread_index < 0 ? 0 : (uint32_t)thread_index;
+}
+
+void job_run(JobDecl *jobs, uint32_t count, JobCounter *counter) {
+	if (counter)
+		__atomic_add_fetch(&counter->value, (int32_t)count, __ATOMIC_RELAXED);
+
+	// NOTE: Threads the job system didn't start own no queue, their jobs run inline like they do before startup
+	if (state == NULL || thread_index < 0) {
+		for (uint32_t index = 0; index < count; ++index) {
+			Job job = { .function = jobs[index].function, .user_data = jobs[index].user_data, .counter = counter };
+			job_execute(&job);
+		}
+		return;
+	}
+
+	JobQueue *queue = &state->queues[thread_index];
+	for (uint32_t index = 0; index < count; ++index) {
+		Job job = { .function = jobs[index].function, .user_data = jobs[index].user_data, .counter = counter };
+		if (job_queue_push(queue, job) == false)
+			job_execute(&job);
+	}
+
+	// NOTE: Pairs with the sleeping increment in job_worker_main so a worker about to sleep either sees the new jobs or gets woken
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int32_t sleeping = __atomic_load_n(&state->sleeping, __ATOMIC_RELAXED);
+	for (int32_t index = 0; index < sleeping && index < (int32_t)count; ++index)
+		sem_post(&state->wake);
+}
+
+void job_wait(JobCounter *counter) {
+	while (__atomic_load_n(&counter->value, __ATOMIC_ACQUIRE) > 0) {
+		Job job;
+		if (state && thread_index >= 0 && job_acquire(&job))
+			job_execute(&job);
+		else
+			cpu_relax();
+	}
+}
+
+bool job_done(JobCounter *counter) {
+	return __atomic_load_n(&counter->value, __ATOMIC_ACQUIRE) <= 0;
+}
+
+void job_parallel_for(uint32_t count, uint32_t batch_size, PFN_job_range function, void *user_data) {
+	if (count == 0)
+		return;
+
+	if (batch_size == 0)
+		batch_size = MAX(1, count / (job_thread_count() * 4));
+
+	uint32_t batch_count = (count + batch_size - 1) / batch_size;
+	if (batch_count == 1 || state == NULL) {
+		function(user_data, 0, count);
+		return;
+	}
+
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+	JobRange *ranges = arena_push_count(scratch.arena, batch_count, JobRange);
+	JobDecl *jobs = arena_push_count(scratch.arena, batch_count, JobDecl);
+
+	for (uint32_t batch = 0; batch < batch_count; ++batch) {
+		ranges[batch] = (JobRange){
+			.function = function,
+			.user_data = user_data,
+			.start = batch * batch_size,
+			.end = MIN((batch + 1) * batch_size, count),
+		};
+		jobs[batch] = (JobDecl){ .function = job_range_execute, .user_data = &ranges[batch] };
+	}
+
+	JobCounter counter = { 0 };
+	job_run(jobs, batch_count, &counter);
+	job_wait(&counter);
+
+	arena_scratch_end(scratch);
+}
+
+static void job_range_execute(void *user_data) {
+	JobRange *range = user_data;
+	range->function(range->user_data, range->start, range->end);
+}
+
+static void job_execute(Job *job) {
+	job->function(job->user_data);
+
+	if (job->counter)
+		__atomic_sub_fetch(&job->counter->value, 1, __ATOMIC_RELEASE);
+}
+
+static bool job_acquire(Job *out_job) {
+	if (job_queue_pop(&state->queues[thread_index], out_job))
+		return true;
+
+	// xorshift32, picks where to start looking for a victim so thieves don't all hammer the same queue
+	steal_seed ^= steal_seed << 13;
+	steal_seed ^= steal_seed >> 17;
+	steal_seed ^= steal_seed << 5;
+
+	uint32_t queue_count = state->worker_count + 1;
+	uint32_t start = steal_seed % queue_count;
+	for (uint32_t offset = 0; offset < queue_count; ++offset) {
+		uint32_t victim = (start + offset) % queue_count;
+		if (victim != (uint32_t)thread_index && job_queue_steal(&state->queues[victim], out_job))
+			return true;
+	}
+
+	return false;
+}
+
+static void *job_worker_main(void *user_data) {
+	thread_index = (int32_t)(uintptr_t)user_data;
+	steal_seed = 0x9E3779B9u * (uint32_t)(thread_index + 1);
+
+	uint32_t spin = 0;
+	while (__atomic_load_n(&state->running, __ATOMIC_RELAXED)) {
+		Job job;
+		if (job_acquire(&job)) {
+			job_execute(&job);
+			spin = 0;
+			continue;
+		}
+
+		if (spin++ < JOB_SPIN_COUNT) {
+			cpu_relax();
+			continue;
+		}
+
+		__atomic_add_fetch(&state->sleeping, 1, __ATOMIC_SEQ_CST);
+		if (job_acquire(&job)) {
+			__atomic_sub_fetch(&state->sleeping, 1, __ATOMIC_SEQ_CST);
+			job_execute(&job);
+			spin = 0;
+			continue;
+		}
+
+		sem_wait(&state->wake);
+		__atomic_sub_fetch(&state->sleeping, 1, __ATOMIC_SEQ_CST);
+		spin = 0;
+	}
+
+	arena_scratch_release();
+	return NULL;
+}
+
+// NOTE: Slots are written and read field by field with relaxed atomics, a thief may read a slot the owner is
+// overwriting but its CAS on top fails in that case and the torn copy is discarded
+static inline void job_slot_store(Job *slot, Job job) {
+	__atomic_store_n(&slot->function, job.function, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->user_data, job.user_data, __ATOMIC_RELAXED);
+	__atomic_store_n(&slot->counter, job.counter, __ATOMIC_RELAXED);
+}
+
+static inline Job job_slot_load(Job *slot) {
+	return (Job){
+		.function = __atomic_load_n(&slot->function, __ATOMIC_RELAXED),
+		.user_data = __atomic_load_n(&slot->user_data, __ATOMIC_RELAXED),
+		.counter = __atomic_load_n(&slot->counter, __ATOMIC_RELAXED),
+	};
+}
+
+static bool job_queue_push(JobQueue *queue, Job job) {
+	int64_t bottom = __atomic_load_n(&queue->bottom, __ATOMIC_RELAXED);
+	int64_t top = __atomic_load_n(&queue->top, __ATOMIC_ACQUIRE);
+	if (bottom - top >= JOB_QUEUE_CAPACITY)
+		return false;
+
+	job_slot_store(&queue->jobs[bottom & (JOB_QUEUE_CAPACITY - 1)], job);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	__atomic_store_n(&queue->bottom, bottom + 1, __ATOMIC_RELAXED);
+	return true;
+}
+
+static bool job_queue_pop(JobQueue *queue, Job *out_job) {
+	int64_t bottom = __atomic_load_n(&queue->bottom, __ATOMIC_RELAXED) - 1;
+	__atomic_store_n(&queue->bottom, bottom, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t top = __atomic_load_n(&queue->top, __ATOMIC_RELAXED);
+
+	if (top > bottom) {
+		__atomic_store_n(&queue->bottom, bottom + 1, __ATOMIC_RELAXED);
+		return false;
+	}
+
+	*out_job = job_slot_load(&queue->jobs[bottom & (JOB_QUEUE_CAPACITY - 1)]);
+	if (top != bottom)
+		return true;
+
+	// NOTE: Last job left, race any thief for it
+	bool won = __atomic_compare_exchange_n(&queue->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+	__atomic_store_n(&queue->bottom, bottom + 1, __ATOMIC_RELAXED);
+	return won;
+}
+
+static bool job_queue_steal(JobQueue *queue, Job *out_job) {
+	int64_t top = __atomic_load_n(&queue->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	int64_t bottom = __atomic_load_n(&queue->bottom, __ATOMIC_ACQUIRE);
+
+	if (top >= bottom)
+		return false;
+
+	Job job = job_slot_load(&queue->jobs[top & (JOB_QUEUE_CAPACITY - 1)]);
+	if (__atomic_compare_exchange_n(&queue->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED) == false)
+		return false;
+
+	*out_job = job;
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common.h"
+#include "core/arena.h"
+
+#define MAX_JOB_WORKERS 64
+#define JOB_QUEUE_CAPACITY 4096
+
+typedef void (*PFN_job)(void *user_data);
+typedef void (*PFN_job_range)(void *user_data, uint32_t start, uint32_t end);
+
+// NOTE: Incremented by job_run, decremented as each job finishes. Zero means every job tracked by it is done
+typedef struct {
+	int32_t value;
+} JobCounter;
+
+typedef struct {
+	PFN_job function;
+	void *user_data;
+} JobDecl;
+
+typedef struct JobState JobState;
+
+// worker_count of 0 picks one worker per online core, minus the calling thread
+JobState *job_system_startup(Arena *arena, uint32_t worker_count, bool pin_threads);
+bool job_system_shutdown(void);
+
+// Number of threads executing jobs, including the thread that called job_system_startup
+ENGINE_API uint32_t job_thread_count(void);
+// 0 for the thread that started the job system, 1..N for workers
+ENGINE_API uint32_t job_thread_index(void);
+
+// Called from a thread the job system didn't start, the jobs run inline before job_run returns
+ENGINE_API void job_run(JobDecl *jobs, uint32_t count, JobCounter *counter);
+ENGINE_API void job_wait(JobCounter *counter);
+ENGINE_API bool job_done(JobCounter *counter);
+
+// Splits [0, count) into batches of batch_size (0 picks one) and blocks until all of them are done
+ENGINE_API void job_parallel_for(uint32_t count, uint32_t batch_size, PFN_job_range function, void *user_data);
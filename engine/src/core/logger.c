@@ -9,10 +9,10 @@
 typedef struct {
 	LogLevel level;
 	bool quiet;
-	uint32_t indent;
 } Logger;
 
-static Logger g_logger = { LOG_LEVEL_TRACE, false, 0 };
+static Logger g_logger = { LOG_LEVEL_TRACE, false };
+static thread_local uint32_t g_indent = 0;
 static const char *g_level_strings[] = {
 	"TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL"
 };
@@ -47,11 +47,11 @@ static const char *basename(const char *path) {
 }
 
 void logger_indent(void) {
-	g_logger.indent++;
+	g_indent++;
 }
 void logger_dedent(void) {
-	if (g_logger.indent > 0)
-		g_logger.indent--;
+	if (g_indent > 0)
+		g_indent--;
 }
 
 void logger_log(LogLevel level, const char *file, int line, const char *format, ...) {
@@ -60,18 +60,21 @@ void logger_log(LogLevel level, const char *file, int line, const char *format,
 	}
 
 	time_t t = time(NULL);
-	struct tm *tm_info = localtime(&t);
+	struct tm tm_info;
+	localtime_r(&t, &tm_info);
 
 	char time_buffer[16];
-	strftime(time_buffer, sizeof(time_buffer), "%H:%M:%S", tm_info);
+	strftime(time_buffer, sizeof(time_buffer), "%H:%M:%S", &tm_info);
 
 	char indent_buffer[32];
 	memory_set(indent_buffer, ' ', sizeof(indent_buffer));
-	int32_t indent_space = MIN(g_logger.indent, 15) * 2;
+	int32_t indent_space = MIN(g_indent, 15) * 2;
 	indent_buffer[indent_space] = '\0';
 
 	va_list arg_ptr;
 	va_start(arg_ptr, format);
+	// NOTE: Hold the stream lock so lines from different threads don't interleave
+	flockfile(stdout);
 	printf(
 		"%s %s%s[%s]\x1b[0m \x1b[37m%s:%d:\x1b[0m ",
 		time_buffer, // Timestamp
@@ -86,5 +89,6 @@ void logger_log(LogLevel level, const char *file, int line, const char *format,
 	vprintf(format, arg_ptr);
 	printf("\x1b[0m\n");
 	fflush(stdout);
+	funlockfile(stdout);
 	va_end(arg_ptr);
 }
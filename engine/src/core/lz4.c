@@ -0,0 +1,161 @@
+#include "lz4.h"
+
+#include <string.h>
+
+#define LZ4_MIN_MATCH 4
+// The format requires the last 5 bytes to be literals and no match to start in the last 12
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+
+#define LZ4_HASH_BITS 12
+
+static inline uint32_t read32(const uint8_t *pointer) {
+	uint32_t value;
+	memcpy(&value, pointer, sizeof(value));
+	return value;
+}
+
+static inline uint32_t lz4_hash(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+static inline uint8_t *write_length(uint8_t *out, size_t length) {
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+	*out++ = (uint8_t)length;
+	return out;
+}
+
+static uint8_t *write_sequence(uint8_t *out, const uint8_t *literals, size_t literal_length, size_t offset, size_t match_length) {
+	uint8_t *token = out++;
+	*token = (uint8_t)(MIN(literal_length, 15) << 4);
+	if (literal_length >= 15)
+		out = write_length(out, literal_length - 15);
+
+	memcpy(out, literals, literal_length);
+	out += literal_length;
+
+	// Final sequence, literals only
+	if (match_length == 0)
+		return out;
+
+	*out++ = (uint8_t)(offset & 0xFF);
+	*out++ = (uint8_t)(offset >> 8);
+
+	size_t stored_length = match_length - LZ4_MIN_MATCH;
+	*token |= (uint8_t)MIN(stored_length, 15);
+	if (stored_length >= 15)
+		out = write_length(out, stored_length - 15);
+
+	return out;
+}
+
+// Greedy single pass with a 4 KiB entry hash table, good enough for cooking and the decoder is what matters at runtime
+size_t lz4_compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity) {
+	if (capacity < lz4_compress_bound(size))
+		return 0;
+
+	uint32_t table[1 << LZ4_HASH_BITS];
+	memset(table, 0, sizeof(table));
+
+	uint8_t *out = dst;
+	const uint8_t *anchor = src;
+
+	if (size >= LZ4_MATCH_LIMIT + 1) {
+		const uint8_t *match_limit = src + size - LZ4_MATCH_LIMIT;
+		const uint8_t *match_end = src + size - LZ4_LAST_LITERALS;
+
+		const uint8_t *cursor = src + 1;
+		while (cursor < match_limit) {
+			uint32_t sequence = read32(cursor);
+			uint32_t hash = lz4_hash(sequence);
+			const uint8_t *candidate = src + table[hash];
+			table[hash] = (uint32_t)(cursor - src);
+
+			if (candidate >= cursor || cursor - candidate > LZ4_MAX_OFFSET || read32(candidate) != sequence) {
+				cursor++;
+				continue;
+			}
+
+			// Extend backwards over pending literals, then forwards up to the tail that has to stay literal
+			while (cursor > anchor && candidate > src && cursor[-1] == candidate[-1]) {
+				cursor--;
+				candidate--;
+			}
+
+			const uint8_t *end = cursor + LZ4_MIN_MATCH;
+			while (end < match_end && *end == candidate[end - cursor])
+				end++;
+
+			out = write_sequence(out, anchor, cursor - anchor, cursor - candidate, end - cursor);
+			anchor = cursor = end;
+
+			if (cursor < match_limit)
+				table[lz4_hash(read32(cursor - 2))] = (uint32_t)(cursor - 2 - src);
+		}
+	}
+
+	out = write_sequence(out, anchor, src + size - anchor, 0, 0);
+	return out - dst;
+}
+
+static inline bool read_length(const uint8_t **in, const uint8_t *in_end, size_t *length) {
+	uint8_t byte;
+	do {
+		if (*in >= in_end)
+			return false;
+		byte = *(*in)++;
+		*length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+bool lz4_decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size) {
+	const uint8_t *in = src, *in_end = src + size;
+	uint8_t *out = dst, *out_end = dst + dst_size;
+
+	while (in < in_end) {
+		uint8_t token = *in++;
+
+		size_t literal_length = token >> 4;
+		if (literal_length == 15 && read_length(&in, in_end, &literal_length) == false)
+			return false;
+		if (literal_length > (size_t)(in_end - in) || literal_length > (size_t)(out_end - out))
+			return false;
+
+		memcpy(out, in, literal_length);
+		in += literal_length;
+		out += literal_length;
+
+		// The last sequence has no match part
+		if (in == in_end)
+			break;
+
+		if (in_end - in < 2)
+			return false;
+		size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > (size_t)(out - dst))
+			return false;
+
+		size_t match_length = token & 15;
+		if (match_length == 15 && read_length(&in, in_end, &match_length) == false)
+			return false;
+		match_length += LZ4_MIN_MATCH;
+		if (match_length > (size_t)(out_end - out))
+			return false;
+
+		// NOTE: Source and destination overlap when offset < match_length, that's how runs are encoded
+		const uint8_t *match = out - offset;
+		if (offset >= match_length) {
+			memcpy(out, match, match_length);
+			out += match_length;
+		} else {
+			for (size_t index = 0; index < match_length; ++index)
+				*out++ = match[index];
+		}
+	}
+
+	return out == out_end;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "common.h"
+
+// LZ4 block format (no frame header), compatible with the reference decoder
+
+// Worst case size of lz4_compress output for size bytes of input
+static inline size_t lz4_compress_bound(size_t size) { return size + size / 255 + 16; }
+
+// Returns the compressed size, 0 if it doesn't fit in capacity
+ENGINE_API size_t lz4_compress(const uint8_t *src, size_t size, uint8_t *dst, size_t capacity);
+
+// Returns false on malformed input or if the output isn't exactly dst_size bytes
+ENGINE_API bool lz4_decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t dst_size);
@@ -52,6 +52,10 @@ typedef struct {
 
 	size_t vertex_offset, vertex_count;
 	size_t index_offset, index_count;
+
+	// The same ranges in elements, for drawing with handle bound once at offset 0
+	uint32_t first_index;
+	int32_t base_vertex;
 } Mesh;
 
 typedef struct {
@@ -62,4 +66,7 @@ typedef struct {
 
 	RhiTexture textures[16];
 	uint32_t texture_count;
+
+	// Persistent, written once with the parameter range. Textures are read through their bindless slots
+	RhiUniformSet set;
 } Material;
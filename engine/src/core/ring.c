@@ -0,0 +1,85 @@
+#include "ring.h"
+
+#include "core/debug.h"
+
+Ring ring_make(uint64_t capacity) {
+	return (Ring){ .capacity = capacity };
+}
+
+// Free space past the head before the end of the buffer, and past the start once wrapped
+static void ring_free_space(Ring *ring, uint64_t *out_end, uint64_t *out_start) {
+	// NOTE: An empty ring starts over at offset 0 so the whole buffer is contiguous again
+	if (ring->head == ring->tail) {
+		uint64_t start = (ring->head + ring->capacity - 1) / ring->capacity * ring->capacity;
+		ring->head = ring->tail = ring->tagged = start;
+	}
+
+	uint64_t free = ring->capacity - (ring->head - ring->tail);
+	uint64_t head_offset = ring->head % ring->capacity;
+
+	*out_end = MIN(ring->capacity - head_offset, free);
+	*out_start = free - *out_end;
+}
+
+bool ring_alloc(Ring *ring, uint64_t size, uint64_t alignment, uint64_t *out_offset) {
+	uint64_t end_space, start_space;
+	ring_free_space(ring, &end_space, &start_space);
+
+	uint64_t head_offset = ring->head % ring->capacity;
+	uint64_t padding = alignup(head_offset, alignment) - head_offset;
+
+	if (padding + size <= end_space) {
+		*out_offset = head_offset + padding;
+		ring->head += padding + size;
+		return true;
+	}
+
+	if (size <= start_space) {
+		*out_offset = 0;
+		ring->head += end_space + size;
+		return true;
+	}
+
+	return false;
+}
+
+uint64_t ring_contiguous(Ring *ring, uint64_t alignment) {
+	uint64_t end_space, start_space;
+	ring_free_space(ring, &end_space, &start_space);
+
+	uint64_t head_offset = ring->head % ring->capacity;
+	uint64_t padding = alignup(head_offset, alignment) - head_offset;
+	uint64_t end_usable = end_space > padding ? end_space - padding : 0;
+
+	return MAX(end_usable, start_space);
+}
+
+void ring_tag(Ring *ring, uint64_t value) {
+	if (ring->head == ring->tagged)
+		return;
+
+	if (ring->span_count == RING_MAX_SPANS) {
+		RingSpan *newest = &ring->spans[(ring->span_first + ring->span_count - 1) % RING_MAX_SPANS];
+		ASSERT(value >= newest->value);
+		*newest = (RingSpan){ .end = ring->head, .value = value };
+	} else
+		ring->spans[(ring->span_first + ring->span_count++) % RING_MAX_SPANS] = (RingSpan){ .end = ring->head, .value = value };
+
+	ring->tagged = ring->head;
+}
+
+void ring_reclaim(Ring *ring, uint64_t completed) {
+	while (ring->span_count && ring->spans[ring->span_first].value <= completed) {
+		ring->tail = ring->spans[ring->span_first].end;
+		ring->span_first = (ring->span_first + 1) % RING_MAX_SPANS;
+		ring->span_count--;
+	}
+}
+
+uint64_t ring_untagged(Ring *ring) {
+	return ring->head - ring->tagged;
+}
+
+uint64_t ring_oldest_value(Ring *ring) {
+	return ring->span_count ? ring->spans[ring->span_first].value : 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common.h"
+#include "core/arena.h"
+
+// NOTE: Spans beyond this are merged into the newest one, which only delays reclaiming them
+#define RING_MAX_SPANS 64
+
+// Allocations made since the last ring_tag share one span, freed together once its value completes
+typedef struct {
+	uint64_t end, value;
+} RingSpan;
+
+// Byte ring over an external buffer. Positions only ever grow, offsets are positions modulo capacity.
+// Knows nothing about what completes the values, callers feed in the last completed one
+typedef struct {
+	uint64_t capacity;
+	uint64_t head, tail, tagged;
+
+	RingSpan spans[RING_MAX_SPANS];
+	uint32_t span_first, span_count;
+} Ring;
+
+ENGINE_API Ring ring_make(uint64_t capacity);
+
+// Never splits an allocation across the end, the skipped gap stays in use until the span holding it is reclaimed.
+// False when there isn't room yet, see ring_contiguous
+ENGINE_API bool ring_alloc(Ring *ring, uint64_t size, uint64_t alignment, uint64_t *out_offset);
+// Largest size ring_alloc can hand out right now
+ENGINE_API uint64_t ring_contiguous(Ring *ring, uint64_t alignment);
+
+// Everything allocated since the previous tag is freed once value completes, values must not decrease
+ENGINE_API void ring_tag(Ring *ring, uint64_t value);
+ENGINE_API void ring_reclaim(Ring *ring, uint64_t completed);
+
+// Allocations made since the last tag, they can't be reclaimed until tagged
+ENGINE_API uint64_t ring_untagged(Ring *ring);
+// Value to wait for before the oldest span can be reclaimed, 0 when nothing is tagged
+ENGINE_API uint64_t ring_oldest_value(Ring *ring);
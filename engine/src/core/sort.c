@@ -0,0 +1,54 @@
+#include "sort.h"
+
+#include "core/arena.h"
+
+void radix_sort64(uint64_t *keys, uint32_t *values, uint32_t count) {
+	if (count < 2)
+		return;
+
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+
+	// NOTE: All eight histograms are gathered in one pass over the keys
+	uint32_t(*histograms)[256] = (uint32_t(*)[256])arena_push_count(scratch.arena, 8 * 256, uint32_t);
+	for (uint32_t index = 0; index < count; ++index)
+		for (uint32_t byte = 0; byte < 8; ++byte)
+			histograms[byte][(keys[index] >> (byte * 8)) & 0xFF]++;
+
+	uint64_t *key_swap = arena_push_count(scratch.arena, count, uint64_t);
+	uint32_t *value_swap = arena_push_count(scratch.arena, count, uint32_t);
+
+	uint64_t *src_keys = keys, *dst_keys = key_swap;
+	uint32_t *src_values = values, *dst_values = value_swap;
+
+	for (uint32_t byte = 0; byte < 8; ++byte) {
+		uint32_t *histogram = histograms[byte];
+		if (histogram[(keys[0] >> (byte * 8)) & 0xFF] == count)
+			continue;
+
+		uint32_t offset = 0;
+		for (uint32_t digit = 0; digit < 256; ++digit) {
+			uint32_t digit_count = histogram[digit];
+			histogram[digit] = offset;
+			offset += digit_count;
+		}
+
+		uint32_t shift = byte * 8;
+		for (uint32_t index = 0; index < count; ++index) {
+			uint32_t target = histogram[(src_keys[index] >> shift) & 0xFF]++;
+			dst_keys[target] = src_keys[index];
+			dst_values[target] = src_values[index];
+		}
+
+		uint64_t *keys_temp = src_keys;
+		src_keys = dst_keys, dst_keys = keys_temp;
+		uint32_t *values_temp = src_values;
+		src_values = dst_values, dst_values = values_temp;
+	}
+
+	if (src_keys != keys) {
+		memory_copy_count(keys, src_keys, count);
+		memory_copy_count(values, src_values, count);
+	}
+
+	arena_scratch_end(scratch);
+}
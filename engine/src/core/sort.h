@@ -0,0 +1,7 @@
+#pragma once
+
+#include "common.h"
+
+// Stable LSD radix sort of keys in ascending order, values are moved along with their key.
+// Bytes that are equal across every key are skipped, so sparse keys only pay for the bits they use
+ENGINE_API void radix_sort64(uint64_t *keys, uint32_t *values, uint32_t count);
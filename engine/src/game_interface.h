@@ -22,6 +22,8 @@ typedef struct FrameInfo {
 
 typedef struct {
 	FrameInfo (*on_update)(GameContext *, float dt);
+	// Called once before the engine exits, not on reloads
+	void (*on_shutdown)(GameContext *);
 } GameInterface;
 
 typedef GameInterface (*PFN_game_hookup)(void);
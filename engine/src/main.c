@@ -14,10 +14,12 @@
 #include "common.h"
 #include "core/debug.h"
 #include "core/arena.h"
+#include "core/jobs.h"
 #include "core/logger.h"
 #include "core/strings.h"
 
 #include "platform/filesystem.h"
+#include "platform/filewatch.h"
 
 #include "core/cmath.h"
 #include "scene.h"
@@ -25,11 +27,9 @@
 #include <dlfcn.h>
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 
 typedef struct {
 	void *handle;
-	uint64_t last_write;
 } DynamicLibrary;
 
 static DynamicLibrary game_library = { 0 };
@@ -42,11 +42,18 @@ FrameInfo game_on_update_and_render(GameContext *context, float dt) {
 	return (FrameInfo){ 0 };
 }
 
+void game_on_shutdown(GameContext *context) {
+	if (game.on_shutdown)
+		game.on_shutdown(context);
+}
+
 typedef struct engine {
 	Arena memory;
 
 	Window *display;
 	VulkanContext *context;
+	// Watches the working directory for a rebuilt game library
+	FileWatch *watch;
 
 	uint64_t start_time;
 
@@ -59,8 +66,9 @@ int main(void) {
 
 	platform_startup();
 	engine = (Engine){
-		.memory = arena_make(GiB(1)),
+		.memory = arena_reserve(GiB(16), ARENA_FLAG_NONE),
 	};
+	job_system_startup(&engine.memory, 0, false);
 	event_system_startup(&engine.memory);
 	input_system_startup(&engine.memory);
 
@@ -74,16 +82,22 @@ int main(void) {
 	/* window_set_cursor_locked(engine.display, true); */
     /* window_set_fullscreen(engine.display, true); */
 
+	// NOTE: Freshly committed pages are already zero, so only what the game touches becomes resident
 	GameContext game_context = {
-		.permanent_memory = arena_push(&engine.memory, MiB(256), 16, true),
+		.permanent_memory = arena_push(&engine.memory, MiB(256), 16, false),
 		.permanent_memory_size = MiB(256),
-		.transient_memory = arena_push(&engine.memory, MiB(256), 16, true),
+		.transient_memory = arena_push(&engine.memory, MiB(256), 16, false),
 		.transient_memory_size = MiB(256),
 		.render = engine.context,
 		.display = engine.display
 	};
 	game_load(&game_context);
 
+	// NOTE: The debounce covers the linker's writes, so the library is complete once it's reported
+	engine.watch = filewatch_make(&engine.memory, FILEWATCH_DEBOUNCE_MS);
+	if (engine.watch)
+		filewatch_add(engine.watch, S("."), false);
+
 	float delta_time = 0.0f;
 	float last_frame = 0.0f;
 
@@ -94,20 +108,27 @@ int main(void) {
 
 		input_system_update();
 
-		uint64_t current_write_time = filesystem_last_modified(S("libgame.so"));
-		if (current_write_time && current_write_time != game_library.last_write) {
-			LOG_INFO("Game file change detected. Reloading...");
-			struct timespec ts = { .tv_sec = 0, .tv_nsec = 100000000 };
-			nanosleep(&ts, NULL);
-			game_load(&game_context);
-			memory_zero(game_context.transient_memory, game_context.transient_memory_size);
+		ArenaTemp scratch = arena_scratch_begin(NULL);
+		StringList changes = engine.watch ? filewatch_poll(engine.watch, scratch.arena) : (StringList){ 0 };
+		for (StringNode *change = changes.first; change; change = change->next) {
+			if (string_equals(stringpath_filename(change->string), S("libgame.so"))) {
+				LOG_INFO("Game file change detected. Reloading...");
+				game_load(&game_context);
+				memory_zero(game_context.transient_memory, game_context.transient_memory_size);
+				break;
+			}
 		}
+		arena_scratch_end(scratch);
 
 		window_poll_events(engine.display);
 		game_on_update_and_render(&game_context, delta_time);
 	}
 
+	game_on_shutdown(&game_context);
+	if (engine.watch)
+		filewatch_destroy(engine.watch);
 	vulkan_renderer_destroy(engine.context);
+	job_system_shutdown();
 
 	return 0;
 }
@@ -139,7 +160,6 @@ bool game_load(GameContext *context) {
 	}
 
 	game_library.handle = handle;
-	game_library.last_write = filesystem_last_modified(path);
 
 	PFN_game_hookup hookup;
 	*(void **)(&hookup) = dlsym(game_library.handle, GAME_HOOKUP_NAME);
@@ -6,7 +6,9 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -58,6 +60,25 @@ ENGINE_API void filesystem_make_directory(String directory) {
 	arena_scratch_end(scratch);
 }
 
+String filesystem_cache_directory(Arena *arena) {
+	const char *xdg_cache = getenv("XDG_CACHE_HOME");
+	const char *home = getenv("HOME");
+
+	String base = { 0 };
+	if (xdg_cache && xdg_cache[0] == '/')
+		base = string_wrap(xdg_cache);
+	else if (home && home[0])
+		base = string_format(arena, "%s/.cache", home);
+	else
+		return (String){ 0 };
+
+	filesystem_make_directory(base);
+	String result = stringpath_join(arena, base, S("starter_vulkan"));
+	filesystem_make_directory(result);
+
+	return result;
+}
+
 Buffer filesystem_read(Arena *arena, String path) {
 	FILE *file = fopen((const char *)path.chars, "rb");
 	if (file == NULL) {
@@ -163,3 +184,51 @@ uint64_t filesystem_last_modified(String path) {
 	}
 	return 0;
 }
+
+FileInfo filesystem_info(String path) {
+	struct stat attrib;
+	if (stat(path.chars, &attrib) != 0)
+		return (FileInfo){ 0 };
+
+	return (FileInfo){
+		.exists = true,
+		.size = (uint64_t)attrib.st_size,
+		.last_modified = (uint64_t)attrib.st_mtim.tv_sec * 1000000000ULL + (uint64_t)attrib.st_mtim.tv_nsec,
+	};
+}
+
+Buffer filesystem_map(String path) {
+	int fd = open(path.chars, O_RDONLY);
+	if (fd == -1)
+		return (Buffer){ 0 };
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		return (Buffer){ 0 };
+	}
+
+	// NOTE: Private mapping, writes through the pointer are copy-on-write and never reach the file
+	void *pointer = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (pointer == MAP_FAILED) {
+		LOG_ERROR("Failed to map file '%.*s': %s", SARG(path), strerror(errno));
+		return (Buffer){ 0 };
+	}
+
+	return buffer_make(pointer, info.st_size);
+}
+
+void filesystem_unmap(Buffer mapping) {
+	if (mapping.pointer)
+		munmap(mapping.pointer, mapping.size);
+}
+
+bool filesystem_rename(String from, String to) {
+	if (rename(from.chars, to.chars) != 0) {
+		LOG_ERROR("Failed to rename '%.*s' to '%.*s': %s", SARG(from), SARG(to), strerror(errno));
+		return false;
+	}
+	return true;
+}
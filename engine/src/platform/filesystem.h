@@ -27,6 +27,8 @@ ENGINE_API size_t file_write(File *file, size_t element_size, uint32_t element_c
 ENGINE_API void file_close(File *file);
 
 ENGINE_API void filesystem_make_directory(String directory);
+// Per-user cache directory for the engine ($XDG_CACHE_HOME or ~/.cache), created on demand. Empty if unknown
+ENGINE_API String filesystem_cache_directory(struct arena *arena);
 
 #define file_write_struct(file, T, ...)            \
 	do {                                           \
@@ -36,6 +38,20 @@ ENGINE_API void filesystem_make_directory(String directory);
 #define file_write_count(file, count, data) file_write(file, sizeof(*data), count, data)
 
 bool filesystem_file_copy(String from, String to);
+// Replaces `to` atomically when both paths are on the same filesystem
+ENGINE_API bool filesystem_rename(String from, String to);
+
+ENGINE_API Buffer filesystem_map(String path);
+ENGINE_API void filesystem_unmap(Buffer mapping);
 ENGINE_API StringList filesystem_directory_files(Arena *arena, String directory_path, bool recursive);
 
 uint64_t filesystem_last_modified(String path);
+
+typedef struct {
+	bool exists;
+	uint64_t size;
+	// Nanoseconds, filesystem_last_modified only has second resolution
+	uint64_t last_modified;
+} FileInfo;
+
+ENGINE_API FileInfo filesystem_info(String path);
@@ -0,0 +1,334 @@
+#include "filewatch.h"
+
+#include "core/arena.h"
+#include "core/logger.h"
+#include "core/strings.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdalign.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FILEWATCH_FILE_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+#define FILEWATCH_DIRECTORY_EVENTS (IN_CREATE | IN_MOVED_TO)
+// A file that is written and then moved or deleted before it settles, like an editor's temporary, is never reported
+#define FILEWATCH_REMOVE_EVENTS (IN_MOVED_FROM | IN_DELETE)
+
+typedef struct {
+	int descriptor;
+	bool recursive;
+	String path;
+} FileWatchDirectory;
+
+typedef struct {
+	String path;
+	uint64_t last_event;
+} FileWatchChange;
+
+struct filewatch {
+	int fd, wake_fd;
+	pthread_t thread;
+	uint64_t debounce;
+
+	// Everything below is shared with the watcher thread and guarded by mutex
+	pthread_mutex_t mutex;
+
+	Arena directory_arena;
+	FileWatchDirectory *directories;
+
+	// Only ever holds what is still pending, see filewatch_compact
+	Arena pending_arena;
+	FileWatchChange *pending;
+	uint32_t pending_count;
+};
+
+static uint64_t filewatch_now(void) {
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000ULL + (uint64_t)time.tv_nsec;
+}
+
+static FileWatchDirectory *filewatch_find_directory(FileWatch *watch, int descriptor) {
+	for (uint32_t index = 0; index < arena_array_count(watch->directories); ++index)
+		if (watch->directories[index].descriptor == descriptor)
+			return &watch->directories[index];
+
+	return NULL;
+}
+
+// NOTE: Caller holds the mutex. Removed entries leave their paths behind in the arena, so the survivors
+// are copied out and pushed back. Otherwise it would grow for as long as anything stays pending
+static void filewatch_compact(FileWatch *watch, Arena *conflict) {
+	uint32_t count = arena_array_count(watch->pending);
+	if (count == 0) {
+		arena_rewind(&watch->pending_arena, 0);
+		watch->pending = NULL;
+		return;
+	}
+
+	ArenaTemp scratch = arena_scratch_begin(conflict);
+	FileWatchChange *survivors = arena_push_count(scratch.arena, count, FileWatchChange);
+	for (uint32_t index = 0; index < count; ++index)
+		survivors[index] = (FileWatchChange){
+			.path = string_copy(scratch.arena, watch->pending[index].path),
+			.last_event = watch->pending[index].last_event,
+		};
+
+	arena_rewind(&watch->pending_arena, 0);
+	watch->pending = NULL;
+	for (uint32_t index = 0; index < count; ++index)
+		arena_darray_put(&watch->pending_arena, watch->pending, FileWatchChange, { .path = string_copy(&watch->pending_arena, survivors[index].path), .last_event = survivors[index].last_event });
+
+	arena_scratch_end(scratch);
+}
+
+// Repeated events for a path only move its deadline, so a burst of writes is reported once
+static void filewatch_touch(FileWatch *watch, String path, uint64_t now) {
+	for (uint32_t index = 0; index < arena_array_count(watch->pending); ++index) {
+		if (string_equals(watch->pending[index].path, path)) {
+			watch->pending[index].last_event = now;
+			return;
+		}
+	}
+
+	arena_darray_put(&watch->pending_arena, watch->pending, FileWatchChange, { .path = string_copy(&watch->pending_arena, path), .last_event = now });
+	__atomic_store_n(&watch->pending_count, arena_array_count(watch->pending), __ATOMIC_RELEASE);
+}
+
+static void filewatch_forget(FileWatch *watch, String path) {
+	uint32_t count = arena_array_count(watch->pending);
+	for (uint32_t index = 0; index < count; ++index) {
+		if (string_equals(watch->pending[index].path, path)) {
+			watch->pending[index] = watch->pending[--count];
+			HEADER(watch->pending, ArenaArrayHeader)->count = count;
+			filewatch_compact(watch, NULL);
+			__atomic_store_n(&watch->pending_count, count, __ATOMIC_RELEASE);
+			return;
+		}
+	}
+}
+
+// NOTE: Caller holds the mutex. With report set, files already inside are treated as changed,
+// they may have been written before the watch existed
+static bool filewatch_add_directory(FileWatch *watch, String directory, bool recursive, bool report) {
+	uint32_t mask = FILEWATCH_FILE_EVENTS | FILEWATCH_REMOVE_EVENTS | (recursive ? FILEWATCH_DIRECTORY_EVENTS : 0) | IN_ONLYDIR;
+	int descriptor = inotify_add_watch(watch->fd, directory.chars, mask);
+	if (descriptor == -1) {
+		LOG_WARN("FileWatch: Failed to watch '%.*s': %s", SARG(directory), strerror(errno));
+		return false;
+	}
+
+	FileWatchDirectory *existing = filewatch_find_directory(watch, descriptor);
+	if (existing)
+		existing->recursive |= recursive;
+	else
+		arena_darray_put(&watch->directory_arena, watch->directories, FileWatchDirectory, { .descriptor = descriptor, .recursive = recursive, .path = string_copy(&watch->directory_arena, directory) });
+
+	if (recursive == false && report == false)
+		return true;
+
+	DIR *handle = opendir(directory.chars);
+	if (handle == NULL)
+		return true;
+
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+	uint64_t now = filewatch_now();
+
+	struct dirent *entry;
+	while ((entry = readdir(handle))) {
+		String name = string_wrap(entry->d_name);
+		if (string_equals(name, S(".")) || string_equals(name, S("..")))
+			continue;
+
+		String path = stringpath_join(scratch.arena, directory, name);
+
+		struct stat info;
+		if (stat(path.chars, &info) != 0)
+			continue;
+
+		if (S_ISDIR(info.st_mode) && recursive)
+			filewatch_add_directory(watch, path, true, report);
+		else if (S_ISREG(info.st_mode) && report)
+			filewatch_touch(watch, path, now);
+	}
+
+	closedir(handle);
+	arena_scratch_end(scratch);
+	return true;
+}
+
+static void filewatch_handle_event(FileWatch *watch, struct inotify_event *event, uint64_t now) {
+	if (event->mask & IN_Q_OVERFLOW) {
+		LOG_WARN("FileWatch: Event queue overflowed, changes were dropped");
+		return;
+	}
+
+	FileWatchDirectory *directory = filewatch_find_directory(watch, event->wd);
+	if (directory == NULL)
+		return;
+
+	// The directory itself is gone, its descriptor may be handed out again
+	if (event->mask & IN_IGNORED) {
+		directory->descriptor = -1;
+		return;
+	}
+	if (event->len == 0)
+		return;
+
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+	String path = stringpath_join(scratch.arena, directory->path, string_wrap(event->name));
+
+	if (event->mask & IN_ISDIR) {
+		if (directory->recursive && (event->mask & FILEWATCH_DIRECTORY_EVENTS))
+			filewatch_add_directory(watch, path, true, true);
+	} else if (event->mask & FILEWATCH_FILE_EVENTS)
+		filewatch_touch(watch, path, now);
+	else if (event->mask & FILEWATCH_REMOVE_EVENTS)
+		filewatch_forget(watch, path);
+
+	arena_scratch_end(scratch);
+}
+
+static void *filewatch_thread_main(void *user_data) {
+	FileWatch *watch = user_data;
+
+	alignas(struct inotify_event) char buffer[4096];
+	while (true) {
+		struct pollfd descriptors[2] = {
+			{ .fd = watch->fd, .events = POLLIN },
+			{ .fd = watch->wake_fd, .events = POLLIN },
+		};
+
+		if (poll(descriptors, countof(descriptors), -1) == -1) {
+			if (errno == EINTR)
+				continue;
+
+			LOG_ERROR("FileWatch: poll failed: %s", strerror(errno));
+			break;
+		}
+		if (descriptors[1].revents)
+			break;
+
+		// NOTE: The descriptor is non-blocking, drain everything queued so one lock covers the whole burst
+		ssize_t length;
+		while ((length = read(watch->fd, buffer, sizeof(buffer))) > 0) {
+			uint64_t now = filewatch_now();
+
+			pthread_mutex_lock(&watch->mutex);
+			for (char *cursor = buffer; cursor < buffer + length;) {
+				struct inotify_event *event = (struct inotify_event *)cursor;
+				filewatch_handle_event(watch, event, now);
+				cursor += sizeof(struct inotify_event) + event->len;
+			}
+			pthread_mutex_unlock(&watch->mutex);
+		}
+	}
+
+	arena_scratch_release();
+	return NULL;
+}
+
+FileWatch *filewatch_make(Arena *arena, uint32_t debounce_ms) {
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd == -1) {
+		LOG_ERROR("FileWatch: inotify unavailable: %s", strerror(errno));
+		return NULL;
+	}
+
+	int wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wake_fd == -1) {
+		LOG_ERROR("FileWatch: eventfd failed: %s", strerror(errno));
+		close(fd);
+		return NULL;
+	}
+
+	FileWatch *watch = arena_push_struct(arena, FileWatch);
+	*watch = (FileWatch){
+		.fd = fd,
+		.wake_fd = wake_fd,
+		.debounce = (uint64_t)debounce_ms * 1000000ULL,
+		.directory_arena = arena_reserve(MiB(64), ARENA_FLAG_NONE),
+		.pending_arena = arena_reserve(MiB(64), ARENA_FLAG_NONE),
+	};
+	pthread_mutex_init(&watch->mutex, NULL);
+
+	if (pthread_create(&watch->thread, NULL, filewatch_thread_main, watch) != 0) {
+		LOG_ERROR("FileWatch: Failed to start watcher thread");
+		pthread_mutex_destroy(&watch->mutex);
+		arena_destroy(&watch->directory_arena);
+		arena_destroy(&watch->pending_arena);
+		close(wake_fd);
+		close(fd);
+		return NULL;
+	}
+
+	return watch;
+}
+
+void filewatch_destroy(FileWatch *watch) {
+	// NOTE: Without the wake up the thread would sleep in poll forever, cancel it there instead
+	if (write(watch->wake_fd, &(uint64_t){ 1 }, sizeof(uint64_t)) != sizeof(uint64_t)) {
+		LOG_ERROR("FileWatch: Failed to wake watcher thread: %s", strerror(errno));
+		pthread_cancel(watch->thread);
+	}
+	pthread_join(watch->thread, NULL);
+
+	close(watch->wake_fd);
+	close(watch->fd);
+
+	pthread_mutex_destroy(&watch->mutex);
+	arena_destroy(&watch->directory_arena);
+	arena_destroy(&watch->pending_arena);
+}
+
+bool filewatch_add(FileWatch *watch, String directory, bool recursive) {
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+
+	// NOTE: A trailing separator would end up doubled in every reported path
+	String path = directory;
+	while (path.length > 1 && path.chars[path.length - 1] == '/')
+		path.length--;
+	path = string_copy(scratch.arena, path);
+
+	pthread_mutex_lock(&watch->mutex);
+	bool result = filewatch_add_directory(watch, path, recursive, false);
+	pthread_mutex_unlock(&watch->mutex);
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
+StringList filewatch_poll(FileWatch *watch, Arena *arena) {
+	StringList result = { 0 };
+	if (__atomic_load_n(&watch->pending_count, __ATOMIC_ACQUIRE) == 0)
+		return result;
+
+	uint64_t now = filewatch_now();
+
+	pthread_mutex_lock(&watch->mutex);
+	uint32_t kept = 0;
+	for (uint32_t index = 0; index < arena_array_count(watch->pending); ++index) {
+		FileWatchChange *change = &watch->pending[index];
+		if (now >= change->last_event + watch->debounce)
+			stringlist_push(arena, &result, string_copy(arena, change->path));
+		else
+			watch->pending[kept++] = *change;
+	}
+
+	if (watch->pending && kept != arena_array_count(watch->pending)) {
+		HEADER(watch->pending, ArenaArrayHeader)->count = kept;
+		filewatch_compact(watch, arena);
+	}
+
+	__atomic_store_n(&watch->pending_count, kept, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&watch->mutex);
+
+	return result;
+}
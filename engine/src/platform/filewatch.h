@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common.h"
+
+#include "core/arena.h"
+#include "core/strings.h"
+
+// Default quiet period before a change is reported. Long enough to cover the writes of a linker or an image editor
+#define FILEWATCH_DEBOUNCE_MS 100
+
+typedef struct filewatch FileWatch;
+
+// NULL when the platform can't watch files. Events are drained by a background thread,
+// so polling costs a single atomic load until something actually changed
+ENGINE_API FileWatch *filewatch_make(Arena *arena, uint32_t debounce_ms);
+ENGINE_API void filewatch_destroy(FileWatch *watch);
+
+// Watches the files in directory, and every directory below it when recursive, including ones created later
+ENGINE_API bool filewatch_add(FileWatch *watch, String directory, bool recursive);
+
+// Paths written or moved into place that have been quiet for the debounce period, each reported once per burst
+ENGINE_API StringList filewatch_poll(FileWatch *watch, Arena *arena);
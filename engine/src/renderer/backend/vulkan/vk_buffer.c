@@ -63,7 +63,7 @@ bool vulkan_buffer_destroy(VulkanContext *context, RhiBuffer buffer_handle) {
 	VULKAN_GET_OR_RETURN(buffer, context->buffer_pool, buffer_handle, MAX_BUFFERS, true, false);
 
 	vkDestroyBuffer(context->device.logical, buffer->handle, NULL);
-	vkFreeMemory(context->device.logical, buffer->memory, NULL);
+	vulkan_memory_free(context, &buffer->allocation);
 	if (buffer->view)
 		vkDestroyBufferView(context->device.logical, buffer->view, NULL);
 
@@ -147,22 +147,38 @@ bool vulkan_buffer_write_all(VulkanContext *context, RhiBuffer buffer_handle, si
 	return result;
 }
 
-bool vulkan_buffer_bind_index(VulkanContext *context, RhiBuffer buffer_handle, size_t offset) {
+bool vulkan_buffer_bind_index(VulkanContext *context, VulkanRecorder *recorder, RhiBuffer buffer_handle, size_t offset) {
 	const VulkanBuffer *buffer = NULL;
 	VULKAN_GET_OR_RETURN(buffer, context->buffer_pool, buffer_handle, MAX_BUFFERS, true, false);
 
 	ASSERT(FLAG_GET(buffer->memory_property_flags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
 	ASSERT(FLAG_GET(buffer->usage, VK_BUFFER_USAGE_INDEX_BUFFER_BIT));
-	vkCmdBindIndexBuffer(context->command_buffers[context->current_frame], buffer->handle, offset, VK_INDEX_TYPE_UINT32);
+	if (recorder->bound_index_buffer == buffer->handle && recorder->bound_index_offset == offset) {
+		recorder->bind_stats.skipped++;
+		return true;
+	}
+
+	vkCmdBindIndexBuffer(recorder->command_buffer, buffer->handle, offset, VK_INDEX_TYPE_UINT32);
+	recorder->bound_index_buffer = buffer->handle;
+	recorder->bound_index_offset = offset;
+	recorder->bind_stats.issued++;
 	return true;
 }
-ENGINE_API bool vulkan_buffer_bind_vertex(VulkanContext *context, RhiBuffer buffer_handle, size_t offset) {
+ENGINE_API bool vulkan_buffer_bind_vertex(VulkanContext *context, VulkanRecorder *recorder, RhiBuffer buffer_handle, size_t offset) {
 	const VulkanBuffer *buffer = NULL;
 	VULKAN_GET_OR_RETURN(buffer, context->buffer_pool, buffer_handle, MAX_BUFFERS, true, false);
 
 	ASSERT(FLAG_GET(buffer->memory_property_flags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
 	ASSERT(FLAG_GET(buffer->usage, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT));
-	vkCmdBindVertexBuffers(context->command_buffers[context->current_frame], 0, 1, &buffer->handle, &offset);
+	if (recorder->bound_vertex_buffer == buffer->handle && recorder->bound_vertex_offset == offset) {
+		recorder->bind_stats.skipped++;
+		return true;
+	}
+
+	vkCmdBindVertexBuffers(recorder->command_buffer, 0, 1, &buffer->handle, &offset);
+	recorder->bound_vertex_buffer = buffer->handle;
+	recorder->bound_vertex_offset = offset;
+	recorder->bind_stats.issued++;
 	return true;
 }
 
@@ -222,30 +238,11 @@ bool vulkan_buffer_make_internal(
 		return false;
 	}
 
-	VkMemoryRequirements memory_requirements;
-	vkGetBufferMemoryRequirements(context->device.logical, out_buffer->handle, &memory_requirements);
-
-	uint32_t memory_type_index = vulkan_memory_type_find(context->device.physical, memory_requirements.memoryTypeBits, properties);
-	size_t allocation_size = memory_requirements.size;
-
-	LOG_TRACE("SIZE = %llu, REQUIREMENT = %llu", size, memory_requirements.size);
-
-	VkMemoryAllocateInfo allocate_info = {
-		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize = memory_requirements.size,
-		.memoryTypeIndex = memory_type_index,
-	};
-
-	if (vkAllocateMemory(context->device.logical, &allocate_info, NULL, &out_buffer->memory) != VK_SUCCESS) {
+	if (vulkan_memory_bind_buffer(context, out_buffer->handle, properties, &out_buffer->allocation) == false) {
 		LOG_ERROR("Vulkan: failed to allocate buffer memory");
 		return false;
 	}
 
-	if (vkBindBufferMemory(context->device.logical, out_buffer->handle, out_buffer->memory, 0) != VK_SUCCESS) {
-		LOG_ERROR("Vulkan: failed to bind buffer memory");
-		return false;
-	}
-
 	if (format) {
 		VkFormatProperties format_properties = { 0 };
 		vkGetPhysicalDeviceFormatProperties(context->device.physical, format, &format_properties);
@@ -277,94 +274,14 @@ bool vulkan_buffer_make_internal(
 	return true;
 }
 
+// NOTE: Host visible memory stays mapped for its whole lifetime, these only expose or hide the pointer
 bool vulkan_buffer_map(VulkanContext *context, VulkanBuffer *buffer) {
-	return vkMapMemory(context->device.logical, buffer->memory, 0, buffer->frame_size * MAX_FRAMES_IN_FLIGHT, 0, &buffer->mapped) == VK_SUCCESS;
+	buffer->mapped = buffer->allocation.mapped;
+	return buffer->mapped != NULL;
 }
 
 void vulkan_buffer_unmap(VulkanContext *context, VulkanBuffer *buffer) {
-	vkUnmapMemory(context->device.logical, buffer->memory);
-}
-
-bool vulkan_buffer_upload(VulkanContext *context, VulkanBuffer *dst, size_t offset, size_t size, void *data) {
-	VulkanBuffer *staging_buffer = &context->staging_buffer;
-	size_t copy_end = alignup(staging_buffer->offset + size, context->device.properties.limits.minMemoryMapAlignment);
-	size_t copy_start = staging_buffer->frame_size * context->current_frame + staging_buffer->offset;
-	if (copy_end >= staging_buffer->frame_size) {
-		ASSERT_MESSAGE(false, "Max staging buffer size exceeded, aborting vulkan_buffer_create");
-		return false;
-	}
-
-	memory_copy((uint8_t *)staging_buffer->mapped + copy_start, data, size);
-	vulkan_buffer_to_buffer(context, copy_start, staging_buffer->handle, offset, dst->handle, size);
-	staging_buffer->offset = copy_end;
-
-	return true;
-}
-
-bool vulkan_buffer_to_buffer(VulkanContext *context, VkDeviceSize src_offset, VkBuffer src, VkDeviceSize dst_offset, VkBuffer dst, VkDeviceSize size) {
-	VkCommandBuffer command_buffer;
-	vulkan_command_oneshot_begin(context, context->graphics_command_pool, &command_buffer);
-
-	LOG_TRACE("Copying region of %llu from %p to %p", size, src, dst);
-	VkBufferCopy copy_region = { .srcOffset = src_offset, .dstOffset = dst_offset, .size = size };
-	vkCmdCopyBuffer(command_buffer, src, dst, 1, &copy_region);
-
-	VkBufferMemoryBarrier barrier = {
-		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-		.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT,
-		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-		.buffer = dst,
-		.offset = 0,
-		.size = size
-	};
-
-	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 0, NULL, 1, &barrier, 0, NULL);
-	vulkan_command_oneshot_end(context, context->device.graphics_queue, context->graphics_command_pool, &command_buffer);
-	return true;
-}
-
-bool vulkan_buffer_to_image(VulkanContext *context, VkDeviceSize src_offset, VkBuffer src, VkImage dst, uint32_t width, uint32_t height, uint32_t layer_count, VkDeviceSize layer_size) {
-	VkCommandBuffer command_buffer;
-	vulkan_command_oneshot_begin(context, context->graphics_command_pool, &command_buffer);
-	vulkan_image_transition(
-		context, command_buffer, dst, VK_IMAGE_ASPECT_COLOR_BIT, layer_count,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-		0, VK_ACCESS_TRANSFER_WRITE_BIT);
-
-	ArenaTemp scratch = arena_scratch_begin(NULL);
-	VkBufferImageCopy *regions = arena_push_count(scratch.arena, layer_count, VkBufferImageCopy);
-
-	for (uint32_t layer_index = 0; layer_index < layer_count; ++layer_index) {
-		regions[layer_index] = (VkBufferImageCopy){
-			.bufferOffset = src_offset + layer_index * layer_size,
-			.bufferRowLength = 0,
-			.bufferImageHeight = 0,
-			.imageSubresource = {
-			  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-			  .mipLevel = 0,
-			  .baseArrayLayer = layer_index,
-			  .layerCount = 1,
-			},
-			.imageOffset = { 0 },
-			.imageExtent = { .width = width, .height = height, .depth = 1 },
-		};
-	}
-
-	vkCmdCopyBufferToImage(command_buffer, src, dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, layer_count, regions);
-
-	vulkan_image_transition(
-		context, command_buffer, dst, VK_IMAGE_ASPECT_COLOR_BIT, layer_count,
-		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-
-	vulkan_command_oneshot_end(context, context->device.graphics_queue, context->graphics_command_pool, &command_buffer);
-	arena_scratch_end(scratch);
-
-	return true;
+	buffer->mapped = NULL;
 }
 
 VkBufferUsageFlags to_vulkan_usage(BufferUsageFlags usage) {
@@ -19,7 +19,7 @@ bool vulkan_command_pool_create(VulkanContext *context) {
 		return false;
 	}
 
-	cp_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	cp_create_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 	cp_create_info.queueFamilyIndex = context->device.transfer_index;
 	if (vkCreateCommandPool(context->device.logical, &cp_create_info, NULL, &context->transfer_command_pool) != VK_SUCCESS) {
 		LOG_ERROR("Failed to create command pool");
@@ -48,6 +48,78 @@ bool vulkan_command_buffer_create(VulkanContext *context) {
 	return true;
 }
 
+bool vulkan_recorders_create(VulkanContext *context) {
+	VkCommandPoolCreateInfo pool_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = context->device.graphics_index,
+	};
+
+	for (uint32_t slot_index = 0; slot_index < countof(context->recorder_slots); ++slot_index) {
+		VulkanRecorderSlot *slot = &context->recorder_slots[slot_index];
+
+		for (uint32_t frame_index = 0; frame_index < MAX_FRAMES_IN_FLIGHT; ++frame_index) {
+			if (vkCreateCommandPool(context->device.logical, &pool_info, NULL, &slot->command_pools[frame_index]) != VK_SUCCESS) {
+				LOG_ERROR("Vulkan: failed to create recorder command pool");
+				return false;
+			}
+
+			VkCommandBufferAllocateInfo allocate_info = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.commandPool = slot->command_pools[frame_index],
+				.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+				.commandBufferCount = VULKAN_MAX_PARALLEL_DRAWLISTS,
+			};
+
+			if (vkAllocateCommandBuffers(context->device.logical, &allocate_info, slot->command_buffers[frame_index]) != VK_SUCCESS) {
+				LOG_ERROR("Vulkan: failed to allocate recorder command buffers");
+				return false;
+			}
+
+			if (vulkan_descriptor_pool_make(context, 0, &slot->descriptor_pools[frame_index]) == false)
+				return false;
+		}
+	}
+
+	LOG_INFO("Vulkan Recorders created");
+	return true;
+}
+
+void vulkan_recorders_destroy(VulkanContext *context) {
+	for (uint32_t slot_index = 0; slot_index < countof(context->recorder_slots); ++slot_index) {
+		VulkanRecorderSlot *slot = &context->recorder_slots[slot_index];
+
+		for (uint32_t frame_index = 0; frame_index < MAX_FRAMES_IN_FLIGHT; ++frame_index) {
+			vkDestroyCommandPool(context->device.logical, slot->command_pools[frame_index], NULL);
+			vkDestroyDescriptorPool(context->device.logical, slot->descriptor_pools[frame_index], NULL);
+		}
+
+		*slot = (VulkanRecorderSlot){ 0 };
+	}
+}
+
+void vulkan_recorders_reset(VulkanContext *context) {
+	for (uint32_t slot_index = 0; slot_index < countof(context->recorder_slots); ++slot_index) {
+		VulkanRecorderSlot *slot = &context->recorder_slots[slot_index];
+
+		// NOTE: Untouched slots skip the reset, most frames only use a few of them
+		if (slot->used[context->current_frame] == 0)
+			continue;
+
+		vkResetCommandPool(context->device.logical, slot->command_pools[context->current_frame], 0);
+		vkResetDescriptorPool(context->device.logical, slot->descriptor_pools[context->current_frame], 0);
+		slot->used[context->current_frame] = 0;
+	}
+}
+
+void vulkan_recorder_invalidate(VulkanRecorder *recorder) {
+	recorder->bound_pipeline = VK_NULL_HANDLE;
+	recorder->bound_layout = VK_NULL_HANDLE;
+	recorder->bound_vertex_buffer = recorder->bound_index_buffer = VK_NULL_HANDLE;
+	for (uint32_t index = 0; index < MAX_SETS; ++index)
+		recorder->bound_sets[index] = VK_NULL_HANDLE;
+}
+
 bool vulkan_command_oneshot_begin(VulkanContext *context, VkCommandPool pool, VkCommandBuffer *buffer) {
 	VkCommandBufferAllocateInfo allocate_info = {
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
@@ -64,7 +64,7 @@ bool vulkan_descriptor_layout_create(VulkanContext *context, VkDescriptorSetLayo
 	return true;
 }
 
-bool vulkan_descriptor_pool_create(VulkanContext *context) {
+bool vulkan_descriptor_pool_make(VulkanContext *context, VkDescriptorPoolCreateFlags flags, VkDescriptorPool *out_pool) {
 	VkDescriptorPoolSize sizes[] = {
 		{
 		  .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
@@ -90,22 +90,181 @@ bool vulkan_descriptor_pool_create(VulkanContext *context) {
 
 	VkDescriptorPoolCreateInfo dp_create_info = {
 		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags = flags,
 		.poolSizeCount = countof(sizes),
 		.pPoolSizes = sizes,
 		.maxSets = 1000,
 	};
 
+	if (vkCreateDescriptorPool(context->device.logical, &dp_create_info, NULL, out_pool) != VK_SUCCESS) {
+		LOG_ERROR("Failed to create Vulkan DescriptorPool");
+		return false;
+	}
+
+	return true;
+}
+
+void vulkan_descriptor_write(VulkanContext *context, VkWriteDescriptorSet *write) {
+	vkUpdateDescriptorSets(context->device.logical, 1, write, 0, NULL);
+	__atomic_fetch_add(&context->descriptor_writes, 1, __ATOMIC_RELAXED);
+}
+
+bool vulkan_descriptor_pool_create(VulkanContext *context) {
 	for (uint32_t frame_index = 0; frame_index < MAX_FRAMES_IN_FLIGHT; ++frame_index) {
-		if (vkCreateDescriptorPool(context->device.logical, &dp_create_info, NULL, &context->descriptor_pools[frame_index]) != VK_SUCCESS) {
-			LOG_ERROR("Failed to create Vulkan DescriptorPool");
+		if (vulkan_descriptor_pool_make(context, 0, &context->descriptor_pools[frame_index]) == false)
 			return false;
-		}
 	}
 
+	// NOTE: Persistent sets are freed one at a time instead of with the whole pool
+	if (vulkan_descriptor_pool_make(context, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, &context->persistent_descriptor_pool) == false)
+		return false;
+
 	LOG_INFO("VkDescriptorPool created");
 	return true;
 }
 
+bool vulkan_bindless_create(VulkanContext *context) {
+	VkPhysicalDeviceVulkan12Properties vk12_properties = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+	VkPhysicalDeviceProperties2 properties = {
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+		.pNext = &vk12_properties,
+	};
+	vkGetPhysicalDeviceProperties2(context->device.physical, &properties);
+
+	uint32_t capacity = MIN(VULKAN_BINDLESS_TEXTURE_CAPACITY, vk12_properties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+	capacity = MIN(capacity, vk12_properties.maxDescriptorSetUpdateAfterBindSampledImages);
+	if (capacity < MAX_TEXTURES) {
+		LOG_ERROR("Vulkan: device supports %u sampled images per stage, bindless table needs %u", capacity, MAX_TEXTURES);
+		return false;
+	}
+	context->bindless.texture_capacity = capacity;
+
+	VkDescriptorSetLayoutBinding bindings[] = {
+		{
+		  .binding = VULKAN_BINDLESS_TEXTURE_BINDING,
+		  .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		  .descriptorCount = capacity,
+		  .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
+		},
+		{
+		  .binding = VULKAN_BINDLESS_SAMPLER_BINDING,
+		  .descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+		  .descriptorCount = MAX_SAMPLERS,
+		  .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
+		},
+	};
+
+	// Slots are written as resources are created, possibly while the set is bound by a frame in flight
+	VkDescriptorBindingFlags binding_flags[] = {
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+	};
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flags_create_info = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.bindingCount = countof(binding_flags),
+		.pBindingFlags = binding_flags,
+	};
+
+	VkDescriptorSetLayoutCreateInfo dsl_create_info = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = &flags_create_info,
+		.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+		.bindingCount = countof(bindings),
+		.pBindings = bindings,
+	};
+
+	if (vkCreateDescriptorSetLayout(context->device.logical, &dsl_create_info, NULL, &context->bindless.layout) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: Failed to create bindless descriptor set layout");
+		return false;
+	}
+
+	VkDescriptorPoolSize sizes[] = {
+		{
+		  .type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		  .descriptorCount = capacity,
+		},
+		{
+		  .type = VK_DESCRIPTOR_TYPE_SAMPLER,
+		  .descriptorCount = MAX_SAMPLERS,
+		},
+	};
+
+	VkDescriptorPoolCreateInfo dp_create_info = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.poolSizeCount = countof(sizes),
+		.pPoolSizes = sizes,
+		.maxSets = 1,
+	};
+
+	if (vkCreateDescriptorPool(context->device.logical, &dp_create_info, NULL, &context->bindless.pool) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: Failed to create bindless descriptor pool");
+		return false;
+	}
+
+	VkDescriptorSetAllocateInfo ds_allocate_info = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = context->bindless.pool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &context->bindless.layout,
+	};
+
+	if (vkAllocateDescriptorSets(context->device.logical, &ds_allocate_info, &context->bindless.set) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: Failed to allocate bindless descriptor set");
+		return false;
+	}
+
+	LOG_INFO("Vulkan: bindless descriptor set created with %u texture slots", capacity);
+	return true;
+}
+
+void vulkan_bindless_destroy(VulkanContext *context) {
+	vkDestroyDescriptorPool(context->device.logical, context->bindless.pool, NULL);
+	vkDestroyDescriptorSetLayout(context->device.logical, context->bindless.layout, NULL);
+	context->bindless.pool = VK_NULL_HANDLE;
+	context->bindless.layout = VK_NULL_HANDLE;
+	context->bindless.set = VK_NULL_HANDLE;
+}
+
+void vulkan_bindless_write_image(VulkanContext *context, uint32_t slot, VulkanImage *image) {
+	ASSERT(slot < context->bindless.texture_capacity);
+
+	VkDescriptorImageInfo image_info = {
+		.imageView = image->view,
+		.imageLayout = image->aspect == VK_IMAGE_ASPECT_COLOR_BIT ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+	};
+
+	VkWriteDescriptorSet descriptor_write = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = context->bindless.set,
+		.dstBinding = VULKAN_BINDLESS_TEXTURE_BINDING,
+		.dstArrayElement = slot,
+		.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+		.descriptorCount = 1,
+		.pImageInfo = &image_info,
+	};
+	vulkan_descriptor_write(context, &descriptor_write);
+}
+
+void vulkan_bindless_write_sampler(VulkanContext *context, uint32_t slot, VulkanSampler *sampler) {
+	ASSERT(slot < MAX_SAMPLERS);
+
+	VkDescriptorImageInfo image_info = {
+		.sampler = sampler->handle,
+	};
+
+	VkWriteDescriptorSet descriptor_write = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = context->bindless.set,
+		.dstBinding = VULKAN_BINDLESS_SAMPLER_BINDING,
+		.dstArrayElement = slot,
+		.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER,
+		.descriptorCount = 1,
+		.pImageInfo = &image_info,
+	};
+	vulkan_descriptor_write(context, &descriptor_write);
+}
+
 // bool vulkan_descriptor_global_create(VulkanContext *context) {
 // 	context->main_pass.binding = (VkDescriptorSetLayoutBinding){
 // 		.binding = 0,
@@ -54,8 +54,11 @@ bool vulkan_device_create(Arena *arena, VulkanContext *context) {
 		.pNext = &vk13_features,
 		.runtimeDescriptorArray = VK_TRUE,
 		.descriptorBindingPartiallyBound = VK_TRUE,
+		.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+		.descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
 		.shaderSampledImageArrayNonUniformIndexing = VK_TRUE, // NOTE: Works perfectly fine without
 		.descriptorIndexing = VK_TRUE,
+		.timelineSemaphore = VK_TRUE,
 	};
 	VkPhysicalDeviceFeatures features = { .samplerAnisotropy = true, .fillModeNonSolid = true };
 
@@ -132,14 +135,17 @@ bool is_device_suitable(Arena *arena, VkPhysicalDevice physical_device, VkSurfac
 		};
 		vkGetPhysicalDeviceFeatures2(physical_device, &device_features);
 
-		bool bindless_supported = indexing_features.descriptorBindingPartiallyBound && indexing_features.runtimeDescriptorArray;
+		bool bindless_supported = indexing_features.descriptorBindingPartiallyBound && indexing_features.runtimeDescriptorArray &&
+			indexing_features.descriptorBindingSampledImageUpdateAfterBind && indexing_features.descriptorBindingUpdateUnusedWhilePending;
 		if (bindless_supported == false) {
-			ASSERT(false);
+			// NOTE: Headless contexts run the GPU tests, which skip rather than stop when no device fits
+			ASSERT(surface == NULL);
 			return false;
 		}
 	}
 
-	if (device->properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
+	// NOTE: Headless contexts take any device type, so the GPU tests also run on software rasterizers like lavapipe
+	if (surface && device->properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU)
 		return false;
 
 	if (!(device->features.geometryShader && device->features.samplerAnisotropy))
@@ -166,27 +172,30 @@ bool is_device_suitable(Arena *arena, VkPhysicalDevice physical_device, VkSurfac
 		}
 	}
 
-	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &device->swapchain_details.capabilities);
+	// NOTE: Headless contexts have no surface, anything with a graphics queue will do
+	if (surface) {
+		vkGetPhysicalDeviceSurfaceCapabilitiesKHR(physical_device, surface, &device->swapchain_details.capabilities);
 
-	vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &device->swapchain_details.format_count, NULL);
-	if (device->swapchain_details.format_count == 0) {
-		LOG_ERROR("No surface formats available");
-		arena_scratch_end(scratch);
-		return false;
-	}
+		vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &device->swapchain_details.format_count, NULL);
+		if (device->swapchain_details.format_count == 0) {
+			LOG_ERROR("No surface formats available");
+			arena_scratch_end(scratch);
+			return false;
+		}
 
-	device->swapchain_details.formats = arena_push_count(arena, device->swapchain_details.format_count, VkSurfaceFormatKHR);
-	vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &device->swapchain_details.format_count, device->swapchain_details.formats);
+		device->swapchain_details.formats = arena_push_count(arena, device->swapchain_details.format_count, VkSurfaceFormatKHR);
+		vkGetPhysicalDeviceSurfaceFormatsKHR(physical_device, surface, &device->swapchain_details.format_count, device->swapchain_details.formats);
 
-	vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &device->swapchain_details.present_mode_count, NULL);
-	if (device->swapchain_details.present_mode_count == 0) {
-		LOG_ERROR("No surface modes available");
-		arena_scratch_end(scratch);
-		return false;
-	}
+		vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &device->swapchain_details.present_mode_count, NULL);
+		if (device->swapchain_details.present_mode_count == 0) {
+			LOG_ERROR("No surface modes available");
+			arena_scratch_end(scratch);
+			return false;
+		}
 
-	device->swapchain_details.present_modes = arena_push_count(arena, device->swapchain_details.present_mode_count, VkPresentModeKHR);
-	vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &device->swapchain_details.present_mode_count, device->swapchain_details.present_modes);
+		device->swapchain_details.present_modes = arena_push_count(arena, device->swapchain_details.present_mode_count, VkPresentModeKHR);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(physical_device, surface, &device->swapchain_details.present_mode_count, device->swapchain_details.present_modes);
+	}
 
 	uint32_t queue_family_count = 0;
 	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, NULL);
@@ -206,11 +215,19 @@ bool is_device_suitable(Arena *arena, VkPhysicalDevice physical_device, VkSurfac
 			device->transfer_index = index;
 
 		VkBool32 present_support = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, index, surface, &present_support);
+		if (surface)
+			vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, index, surface, &present_support);
 		if (present_support && device->present_index == -1)
 			device->present_index = index;
 	}
 
+	if (surface == VK_NULL_HANDLE)
+		device->present_index = device->graphics_index;
+
+	// NOTE: Without a dedicated transfer family uploads share the graphics queue
+	if (device->transfer_index == -1)
+		device->transfer_index = device->graphics_index;
+
 	arena_scratch_end(scratch);
 	LOG_INFO("Device '%s' selected", device->properties.deviceName);
 
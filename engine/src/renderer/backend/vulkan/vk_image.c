@@ -41,23 +41,12 @@ bool vulkan_image_make_internal(
 
 	LOG_INFO("VkImage created");
 
-	VkMemoryRequirements memory_requirements;
-	vkGetImageMemoryRequirements(context->device.logical, image->handle, &memory_requirements);
-
-	VkMemoryAllocateInfo allocate_info = {
-		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize = memory_requirements.size,
-		.memoryTypeIndex = vulkan_memory_type_find(context->device.physical, memory_requirements.memoryTypeBits, properties),
-	};
-
-	if (vkAllocateMemory(context->device.logical, &allocate_info, NULL, &image->memory) != VK_SUCCESS) {
+	if (vulkan_memory_bind_image(context, image->handle, usage, properties, &image->allocation) == false) {
 		LOG_ERROR("Failed to allocate VkDeviceMemory for VkImage");
 		return false;
 	}
 
-	vkBindImageMemory(context->device.logical, image->handle, image->memory, 0);
-
-	LOG_INFO("VkDeviceMemory[%d] allocated for VkImage", memory_requirements.size);
+	LOG_INFO("VkDeviceMemory[%llu] bound to VkImage", image->allocation.size);
 
 	return true;
 }
@@ -68,33 +57,10 @@ void vulkan_image_destroy_internal(VulkanContext *context, VulkanImage *image) {
 
 	vkDestroyImageView(context->device.logical, image->view, NULL);
 	vkDestroyImage(context->device.logical, image->handle, NULL);
-	vkFreeMemory(context->device.logical, image->memory, NULL);
+	vulkan_memory_free(context, &image->allocation);
 	*image = (VulkanImage){ 0 };
 }
 
-bool vulkan_image_upload(VulkanContext *context, void *pixels, VulkanImage *dst) {
-	VkDeviceSize layer_size = dst->width * dst->height * vulkan_utils_format_to_stride(dst->info.format);
-	VkDeviceSize total_size = layer_size * dst->info.arrayLayers;
-
-	VulkanBuffer *staging_buffer = &context->staging_buffer;
-	size_t copy_end = alignup(staging_buffer->offset + total_size,
-		context->device.properties.limits.minMemoryMapAlignment);
-	size_t copy_start = staging_buffer->frame_size * context->current_frame + staging_buffer->offset;
-	if (copy_end >= staging_buffer->frame_size) {
-		LOG_ERROR(
-			"Vulkan: max staging buffer size exceeded, aborting vulkan_renderer_texture_create");
-		ASSERT(false);
-		return false;
-	}
-
-	memory_copy((uint8_t *)staging_buffer->mapped + copy_start, pixels, total_size);
-	staging_buffer->offset = copy_end;
-	vulkan_buffer_to_image(context, copy_start, staging_buffer->handle, dst->handle, dst->width,
-		dst->height, dst->info.arrayLayers, layer_size);
-	dst->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	return true;
-}
-
 bool vulkan_imageview_make(VulkanContext *context, VkImageViewType type, VkImageAspectFlags aspect_flags, VulkanImage *image) {
 	VkImageViewCreateInfo iv_create_info = {
 		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
@@ -4,10 +4,11 @@
 #include "renderer/backend/vulkan_api.h"
 
 #include "core/arena.h"
+#include "core/ring.h"
 
+#include <pthread.h>
 #include <vulkan/vulkan_core.h>
 
-#define MAX_FRAMES_IN_FLIGHT 2
 #define SWAPCHAIN_IMAGE_COUNT 3
 
 #define MAX_SHADER_VARIANTS 8
@@ -18,6 +19,24 @@
 #define MAX_PUSH_CONSTANT_RANGES 3
 #define MAX_UNIFORMS 32
 
+// NOTE: Appended after the reflected sets of every pipeline layout, slots are the texture/sampler pool indices
+#define VULKAN_BINDLESS_SET MAX_SETS
+#define VULKAN_BINDLESS_TEXTURE_BINDING 0
+#define VULKAN_BINDLESS_SAMPLER_BINDING 1
+#define VULKAN_BINDLESS_TEXTURE_CAPACITY 16384
+
+#define VULKAN_MEMORY_BLOCK_SIZE MiB(128)
+#define VULKAN_MEMORY_MAX_BLOCKS 64
+#define VULKAN_MEMORY_MAX_RANGES 16384
+#define VULKAN_MEMORY_DEDICATED_TARGET_SIZE MiB(4)
+
+// NOTE: Host visible buffers hold a copy per frame in flight, the staging ring spans all of them
+#define VULKAN_UPLOAD_BATCH_COUNT 4
+#define VULKAN_UPLOAD_STAGING_SIZE MiB(128)
+
+// Parallel drawlists each recorder slot can take part in per frame
+#define VULKAN_MAX_PARALLEL_DRAWLISTS 8
+
 typedef enum {
 	VULKAN_RESOURCE_STATE_UNINITIALIZED,
 	VULKAN_RESOURCE_STATE_INITIALIZED,
@@ -49,13 +68,33 @@ typedef enum {
 		}                                                                                             \
 	} while (0)
 
+// NOTE: Persistent sets are numbered after the transient ones, so one handle type covers both
+#define VULKAN_GET_SET_OR_RETURN(ptr_var, context, handle, return_type)                                                             \
+	do {                                                                                                                            \
+		if ((handle).id >= MAX_UNIFORM_SETS) {                                                                                      \
+			RhiUniformSet persistent_handle = { (handle).id - MAX_UNIFORM_SETS };                                                   \
+			VULKAN_GET_OR_RETURN(ptr_var, (context)->persistent_set_pool, persistent_handle, MAX_PERSISTENT_UNIFORM_SETS, true, return_type); \
+		} else                                                                                                                      \
+			VULKAN_GET_OR_RETURN(ptr_var, (context)->set_pool, handle, MAX_UNIFORM_SETS, true, return_type);                       \
+	} while (0)
+
+typedef struct VulkanAllocator VulkanAllocator;
+
+// NOTE: range is 0 for dedicated allocations, which own their VkDeviceMemory outright
+typedef struct {
+	VkDeviceMemory memory;
+	VkDeviceSize offset, size;
+	void *mapped;
+	uint32_t range;
+} VulkanAllocation;
+
 typedef struct vulkan_buffer {
 	VulkanResourceState state;
 
 	BufferUsageFlags type;
 
 	VkBuffer handle;
-	VkDeviceMemory memory;
+	VulkanAllocation allocation;
 	VkBufferView view;
 	void *mapped;
 
@@ -72,16 +111,42 @@ typedef struct {
 
 	uint32_t number;
 
-	uint32_t buffer_ranges[MAX_BINDINGS_PER_RESOURCE];
-	uint32_t range_count;
+	// Dynamic offsets by binding, passed in binding order. The frame stride is added when the set is bound,
+	// so a persistent set follows per frame buffers without being written again
+	uint32_t buffer_offsets[MAX_BINDINGS_PER_RESOURCE];
+	uint32_t buffer_strides[MAX_BINDINGS_PER_RESOURCE];
+	// Taken from the shader's layout when the set is allocated, every dynamic binding gets an offset written or not
+	uint32_t dynamic_mask;
 } VulkanUniformSet;
 
+typedef enum {
+	VULKAN_SET_WRITE_NONE,
+	VULKAN_SET_WRITE_BUFFER,
+	VULKAN_SET_WRITE_TEXTURE,
+} VulkanSetWriteType;
+
+typedef struct {
+	VulkanSetWriteType type;
+
+	RhiBuffer buffer;
+	size_t offset, size;
+
+	RhiTexture texture;
+	RhiSampler sampler;
+} VulkanSetWrite;
+
+// What a persistent set was made from, enough to write it again once a resource behind it is replaced
+typedef struct {
+	RhiShader shader;
+	VulkanSetWrite writes[MAX_BINDINGS_PER_RESOURCE];
+} VulkanSetRecord;
+
 typedef struct vulkan_image {
 	VulkanResourceState state;
 
 	VkImage handle;
 	VkImageView view;
-	VkDeviceMemory memory;
+	VulkanAllocation allocation;
 
 	VkImageLayout layout;
 	VkImageAspectFlags aspect;
@@ -165,11 +230,11 @@ bool vulkan_buffer_map(VulkanContext *context, VulkanBuffer *buffer);
 void vulkan_buffer_unmap(VulkanContext *context, VulkanBuffer *buffer);
 bool vulkan_buffer_write_internal(VulkanContext *context, uint32_t frame, size_t offset, size_t size, void *data, VulkanBuffer *buffer);
 
+// Recorded into the current upload batch, the copies land before the graphics work of the frame they're flushed with.
+// Uploads larger than the free staging space go in chunks, waiting on the GPU for room in between
 bool vulkan_buffer_upload(VulkanContext *context, VulkanBuffer *dst, size_t offset, size_t size, void *data);
 bool vulkan_image_upload(VulkanContext *context, void *pixels, VulkanImage *dst);
 
-bool vulkan_buffer_to_buffer(VulkanContext *context, VkDeviceSize src_offset, VkBuffer src, VkDeviceSize dst_offset, VkBuffer dst, VkDeviceSize size);
-bool vulkan_buffer_to_image(VulkanContext *context, VkDeviceSize src_offset, VkBuffer src, VkImage dst, uint32_t width, uint32_t height, uint32_t layer_count, VkDeviceSize layer_size);
 bool vulkan_image_to_buffer(VulkanContext *context, VkCommandBuffer command_buffer, VulkanImage *image, VulkanBuffer *buffer, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 
 bool vulkan_image_make_internal(VulkanContext *context, VkSampleCountFlags, uint32_t, uint32_t, VkFormat, VkImageTiling, VkImageUsageFlags, TextureType, VkMemoryPropertyFlags, VulkanImage *);
@@ -184,16 +249,43 @@ bool vulkan_image_scratch_ensure(VulkanContext *context, VulkanImage *msaa, VkEx
 
 bool vulkan_command_pool_create(VulkanContext *context);
 bool vulkan_command_buffer_create(VulkanContext *context);
+bool vulkan_recorders_create(VulkanContext *context);
+void vulkan_recorders_destroy(VulkanContext *context);
+// Resets the current frame's pools of every slot, its fence must have been waited on
+void vulkan_recorders_reset(VulkanContext *context);
+// Forgets the bound state, for when the command buffer begins or a new pass starts. Stats are kept
+void vulkan_recorder_invalidate(VulkanRecorder *recorder);
 bool vulkan_command_oneshot_begin(VulkanContext *context, VkCommandPool pool, VkCommandBuffer *oneshot);
 bool vulkan_command_oneshot_end(VulkanContext *context, VkQueue queue, VkCommandPool pool, VkCommandBuffer *oneshot);
 
 void vulkan_load_extensions(VulkanContext *context);
 
 bool vulkan_descriptor_pool_create(VulkanContext *context);
+bool vulkan_descriptor_pool_make(VulkanContext *context, VkDescriptorPoolCreateFlags flags, VkDescriptorPool *out_pool);
+// Every host descriptor write goes through here so they can be counted per frame
+void vulkan_descriptor_write(VulkanContext *context, VkWriteDescriptorSet *write);
 bool vulkan_descriptor_layout_create(VulkanContext *context, VkDescriptorSetLayoutBinding *bindings, uint32_t binding_count, VkDescriptorSetLayout *out_layout);
 bool vulkan_sync_objects_create(VulkanContext *context);
 
+bool vulkan_upload_create(VulkanContext *context);
+void vulkan_upload_destroy(VulkanContext *context);
+// Submits the recording batch, returns the timeline value that signals once everything submitted so far is done
+uint64_t vulkan_upload_flush(VulkanContext *context);
+// Records the graphics side of the queue family ownership transfers, false when there was nothing to acquire
+bool vulkan_upload_acquire(VulkanContext *context, VkCommandBuffer command_buffer);
+
+bool vulkan_pipeline_cache_create(Arena *arena, VulkanContext *context);
+void vulkan_pipeline_cache_destroy(VulkanContext *context);
+
+bool vulkan_memory_startup(Arena *arena, VulkanContext *context);
+void vulkan_memory_shutdown(VulkanContext *context);
+// Host visible memory is persistently mapped, out->mapped points at the start of the allocation
+bool vulkan_memory_bind_buffer(VulkanContext *context, VkBuffer buffer, VkMemoryPropertyFlags properties, VulkanAllocation *out);
+bool vulkan_memory_bind_image(VulkanContext *context, VkImage image, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VulkanAllocation *out);
+void vulkan_memory_free(VulkanContext *context, VulkanAllocation *allocation);
+
 size_t vulkan_memory_required_alignment(VulkanContext *context, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_properties);
+// UINT32_MAX when no memory type matches both the filter and the properties
 uint32_t vulkan_memory_type_find(VkPhysicalDevice physical_device, uint32_t type_filter, VkMemoryPropertyFlags properties);
 
 void vulkan_utils_set_object_name(VulkanContext *context, uint64_t object_handle, VkObjectType type, String name);
@@ -233,6 +325,8 @@ typedef struct vulkan_shader {
 	uint32_t attribute_count, binding_count;
 
 	VkDescriptorSetLayout layouts[4];
+	// Bindings of each set whose layout declares a dynamic buffer, as reflected
+	uint32_t dynamic_bindings[MAX_SETS];
 
 	uint32_t group_ubo_binding;
 	VkDeviceSize instance_size;
@@ -247,6 +341,26 @@ typedef struct vulkan_shader {
 	uint32_t variant_count;
 } VulkanShader;
 
+// Destroys the modules, layouts and pipelines of dst and moves src into it
+void vulkan_shader_swap_internal(VulkanContext *context, VulkanShader *dst, VulkanShader *src);
+void vulkan_shader_destroy_internal(VulkanContext *context, VulkanShader *shader);
+
+typedef enum {
+	VULKAN_REPLACEMENT_TEXTURE,
+	VULKAN_REPLACEMENT_SHADER,
+} VulkanReplacementType;
+
+// A resource built next to the one it replaces, moved into the same pool slot at the start of a frame
+typedef struct {
+	VulkanReplacementType type;
+	uint32_t slot;
+
+	union {
+		VulkanImage image;
+		VulkanShader *shader;
+	} as;
+} VulkanReplacement;
+
 typedef struct vulkan_sampler {
 	VulkanResourceState state;
 
@@ -254,6 +368,74 @@ typedef struct vulkan_sampler {
 	VkSamplerCreateInfo info;
 } VulkanSampler;
 
+// Copies run on the transfer queue, one submission per batch. Each batch signals the next value of timeline,
+// which the graphics submit waits on before anything reads what it wrote
+typedef struct {
+	VkQueue queue;
+	uint32_t family;
+	VkSemaphore timeline;
+	uint64_t submitted;
+
+	// Every batch tags what it staged with its timeline value, the space comes back once that value is reached
+	VulkanBuffer staging;
+	Ring ring;
+
+	VkCommandBuffer command_buffers[VULKAN_UPLOAD_BATCH_COUNT];
+	uint64_t batch_values[VULKAN_UPLOAD_BATCH_COUNT];
+	uint32_t batch;
+	bool recording;
+
+	// With a dedicated transfer family the graphics queue has to acquire everything the batches released
+	Arena arena;
+	VkBufferMemoryBarrier *buffer_acquires;
+	VkImageMemoryBarrier *image_acquires;
+	VkCommandBuffer acquire_buffers[MAX_FRAMES_IN_FLIGHT];
+} VulkanUploadQueue;
+
+// Everything a per-draw call touches. The frame recorder writes the primary command buffer, the slot recorders
+// write the secondary command buffers of a parallel drawlist
+struct vulkan_recorder {
+	VkCommandBuffer command_buffer;
+	VkDescriptorPool descriptor_pool;
+
+	VulkanShader *bound_shader;
+	// Owned by the context and only read while recording
+	const VulkanPass *pass;
+
+	// What the command buffer has bound, so binding the same state again is dropped.
+	// Cleared whenever recording starts over, VK_NULL_HANDLE never matches a real bind
+	VkPipeline bound_pipeline;
+	VkPipelineLayout bound_layout;
+	VkDescriptorSet bound_sets[MAX_SETS];
+	uint32_t bound_offsets[MAX_SETS][MAX_BINDINGS_PER_RESOURCE];
+	uint32_t bound_offset_counts[MAX_SETS];
+	VkBuffer bound_vertex_buffer, bound_index_buffer;
+	VkDeviceSize bound_vertex_offset, bound_index_offset;
+
+	VulkanBindStats bind_stats;
+};
+
+// NOTE: Command and descriptor pools are externally synchronized, so every slot has its own per frame in flight.
+// A slot is only ever recorded by one thread at a time
+typedef struct {
+	VkCommandPool command_pools[MAX_FRAMES_IN_FLIGHT];
+	VkDescriptorPool descriptor_pools[MAX_FRAMES_IN_FLIGHT];
+	VkCommandBuffer command_buffers[MAX_FRAMES_IN_FLIGHT][VULKAN_MAX_PARALLEL_DRAWLISTS];
+	uint32_t used[MAX_FRAMES_IN_FLIGHT];
+
+	VulkanRecorder recorder;
+} VulkanRecorderSlot;
+
+bool vulkan_bindless_create(VulkanContext *context);
+void vulkan_bindless_destroy(VulkanContext *context);
+void vulkan_bindless_write_image(VulkanContext *context, uint32_t slot, VulkanImage *image);
+void vulkan_bindless_write_sampler(VulkanContext *context, uint32_t slot, VulkanSampler *sampler);
+
+// Writes the persistent sets that reference the texture again, its image was recreated behind the same handle
+void vulkan_uniformsets_refresh_texture(VulkanContext *context, uint32_t texture_slot);
+// Reallocates the persistent sets made from the shader against its swapped in layouts and writes them again
+void vulkan_uniformsets_refresh_shader(VulkanContext *context, uint32_t shader_slot);
+
 struct vulkan_context {
 	VkInstance instance;
 	void *display;
@@ -277,13 +459,45 @@ struct vulkan_context {
 	VulkanImage *image_pool;
 	VulkanSampler *sampler_pool;
 	VulkanUniformSet *set_pool;
+	// Never reset, allocated from persistent_descriptor_pool and rewritten from their records
+	VulkanUniformSet *persistent_set_pool;
+	VulkanSetRecord *persistent_set_records;
+	VkDescriptorPool persistent_descriptor_pool;
 
+	// Readbacks only, uploads stage through upload
 	VulkanBuffer staging_buffer;
-	VulkanShader *bound_shader;
+	VulkanUploadQueue upload;
+
 	VulkanPass bound_pass;
-	VkCommandBuffer command_buffer;
 	VkDescriptorPool descriptor_pools[MAX_FRAMES_IN_FLIGHT];
 
+	VulkanRecorder recorder;
+	VulkanRecorderSlot recorder_slots[MAX_RECORDERS];
+	// Slot recorders of the open drawlist, 0 when it records into recorder
+	uint32_t parallel_count;
+	// Guards what recorders share: the uniform set pool and the pipeline variants of each shader
+	pthread_mutex_t mutex;
+	// Slot recorders add theirs when their drawlist ends, the frame recorder when the frame does
+	VulkanBindStats frame_bind_stats, bind_stats;
+	// Written from any thread that records
+	uint32_t descriptor_writes;
+
+	struct {
+		VkDescriptorPool pool;
+		VkDescriptorSetLayout layout;
+		VkDescriptorSet set;
+		uint32_t texture_capacity;
+	} bindless;
+
+	// Swapped in by vulkan_frame_begin, the arena is rewound once they're all applied
+	Arena replacement_arena;
+	VulkanReplacement *replacements;
+
+	VulkanAllocator *allocator;
+	VkPipelineCache pipeline_cache;
+	String pipeline_cache_path;
+	size_t pipeline_cache_loaded;
+
 	VkSemaphore image_available_semaphores[MAX_FRAMES_IN_FLIGHT];
 	VkSemaphore render_finished_semaphores[SWAPCHAIN_IMAGE_COUNT];
 	VkFence in_flight_fences[MAX_FRAMES_IN_FLIGHT];
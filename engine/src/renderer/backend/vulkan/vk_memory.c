@@ -1,9 +1,518 @@
 #include "core/debug.h"
 #include "core/logger.h"
+#include "core/pool.h"
 #include "vk_internal.h"
 #include "renderer/backend/vulkan_api.h"
 #include <vulkan/vulkan_core.h>
 
+// NOTE: Two-level segregated fit over offsets inside each VkDeviceMemory block. The first level
+// splits free ranges by power of two, the second into TLSF_SL_COUNT linear steps within it,
+// so both allocation and free are a couple of bit scans plus list splicing
+#define TLSF_SL_BITS 5
+#define TLSF_SL_COUNT (1 << TLSF_SL_BITS)
+#define TLSF_MIN_SHIFT 8
+#define TLSF_FL_COUNT 24
+#define TLSF_GRANULE (1ull << TLSF_MIN_SHIFT)
+
+typedef struct {
+	VkDeviceSize offset, size;
+	uint32_t block;
+	// Neighbours in address order and in the free list, 0 terminates
+	uint32_t prev_physical, next_physical;
+	uint32_t prev_free, next_free;
+	bool free;
+} MemoryRange;
+
+typedef struct {
+	VkDeviceMemory memory;
+	void *mapped;
+	VkDeviceSize size, used;
+	uint32_t memory_type;
+	bool linear;
+	uint32_t allocation_count;
+
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap[TLSF_FL_COUNT];
+	uint32_t free_heads[TLSF_FL_COUNT][TLSF_SL_COUNT];
+} MemoryBlock;
+
+struct VulkanAllocator {
+	VkPhysicalDeviceMemoryProperties properties;
+	VkDeviceSize block_sizes[VK_MAX_MEMORY_TYPES];
+
+	// Index 0 in both is reserved as the null entry
+	MemoryBlock blocks[VULKAN_MEMORY_MAX_BLOCKS];
+	MemoryRange *ranges;
+
+	uint32_t dedicated_count;
+	VkDeviceSize dedicated_size;
+};
+
+static inline uint32_t bit_scan_forward(uint32_t value) { return (uint32_t)__builtin_ctz(value); }
+static inline uint32_t bit_scan_reverse(uint64_t value) { return 63u - (uint32_t)__builtin_clzll(value); }
+
+static void tlsf_mapping(VkDeviceSize size, uint32_t *fl, uint32_t *sl) {
+	uint32_t bit = bit_scan_reverse(size);
+	*sl = (uint32_t)(size >> (bit - TLSF_SL_BITS)) - TLSF_SL_COUNT;
+	*fl = bit - TLSF_MIN_SHIFT;
+}
+
+static void free_list_insert(VulkanAllocator *allocator, MemoryBlock *block, uint32_t index) {
+	MemoryRange *range = &allocator->ranges[index];
+	uint32_t fl, sl;
+	tlsf_mapping(range->size, &fl, &sl);
+
+	uint32_t head = block->free_heads[fl][sl];
+	range->free = true;
+	range->prev_free = 0;
+	range->next_free = head;
+	if (head)
+		allocator->ranges[head].prev_free = index;
+
+	block->free_heads[fl][sl] = index;
+	block->sl_bitmap[fl] |= 1u << sl;
+	block->fl_bitmap |= 1u << fl;
+}
+
+static void free_list_remove(VulkanAllocator *allocator, MemoryBlock *block, uint32_t index) {
+	MemoryRange *range = &allocator->ranges[index];
+	uint32_t fl, sl;
+	tlsf_mapping(range->size, &fl, &sl);
+
+	if (range->prev_free)
+		allocator->ranges[range->prev_free].next_free = range->next_free;
+	else
+		block->free_heads[fl][sl] = range->next_free;
+	if (range->next_free)
+		allocator->ranges[range->next_free].prev_free = range->prev_free;
+
+	if (block->free_heads[fl][sl] == 0) {
+		block->sl_bitmap[fl] &= ~(1u << sl);
+		if (block->sl_bitmap[fl] == 0)
+			block->fl_bitmap &= ~(1u << fl);
+	}
+
+	range->free = false;
+	range->prev_free = range->next_free = 0;
+}
+
+static uint32_t range_make(VulkanAllocator *allocator, uint32_t block, VkDeviceSize offset, VkDeviceSize size) {
+	MemoryRange *range = pool_alloc_struct(allocator->ranges, MemoryRange);
+	if (range == NULL) {
+		LOG_ERROR("Vulkan: out of memory ranges, raise VULKAN_MEMORY_MAX_RANGES");
+		ASSERT(false);
+		return 0;
+	}
+
+	*range = (MemoryRange){ .offset = offset, .size = size, .block = block };
+	return indexof(allocator->ranges, range);
+}
+
+// Finds a free range of at least size bytes, rounding the request up so any range in the found list fits
+static uint32_t block_find_free(VulkanAllocator *allocator, MemoryBlock *block, VkDeviceSize size) {
+	uint32_t bit = bit_scan_reverse(size);
+	size += (1ull << (bit - TLSF_SL_BITS)) - 1;
+
+	uint32_t fl, sl;
+	tlsf_mapping(size, &fl, &sl);
+	if (fl >= TLSF_FL_COUNT)
+		return 0;
+
+	uint32_t sl_map = block->sl_bitmap[fl] & (~0u << sl);
+	if (sl_map == 0) {
+		uint32_t fl_map = fl + 1 < TLSF_FL_COUNT ? block->fl_bitmap & (~0u << (fl + 1)) : 0;
+		if (fl_map == 0)
+			return 0;
+
+		fl = bit_scan_forward(fl_map);
+		sl_map = block->sl_bitmap[fl];
+	}
+
+	return block->free_heads[fl][bit_scan_forward(sl_map)];
+}
+
+static uint32_t block_allocate(VulkanAllocator *allocator, uint32_t block_index, VkDeviceSize size, VkDeviceSize alignment) {
+	MemoryBlock *block = &allocator->blocks[block_index];
+
+	// Offsets are always granule aligned, only larger alignments need slack in the search
+	VkDeviceSize padding = alignment > TLSF_GRANULE ? alignment - TLSF_GRANULE : 0;
+	uint32_t index = block_find_free(allocator, block, size + padding);
+	if (index == 0)
+		return 0;
+
+	free_list_remove(allocator, block, index);
+	MemoryRange *range = &allocator->ranges[index];
+
+	// NOTE: Neighbours of a free range are never free themselves, so split-off pieces need no merging
+	VkDeviceSize aligned = alignup(range->offset, alignment);
+	if (aligned > range->offset) {
+		uint32_t front = range_make(allocator, block_index, range->offset, aligned - range->offset);
+		range = &allocator->ranges[index];
+		if (front == 0) {
+			free_list_insert(allocator, block, index);
+			return 0;
+		}
+
+		MemoryRange *front_range = &allocator->ranges[front];
+		front_range->prev_physical = range->prev_physical;
+		front_range->next_physical = index;
+		if (range->prev_physical)
+			allocator->ranges[range->prev_physical].next_physical = front;
+		range->prev_physical = front;
+
+		range->size -= front_range->size;
+		range->offset = aligned;
+		free_list_insert(allocator, block, front);
+	}
+
+	if (range->size - size >= TLSF_GRANULE) {
+		uint32_t back = range_make(allocator, block_index, range->offset + size, range->size - size);
+		range = &allocator->ranges[index];
+
+		if (back) {
+			MemoryRange *back_range = &allocator->ranges[back];
+			back_range->prev_physical = index;
+			back_range->next_physical = range->next_physical;
+			if (range->next_physical)
+				allocator->ranges[range->next_physical].prev_physical = back;
+			range->next_physical = back;
+
+			range->size = size;
+			free_list_insert(allocator, block, back);
+		}
+	}
+
+	block->used += range->size;
+	block->allocation_count++;
+	return index;
+}
+
+static void block_free(VulkanAllocator *allocator, uint32_t index) {
+	MemoryRange *range = &allocator->ranges[index];
+	MemoryBlock *block = &allocator->blocks[range->block];
+	ASSERT(range->free == false);
+
+	block->used -= range->size;
+	block->allocation_count--;
+
+	uint32_t prev = range->prev_physical;
+	if (prev && allocator->ranges[prev].free) {
+		MemoryRange *prev_range = &allocator->ranges[prev];
+		free_list_remove(allocator, block, prev);
+
+		range->offset = prev_range->offset;
+		range->size += prev_range->size;
+		range->prev_physical = prev_range->prev_physical;
+		if (range->prev_physical)
+			allocator->ranges[range->prev_physical].next_physical = index;
+
+		pool_free(allocator->ranges, prev_range);
+	}
+
+	uint32_t next = range->next_physical;
+	if (next && allocator->ranges[next].free) {
+		MemoryRange *next_range = &allocator->ranges[next];
+		free_list_remove(allocator, block, next);
+
+		range->size += next_range->size;
+		range->next_physical = next_range->next_physical;
+		if (range->next_physical)
+			allocator->ranges[range->next_physical].prev_physical = index;
+
+		pool_free(allocator->ranges, next_range);
+	}
+
+	free_list_insert(allocator, block, index);
+}
+
+static uint32_t block_create(VulkanContext *context, uint32_t memory_type, bool linear) {
+	VulkanAllocator *allocator = context->allocator;
+
+	uint32_t block_index = 0;
+	for (uint32_t index = 1; index < VULKAN_MEMORY_MAX_BLOCKS; ++index) {
+		if (allocator->blocks[index].memory == VK_NULL_HANDLE) {
+			block_index = index;
+			break;
+		}
+	}
+
+	if (block_index == 0) {
+		LOG_WARN("Vulkan: memory block limit reached, falling back to a dedicated allocation");
+		return 0;
+	}
+
+	MemoryBlock *block = &allocator->blocks[block_index];
+	VkMemoryAllocateInfo allocate_info = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.allocationSize = allocator->block_sizes[memory_type],
+		.memoryTypeIndex = memory_type,
+	};
+
+	if (vkAllocateMemory(context->device.logical, &allocate_info, NULL, &block->memory) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to allocate %llu byte memory block", allocate_info.allocationSize);
+		block->memory = VK_NULL_HANDLE;
+		return 0;
+	}
+
+	VkMemoryPropertyFlags flags = allocator->properties.memoryTypes[memory_type].propertyFlags;
+	if (FLAG_GET(flags, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+		vkMapMemory(context->device.logical, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped);
+
+	block->size = allocate_info.allocationSize;
+	block->memory_type = memory_type;
+	block->linear = linear;
+
+	uint32_t range = range_make(allocator, block_index, 0, block->size);
+	free_list_insert(allocator, block, range);
+
+	LOG_INFO("Vulkan: memory block %u created (type %u, %llu MiB, %s)",
+		block_index, memory_type, block->size / MiB(1), linear ? "linear" : "optimal");
+	return block_index;
+}
+
+static void block_destroy(VulkanContext *context, uint32_t block_index) {
+	VulkanAllocator *allocator = context->allocator;
+	MemoryBlock *block = &allocator->blocks[block_index];
+
+	// An empty block is a single free range spanning all of it
+	uint32_t fl, sl;
+	tlsf_mapping(block->size, &fl, &sl);
+	uint32_t range = block->free_heads[fl][sl];
+	if (range)
+		pool_free(allocator->ranges, &allocator->ranges[range]);
+
+	if (block->mapped)
+		vkUnmapMemory(context->device.logical, block->memory);
+	vkFreeMemory(context->device.logical, block->memory, NULL);
+
+	*block = (MemoryBlock){ 0 };
+}
+
+static bool allocate_dedicated(VulkanContext *context, VkMemoryRequirements requirements, uint32_t memory_type, VkBuffer buffer, VkImage image, VulkanAllocation *out) {
+	VulkanAllocator *allocator = context->allocator;
+
+	VkMemoryDedicatedAllocateInfo dedicated_info = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+		.image = image,
+		.buffer = buffer,
+	};
+	VkMemoryAllocateInfo allocate_info = {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		.pNext = &dedicated_info,
+		.allocationSize = requirements.size,
+		.memoryTypeIndex = memory_type,
+	};
+
+	*out = (VulkanAllocation){ .size = requirements.size };
+	if (vkAllocateMemory(context->device.logical, &allocate_info, NULL, &out->memory) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to allocate %llu bytes of dedicated memory", requirements.size);
+		return false;
+	}
+
+	VkMemoryPropertyFlags flags = allocator->properties.memoryTypes[memory_type].propertyFlags;
+	if (FLAG_GET(flags, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+		vkMapMemory(context->device.logical, out->memory, 0, VK_WHOLE_SIZE, 0, &out->mapped);
+
+	allocator->dedicated_count++;
+	allocator->dedicated_size += requirements.size;
+	return true;
+}
+
+static bool allocate(
+	VulkanContext *context, VkMemoryRequirements requirements, VkMemoryPropertyFlags properties,
+	bool linear, bool dedicated, VkBuffer buffer, VkImage image, VulkanAllocation *out) {
+	VulkanAllocator *allocator = context->allocator;
+	uint32_t memory_type = vulkan_memory_type_find(context->device.physical, requirements.memoryTypeBits, properties);
+	if (memory_type == UINT32_MAX)
+		return false;
+
+	VkDeviceSize size = alignup(requirements.size, TLSF_GRANULE);
+	if (dedicated || size > allocator->block_sizes[memory_type] / 2)
+		return allocate_dedicated(context, requirements, memory_type, buffer, image, out);
+
+	uint32_t range = 0;
+	for (uint32_t index = 1; index < VULKAN_MEMORY_MAX_BLOCKS && range == 0; ++index) {
+		MemoryBlock *block = &allocator->blocks[index];
+		if (block->memory && block->memory_type == memory_type && block->linear == linear)
+			range = block_allocate(allocator, index, size, requirements.alignment);
+	}
+
+	if (range == 0) {
+		uint32_t block_index = block_create(context, memory_type, linear);
+		if (block_index == 0)
+			return allocate_dedicated(context, requirements, memory_type, buffer, image, out);
+
+		// NOTE: A large alignment or a full range pool can still fail in a fresh block, release it rather than keep it empty
+		range = block_allocate(allocator, block_index, size, requirements.alignment);
+		if (range == 0) {
+			block_destroy(context, block_index);
+			return allocate_dedicated(context, requirements, memory_type, buffer, image, out);
+		}
+	}
+
+	MemoryRange *memory_range = &allocator->ranges[range];
+	MemoryBlock *block = &allocator->blocks[memory_range->block];
+	*out = (VulkanAllocation){
+		.memory = block->memory,
+		.offset = memory_range->offset,
+		.size = memory_range->size,
+		.mapped = block->mapped ? (uint8_t *)block->mapped + memory_range->offset : NULL,
+		.range = range,
+	};
+
+	return true;
+}
+
+bool vulkan_memory_startup(Arena *arena, VulkanContext *context) {
+	VulkanAllocator *allocator = arena_push_struct(arena, VulkanAllocator);
+	context->allocator = allocator;
+
+	vkGetPhysicalDeviceMemoryProperties(context->device.physical, &allocator->properties);
+	for (uint32_t index = 0; index < allocator->properties.memoryTypeCount; ++index) {
+		// NOTE: Small heaps (e.g. the 256 MiB host visible VRAM window) get proportionally smaller blocks
+		VkDeviceSize heap_size = allocator->properties.memoryHeaps[allocator->properties.memoryTypes[index].heapIndex].size;
+		VkDeviceSize block_size = MIN(VULKAN_MEMORY_BLOCK_SIZE, heap_size / 8);
+		allocator->block_sizes[index] = MAX(alignup(block_size, TLSF_GRANULE), MiB(16));
+	}
+
+	allocator->ranges = arena_push_pool(arena, VULKAN_MEMORY_MAX_RANGES, MemoryRange);
+	pool_alloc(allocator->ranges);
+
+	return true;
+}
+
+void vulkan_memory_shutdown(VulkanContext *context) {
+	VulkanAllocator *allocator = context->allocator;
+	VulkanMemoryStats stats = vulkan_memory_stats(context);
+	LOG_INFO("Vulkan: memory %u blocks, %llu/%llu MiB used, %u dedicated (%llu MiB), fragmentation %.2f",
+		stats.block_count, stats.used / MiB(1), stats.reserved / MiB(1),
+		stats.dedicated_count, stats.dedicated / MiB(1), stats.fragmentation);
+	if (stats.allocation_count)
+		LOG_WARN("Vulkan: %u allocations still alive at shutdown (%llu bytes)", stats.allocation_count, stats.used);
+
+	for (uint32_t index = 1; index < VULKAN_MEMORY_MAX_BLOCKS; ++index) {
+		MemoryBlock *block = &allocator->blocks[index];
+		if (block->memory == VK_NULL_HANDLE)
+			continue;
+
+		if (block->mapped)
+			vkUnmapMemory(context->device.logical, block->memory);
+		vkFreeMemory(context->device.logical, block->memory, NULL);
+	}
+
+	context->allocator = NULL;
+}
+
+bool vulkan_memory_bind_buffer(VulkanContext *context, VkBuffer buffer, VkMemoryPropertyFlags properties, VulkanAllocation *out) {
+	VkMemoryDedicatedRequirements dedicated = { .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
+	VkMemoryRequirements2 requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2, .pNext = &dedicated };
+	VkBufferMemoryRequirementsInfo2 info = { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2, .buffer = buffer };
+	vkGetBufferMemoryRequirements2(context->device.logical, &info, &requirements);
+
+	bool prefer_dedicated = dedicated.requiresDedicatedAllocation || dedicated.prefersDedicatedAllocation;
+	if (allocate(context, requirements.memoryRequirements, properties, true, prefer_dedicated, buffer, VK_NULL_HANDLE, out) == false)
+		return false;
+
+	if (vkBindBufferMemory(context->device.logical, buffer, out->memory, out->offset) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to bind buffer memory");
+		vulkan_memory_free(context, out);
+		return false;
+	}
+
+	return true;
+}
+
+bool vulkan_memory_bind_image(VulkanContext *context, VkImage image, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VulkanAllocation *out) {
+	VkMemoryDedicatedRequirements dedicated = { .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS };
+	VkMemoryRequirements2 requirements = { .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2, .pNext = &dedicated };
+	VkImageMemoryRequirementsInfo2 info = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2, .image = image };
+	vkGetImageMemoryRequirements2(context->device.logical, &info, &requirements);
+
+	// Render targets get recreated on every resize, keeping the big ones out of the blocks avoids fragmenting them
+	bool render_target = usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT);
+	bool prefer_dedicated = dedicated.requiresDedicatedAllocation || dedicated.prefersDedicatedAllocation ||
+		(render_target && requirements.memoryRequirements.size >= VULKAN_MEMORY_DEDICATED_TARGET_SIZE);
+
+	if (allocate(context, requirements.memoryRequirements, properties, false, prefer_dedicated, VK_NULL_HANDLE, image, out) == false)
+		return false;
+
+	if (vkBindImageMemory(context->device.logical, image, out->memory, out->offset) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to bind image memory");
+		vulkan_memory_free(context, out);
+		return false;
+	}
+
+	return true;
+}
+
+void vulkan_memory_free(VulkanContext *context, VulkanAllocation *allocation) {
+	VulkanAllocator *allocator = context->allocator;
+	if (allocation->memory == VK_NULL_HANDLE)
+		return;
+
+	if (allocation->range == 0) {
+		if (allocation->mapped)
+			vkUnmapMemory(context->device.logical, allocation->memory);
+		vkFreeMemory(context->device.logical, allocation->memory, NULL);
+
+		allocator->dedicated_count--;
+		allocator->dedicated_size -= allocation->size;
+	} else {
+		uint32_t block_index = allocator->ranges[allocation->range].block;
+		block_free(allocator, allocation->range);
+
+		// Keep one empty block per memory type around so a free/allocate cycle doesn't hit the driver
+		MemoryBlock *block = &allocator->blocks[block_index];
+		if (block->allocation_count == 0) {
+			for (uint32_t index = 1; index < VULKAN_MEMORY_MAX_BLOCKS; ++index) {
+				MemoryBlock *other = &allocator->blocks[index];
+				if (index != block_index && other->memory && other->memory_type == block->memory_type && other->linear == block->linear) {
+					block_destroy(context, block_index);
+					break;
+				}
+			}
+		}
+	}
+
+	*allocation = (VulkanAllocation){ 0 };
+}
+
+VulkanMemoryStats vulkan_memory_stats(VulkanContext *context) {
+	VulkanAllocator *allocator = context->allocator;
+	VulkanMemoryStats stats = {
+		.dedicated_count = allocator->dedicated_count,
+		.dedicated = allocator->dedicated_size,
+		.allocation_count = allocator->dedicated_count,
+	};
+
+	VkDeviceSize free_total = 0;
+	for (uint32_t index = 1; index < VULKAN_MEMORY_MAX_BLOCKS; ++index) {
+		MemoryBlock *block = &allocator->blocks[index];
+		if (block->memory == VK_NULL_HANDLE)
+			continue;
+
+		stats.block_count++;
+		stats.reserved += block->size;
+		stats.used += block->used;
+		stats.allocation_count += block->allocation_count;
+
+		for (uint32_t fl = 0; fl < TLSF_FL_COUNT; ++fl) {
+			for (uint32_t sl = 0; sl < TLSF_SL_COUNT; ++sl) {
+				for (uint32_t range = block->free_heads[fl][sl]; range; range = allocator->ranges[range].next_free) {
+					VkDeviceSize size = allocator->ranges[range].size;
+					stats.free_range_count++;
+					stats.largest_free = MAX(stats.largest_free, size);
+					free_total += size;
+				}
+			}
+		}
+	}
+
+	// 0 when all free space is one contiguous range, approaching 1 as it splinters
+	stats.fragmentation = free_total ? 1.0f - (float)stats.largest_free / (float)free_total : 0.0f;
+	return stats;
+}
+
 VkDeviceSize vulkan_memory_required_alignment(VulkanContext *context, VkBufferUsageFlags usage, VkMemoryPropertyFlags memory_properties) {
 	// NOTE: Seems like device local index/vertex buffers don't need alignment at all
 	VkDeviceSize alignment = 1;
@@ -36,6 +545,5 @@ uint32_t vulkan_memory_type_find(VkPhysicalDevice physical_device, uint32_t type
 	}
 
 	LOG_ERROR("Failed to find suitable memory type!");
-	ASSERT(false);
-	return 0;
+	return UINT32_MAX;
 }
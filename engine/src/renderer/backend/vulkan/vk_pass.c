@@ -3,11 +3,13 @@
 #include "renderer/backend/vulkan_api.h"
 
 #include "core/debug.h"
+#include "core/logger.h"
 #include <vulkan/vulkan_core.h>
 
 VkSampleCountFlags to_sample_count(uint32_t sample_count);
 
-bool vulkan_drawlist_begin(VulkanContext *context, DrawlistDesc desc) {
+// Begins rendering on the frame's command buffer, out_rect is the area viewport and scissor should cover
+static bool drawlist_begin_internal(VulkanContext *context, DrawlistDesc desc, VkRenderingFlags flags, VkRect2D *out_rect) {
 	VkRect2D viewport_rect = { 0 };
 
 	bool use_msaa = desc.msaa_level > 1 && context->device.sample_count > VK_SAMPLE_COUNT_1_BIT;
@@ -141,6 +143,7 @@ bool vulkan_drawlist_begin(VulkanContext *context, DrawlistDesc desc) {
 
 	VkRenderingInfo pass_info = {
 		.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+		.flags = flags,
 		.renderArea = viewport_rect,
 		.layerCount = 1,
 		.colorAttachmentCount = desc.color_attachment_count,
@@ -152,22 +155,108 @@ bool vulkan_drawlist_begin(VulkanContext *context, DrawlistDesc desc) {
 		vulkan_utils_begin_label(context, desc.name.chars);
 	vkCmdBeginRendering(context->command_buffers[context->current_frame], &pass_info);
 
+	context->bound_pass.state = VULKAN_RESOURCE_STATE_INITIALIZED;
+	*out_rect = viewport_rect;
+	return true;
+}
+
+// NOTE: Dynamic state isn't inherited, every secondary command buffer sets its own
+static void drawlist_set_viewport(VkCommandBuffer command_buffer, VkRect2D rect) {
 	VkViewport viewport = {
-		.x = viewport_rect.offset.x,
-		.y = viewport_rect.offset.y,
-		.width = viewport_rect.extent.width,
-		.height = viewport_rect.extent.height,
+		.x = rect.offset.x,
+		.y = rect.offset.y,
+		.width = rect.extent.width,
+		.height = rect.extent.height,
 		.minDepth = 0.0f,
 		.maxDepth = 1.0f
 	};
-	vkCmdSetViewport(context->command_buffers[context->current_frame], 0, 1, &viewport);
-	vkCmdSetScissor(context->command_buffers[context->current_frame], 0, 1, &viewport_rect);
+	vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+	vkCmdSetScissor(command_buffer, 0, 1, &rect);
+}
 
-	context->bound_pass.state = VULKAN_RESOURCE_STATE_INITIALIZED;
+VulkanRecorder *vulkan_drawlist_begin(VulkanContext *context, DrawlistDesc desc) {
+	VkRect2D rect;
+	if (drawlist_begin_internal(context, desc, 0, &rect) == false)
+		return NULL;
+
+	vulkan_recorder_invalidate(&context->recorder);
+	drawlist_set_viewport(context->recorder.command_buffer, rect);
+	return &context->recorder;
+}
+
+bool vulkan_drawlist_begin_parallel(VulkanContext *context, DrawlistDesc desc, uint32_t recorder_count, VulkanRecorder **out_recorders) {
+	if (recorder_count == 0 || recorder_count > MAX_RECORDERS) {
+		LOG_ERROR("Vulkan: %u recorders requested (min 1, max %u), aborting %s", recorder_count, MAX_RECORDERS, __func__);
+		ASSERT(false);
+		return false;
+	}
+
+	for (uint32_t index = 0; index < recorder_count; ++index) {
+		if (context->recorder_slots[index].used[context->current_frame] == VULKAN_MAX_PARALLEL_DRAWLISTS) {
+			LOG_ERROR("Vulkan: more than %u parallel drawlists this frame, aborting %s", VULKAN_MAX_PARALLEL_DRAWLISTS, __func__);
+			ASSERT(false);
+			return false;
+		}
+	}
+
+	VkRect2D rect;
+	if (drawlist_begin_internal(context, desc, VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, &rect) == false)
+		return false;
+
+	const VulkanPass *pass = &context->bound_pass;
+	VkCommandBufferInheritanceRenderingInfo rendering_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+		.colorAttachmentCount = desc.color_attachment_count,
+		.pColorAttachmentFormats = pass->color_formats,
+		.depthAttachmentFormat = pass->depth_format,
+		.rasterizationSamples = (VkSampleCountFlagBits)pass->sample_count,
+	};
+	VkCommandBufferInheritanceInfo inheritance_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		.pNext = &rendering_info,
+	};
+	VkCommandBufferBeginInfo begin_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+		.pInheritanceInfo = &inheritance_info,
+	};
+
+	// NOTE: Recorder N always records into slot N, so a slot's pools never see two threads at once
+	for (uint32_t index = 0; index < recorder_count; ++index) {
+		VulkanRecorderSlot *slot = &context->recorder_slots[index];
+		VkCommandBuffer command_buffer = slot->command_buffers[context->current_frame][slot->used[context->current_frame]++];
+
+		vkBeginCommandBuffer(command_buffer, &begin_info);
+		drawlist_set_viewport(command_buffer, rect);
+
+		slot->recorder = (VulkanRecorder){
+			.command_buffer = command_buffer,
+			.descriptor_pool = slot->descriptor_pools[context->current_frame],
+			.pass = pass,
+		};
+		out_recorders[index] = &slot->recorder;
+	}
+
+	context->parallel_count = recorder_count;
 	return true;
 }
 
 bool vulkan_drawlist_end(VulkanContext *context) {
+	if (context->parallel_count) {
+		VkCommandBuffer command_buffers[MAX_RECORDERS];
+		for (uint32_t index = 0; index < context->parallel_count; ++index) {
+			VulkanRecorder *recorder = &context->recorder_slots[index].recorder;
+			command_buffers[index] = recorder->command_buffer;
+			vkEndCommandBuffer(command_buffers[index]);
+
+			context->frame_bind_stats.issued += recorder->bind_stats.issued;
+			context->frame_bind_stats.skipped += recorder->bind_stats.skipped;
+		}
+
+		vkCmdExecuteCommands(context->command_buffers[context->current_frame], context->parallel_count, command_buffers);
+		context->parallel_count = 0;
+	}
+
 	vkCmdEndRendering(context->command_buffers[context->current_frame]);
 
 	if (context->bound_pass.name.length)
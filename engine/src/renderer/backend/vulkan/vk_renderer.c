@@ -11,9 +11,14 @@
 #include <string.h>
 #include <vulkan/vulkan_core.h>
 
+static void replacements_apply(VulkanContext *context);
+static void replacements_discard(VulkanContext *context);
+
 VulkanContext *vulkan_renderer_make(Arena *arena, struct window *display) {
 	VulkanContext *context = arena_push_struct(arena, VulkanContext);
 	context->display = display;
+	context->replacement_arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	pthread_mutex_init(&context->mutex, NULL);
 
 	uint32_t version = 0;
 	vkEnumerateInstanceVersion(&version);
@@ -25,6 +30,8 @@ VulkanContext *vulkan_renderer_make(Arena *arena, struct window *display) {
 	context->sampler_pool = arena_push_pool(arena, MAX_SAMPLERS, VulkanSampler);
 	context->shader_pool = arena_push_pool(arena, MAX_SHADERS, VulkanShader);
 	context->set_pool = arena_push_pool(arena, MAX_UNIFORM_SETS, VulkanUniformSet);
+	context->persistent_set_pool = arena_push_pool(arena, MAX_PERSISTENT_UNIFORM_SETS, VulkanUniformSet);
+	context->persistent_set_records = arena_push_count(arena, MAX_PERSISTENT_UNIFORM_SETS, VulkanSetRecord);
 
 	// 0 == INVALID
 	pool_alloc(context->image_pool);
@@ -32,16 +39,20 @@ VulkanContext *vulkan_renderer_make(Arena *arena, struct window *display) {
 	pool_alloc(context->sampler_pool);
 	pool_alloc(context->shader_pool);
 	pool_alloc(context->set_pool);
+	pool_alloc(context->persistent_set_pool);
 
 	if (vulkan_instance_create(context) == false)
 		return NULL;
 
-	if (vulkan_surface_create(context, context->display) == false)
+	if (context->display && vulkan_surface_create(context, context->display) == false)
 		return NULL;
 
 	if (vulkan_device_create(arena, context) == false)
 		return NULL;
 
+	if (vulkan_memory_startup(arena, context) == false)
+		return NULL;
+
 	if (vulkan_command_pool_create(context) == false)
 		return NULL;
 
@@ -51,16 +62,30 @@ VulkanContext *vulkan_renderer_make(Arena *arena, struct window *display) {
 	if (vulkan_descriptor_pool_create(context) == false)
 		return NULL;
 
+	if (vulkan_recorders_create(context) == false)
+		return NULL;
+
+	if (vulkan_bindless_create(context) == false)
+		return NULL;
+
 	if (vulkan_sync_objects_create(context) == false)
 		return NULL;
 
-	uint32x2 dims = window_size_pixel(context->display);
-	if (vulkan_swapchain_create(context, dims.x, dims.y) == false)
+	if (vulkan_upload_create(context) == false)
+		return NULL;
+
+	if (vulkan_pipeline_cache_create(arena, context) == false)
 		return NULL;
 
-	// TODO: Lower this back down to 32?
+	if (context->display) {
+		uint32x2 dims = window_size_pixel(context->display);
+		if (vulkan_swapchain_create(context, dims.x, dims.y) == false)
+			return NULL;
+	}
+
+	// NOTE: Only readbacks go through here now, uploads have their own staging regions
 	if (vulkan_buffer_make_internal(
-			context, MiB(256),
+			context, MiB(32),
 			VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0,
 			&context->staging_buffer) == false)
@@ -79,6 +104,10 @@ VulkanContext *vulkan_renderer_make(Arena *arena, struct window *display) {
 void vulkan_renderer_destroy(VulkanContext *context) {
 	vkDeviceWaitIdle(context->device.logical);
 
+	vulkan_pipeline_cache_destroy(context);
+	replacements_discard(context);
+	arena_destroy(&context->replacement_arena);
+
 	for (uint32_t index = 0; index < MAX_SHADERS; ++index) {
 		if (context->shader_pool[index].state == VULKAN_RESOURCE_STATE_INITIALIZED)
 			vulkan_shader_destroy(context, (RhiShader){ index });
@@ -100,9 +129,11 @@ void vulkan_renderer_destroy(VulkanContext *context) {
 	}
 
 	vkDestroyBuffer(context->device.logical, context->staging_buffer.handle, NULL);
-	vkFreeMemory(context->device.logical, context->staging_buffer.memory, NULL);
+	vulkan_memory_free(context, &context->staging_buffer.allocation);
 	context->staging_buffer = (VulkanBuffer){ 0 };
+	vulkan_upload_destroy(context);
 
+	vulkan_recorders_destroy(context);
 	vkDestroyCommandPool(context->device.logical, context->graphics_command_pool, NULL);
 	vkDestroyCommandPool(context->device.logical, context->transfer_command_pool, NULL);
 
@@ -119,6 +150,8 @@ void vulkan_renderer_destroy(VulkanContext *context) {
 		vkDestroyFence(context->device.logical, context->in_flight_fences[frame_index], NULL);
 		vkDestroyDescriptorPool(context->device.logical, context->descriptor_pools[frame_index], NULL);
 	}
+	vkDestroyDescriptorPool(context->device.logical, context->persistent_descriptor_pool, NULL);
+	vulkan_bindless_destroy(context);
 
 	for (uint32_t index = 0; index < SWAPCHAIN_IMAGE_COUNT; ++index)
 		vkDestroySemaphore(context->device.logical, context->render_finished_semaphores[index], NULL);
@@ -127,9 +160,11 @@ void vulkan_renderer_destroy(VulkanContext *context) {
 	vkDestroyDebugUtilsMessenger(context->instance, context->debug_messenger, NULL);
 #endif
 
+	vulkan_memory_shutdown(context);
 	vkDestroyDevice(context->device.logical, NULL);
 	vkDestroySurfaceKHR(context->instance, context->surface, NULL);
 	vkDestroyInstance(context->instance, NULL);
+	pthread_mutex_destroy(&context->mutex);
 }
 
 bool vulkan_renderer_on_resize(VulkanContext *context, uint32_t new_width, uint32_t new_height) {
@@ -145,19 +180,23 @@ bool vulkan_renderer_on_resize(VulkanContext *context, uint32_t new_width, uint3
 
 bool vulkan_frame_begin(VulkanContext *context, uint32_t width, uint32_t height) {
 	vkWaitForFences(context->device.logical, 1, &context->in_flight_fences[context->current_frame], VK_TRUE, UINT64_MAX);
-
-	VkResult result = vkAcquireNextImageKHR(context->device.logical, context->swapchain.handle, UINT64_MAX, context->image_available_semaphores[context->current_frame], VK_NULL_HANDLE, &context->image_index);
-
-	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-		vulkan_swapchain_recreate(context, width, height);
-		LOG_INFO("Recreating Swapchain");
-		return false;
-	} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
-		LOG_ERROR("Failed to acquire swapchain image!");
+	replacements_apply(context);
+
+	if (context->display) {
+		VkResult result = vkAcquireNextImageKHR(context->device.logical, context->swapchain.handle, UINT64_MAX, context->image_available_semaphores[context->current_frame], VK_NULL_HANDLE, &context->image_index);
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+			vulkan_swapchain_recreate(context, width, height);
+			LOG_INFO("Recreating Swapchain");
+			return false;
+		} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+			LOG_ERROR("Failed to acquire swapchain image!");
+		}
 	}
 
 	vkResetFences(context->device.logical, 1, &context->in_flight_fences[context->current_frame]);
 	vkResetDescriptorPool(context->device.logical, context->descriptor_pools[context->current_frame], 0);
+	vulkan_recorders_reset(context);
 
 	pool_reset(context->set_pool);
 	pool_alloc(context->set_pool);
@@ -173,14 +212,19 @@ bool vulkan_frame_begin(VulkanContext *context, uint32_t width, uint32_t height)
 		LOG_ERROR("Failed to begin command buffer recording");
 		return false;
 	}
-	context->command_buffer = context->command_buffers[context->current_frame];
+	context->recorder = (VulkanRecorder){
+		.command_buffer = context->command_buffers[context->current_frame],
+		.descriptor_pool = context->descriptor_pools[context->current_frame],
+		.pass = &context->bound_pass,
+	};
 
-	vulkan_image_transition(
-		context, context->command_buffers[context->current_frame],
-		context->swapchain.images.handles[context->image_index], VK_IMAGE_ASPECT_COLOR_BIT, 1,
-		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
+	if (context->display)
+		vulkan_image_transition(
+			context, context->command_buffers[context->current_frame],
+			context->swapchain.images.handles[context->image_index], VK_IMAGE_ASPECT_COLOR_BIT, 1,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT);
 
 	return true;
 }
@@ -188,30 +232,51 @@ bool vulkan_frame_begin(VulkanContext *context, uint32_t width, uint32_t height)
 bool vulkan_frame_end(VulkanContext *context) {
 	ASSERT(context->bound_pass.state == VULKAN_RESOURCE_STATE_UNINITIALIZED);
 
-	vulkan_image_transition(
-		context, context->command_buffers[context->current_frame],
-		context->swapchain.images.handles[context->image_index], VK_IMAGE_ASPECT_COLOR_BIT, 1,
-		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0);
+	if (context->display)
+		vulkan_image_transition(
+			context, context->command_buffers[context->current_frame],
+			context->swapchain.images.handles[context->image_index], VK_IMAGE_ASPECT_COLOR_BIT, 1,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+			VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0);
 
 	if (vkEndCommandBuffer(context->command_buffers[context->current_frame]) != VK_SUCCESS) {
 		LOG_ERROR("Failed to record command buffer");
 		return false;
 	}
 
-	VkSemaphore wait_semaphores[] = { context->image_available_semaphores[context->current_frame] };
+	// NOTE: Uploads recorded this frame go out first. Waiting on a value that was already reached is free,
+	// so frames without uploads don't stall
+	uint64_t upload_value = vulkan_upload_flush(context);
+
+	VkCommandBuffer command_buffers[2];
+	uint32_t command_buffer_count = 0;
+	if (vulkan_upload_acquire(context, context->upload.acquire_buffers[context->current_frame]))
+		command_buffers[command_buffer_count++] = context->upload.acquire_buffers[context->current_frame];
+	command_buffers[command_buffer_count++] = context->command_buffers[context->current_frame];
+
+	// NOTE: Headless frames have no image to wait for or present, the upload timeline comes first so it's all that's left
+	VkSemaphore wait_semaphores[] = { context->upload.timeline, context->image_available_semaphores[context->current_frame] };
+	uint64_t wait_values[] = { upload_value, 0 };
 	VkSemaphore signal_semaphores[] = { context->render_finished_semaphores[context->image_index] };
-	VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	VkPipelineStageFlags wait_stages[] = { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	uint32_t wait_count = context->display ? countof(wait_semaphores) : 1;
+
+	VkTimelineSemaphoreSubmitInfo timeline_info = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.waitSemaphoreValueCount = wait_count,
+		.pWaitSemaphoreValues = wait_values,
+	};
 
 	VkSubmitInfo submit_info = {
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.waitSemaphoreCount = countof(wait_semaphores),
+		.pNext = &timeline_info,
+		.waitSemaphoreCount = wait_count,
 		.pWaitSemaphores = wait_semaphores,
 		.pWaitDstStageMask = wait_stages,
-		.commandBufferCount = 1,
-		.pCommandBuffers = &context->command_buffers[context->current_frame],
-		.signalSemaphoreCount = countof(signal_semaphores),
+		.commandBufferCount = command_buffer_count,
+		.pCommandBuffers = command_buffers,
+		.signalSemaphoreCount = context->display ? countof(signal_semaphores) : 0,
 		.pSignalSemaphores = signal_semaphores
 	};
 
@@ -231,27 +296,125 @@ bool vulkan_frame_end(VulkanContext *context) {
 	};
 
 	context->current_frame = (context->current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
-	VkResult result = vkQueuePresentKHR(context->device.present_queue, &present_info);
+	if (context->display)
+		vkQueuePresentKHR(context->device.present_queue, &present_info);
+
+	context->bind_stats = (VulkanBindStats){
+		.issued = context->frame_bind_stats.issued + context->recorder.bind_stats.issued,
+		.skipped = context->frame_bind_stats.skipped + context->recorder.bind_stats.skipped,
+		.descriptor_writes = __atomic_exchange_n(&context->descriptor_writes, 0, __ATOMIC_RELAXED),
+	};
+	context->frame_bind_stats = (VulkanBindStats){ 0 };
 
 	// NOTE: All bound resources are unbound after frame ends
-	context->bound_shader = NULL;
-	context->command_buffer = NULL;
+	context->recorder = (VulkanRecorder){ 0 };
 	context->frame_target_count = 0;
 
 	return true;
 }
 
-bool vulkan_renderer_draw(VulkanContext *context, uint32_t vertex_count) {
-	vkCmdDraw(context->command_buffers[context->current_frame], vertex_count, 1, 0, 0);
+VulkanRecorder *vulkan_frame_recorder(VulkanContext *context) {
+	ASSERT(context->recorder.command_buffer);
+	return &context->recorder;
+}
+
+VulkanBindStats vulkan_bind_stats(VulkanContext *context) {
+	return context->bind_stats;
+}
+
+bool vulkan_renderer_draw(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count) {
+	vkCmdDraw(recorder->command_buffer, vertex_count, 1, 0, 0);
+	return true;
+}
+
+bool vulkan_renderer_draw_indexed(VulkanContext *context, VulkanRecorder *recorder, uint32_t index_count) {
+	vkCmdDrawIndexed(recorder->command_buffer, index_count, 1, 0, 0, 0);
+	return true;
+}
+
+bool vulkan_renderer_draw_offset(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count, uint32_t start_vertex) {
+	vkCmdDraw(recorder->command_buffer, vertex_count, 1, start_vertex, 0);
+	return true;
+}
+
+bool vulkan_renderer_draw_instanced(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count, uint32_t instance_count, uint32_t first_instance) {
+	vkCmdDraw(recorder->command_buffer, vertex_count, instance_count, 0, first_instance);
 	return true;
 }
 
-bool vulkan_renderer_draw_indexed(VulkanContext *context, uint32_t index_count) {
-	vkCmdDrawIndexed(context->command_buffers[context->current_frame], index_count, 1, 0, 0, 0);
+bool vulkan_renderer_draw_indexed_instanced(VulkanContext *context, VulkanRecorder *recorder, uint32_t index_count, uint32_t instance_count, uint32_t first_instance) {
+	vkCmdDrawIndexed(recorder->command_buffer, index_count, instance_count, 0, 0, first_instance);
 	return true;
 }
 
-bool vulkan_renderer_draw_offset(VulkanContext *context, uint32_t vertex_count, uint32_t start_vertex) {
-	vkCmdDraw(context->command_buffers[context->current_frame], vertex_count, 1, start_vertex, 0);
+bool vulkan_renderer_draw_instanced_offset(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count, uint32_t start_vertex, uint32_t instance_count, uint32_t first_instance) {
+	ASSERT(recorder->bound_vertex_buffer);
+	vkCmdDraw(recorder->command_buffer, vertex_count, instance_count, start_vertex, first_instance);
 	return true;
 }
+
+bool vulkan_renderer_draw_indexed_instanced_offset(
+	VulkanContext *context, VulkanRecorder *recorder,
+	uint32_t index_count, uint32_t first_index, int32_t vertex_offset, uint32_t instance_count, uint32_t first_instance) {
+	ASSERT(recorder->bound_vertex_buffer && recorder->bound_index_buffer);
+	vkCmdDrawIndexed(recorder->command_buffer, index_count, instance_count, first_index, vertex_offset, first_instance);
+	return true;
+}
+
+// NOTE: Handles keep their slot and bindless index, so the old resource can only go once no frame in flight
+// references it. That costs one short stall on the frame a reload lands, nothing otherwise
+static void replacements_apply(VulkanContext *context) {
+	uint32_t count = arena_array_count(context->replacements);
+	if (count == 0)
+		return;
+
+	vkWaitForFences(context->device.logical, MAX_FRAMES_IN_FLIGHT, context->in_flight_fences, VK_TRUE, UINT64_MAX);
+
+	for (uint32_t index = 0; index < count; ++index) {
+		VulkanReplacement *replacement = &context->replacements[index];
+
+		switch (replacement->type) {
+			case VULKAN_REPLACEMENT_TEXTURE: {
+				VulkanImage *image = &context->image_pool[replacement->slot];
+				if (image->state != VULKAN_RESOURCE_STATE_INITIALIZED) {
+					vulkan_image_destroy_internal(context, &replacement->as.image);
+					break;
+				}
+
+				vulkan_image_destroy_internal(context, image);
+				*image = replacement->as.image;
+				if (image->type == TEXTURE_TYPE_2D && FLAG_GET(image->info.usage, VK_IMAGE_USAGE_SAMPLED_BIT))
+					vulkan_bindless_write_image(context, replacement->slot, image);
+				vulkan_uniformsets_refresh_texture(context, replacement->slot);
+			} break;
+
+			case VULKAN_REPLACEMENT_SHADER: {
+				VulkanShader *shader = &context->shader_pool[replacement->slot];
+				if (shader->state != VULKAN_RESOURCE_STATE_INITIALIZED) {
+					vulkan_shader_destroy_internal(context, replacement->as.shader);
+					break;
+				}
+
+				vulkan_shader_swap_internal(context, shader, replacement->as.shader);
+				vulkan_uniformsets_refresh_shader(context, replacement->slot);
+			} break;
+		}
+	}
+
+	LOG_INFO("Vulkan: Swapped in %u replaced resources", count);
+	context->replacements = NULL;
+	arena_rewind(&context->replacement_arena, 0);
+}
+
+static void replacements_discard(VulkanContext *context) {
+	for (uint32_t index = 0; index < arena_array_count(context->replacements); ++index) {
+		VulkanReplacement *replacement = &context->replacements[index];
+		if (replacement->type == VULKAN_REPLACEMENT_TEXTURE)
+			vulkan_image_destroy_internal(context, &replacement->as.image);
+		else
+			vulkan_shader_destroy_internal(context, replacement->as.shader);
+	}
+
+	context->replacements = NULL;
+	arena_rewind(&context->replacement_arena, 0);
+}
@@ -8,14 +8,119 @@
 #include "core/logger.h"
 #include <vulkan/vulkan_core.h>
 
-VkDescriptorType to_vulkan_descriptor_type(ShaderBindingType type);
+VkDescriptorType to_vulkan_descriptor_type(ShaderBindingType type, bool dynamic);
+
+static bool uniformset_allocate(VulkanContext *context, VulkanShader *shader, VulkanUniformSet *set, VkDescriptorPool pool) {
+	ASSERT(set->number < MAX_SETS);
+	VkDescriptorSetAllocateInfo ds_allocate_info = {
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool = pool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &shader->layouts[set->number]
+	};
+
+	if (vkAllocateDescriptorSets(context->device.logical, &ds_allocate_info, &set->handle) != VK_SUCCESS) {
+		LOG_ERROR("Failed to create Vulkan DescriptorSets");
+		set->handle = VK_NULL_HANDLE;
+		return false;
+	}
+
+	set->dynamic_mask = shader->dynamic_bindings[set->number];
+	return true;
+}
+
+static void uniformset_write_buffer(VulkanContext *context, VulkanUniformSet *set, uint32_t binding, VulkanBuffer *buffer, size_t offset, size_t size) {
+	ASSERT(binding < MAX_BINDINGS_PER_RESOURCE);
+	bool dynamic = FLAG_GET(set->dynamic_mask, 1u << binding);
+	bool storage = FLAG_GET(buffer->usage, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+	// NOTE: Device local buffers have a single copy, only host visible ones step through frames
+	VkDeviceSize frame_stride = buffer->size > buffer->frame_size ? buffer->frame_size : 0;
+	set->buffer_offsets[binding] = offset;
+	set->buffer_strides[binding] = frame_stride;
+	if (set->handle == VK_NULL_HANDLE)
+		return;
+
+	// NOTE: A static binding is pinned to the copy of the frame it was written in
+	VkDescriptorBufferInfo buffer_info = {
+		.buffer = buffer->handle,
+		.offset = dynamic ? 0 : frame_stride * context->current_frame + offset,
+		.range = size
+	};
+
+	VkDescriptorType type =
+		storage
+		? (dynamic ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+		: (dynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+
+	VkWriteDescriptorSet descriptor_write = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = set->handle,
+		.dstBinding = binding,
+		.dstArrayElement = 0,
+		.descriptorType = type,
+		.descriptorCount = 1,
+		.pBufferInfo = &buffer_info
+	};
+	vulkan_descriptor_write(context, &descriptor_write);
+}
+
+static void uniformset_write_texture(VulkanContext *context, VulkanUniformSet *set, uint32_t binding, uint32_t element, VulkanImage *image, VulkanSampler *sampler) {
+	if (set->handle == VK_NULL_HANDLE)
+		return;
+
+	VkDescriptorImageInfo image_info = {
+		.sampler = sampler->handle,
+		.imageView = image->view,
+		.imageLayout = image->aspect == VK_IMAGE_ASPECT_COLOR_BIT ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+	};
+
+	VkWriteDescriptorSet descriptor_write = {
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstSet = set->handle,
+		.dstBinding = binding,
+		.dstArrayElement = element,
+		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount = 1,
+		.pImageInfo = &image_info,
+	};
+	vulkan_descriptor_write(context, &descriptor_write);
+}
+
+// Transient sets aren't recorded, they're gone before anything they reference could be replaced
+static void uniformset_record(VulkanContext *context, RhiUniformSet set_handle, uint32_t binding, VulkanSetWrite write) {
+	if (set_handle.id < MAX_UNIFORM_SETS)
+		return;
+
+	ASSERT(binding < MAX_BINDINGS_PER_RESOURCE);
+	context->persistent_set_records[set_handle.id - MAX_UNIFORM_SETS].writes[binding] = write;
+}
+
+static void uniformset_rewrite(VulkanContext *context, VulkanUniformSet *set, VulkanSetRecord *record) {
+	for (uint32_t binding = 0; binding < MAX_BINDINGS_PER_RESOURCE; ++binding) {
+		VulkanSetWrite *write = &record->writes[binding];
+
+		if (write->type == VULKAN_SET_WRITE_BUFFER) {
+			VulkanBuffer *buffer = &context->buffer_pool[write->buffer.id];
+			if (buffer->state == VULKAN_RESOURCE_STATE_INITIALIZED)
+				uniformset_write_buffer(context, set, binding, buffer, write->offset, write->size);
+		} else if (write->type == VULKAN_SET_WRITE_TEXTURE) {
+			VulkanImage *image = &context->image_pool[write->texture.id];
+			VulkanSampler *sampler = &context->sampler_pool[write->sampler.id];
+			if (image->state == VULKAN_RESOURCE_STATE_INITIALIZED && sampler->state == VULKAN_RESOURCE_STATE_INITIALIZED)
+				uniformset_write_texture(context, set, binding, 0, image, sampler);
+		}
+	}
+}
 
 RhiUniformSet vulkan_uniformset_push(
-	VulkanContext *context, RhiShader rshader, uint32_t set_number) {
+	VulkanContext *context, VulkanRecorder *recorder, RhiShader rshader, uint32_t set_number) {
 	VulkanShader *shader = NULL;
 	VULKAN_GET_OR_RETURN(shader, context->shader_pool, rshader, MAX_UNIFORM_SETS, true, INVALID_RHI(RhiUniformSet));
 
+	pthread_mutex_lock(&context->mutex);
 	VulkanUniformSet *set = pool_alloc_struct(context->set_pool, VulkanUniformSet);
+	pthread_mutex_unlock(&context->mutex);
 	set->number = set_number;
 	if (indexof(context->set_pool, set) == 0) {
 		LOG_INFO("The set is 0 for some reason");
@@ -24,64 +129,106 @@ RhiUniformSet vulkan_uniformset_push(
 	// TODO: Keep reflection around and copy it to uniform set here
 	// set->bindings = shader->bindings;
 
-	VkDescriptorSetAllocateInfo ds_allocate_info = {
-		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-		.descriptorPool = context->descriptor_pools[context->current_frame],
-		.descriptorSetCount = 1,
-		.pSetLayouts = &shader->layouts[set_number]
-	};
+	if (uniformset_allocate(context, shader, set, recorder->descriptor_pool) == false)
+		return INVALID_RHI(RhiUniformSet);
 
-	if (vkAllocateDescriptorSets(context->device.logical, &ds_allocate_info, &set->handle) != VK_SUCCESS) {
-		LOG_ERROR("Failed to create Vulkan DescriptorSets");
+	set->state = VULKAN_RESOURCE_STATE_INITIALIZED;
+	return (RhiUniformSet){ indexof(context->set_pool, set) };
+}
+
+RhiUniformSet vulkan_uniformset_make(VulkanContext *context, RhiShader rshader, uint32_t set_number) {
+	VulkanShader *shader = NULL;
+	VULKAN_GET_OR_RETURN(shader, context->shader_pool, rshader, MAX_SHADERS, true, INVALID_RHI(RhiUniformSet));
+
+	VulkanUniformSet *set = pool_alloc_struct(context->persistent_set_pool, VulkanUniformSet);
+	if (set == NULL)
+		return INVALID_RHI(RhiUniformSet);
+
+	*set = (VulkanUniformSet){ .number = set_number };
+	if (uniformset_allocate(context, shader, set, context->persistent_descriptor_pool) == false) {
+		pool_free(context->persistent_set_pool, set);
 		return INVALID_RHI(RhiUniformSet);
 	}
 
+	uint32_t index = indexof(context->persistent_set_pool, set);
+	context->persistent_set_records[index] = (VulkanSetRecord){ .shader = rshader };
+
 	set->state = VULKAN_RESOURCE_STATE_INITIALIZED;
-	return (RhiUniformSet){ indexof(context->set_pool, set) };
+	return (RhiUniformSet){ MAX_UNIFORM_SETS + index };
 }
 
 bool vulkan_uniformset_destroy(VulkanContext *context, RhiUniformSet set_handle) {
 	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
+
+	if (set_handle.id >= MAX_UNIFORM_SETS) {
+		// NOTE: Frames in flight may still read the set. The current frame's fence may be reset already, so wait on the device
+		vkDeviceWaitIdle(context->device.logical);
+		vkFreeDescriptorSets(context->device.logical, context->persistent_descriptor_pool, 1, &set->handle);
 
+		context->persistent_set_records[set_handle.id - MAX_UNIFORM_SETS] = (VulkanSetRecord){ 0 };
+		*set = (VulkanUniformSet){ 0 };
+		pool_free(context->persistent_set_pool, set);
+		return true;
+	}
+
+	pthread_mutex_lock(&context->mutex);
 	pool_free(context->set_pool, set);
+	pthread_mutex_unlock(&context->mutex);
 
 	return true;
 }
 
+void vulkan_uniformsets_refresh_texture(VulkanContext *context, uint32_t texture_slot) {
+	for (uint32_t index = 1; index < MAX_PERSISTENT_UNIFORM_SETS; ++index) {
+		VulkanUniformSet *set = &context->persistent_set_pool[index];
+		VulkanSetRecord *record = &context->persistent_set_records[index];
+		if (set->state != VULKAN_RESOURCE_STATE_INITIALIZED)
+			continue;
+
+		for (uint32_t binding = 0; binding < MAX_BINDINGS_PER_RESOURCE; ++binding) {
+			if (record->writes[binding].type == VULKAN_SET_WRITE_TEXTURE && record->writes[binding].texture.id == texture_slot) {
+				uniformset_rewrite(context, set, record);
+				break;
+			}
+		}
+	}
+}
+
+void vulkan_uniformsets_refresh_shader(VulkanContext *context, uint32_t shader_slot) {
+	VulkanShader *shader = &context->shader_pool[shader_slot];
+
+	for (uint32_t index = 1; index < MAX_PERSISTENT_UNIFORM_SETS; ++index) {
+		VulkanUniformSet *set = &context->persistent_set_pool[index];
+		VulkanSetRecord *record = &context->persistent_set_records[index];
+		if (set->state != VULKAN_RESOURCE_STATE_INITIALIZED || record->shader.id != shader_slot)
+			continue;
+
+		// NOTE: The old layout may be gone, the set is only valid against the one it was allocated with
+		vkFreeDescriptorSets(context->device.logical, context->persistent_descriptor_pool, 1, &set->handle);
+		if (uniformset_allocate(context, shader, set, context->persistent_descriptor_pool) == false) {
+			// NOTE: A null handle marks the set invalid, writes still land in its record and it refuses to bind
+			// until the next reload of the shader allocates it again
+			LOG_ERROR("Vulkan: uniform set %u lost its descriptors reloading shader %u, it won't bind until the shader is reloaded again",
+				MAX_UNIFORM_SETS + index, shader_slot);
+			continue;
+		}
+
+		uniformset_rewrite(context, set, record);
+	}
+}
+
 bool vulkan_uniformset_bind_buffer(
 	VulkanContext *context, RhiUniformSet set_handle,
 	uint32_t binding, RhiBuffer buffer_handle) {
 	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
 
 	VulkanBuffer *buffer = NULL;
 	VULKAN_GET_OR_RETURN(buffer, context->buffer_pool, buffer_handle, MAX_BUFFERS, true, false);
 
-	// NOTE: This won't work with persistent descriptors
-	set->buffer_ranges[set->range_count++] = buffer->frame_size * context->current_frame;
-
-	VkDescriptorBufferInfo buffer_info = {
-		.buffer = buffer->handle,
-		.offset = 0,
-		.range = buffer->frame_size
-	};
-
-	VkDescriptorType type =
-		FLAG_GET(buffer->usage, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
-		? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
-		: VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-
-	VkWriteDescriptorSet descriptor_write = {
-		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-		.dstSet = set->handle,
-		.dstBinding = binding,
-		.dstArrayElement = 0,
-		.descriptorType = type, // TODO: Can't assume dynamic
-		.descriptorCount = 1,
-		.pBufferInfo = &buffer_info
-	};
-	vkUpdateDescriptorSets(context->device.logical, 1, &descriptor_write, 0, NULL);
+	uniformset_record(context, set_handle, binding, (VulkanSetWrite){ .type = VULKAN_SET_WRITE_BUFFER, .buffer = buffer_handle, .size = buffer->frame_size });
+	uniformset_write_buffer(context, set, binding, buffer, 0, buffer->frame_size);
 
 	return true;
 }
@@ -92,36 +239,13 @@ bool vulkan_uniformset_bind_buffer_range(
 	size_t offset, size_t size,
 	RhiBuffer buffer_handle) {
 	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
 
 	VulkanBuffer *buffer = NULL;
 	VULKAN_GET_OR_RETURN(buffer, context->buffer_pool, buffer_handle, MAX_BUFFERS, true, false);
 
-	// TODO: This expects a certain order
-
-	set->buffer_ranges[set->range_count++] = offset + buffer->frame_size * context->current_frame;
-
-	VkDescriptorBufferInfo buffer_info = {
-		.buffer = buffer->handle,
-		.offset = 0,
-		.range = size
-	};
-
-	VkDescriptorType type =
-		FLAG_GET(buffer->usage, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
-		? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC
-		: VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-
-	VkWriteDescriptorSet descriptor_write = {
-		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-		.dstSet = set->handle,
-		.dstBinding = binding,
-		.dstArrayElement = 0,
-		.descriptorType = type, // TODO: Can't assume dynamic
-		.descriptorCount = 1,
-		.pBufferInfo = &buffer_info
-	};
-	vkUpdateDescriptorSets(context->device.logical, 1, &descriptor_write, 0, NULL);
+	uniformset_record(context, set_handle, binding, (VulkanSetWrite){ .type = VULKAN_SET_WRITE_BUFFER, .buffer = buffer_handle, .offset = offset, .size = size });
+	uniformset_write_buffer(context, set, binding, buffer, offset, size);
 
 	return true;
 }
@@ -130,7 +254,7 @@ bool vulkan_uniformset_bind_texture(
 	VulkanContext *context, RhiUniformSet set_handle,
 	uint32_t binding, RhiTexture texture_handle, RhiSampler sampler_handle) {
 	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
 
 	VulkanImage *image = NULL;
 	VULKAN_GET_OR_RETURN(image, context->image_pool, texture_handle, MAX_TEXTURES, true, false);
@@ -138,29 +262,16 @@ bool vulkan_uniformset_bind_texture(
 	VulkanSampler *sampler = NULL;
 	VULKAN_GET_OR_RETURN(sampler, context->sampler_pool, sampler_handle, MAX_SAMPLERS, true, false);
 
-	VkDescriptorImageInfo image_info = {
-		.sampler = sampler->handle,
-		.imageView = image->view,
-		.imageLayout = image->aspect == VK_IMAGE_ASPECT_COLOR_BIT ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
-	};
-
-	VkWriteDescriptorSet descriptor_write = {
-		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-		.dstSet = set->handle,
-		.dstBinding = binding,
-		.dstArrayElement = 0,
-		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-		.descriptorCount = 1,
-		.pImageInfo = &image_info,
-	};
-	vkUpdateDescriptorSets(context->device.logical, 1, &descriptor_write, 0, NULL);
+	uniformset_record(context, set_handle, binding, (VulkanSetWrite){ .type = VULKAN_SET_WRITE_TEXTURE, .texture = texture_handle, .sampler = sampler_handle });
+	uniformset_write_texture(context, set, binding, 0, image, sampler);
 
 	return true;
 }
 
+// NOTE: Array elements aren't recorded, a persistent set written through here isn't rewritten on replacement
 ENGINE_API bool vulkan_uniformset_bind_texture_index(VulkanContext *context, RhiUniformSet set_handle, uint32_t binding, uint32_t index, RhiTexture texture_handle, RhiSampler sampler_handle) {
 	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
 
 	VulkanImage *image = NULL;
 	VULKAN_GET_OR_RETURN(image, context->image_pool, texture_handle, MAX_TEXTURES, true, false);
@@ -168,29 +279,13 @@ ENGINE_API bool vulkan_uniformset_bind_texture_index(VulkanContext *context, Rhi
 	VulkanSampler *sampler = NULL;
 	VULKAN_GET_OR_RETURN(sampler, context->sampler_pool, sampler_handle, MAX_SAMPLERS, true, false);
 
-	VkDescriptorImageInfo image_info = {
-		.sampler = sampler->handle,
-		.imageView = image->view,
-		.imageLayout = image->aspect == VK_IMAGE_ASPECT_COLOR_BIT ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
-	};
-
-	VkWriteDescriptorSet descriptor_write = {
-		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-		.dstSet = set->handle,
-		.dstBinding = binding,
-		.dstArrayElement = index,
-		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-		.descriptorCount = 1,
-		.pImageInfo = &image_info,
-	};
-	vkUpdateDescriptorSets(context->device.logical, 1, &descriptor_write, 0, NULL);
-
+	uniformset_write_texture(context, set, binding, index, image, sampler);
 	return true;
 }
 
 bool vulkan_uniformset_bind_texture_array(VulkanContext *context, RhiUniformSet set_handle, uint32_t binding, uint32_t texture_count, RhiTexture *textures, RhiSampler *samplers) {
 	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
 
 	for (uint32_t index = 0; index < texture_count; ++index) {
 		RhiTexture texture_handle = textures[index];
@@ -202,66 +297,86 @@ bool vulkan_uniformset_bind_texture_array(VulkanContext *context, RhiUniformSet
 		VulkanSampler *sampler = NULL;
 		VULKAN_GET_OR_RETURN(sampler, context->sampler_pool, sampler_handle, MAX_SAMPLERS, true, false);
 
-		VkDescriptorImageInfo image_info = {
-			.sampler = sampler->handle,
-			.imageView = image->view,
-			.imageLayout = image->aspect == VK_IMAGE_ASPECT_COLOR_BIT ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
-		};
-
-		VkWriteDescriptorSet descriptor_write = {
-			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			.dstSet = set->handle,
-			.dstBinding = binding,
-			.dstArrayElement = index,
-			.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-			.descriptorCount = 1,
-			.pImageInfo = &image_info,
-		};
-		vkUpdateDescriptorSets(context->device.logical, 1, &descriptor_write, 0, NULL);
+		uniformset_write_texture(context, set, binding, index, image, sampler);
 	}
 
 	return true;
 }
 
-bool vulkan_uniformset_bind(VulkanContext *context, RhiUniformSet set_handle) {
-	VulkanUniformSet *set = NULL;
-	VULKAN_GET_OR_RETURN(set, context->set_pool, set_handle, MAX_UNIFORM_SETS, true, false);
-
-	VulkanShader *shader = context->bound_shader;
+// NOTE: draw_offsets, when given, holds one entry per dynamic binding in binding order and is added on top of the written range
+static bool uniformset_bind_offsets(VulkanContext *context, VulkanRecorder *recorder, VulkanUniformSet *set, const uint32_t *draw_offsets) {
+	VulkanShader *shader = recorder->bound_shader;
 	ASSERT(shader);
 
-	static uint32_t current_frame = 0;
-
 	uint32_t offsets[MAX_BINDINGS_PER_RESOURCE] = { 0 };
-	for (uint32_t index = 0; index < set->range_count; index++)
-		offsets[index] = set->buffer_ranges[index];
+	uint32_t offset_count = 0;
+	for (uint32_t binding = 0; binding < MAX_BINDINGS_PER_RESOURCE; binding++) {
+		if ((set->dynamic_mask & (1u << binding)) == 0)
+			continue;
+
+		uint32_t draw_offset = draw_offsets ? draw_offsets[offset_count] : 0;
+		offsets[offset_count++] = set->buffer_offsets[binding] + set->buffer_strides[binding] * context->current_frame + draw_offset;
+	}
+
+	ASSERT(set->number < MAX_SETS);
+	if (set->handle == VK_NULL_HANDLE) {
+		LOG_ERROR("Vulkan: uniform set has no descriptors since its shader failed to reload, aborting %s", __func__);
+		return false;
+	}
+
+	if (recorder->bound_sets[set->number] == set->handle &&
+		recorder->bound_offset_counts[set->number] == offset_count &&
+		memory_equals(recorder->bound_offsets[set->number], offsets, sizeof(uint32_t) * offset_count)) {
+		recorder->bind_stats.skipped++;
+		return true;
+	}
 
 	vkCmdBindDescriptorSets(
-		context->command_buffers[context->current_frame],
+		recorder->command_buffer,
 		VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline_layout,
-		set->number, 1, &set->handle, set->range_count, offsets);
+		set->number, 1, &set->handle, offset_count, offsets);
+
+	recorder->bound_sets[set->number] = set->handle;
+	recorder->bound_offset_counts[set->number] = offset_count;
+	memory_copy_count(recorder->bound_offsets[set->number], offsets, offset_count);
+	recorder->bind_stats.issued++;
 
 	return true;
 }
 
-bool vulkan_push_constants(VulkanContext *context, size_t offset, size_t size, void *data) {
-	VulkanShader *shader = context->bound_shader;
+bool vulkan_uniformset_bind(VulkanContext *context, VulkanRecorder *recorder, RhiUniformSet set_handle) {
+	VulkanUniformSet *set = NULL;
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
+
+	return uniformset_bind_offsets(context, recorder, set, NULL);
+}
+
+bool vulkan_uniformset_bind_dynamic(VulkanContext *context, VulkanRecorder *recorder, RhiUniformSet set_handle, const uint32_t *offsets) {
+	VulkanUniformSet *set = NULL;
+	VULKAN_GET_SET_OR_RETURN(set, context, set_handle, false);
+
+	return uniformset_bind_offsets(context, recorder, set, offsets);
+}
+
+bool vulkan_push_constants(VulkanContext *context, VulkanRecorder *recorder, size_t offset, size_t size, void *data) {
+	VulkanShader *shader = recorder->bound_shader;
 	if (shader == NULL) {
 		LOG_ERROR("Vulkan: No shader currently bound, aborting vulkan_renderer_resource_local_write");
 		return false;
 	}
 
-	vkCmdPushConstants(context->command_buffers[context->current_frame], shader->pipeline_layout, VK_SHADER_STAGE_ALL_GRAPHICS, offset, size, data);
+	vkCmdPushConstants(recorder->command_buffer, shader->pipeline_layout, VK_SHADER_STAGE_ALL_GRAPHICS, offset, size, data);
 	return true;
 }
 
-VkDescriptorType to_vulkan_descriptor_type(ShaderBindingType type) {
+// dynamic as reflected into ShaderBinding, see reflect_descriptor_type
+VkDescriptorType to_vulkan_descriptor_type(ShaderBindingType type, bool dynamic) {
 	switch (type) {
 		case SHADER_BINDING_UNIFORM_BUFFER: {
-			return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			return dynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
 		} break;
 		case SHADER_BINDING_STORAGE_BUFFER: {
-			return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+			return dynamic ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
 		} break;
 		case SHADER_BINDING_TEXTURE_2D: {
 			return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -12,27 +12,45 @@
 #include "core/logger.h"
 #include "core/r_types.h"
 #include "core/strings.h"
+#include "platform.h"
+#include "platform/filesystem.h"
 
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 #include <vulkan/vulkan_core.h>
 
-bool create_shader_variant(VulkanContext *context, VulkanShader *shader, VulkanPass *pass, PipelineDesc desc, VulkanPipeline *variant);
+bool create_shader_variant(VulkanContext *context, VulkanShader *shader, const VulkanPass *pass, PipelineDesc desc, VulkanPipeline *variant);
 bool destroy_shader_variant(VulkanContext *context, VulkanShader *shader, VulkanPipeline *variant);
 
+// NOTE: Only buffers in the per-material set are declared dynamic. Those sets are made once and bound across
+// frames, or bound once per pass and moved per draw, so they take their frame copy and draw range as offsets
+// from vulkan_uniformset_bind_dynamic. Per-frame sets are pushed and written every frame and stay plain
+static VkDescriptorType reflect_descriptor_type(SpvReflectDescriptorBinding *binding) {
+	bool dynamic = binding->set == SHADER_UNIFORM_FREQUENCY_PER_MATERIAL;
+	if (binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+		return dynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	if (binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+		return dynamic ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+
+	return (VkDescriptorType)binding->descriptor_type;
+}
+
+static bool type_is_dynamic(VkDescriptorType type) {
+	return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC || type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
 bool reflect_shader_interface(
 	Arena *arena, VulkanContext *context, VulkanShader *shader,
 	Buffer vertex, Buffer fragment, ShaderReflection *out_reflection);
 
-RhiShader vulkan_shader_make(
-	Arena *arena, VulkanContext *context,
+static bool shader_build(
+	Arena *arena, VulkanContext *context, VulkanShader *shader,
 	String name, Buffer vertex, Buffer fragment, ShaderReflection *out_reflection) {
-	VulkanShader *shader = pool_alloc(context->shader_pool);
-
 	if (vertex.pointer == NULL || vertex.size == 0 || fragment.pointer == NULL || fragment.size == 0) {
 		LOG_ERROR("Vulkan: invalid shader code passed, aborting %s", __func__);
-		return INVALID_RHI(RhiShader);
+		return false;
 	}
 
 	VkShaderModuleCreateInfo vsm_create_info = {
@@ -43,7 +61,7 @@ RhiShader vulkan_shader_make(
 
 	if (vkCreateShaderModule(context->device.logical, &vsm_create_info, NULL, &shader->vertex_shader) != VK_SUCCESS) {
 		LOG_ERROR("Vulkan: failed to create vertex shader module, aborting %s", __func__);
-		return INVALID_RHI(RhiShader);
+		return false;
 	}
 
 	VkShaderModuleCreateInfo fsm_create_info = {
@@ -54,10 +72,19 @@ RhiShader vulkan_shader_make(
 
 	if (vkCreateShaderModule(context->device.logical, &fsm_create_info, NULL, &shader->fragment_shader) != VK_SUCCESS) {
 		LOG_ERROR("Vulkan: failed to create fragment shader module, aborting %s", __func__);
-		return INVALID_RHI(RhiShader);
+		vkDestroyShaderModule(context->device.logical, shader->vertex_shader, NULL);
+		return false;
 	}
 
-	reflect_shader_interface(arena, context, shader, vertex, fragment, out_reflection);
+	// NOTE: Reflection may fail after some of the layouts were made, null handles are ignored by vkDestroy*
+	if (reflect_shader_interface(arena, context, shader, vertex, fragment, out_reflection) == false) {
+		LOG_ERROR("Vulkan: failed to reflect shader '%.*s', aborting %s", SARG(name), __func__);
+		for (uint32_t index = 0; index < MAX_SETS; ++index)
+			vkDestroyDescriptorSetLayout(context->device.logical, shader->layouts[index], NULL);
+		vkDestroyShaderModule(context->device.logical, shader->vertex_shader, NULL);
+		vkDestroyShaderModule(context->device.logical, shader->fragment_shader, NULL);
+		return false;
+	}
 	shader->state = VULKAN_RESOURCE_STATE_INITIALIZED;
 
 	shader->first_free = arena_freelist_wrap_array(shader->variants, VulkanPipeline);
@@ -68,13 +95,48 @@ RhiShader vulkan_shader_make(
     memory_copy(shader->name, name.chars, length);
     shader->name[length] = '\0';
 
+	return true;
+}
+
+RhiShader vulkan_shader_make(
+	Arena *arena, VulkanContext *context,
+	String name, Buffer vertex, Buffer fragment, ShaderReflection *out_reflection) {
+	VulkanShader *shader = pool_alloc(context->shader_pool);
+
+	if (shader_build(arena, context, shader, name, vertex, fragment, out_reflection) == false) {
+		*shader = (VulkanShader){ 0 };
+		pool_free(context->shader_pool, shader);
+		return INVALID_RHI(RhiShader);
+	}
+
 	return (RhiShader){ indexof(context->shader_pool, shader) };
 }
 
-bool vulkan_shader_destroy(VulkanContext *context, RhiShader rshader) {
+bool vulkan_shader_replace(VulkanContext *context, RhiShader rshader, Buffer vertex, Buffer fragment) {
 	VulkanShader *shader = NULL;
 	VULKAN_GET_OR_RETURN(shader, context->shader_pool, rshader, MAX_SHADERS, true, false);
 
+	// NOTE: Built right away so broken code is rejected while the old shader is still in place
+	VulkanShader *next = arena_push_struct(&context->replacement_arena, VulkanShader);
+	if (shader_build(NULL, context, next, string_wrap(shader->name), vertex, fragment, NULL) == false) {
+		LOG_WARN("Vulkan: Keeping previous version of shader '%s'", shader->name);
+		return false;
+	}
+
+	// Material ranges were laid out against the reflected block, a different one would read past or short of them
+	if (next->instance_size != shader->instance_size || next->group_ubo_binding != shader->group_ubo_binding) {
+		LOG_WARN("Vulkan: Shader '%s' changed its material block (%llu -> %llu bytes), restart to pick it up",
+			shader->name, (unsigned long long)shader->instance_size, (unsigned long long)next->instance_size);
+		vulkan_shader_destroy_internal(context, next);
+		return false;
+	}
+
+	arena_darray_put(&context->replacement_arena, context->replacements, VulkanReplacement,
+		{ .type = VULKAN_REPLACEMENT_SHADER, .slot = rshader.id, .as.shader = next });
+	return true;
+}
+
+void vulkan_shader_destroy_internal(VulkanContext *context, VulkanShader *shader) {
 	vkDestroyShaderModule(context->device.logical, shader->vertex_shader, NULL);
 	vkDestroyShaderModule(context->device.logical, shader->fragment_shader, NULL);
 
@@ -91,7 +153,28 @@ bool vulkan_shader_destroy(VulkanContext *context, RhiShader rshader) {
 	}
 
 	*shader = (VulkanShader){ 0 };
+}
+
+void vulkan_shader_swap_internal(VulkanContext *context, VulkanShader *dst, VulkanShader *src) {
+	vulkan_shader_destroy_internal(context, dst);
+	*dst = *src;
+
+	// NOTE: The variant free list and lookup point into the shader itself, rebuild them for the new address
+	memory_zero(dst->variants, sizeof(dst->variants));
+	dst->trie = (ArenaTrie){ 0 };
+	dst->pipeline_lru_head = NULL;
+	dst->first_free = arena_freelist_wrap_array(dst->variants, VulkanPipeline);
+	arena_list_pop(dst->first_free, VulkanPipeline);
+	dst->variant_count = 1;
+
+	*src = (VulkanShader){ 0 };
+}
+
+bool vulkan_shader_destroy(VulkanContext *context, RhiShader rshader) {
+	VulkanShader *shader = NULL;
+	VULKAN_GET_OR_RETURN(shader, context->shader_pool, rshader, MAX_SHADERS, true, false);
 
+	vulkan_shader_destroy_internal(context, shader);
 	pool_free(context->shader_pool, shader);
 
 	return true;
@@ -105,7 +188,7 @@ struct vertex_input_state {
 };
 
 static bool override_attributes(struct vertex_input_state *state, ShaderAttribute *attributes, uint32_t attribute_count);
-bool create_shader_variant(VulkanContext *context, VulkanShader *shader, VulkanPass *pass, PipelineDesc desc, VulkanPipeline *variant) {
+bool create_shader_variant(VulkanContext *context, VulkanShader *shader, const VulkanPass *pass, PipelineDesc desc, VulkanPipeline *variant) {
 	VkPipelineShaderStageCreateInfo vss_create_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
 		.stage = VK_SHADER_STAGE_VERTEX_BIT,
@@ -239,12 +322,13 @@ bool create_shader_variant(VulkanContext *context, VulkanShader *shader, VulkanP
 		.layout = shader->pipeline_layout,
 	};
 
-	if (vkCreateGraphicsPipelines(context->device.logical, VK_NULL_HANDLE, 1, &gp_create_info, NULL, &variant->handle) != VK_SUCCESS) {
+	double start = platform_time();
+	if (vkCreateGraphicsPipelines(context->device.logical, context->pipeline_cache, 1, &gp_create_info, NULL, &variant->handle) != VK_SUCCESS) {
 		LOG_ERROR("Vulkan: Failed to create pipeline");
 		return false;
 	}
 
-	LOG_INFO("Vulkan: VkPipeline created");
+	LOG_INFO("Vulkan: VkPipeline created in %.2fms", (platform_time() - start) * 1000.0);
 	return true;
 }
 
@@ -259,11 +343,11 @@ bool destroy_shader_variant(VulkanContext *context, VulkanShader *shader, Vulkan
 	return false;
 }
 
-bool vulkan_shader_bind(VulkanContext *context, RhiShader rshader, PipelineDesc desc) {
+bool vulkan_shader_bind(VulkanContext *context, VulkanRecorder *recorder, RhiShader rshader, PipelineDesc desc) {
 	VulkanShader *shader = NULL;
 	VULKAN_GET_OR_RETURN(shader, context->shader_pool, rshader, MAX_SHADERS, true, false);
 
-	VulkanPass *pass = &context->bound_pass;
+	const VulkanPass *pass = recorder->pass;
 	PipelineStateKey key;
 	memory_zero(&key, sizeof(key));
 	key = (PipelineStateKey){
@@ -275,6 +359,8 @@ bool vulkan_shader_bind(VulkanContext *context, RhiShader rshader, PipelineDesc
 	for (uint32_t index = 0; pass->color_formats[index] && index < countof(key.color_formats); ++index)
 		key.color_formats[index] = pass->color_formats[index];
 
+	// NOTE: Lookups reorder the LRU list, so even a hit has to hold the lock
+	pthread_mutex_lock(&context->mutex);
 	VulkanPipeline *popped_slot = arena_list_pop(&shader->first_free, VulkanPipeline);
 	shader->trie.arena = &arena_wrap_struct(popped_slot);
 
@@ -309,9 +395,32 @@ bool vulkan_shader_bind(VulkanContext *context, RhiShader rshader, PipelineDesc
 		}
 		shader->pipeline_lru_head = variant;
 	}
+	VkPipeline pipeline = variant->handle;
+	pthread_mutex_unlock(&context->mutex);
 
-	context->bound_shader = shader;
-	vkCmdBindPipeline(context->command_buffers[context->current_frame], VK_PIPELINE_BIND_POINT_GRAPHICS, variant->handle);
+	recorder->bound_shader = shader;
+	if (recorder->bound_pipeline == pipeline) {
+		recorder->bind_stats.skipped++;
+		return true;
+	}
+
+	vkCmdBindPipeline(recorder->command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+	recorder->bound_pipeline = pipeline;
+	recorder->bind_stats.issued++;
+
+	if (recorder->bound_layout == shader->pipeline_layout)
+		return true;
+
+	// NOTE: Layouts differ below the bindless set, so it's disturbed by every pipeline layout switch.
+	// Whatever was bound to the lower sets can't be relied on afterwards either
+	vkCmdBindDescriptorSets(
+		recorder->command_buffer,
+		VK_PIPELINE_BIND_POINT_GRAPHICS, shader->pipeline_layout,
+		VULKAN_BINDLESS_SET, 1, &context->bindless.set, 0, NULL);
+
+	recorder->bound_layout = shader->pipeline_layout;
+	for (uint32_t index = 0; index < MAX_SETS; ++index)
+		recorder->bound_sets[index] = VK_NULL_HANDLE;
 
 	return true;
 }
@@ -461,7 +570,7 @@ bool reflect_shader_interface(
 	ASSERT(result == SPV_REFLECT_RESULT_SUCCESS);
 
 	// TODO: remove set count hardcap
-	ASSERT(vs_set_count <= 2 && fs_set_count <= 2);
+	ASSERT(vs_set_count <= MAX_SETS + 1 && fs_set_count <= MAX_SETS + 1);
 
 	SpvReflectDescriptorSet **vs_sets = arena_push_count(scratch.arena, vs_set_count, SpvReflectDescriptorSet *);
 	SpvReflectDescriptorSet **fs_sets = arena_push_count(scratch.arena, fs_set_count, SpvReflectDescriptorSet *);
@@ -482,7 +591,8 @@ bool reflect_shader_interface(
 
 	for (uint32_t set_index = 0; set_index < vs_set_count; ++set_index) {
 		SpvReflectDescriptorSet *spv_set = vs_sets[set_index];
-		if (spv_set->set > MAX_SETS)
+		// NOTE: VULKAN_BINDLESS_SET uses the context layout
+		if (spv_set->set >= MAX_SETS)
 			continue;
 		SetInfo *set = &merged_sets[spv_set->set];
 		if (spv_set->set > max_set_index)
@@ -496,12 +606,7 @@ bool reflect_shader_interface(
 
 			vk->binding = spv_binding->binding;
 
-			if (spv_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
-				vk->descriptorType = (VkDescriptorType)VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-			else if (spv_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER)
-				vk->descriptorType = (VkDescriptorType)VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-			else
-				vk->descriptorType = (VkDescriptorType)spv_binding->descriptor_type;
+			vk->descriptorType = reflect_descriptor_type(spv_binding);
 
 			vk->descriptorCount = spv_binding->count;
 			vk->stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
@@ -511,7 +616,7 @@ bool reflect_shader_interface(
 
 	for (uint32_t set_index = 0; set_index < fs_set_count; ++set_index) {
 		SpvReflectDescriptorSet *reflect_set = fs_sets[set_index];
-		if (reflect_set->set > MAX_SETS)
+		if (reflect_set->set >= MAX_SETS)
 			continue;
 
 		SetInfo *set = &merged_sets[reflect_set->set];
@@ -537,12 +642,7 @@ bool reflect_shader_interface(
 
 				vk->binding = reflect_binding->binding;
 
-				if (reflect_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
-					vk->descriptorType = (VkDescriptorType)VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-				else if (reflect_binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER)
-					vk->descriptorType = (VkDescriptorType)VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
-				else
-					vk->descriptorType = (VkDescriptorType)reflect_binding->descriptor_type;
+				vk->descriptorType = reflect_descriptor_type(reflect_binding);
 
 				vk->descriptorCount = reflect_binding->count;
 				vk->stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS;
@@ -550,24 +650,55 @@ bool reflect_shader_interface(
 		}
 	}
 
+	// NOTE: A set takes one offset per dynamic binding when bound, its writes and binds go by this mask
+	uint32_t dynamic_uniform_count = 0, dynamic_storage_count = 0;
+	for (uint32_t set_index = 0; set_index < MAX_SETS; ++set_index) {
+		SetInfo *set = &merged_sets[set_index];
+		for (uint32_t binding_index = 0; binding_index < set->binding_count; ++binding_index) {
+			VkDescriptorSetLayoutBinding *vk = &set->vk_binding[binding_index];
+			ASSERT(vk->binding < MAX_BINDINGS_PER_RESOURCE);
+			if (type_is_dynamic(vk->descriptorType))
+				shader->dynamic_bindings[set_index] |= 1u << vk->binding;
+
+			if (vk->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+				dynamic_uniform_count += vk->descriptorCount;
+			else if (vk->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+				dynamic_storage_count += vk->descriptorCount;
+		}
+	}
+
+	// NOTE: The limits cover the whole pipeline layout, the spec only guarantees 8 uniform and 4 storage buffers
+	VkPhysicalDeviceLimits *limits = &context->device.properties.limits;
+	if (dynamic_uniform_count > limits->maxDescriptorSetUniformBuffersDynamic ||
+		dynamic_storage_count > limits->maxDescriptorSetStorageBuffersDynamic) {
+		LOG_ERROR("Vulkan: shader declares %u dynamic uniform and %u dynamic storage buffers, the device allows %u and %u",
+			dynamic_uniform_count, dynamic_storage_count,
+			limits->maxDescriptorSetUniformBuffersDynamic, limits->maxDescriptorSetStorageBuffersDynamic);
+		spvReflectDestroyShaderModule(&vertex_module);
+		spvReflectDestroyShaderModule(&fragment_module);
+		arena_scratch_end(scratch);
+		return false;
+	}
+
 	if (out_reflection) {
 		for (uint32_t i = 0; i <= max_set_index; ++i) {
 			out_reflection->sets[i].binding_count = merged_sets[i].binding_count;
 			out_reflection->sets[i].bindings = arena_push_count(arena, out_reflection->sets[i].binding_count, ShaderBinding);
 		}
 
-		for (uint32_t set_index = 0, index = 0; set_index <= max_set_index; ++set_index) {
+		for (uint32_t set_index = 0; set_index <= max_set_index; ++set_index) {
 			SetInfo *set = &merged_sets[set_index];
-			for (uint32_t binding_index = 0; binding_index < set->binding_count; ++binding_index, ++index) {
+			for (uint32_t binding_index = 0; binding_index < set->binding_count; ++binding_index) {
 				SpvReflectDescriptorBinding *spv = set->spv_binding[binding_index];
 				VkDescriptorSetLayoutBinding *vk = &set->vk_binding[binding_index];
 
-				ShaderBinding *dst = &out_reflection->sets[set_index].bindings[index];
+				ShaderBinding *dst = &out_reflection->sets[set_index].bindings[binding_index];
 
 				dst->name = string_copy(arena, string_wrap(spv->name));
 
 				dst->binding_number = spv->binding;
 				dst->count = spv->count;
+				dst->dynamic = FLAG_GET(shader->dynamic_bindings[set_index], 1u << spv->binding);
 				if ((vk->stageFlags & VK_SHADER_STAGE_VERTEX_BIT) == VK_SHADER_STAGE_VERTEX_BIT)
 					dst->stage |= SHADER_STAGE_VERTEX;
 				if ((vk->stageFlags & VK_SHADER_STAGE_FRAGMENT_BIT) == VK_SHADER_STAGE_FRAGMENT_BIT)
@@ -616,13 +747,11 @@ bool reflect_shader_interface(
 
 	SetInfo *material_reflect_info = &merged_sets[SHADER_UNIFORM_FREQUENCY_PER_MATERIAL];
 	for (uint32_t index = 0; index < material_reflect_info->binding_count; ++index) {
-		VkDescriptorSetLayoutBinding *vk_binding = &material_reflect_info->vk_binding[index];
 		SpvReflectDescriptorBinding *binding = material_reflect_info->spv_binding[index];
 
 		if (binding->descriptor_type == SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
 			ASSERT(shader->instance_size == 0);
 
-			vk_binding->descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 			shader->instance_size = binding->block.size;
 			shader->group_ubo_binding = binding->binding;
 		}
@@ -646,9 +775,11 @@ bool reflect_shader_interface(
 	spvReflectDestroyShaderModule(&fragment_module);
 	arena_scratch_end(scratch);
 
+	shader->layouts[VULKAN_BINDLESS_SET] = context->bindless.layout;
+
 	VkPipelineLayoutCreateInfo pipeline_layout_info = {
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-		.setLayoutCount = 2,
+		.setLayoutCount = VULKAN_BINDLESS_SET + 1,
 		.pSetLayouts = shader->layouts,
 		.pushConstantRangeCount = 1,
 		.pPushConstantRanges = &context->global_range,
@@ -774,3 +905,105 @@ size_t to_bytes(ShaderAttributeFormat format) {
 	}
 	return type_size * format.count;
 }
+
+static bool pipeline_cache_valid(VulkanContext *context, Buffer data) {
+	VkPipelineCacheHeaderVersionOne header;
+	if (data.size < sizeof(header))
+		return false;
+	memory_copy(&header, data.pointer, sizeof(header));
+
+	VkPhysicalDeviceProperties *properties = &context->device.properties;
+	return header.headerSize >= sizeof(header) &&
+		header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.vendorID == properties->vendorID &&
+		header.deviceID == properties->deviceID &&
+		memory_equals(header.pipelineCacheUUID, properties->pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+// NOTE: Every process sharing the cache directory writes a temporary of its own, only the rename is shared
+static String pipeline_cache_temp_path(Arena *arena, String path) {
+	static uint32_t counter = 0;
+	uint32_t unique = __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+	return string_format(arena, "%.*s.%d.%u.tmp", SARG(path), (int)getpid(), unique);
+}
+
+bool vulkan_pipeline_cache_create(Arena *arena, VulkanContext *context) {
+	ArenaTemp scratch = arena_scratch_begin(arena);
+
+	String directory = filesystem_cache_directory(scratch.arena);
+	if (directory.length)
+		context->pipeline_cache_path = stringpath_join(arena, directory, S("pipeline_cache.bin"));
+
+	// NOTE: A cache from another driver or GPU is silently ignored, the driver would reject or misuse it anyway
+	Buffer data = { 0 };
+	if (context->pipeline_cache_path.length && file_exists(context->pipeline_cache_path)) {
+		data = filesystem_read(scratch.arena, context->pipeline_cache_path);
+		if (pipeline_cache_valid(context, data) == false) {
+			LOG_INFO("Vulkan: Discarding stale pipeline cache '%.*s'", SARG(context->pipeline_cache_path));
+			data = (Buffer){ 0 };
+		}
+	}
+
+	VkPipelineCacheCreateInfo create_info = {
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.initialDataSize = data.size,
+		.pInitialData = data.pointer,
+	};
+
+	VkResult result = vkCreatePipelineCache(context->device.logical, &create_info, NULL, &context->pipeline_cache);
+	if (result != VK_SUCCESS && data.size) {
+		LOG_WARN("Vulkan: Pipeline cache rejected by driver, starting empty");
+		create_info.initialDataSize = 0;
+		create_info.pInitialData = NULL;
+		result = vkCreatePipelineCache(context->device.logical, &create_info, NULL, &context->pipeline_cache);
+	}
+
+	arena_scratch_end(scratch);
+
+	if (result != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: Failed to create pipeline cache");
+		return false;
+	}
+
+	context->pipeline_cache_loaded = create_info.initialDataSize;
+	LOG_INFO("Vulkan: Pipeline cache created (%zu bytes loaded)", (size_t)create_info.initialDataSize);
+	return true;
+}
+
+size_t vulkan_pipeline_cache_loaded(VulkanContext *context) {
+	return context->pipeline_cache_loaded;
+}
+
+void vulkan_pipeline_cache_destroy(VulkanContext *context) {
+	if (context->pipeline_cache == VK_NULL_HANDLE)
+		return;
+
+	size_t size = 0;
+	if (context->pipeline_cache_path.length &&
+		vkGetPipelineCacheData(context->device.logical, context->pipeline_cache, &size, NULL) == VK_SUCCESS && size) {
+		ArenaTemp scratch = arena_scratch_begin(NULL);
+		void *data = arena_push(scratch.arena, size, 16, false);
+
+		if (vkGetPipelineCacheData(context->device.logical, context->pipeline_cache, &size, data) == VK_SUCCESS) {
+			// Write next to the destination and rename over it so an interrupted write never leaves a torn cache
+			String temp_path = pipeline_cache_temp_path(scratch.arena, context->pipeline_cache_path);
+			File file = filesystem_open(temp_path, FILE_MODE_WRITE_BINARY);
+			if (file.handle) {
+				size_t written = file_write(&file, size, 1, data);
+				file_close(&file);
+
+				if (written == 1 && filesystem_rename(temp_path, context->pipeline_cache_path))
+					LOG_INFO("Vulkan: Pipeline cache saved (%zu bytes)", size);
+				else {
+					LOG_WARN("Vulkan: Failed to save pipeline cache '%.*s'", SARG(context->pipeline_cache_path));
+					remove(temp_path.chars);
+				}
+			}
+		}
+
+		arena_scratch_end(scratch);
+	}
+
+	vkDestroyPipelineCache(context->device.logical, context->pipeline_cache, NULL);
+	context->pipeline_cache = VK_NULL_HANDLE;
+}
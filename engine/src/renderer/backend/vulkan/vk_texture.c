@@ -46,6 +46,10 @@ RhiTexture vulkan_texture_make(
 		return INVALID_RHI(RhiTexture);
 	}
 
+	// NOTE: Freed slots come back through the pool free list and are overwritten here
+	if (type == TEXTURE_TYPE_2D && FLAG_GET(vk_usage, VK_IMAGE_USAGE_SAMPLED_BIT))
+		vulkan_bindless_write_image(context, indexof(context->image_pool, image), image);
+
 	LOG_INFO("Vulkan Texture created");
 	image->state = VULKAN_RESOURCE_STATE_INITIALIZED;
 	return (RhiTexture){ indexof(context->image_pool, image) };
@@ -57,7 +61,7 @@ bool vulkan_texture_destroy(VulkanContext *context, RhiTexture image_handle) {
 
 	vkDestroyImageView(context->device.logical, image->view, NULL);
 	vkDestroyImage(context->device.logical, image->handle, NULL);
-	vkFreeMemory(context->device.logical, image->memory, NULL);
+	vulkan_memory_free(context, &image->allocation);
 
 	*image = (VulkanImage){ 0 };
 
@@ -66,6 +70,31 @@ bool vulkan_texture_destroy(VulkanContext *context, RhiTexture image_handle) {
 	return true;
 }
 
+bool vulkan_texture_replace(VulkanContext *context, RhiTexture image_handle, uint32_t width, uint32_t height, void *pixels) {
+	VulkanImage *image = NULL;
+	VULKAN_GET_OR_RETURN(image, context->image_pool, image_handle, MAX_TEXTURES, true, false);
+	ASSERT(pixels);
+
+	VulkanReplacement *replacement = arena_darray_push(&context->replacement_arena, context->replacements, VulkanReplacement);
+	*replacement = (VulkanReplacement){ .type = VULKAN_REPLACEMENT_TEXTURE, .slot = image_handle.id };
+
+	VulkanImage *next = &replacement->as.image;
+	bool created = vulkan_image_make_internal(context, image->info.samples, width, height, image->info.format,
+		VK_IMAGE_TILING_OPTIMAL, image->info.usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, image->type,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, next);
+
+	if (created == false || vulkan_image_upload(context, pixels, next) == false ||
+		vulkan_imageview_make(context, to_view_type(image->type), image->aspect, next) == false) {
+		LOG_ERROR("Vulkan: Failed to build replacement texture, keeping the previous one");
+		vulkan_image_destroy_internal(context, next);
+		HEADER(context->replacements, ArenaArrayHeader)->count--;
+		return false;
+	}
+
+	next->state = VULKAN_RESOURCE_STATE_INITIALIZED;
+	return true;
+}
+
 bool vulkan_texture_read_pixel(VulkanContext *context, RhiTexture image_handle, uint32_t x, uint32_t y, void *pixel) {
 	VulkanImage *image = NULL;
 	VULKAN_GET_OR_RETURN(image, context->image_pool, image_handle, MAX_TEXTURES, true, false);
@@ -162,16 +191,34 @@ bool vulkan_texture_resize(VulkanContext *context, RhiTexture image_handle, uint
 
 	vkDestroyImageView(context->device.logical, image->view, NULL);
 	vkDestroyImage(context->device.logical, image->handle, NULL);
-	vkFreeMemory(context->device.logical, image->memory, NULL);
+	vulkan_memory_free(context, &image->allocation);
 
 	vulkan_image_make_internal(context, image->info.samples, width, height, image->info.format,
 		VK_IMAGE_TILING_OPTIMAL, image->info.usage, image->type,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image);
 	vulkan_imageview_make(context, to_view_type(image->type), image->aspect, image);
+	if (image->type == TEXTURE_TYPE_2D && FLAG_GET(image->info.usage, VK_IMAGE_USAGE_SAMPLED_BIT))
+		vulkan_bindless_write_image(context, image_handle.id, image);
+	vulkan_uniformsets_refresh_texture(context, image_handle.id);
 
 	return true;
 }
 
+uint32_t vulkan_texture_bindless_index(VulkanContext *context, RhiTexture image_handle) {
+	VulkanImage *image = NULL;
+	VULKAN_GET_OR_RETURN(image, context->image_pool, image_handle, MAX_TEXTURES, true, 0);
+
+	ASSERT(image->type == TEXTURE_TYPE_2D && FLAG_GET(image->info.usage, VK_IMAGE_USAGE_SAMPLED_BIT));
+	return image_handle.id;
+}
+
+uint32_t vulkan_sampler_bindless_index(VulkanContext *context, RhiSampler sampler_handle) {
+	VulkanSampler *sampler = NULL;
+	VULKAN_GET_OR_RETURN(sampler, context->sampler_pool, sampler_handle, MAX_SAMPLERS, true, 0);
+
+	return sampler_handle.id;
+}
+
 uint32x2 vulkan_texture_size(VulkanContext *context, RhiTexture image_handle) {
 	VulkanImage *image = NULL;
 	VULKAN_GET_OR_RETURN(image, context->image_pool, image_handle, MAX_TEXTURES, true, (uint32x2){ 0 });
@@ -213,6 +260,8 @@ RhiSampler vulkan_sampler_make(VulkanContext *context, SamplerDesc description)
 		return INVALID_RHI(RhiSampler);
 	}
 
+	vulkan_bindless_write_sampler(context, indexof(context->sampler_pool, sampler), sampler);
+
 	LOG_INFO("VkSampler created");
 	sampler->state = VULKAN_RESOURCE_STATE_INITIALIZED;
 
@@ -0,0 +1,366 @@
+#include "common.h"
+#include "renderer/backend/vulkan_api.h"
+
+#include "vk_internal.h"
+
+#include "core/arena.h"
+#include "core/debug.h"
+#include "core/logger.h"
+#include <vulkan/vulkan_core.h>
+
+// Everything an uploaded buffer range can be read as once the graphics queue owns it again
+#define UPLOAD_BUFFER_READ_ACCESS (VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT)
+#define UPLOAD_READ_STAGES (VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT)
+
+static inline bool upload_dedicated(VulkanContext *context) {
+	return context->upload.family != (uint32_t)context->device.graphics_index;
+}
+
+bool vulkan_upload_create(VulkanContext *context) {
+	VulkanUploadQueue *upload = &context->upload;
+	upload->family = context->device.transfer_index;
+	upload->queue = context->device.transfer_queue;
+	upload->arena = arena_reserve(MiB(16), ARENA_FLAG_NONE);
+
+	VkSemaphoreTypeCreateInfo type_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+		.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+		.initialValue = 0,
+	};
+	VkSemaphoreCreateInfo semaphore_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		.pNext = &type_info,
+	};
+
+	if (vkCreateSemaphore(context->device.logical, &semaphore_info, NULL, &upload->timeline) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to create upload timeline semaphore");
+		return false;
+	}
+
+	VkCommandBufferAllocateInfo allocate_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.commandPool = context->transfer_command_pool,
+		.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = countof(upload->command_buffers),
+	};
+
+	if (vkAllocateCommandBuffers(context->device.logical, &allocate_info, upload->command_buffers) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to allocate upload command buffers");
+		return false;
+	}
+
+	allocate_info.commandPool = context->graphics_command_pool;
+	allocate_info.commandBufferCount = countof(upload->acquire_buffers);
+	if (vkAllocateCommandBuffers(context->device.logical, &allocate_info, upload->acquire_buffers) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to allocate upload acquire command buffers");
+		return false;
+	}
+
+	if (vulkan_buffer_make_internal(
+			context, VULKAN_UPLOAD_STAGING_SIZE,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0,
+			&upload->staging) == false)
+		return false;
+	vulkan_buffer_map(context, &upload->staging);
+	upload->ring = ring_make(upload->staging.size);
+
+	LOG_INFO("Vulkan Upload Queue created on %s queue family %u", upload_dedicated(context) ? "transfer" : "graphics", upload->family);
+	return true;
+}
+
+void vulkan_upload_destroy(VulkanContext *context) {
+	VulkanUploadQueue *upload = &context->upload;
+
+	vkDestroySemaphore(context->device.logical, upload->timeline, NULL);
+	vkDestroyBuffer(context->device.logical, upload->staging.handle, NULL);
+	vulkan_memory_free(context, &upload->staging.allocation);
+	arena_destroy(&upload->arena);
+
+	*upload = (VulkanUploadQueue){ 0 };
+}
+
+static bool upload_batch_begin(VulkanContext *context) {
+	VulkanUploadQueue *upload = &context->upload;
+
+	// NOTE: Command buffers are reused round robin, which only blocks when uploads get every batch
+	// ahead of the transfer queue
+	VkSemaphoreWaitInfo wait_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount = 1,
+		.pSemaphores = &upload->timeline,
+		.pValues = &upload->batch_values[upload->batch],
+	};
+	vkWaitSemaphores(context->device.logical, &wait_info, UINT64_MAX);
+
+	VkCommandBuffer command_buffer = upload->command_buffers[upload->batch];
+	vkResetCommandBuffer(command_buffer, 0);
+
+	VkCommandBufferBeginInfo begin_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+
+	if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to begin upload command buffer");
+		return false;
+	}
+
+	upload->recording = true;
+	return true;
+}
+
+static inline bool upload_begin(VulkanContext *context) {
+	return context->upload.recording || upload_batch_begin(context);
+}
+
+// Reserves up to size bytes of staging space in whole multiples of granularity and returns how much it got.
+// When even one granule doesn't fit it waits for the oldest batch instead, submitting the recording one first
+// if that's what holds the space
+static uint64_t upload_reserve(VulkanContext *context, uint64_t size, uint64_t granularity, VkDeviceSize *out_offset) {
+	VulkanUploadQueue *upload = &context->upload;
+	Ring *ring = &upload->ring;
+	uint64_t alignment = context->device.properties.limits.minMemoryMapAlignment;
+
+	if (granularity + alignment > ring->capacity) {
+		LOG_ERROR("Vulkan: upload granule of %lluB exceeds the staging ring, aborting %s", (unsigned long long)granularity, __func__);
+		ASSERT(false);
+		return 0;
+	}
+
+	uint64_t completed = 0;
+	vkGetSemaphoreCounterValue(context->device.logical, upload->timeline, &completed);
+	ring_reclaim(ring, completed);
+
+	uint64_t available = 0;
+	while ((available = ring_contiguous(ring, alignment)) < granularity) {
+		if (ring_oldest_value(ring) == 0)
+			vulkan_upload_flush(context);
+
+		uint64_t value = ring_oldest_value(ring);
+		VkSemaphoreWaitInfo wait_info = {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &upload->timeline,
+			.pValues = &value,
+		};
+		vkWaitSemaphores(context->device.logical, &wait_info, UINT64_MAX);
+		ring_reclaim(ring, value);
+	}
+
+	uint64_t reserved = MIN(size, available / granularity * granularity);
+	ring_alloc(ring, reserved, alignment, out_offset);
+	return reserved;
+}
+
+bool vulkan_buffer_upload(VulkanContext *context, VulkanBuffer *dst, size_t offset, size_t size, void *data) {
+	VulkanUploadQueue *upload = &context->upload;
+
+	for (size_t copied = 0; copied < size;) {
+		VkDeviceSize src_offset = 0;
+		uint64_t chunk = upload_reserve(context, size - copied, 1, &src_offset);
+		if (chunk == 0 || upload_begin(context) == false)
+			return false;
+
+		memory_copy((uint8_t *)upload->staging.mapped + src_offset, (uint8_t *)data + copied, chunk);
+
+		VkBufferCopy region = { .srcOffset = src_offset, .dstOffset = offset + copied, .size = chunk };
+		vkCmdCopyBuffer(upload->command_buffers[upload->batch], upload->staging.handle, dst->handle, 1, &region);
+		copied += chunk;
+	}
+
+	// NOTE: On a shared family the timeline wait alone makes the copy visible to the frame
+	if (upload_dedicated(context) == false)
+		return true;
+
+	// Barriers cover everything submitted to the queue before them, chunks from earlier batches included
+	VkBufferMemoryBarrier release = {
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = 0,
+		.srcQueueFamilyIndex = upload->family,
+		.dstQueueFamilyIndex = context->device.graphics_index,
+		.buffer = dst->handle,
+		.offset = offset,
+		.size = size,
+	};
+	vkCmdPipelineBarrier(upload->command_buffers[upload->batch], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 1, &release, 0, NULL);
+
+	VkBufferMemoryBarrier acquire = release;
+	acquire.srcAccessMask = 0;
+	acquire.dstAccessMask = UPLOAD_BUFFER_READ_ACCESS;
+	arena_darray_put(&upload->arena, upload->buffer_acquires, VkBufferMemoryBarrier, acquire);
+
+	return true;
+}
+
+bool vulkan_image_upload(VulkanContext *context, void *pixels, VulkanImage *dst) {
+	VulkanUploadQueue *upload = &context->upload;
+
+	uint32_t layer_count = dst->info.arrayLayers;
+	VkDeviceSize row_size = dst->width * vulkan_utils_format_to_stride(dst->info.format);
+	VkDeviceSize layer_size = row_size * dst->height;
+
+	if (upload_begin(context) == false)
+		return false;
+
+	vulkan_image_transition(
+		context, upload->command_buffers[upload->batch], dst->handle, VK_IMAGE_ASPECT_COLOR_BIT, layer_count,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	// NOTE: Split on whole rows, so a chunk is always a plain rectangle of the layer
+	for (uint32_t layer_index = 0; layer_index < layer_count; ++layer_index) {
+		for (uint32_t row = 0; row < dst->height;) {
+			VkDeviceSize src_offset = 0;
+			uint64_t chunk = upload_reserve(context, (dst->height - row) * row_size, row_size, &src_offset);
+			if (chunk == 0 || upload_begin(context) == false)
+				return false;
+
+			uint32_t row_count = (uint32_t)(chunk / row_size);
+			memory_copy((uint8_t *)upload->staging.mapped + src_offset, (uint8_t *)pixels + layer_index * layer_size + row * row_size, chunk);
+
+			VkBufferImageCopy region = {
+				.bufferOffset = src_offset,
+				.imageSubresource = {
+				  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				  .mipLevel = 0,
+				  .baseArrayLayer = layer_index,
+				  .layerCount = 1,
+				},
+				.imageOffset = { .x = 0, .y = (int32_t)row, .z = 0 },
+				.imageExtent = { .width = dst->width, .height = row_count, .depth = 1 },
+			};
+			vkCmdCopyBufferToImage(upload->command_buffers[upload->batch], upload->staging.handle, dst->handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+			row += row_count;
+		}
+	}
+
+	// NOTE: A transfer only queue can't name shader stages, so the layout change doubles as the release
+	// and the graphics queue repeats it in its acquire
+	bool dedicated = upload_dedicated(context);
+	VkImageMemoryBarrier release = {
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = 0,
+		.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		.srcQueueFamilyIndex = dedicated ? upload->family : VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = dedicated ? (uint32_t)context->device.graphics_index : VK_QUEUE_FAMILY_IGNORED,
+		.image = dst->handle,
+		.subresourceRange = {
+		  .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+		  .baseMipLevel = 0,
+		  .levelCount = 1,
+		  .baseArrayLayer = 0,
+		  .layerCount = layer_count,
+		},
+	};
+	vkCmdPipelineBarrier(upload->command_buffers[upload->batch], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &release);
+
+	if (dedicated) {
+		VkImageMemoryBarrier acquire = release;
+		acquire.srcAccessMask = 0;
+		acquire.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		arena_darray_put(&upload->arena, upload->image_acquires, VkImageMemoryBarrier, acquire);
+	}
+
+	dst->layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	return true;
+}
+
+uint64_t vulkan_upload_flush(VulkanContext *context) {
+	VulkanUploadQueue *upload = &context->upload;
+	if (upload->recording == false)
+		return upload->submitted;
+
+	VkCommandBuffer command_buffer = upload->command_buffers[upload->batch];
+	vkEndCommandBuffer(command_buffer);
+
+	uint64_t value = upload->submitted + 1;
+	VkTimelineSemaphoreSubmitInfo timeline_info = {
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &value,
+	};
+
+	VkSubmitInfo submit_info = {
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timeline_info,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &command_buffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &upload->timeline,
+	};
+
+	if (vkQueueSubmit(upload->queue, 1, &submit_info, VK_NULL_HANDLE) != VK_SUCCESS) {
+		LOG_ERROR("Vulkan: failed to submit upload batch");
+		ASSERT(false);
+	}
+
+	ring_tag(&upload->ring, value);
+	upload->batch_values[upload->batch] = value;
+	upload->batch = (upload->batch + 1) % VULKAN_UPLOAD_BATCH_COUNT;
+	upload->submitted = value;
+	upload->recording = false;
+
+	return value;
+}
+
+bool vulkan_upload_acquire(VulkanContext *context, VkCommandBuffer command_buffer) {
+	VulkanUploadQueue *upload = &context->upload;
+
+	uint32_t buffer_count = arena_array_count(upload->buffer_acquires);
+	uint32_t image_count = arena_array_count(upload->image_acquires);
+	if (buffer_count == 0 && image_count == 0)
+		return false;
+
+	vkResetCommandBuffer(command_buffer, 0);
+	VkCommandBufferBeginInfo begin_info = {
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+
+	vkCmdPipelineBarrier(
+		command_buffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, UPLOAD_READ_STAGES,
+		0,
+		0, NULL,
+		buffer_count, upload->buffer_acquires,
+		image_count, upload->image_acquires);
+
+	vkEndCommandBuffer(command_buffer);
+
+	upload->buffer_acquires = NULL;
+	upload->image_acquires = NULL;
+	arena_rewind(&upload->arena, 0);
+
+	return true;
+}
+
+UploadTicket vulkan_upload_ticket(VulkanContext *context) {
+	VulkanUploadQueue *upload = &context->upload;
+	return (UploadTicket){ upload->recording ? upload->submitted + 1 : upload->submitted };
+}
+
+bool vulkan_upload_complete(VulkanContext *context, UploadTicket ticket) {
+	uint64_t value = 0;
+	vkGetSemaphoreCounterValue(context->device.logical, context->upload.timeline, &value);
+	return value >= ticket.value;
+}
+
+void vulkan_upload_wait(VulkanContext *context, UploadTicket ticket) {
+	if (ticket.value > context->upload.submitted)
+		vulkan_upload_flush(context);
+
+	VkSemaphoreWaitInfo wait_info = {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount = 1,
+		.pSemaphores = &context->upload.timeline,
+		.pValues = &ticket.value,
+	};
+	vkWaitSemaphores(context->device.logical, &wait_info, UINT64_MAX);
+}
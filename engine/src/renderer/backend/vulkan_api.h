@@ -7,37 +7,96 @@
 struct window;
 
 typedef struct vulkan_context VulkanContext;
+typedef struct vulkan_recorder VulkanRecorder;
 
 #define MAX_BUFFERS 1024
 #define MAX_TEXTURES 512
 #define MAX_SAMPLERS 32
 #define MAX_SHADERS 32
 #define MAX_UNIFORM_SETS 4096
-
+#define MAX_PERSISTENT_UNIFORM_SETS 512
+// Frames recorded ahead of the GPU, anything a frame reads has to outlive this many frame_begins
+#define MAX_FRAMES_IN_FLIGHT 2
+// Upper bound on the recorders, and so the recording threads, of one parallel drawlist
+#define MAX_RECORDERS 8
+
+// Value on the upload timeline, reached once every upload recorded before it was taken has landed
+typedef struct {
+	uint64_t value;
+} UploadTicket;
+
+typedef struct {
+	uint32_t block_count, dedicated_count;
+	uint32_t allocation_count, free_range_count;
+	uint64_t reserved, used, dedicated, largest_free;
+	// 1 - largest free range / total free space across blocks
+	float fragmentation;
+} VulkanMemoryStats;
+
+// Pipeline, uniform set and vertex/index binds recorded, and the ones dropped because the state was already bound.
+// descriptor_writes counts every descriptor written by the host, including the ones made between frames
+typedef struct {
+	uint32_t issued, skipped;
+	uint32_t descriptor_writes;
+} VulkanBindStats;
+
+// Headless without a display, nothing is presented and passes have to name their color targets
 VulkanContext *vulkan_renderer_make(Arena *arena, struct window *display);
 void vulkan_renderer_destroy(VulkanContext *context);
 ENGINE_API bool vulkan_renderer_on_resize(VulkanContext *context, uint32_t new_width, uint32_t new_height);
+ENGINE_API VulkanMemoryStats vulkan_memory_stats(VulkanContext *context);
+// Totals of the last finished frame, across every recorder
+ENGINE_API VulkanBindStats vulkan_bind_stats(VulkanContext *context);
+// Bytes of pipeline cache read back from disk when the renderer was made, 0 when it started empty
+ENGINE_API size_t vulkan_pipeline_cache_loaded(VulkanContext *context);
+
+// Uploads are batched and submitted with the next vulkan_frame_end, the ticket covers everything recorded so far
+ENGINE_API UploadTicket vulkan_upload_ticket(VulkanContext *context);
+ENGINE_API bool vulkan_upload_complete(VulkanContext *context, UploadTicket ticket);
+// Submits the pending batch early if the ticket needs it
+ENGINE_API void vulkan_upload_wait(VulkanContext *context, UploadTicket ticket);
 
 ENGINE_API bool vulkan_frame_begin(VulkanContext *context, uint32_t width, uint32_t height);
 ENGINE_API bool vulkan_frame_end(VulkanContext *context);
-
-ENGINE_API bool vulkan_drawlist_begin(VulkanContext *context, DrawlistDesc desc);
+// Records into the frame's command buffer, for work outside of drawlists like pushing sets up front
+ENGINE_API VulkanRecorder *vulkan_frame_recorder(VulkanContext *context);
+
+// Returns the frame recorder, or NULL when the pass couldn't begin
+ENGINE_API VulkanRecorder *vulkan_drawlist_begin(VulkanContext *context, DrawlistDesc desc);
+// Splits the pass into recorder_count secondary command buffers that vulkan_drawlist_end executes in order.
+// Each recorder may be filled from its own thread, everything that isn't a per-draw call stays on the calling one
+ENGINE_API bool vulkan_drawlist_begin_parallel(VulkanContext *context, DrawlistDesc desc, uint32_t recorder_count, VulkanRecorder **out_recorders);
 ENGINE_API bool vulkan_drawlist_end(VulkanContext *context);
 
-ENGINE_API bool vulkan_renderer_draw(VulkanContext *context, uint32_t vertex_count);
-ENGINE_API bool vulkan_renderer_draw_indexed(VulkanContext *context, uint32_t index_count);
-ENGINE_API bool vulkan_renderer_draw_offset(VulkanContext *context, uint32_t vertex_count, uint32_t start_vertex);
+ENGINE_API bool vulkan_renderer_draw(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count);
+ENGINE_API bool vulkan_renderer_draw_indexed(VulkanContext *context, VulkanRecorder *recorder, uint32_t index_count);
+ENGINE_API bool vulkan_renderer_draw_offset(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count, uint32_t start_vertex);
+// first_instance is added to gl_InstanceIndex, so it can index straight into a per-instance buffer
+ENGINE_API bool vulkan_renderer_draw_instanced(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count, uint32_t instance_count, uint32_t first_instance);
+ENGINE_API bool vulkan_renderer_draw_indexed_instanced(VulkanContext *context, VulkanRecorder *recorder, uint32_t index_count, uint32_t instance_count, uint32_t first_instance);
+// Draw one mesh out of a shared buffer that stays bound, first_index and vertex_offset locate it in elements
+ENGINE_API bool vulkan_renderer_draw_instanced_offset(VulkanContext *context, VulkanRecorder *recorder, uint32_t vertex_count, uint32_t start_vertex, uint32_t instance_count, uint32_t first_instance);
+ENGINE_API bool vulkan_renderer_draw_indexed_instanced_offset(
+	VulkanContext *context, VulkanRecorder *recorder,
+	uint32_t index_count, uint32_t first_index, int32_t vertex_offset, uint32_t instance_count, uint32_t first_instance);
 
 ENGINE_API RhiShader vulkan_shader_make(
 	Arena *arena, VulkanContext *context,
 	String name, Buffer vertex, Buffer fragment, ShaderReflection *out_reflection);
 bool vulkan_shader_destroy(VulkanContext *context, RhiShader shader);
 
+// Builds the new version right away and swaps it in behind the same handle at the start of the next frame.
+// Returns false and keeps the current shader when the code is rejected or its per-material block changed
+ENGINE_API bool vulkan_shader_replace(VulkanContext *context, RhiShader shader, Buffer vertex, Buffer fragment);
+
 ENGINE_API bool vulkan_shader_bind(
-	VulkanContext *context, RhiShader rshader, PipelineDesc desc);
+	VulkanContext *context, VulkanRecorder *recorder, RhiShader rshader, PipelineDesc desc);
 
 ENGINE_API RhiTexture vulkan_texture_make(VulkanContext *context, uint32_t width, uint32_t height, TextureType type, TextureFormat format, TextureUsageFlags usage, void *pixels);
 ENGINE_API bool vulkan_texture_destroy(VulkanContext *context, RhiTexture texture);
+// Uploads pixels into a new image with the texture's format and usage, swapped in behind the same handle and
+// bindless slot at the start of the next frame
+ENGINE_API bool vulkan_texture_replace(VulkanContext *context, RhiTexture texture, uint32_t width, uint32_t height, void *pixels);
 
 ENGINE_API bool vulkan_texture_read_pixel(VulkanContext *context, RhiTexture texture, uint32_t x, uint32_t y, void *pixel);
 ENGINE_API bool vulkan_texture_read_pixels(VulkanContext *context, RhiTexture texture, uint32_t x, uint32_t y, void *pixels);
@@ -46,6 +105,8 @@ ENGINE_API bool vulkan_texture_prepare_attachment(VulkanContext *context, RhiTex
 ENGINE_API bool vulkan_texture_prepare_sample(VulkanContext *context, RhiTexture texture);
 ENGINE_API bool vulkan_texture_resize(VulkanContext *context, RhiTexture texture, uint32_t width, uint32_t height);
 ENGINE_API uint32x2 vulkan_texture_size(VulkanContext *context, RhiTexture texture);
+// Slot of a sampled 2D texture in the bindless texture array (set 2, binding 0)
+ENGINE_API uint32_t vulkan_texture_bindless_index(VulkanContext *context, RhiTexture texture);
 
 ENGINE_API RhiBuffer vulkan_buffer_make(VulkanContext *context, BufferUsageFlags type, BufferMemory memory, size_t size, void *data);
 ENGINE_API bool vulkan_buffer_destroy(VulkanContext *context, RhiBuffer buffer);
@@ -59,19 +120,28 @@ ENGINE_API bool vulkan_buffer_write(VulkanContext *context, RhiBuffer buffer, si
 ENGINE_API bool vulkan_buffer_write_all(VulkanContext *context, RhiBuffer buffer, size_t offset, size_t size, void *data);
 
 ENGINE_API bool vulkan_buffer_range_bind(VulkanContext *context, RhiBuffer buffer, size_t offset, size_t size);
-ENGINE_API bool vulkan_buffer_bind_index(VulkanContext *context, RhiBuffer rbuffer, size_t offset);
-ENGINE_API bool vulkan_buffer_bind_vertex(VulkanContext *context, RhiBuffer rbuffer, size_t offset);
+ENGINE_API bool vulkan_buffer_bind_index(VulkanContext *context, VulkanRecorder *recorder, RhiBuffer rbuffer, size_t offset);
+ENGINE_API bool vulkan_buffer_bind_vertex(VulkanContext *context, VulkanRecorder *recorder, RhiBuffer rbuffer, size_t offset);
 /* ENGINE_API bool vulkan_buffers_bind(VulkanContext *context, RhiBuffer *buffers, uint32_t count); */
 
 ENGINE_API RhiSampler vulkan_sampler_make(VulkanContext *context, SamplerDesc description);
 ENGINE_API bool vulkan_sampler_destroy(VulkanContext *context, RhiSampler sampler);
-
-ENGINE_API RhiUniformSet vulkan_uniformset_push(VulkanContext *context, RhiShader shader, uint32_t set_number); // Transient
+// Slot of the sampler in the bindless sampler array (set 2, binding 1)
+ENGINE_API uint32_t vulkan_sampler_bindless_index(VulkanContext *context, RhiSampler sampler);
+
+ENGINE_API RhiUniformSet vulkan_uniformset_push(VulkanContext *context, VulkanRecorder *recorder, RhiShader shader, uint32_t set_number); // Transient
+// Lives until destroyed, written once and bound every frame. Dynamic offsets follow per frame buffers on their own,
+// and the set is written again when a texture or shader behind it is replaced. Make and destroy outside of recording
+ENGINE_API RhiUniformSet vulkan_uniformset_make(VulkanContext *context, RhiShader shader, uint32_t set_number);
+ENGINE_API bool vulkan_uniformset_destroy(VulkanContext *context, RhiUniformSet set);
 ENGINE_API bool vulkan_uniformset_bind_buffer(VulkanContext *context, RhiUniformSet set, uint32_t binding, RhiBuffer buffer);
 ENGINE_API bool vulkan_uniformset_bind_buffer_range(VulkanContext *context, RhiUniformSet set, uint32_t binding, size_t offset, size_t size, RhiBuffer buffer);
 ENGINE_API bool vulkan_uniformset_bind_texture(VulkanContext *context, RhiUniformSet set, uint32_t binding, RhiTexture texture, RhiSampler sampler);
 ENGINE_API bool vulkan_uniformset_bind_texture_index(VulkanContext *context, RhiUniformSet set, uint32_t binding, uint32_t index, RhiTexture texture, RhiSampler sampler);
 ENGINE_API bool vulkan_uniformset_bind_texture_array(VulkanContext *context, RhiUniformSet set, uint32_t binding, uint32_t texture_count, RhiTexture *textures, RhiSampler *samplers);
-ENGINE_API bool vulkan_uniformset_bind(VulkanContext *context, RhiUniformSet uniform);
+ENGINE_API bool vulkan_uniformset_bind(VulkanContext *context, VulkanRecorder *recorder, RhiUniformSet uniform);
+// Binds the set once per pass and moves its buffer bindings per draw. offsets holds one entry per dynamic binding,
+// in binding order, added to the range written for that binding. Each must keep the range inside the buffer and be aligned
+ENGINE_API bool vulkan_uniformset_bind_dynamic(VulkanContext *context, VulkanRecorder *recorder, RhiUniformSet uniform, const uint32_t *offsets);
 
-ENGINE_API bool vulkan_push_constants(VulkanContext *context, size_t offset, size_t size, void *data);
+ENGINE_API bool vulkan_push_constants(VulkanContext *context, VulkanRecorder *recorder, size_t offset, size_t size, void *data);
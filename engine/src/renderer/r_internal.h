@@ -106,6 +106,8 @@ typedef struct shader_binding {
 	ShaderBindingType type;
 	ShaderStageFlags stage;
 	uint32_t binding_number, count;
+	// Takes an offset at bind time, see vulkan_uniformset_bind_dynamic
+	bool dynamic;
 
 	ShaderBuffer *buffer_layout;
 } ShaderBinding;
@@ -20,11 +20,17 @@ typedef struct {
     float rotation, zoom;
 } Camera2D;
 
+#define MATERIAL_TEXTURE_COUNT 5
+
 typedef struct alignas(16) material_paramters {
 	float4 base_color_factor;
 	float3 emissive_factor;
 	float metallic_factor;
 	float roughness_factor;
+
+	// Bindless slots, base color, metallic roughness, normal, occlusion, emissive
+	uint32_t textures[MATERIAL_TEXTURE_COUNT];
+	uint32_t sampler;
 } MaterialParameters;
 
 typedef enum {
@@ -1,3 +1,6 @@
+#ifndef COMPONENTS_H_
+#define COMPONENTS_H_
+
 #include "core/cmath.h"
 #include "core/identifiers.h"
 
@@ -30,3 +33,5 @@ typedef struct {
 	Entity next_sibling;
 	Entity prev_sibling;
 } HierarchyComponent;
+
+#endif /* COMPONENTS_H_ */
@@ -0,0 +1,25 @@
+#include "draw_batches.h"
+
+uint32_t draw_batches_group(
+	const DrawItem *items, const float4x4 *worlds, const uint32_t *mesh_to_material,
+	const uint32_t *order, uint32_t count, bool instancing,
+	DrawBatch *batches, InstanceData *instances) {
+	uint32_t batch_count = 0;
+	for (uint32_t index = 0; index < count; ++index) {
+		uint32_t item_index = order[index];
+		const DrawItem *item = &items[item_index];
+
+		if (instancing == false || index == 0 || item->mesh_index != items[order[index - 1]].mesh_index) {
+			batches[batch_count++] = (DrawBatch){
+				.mesh_index = item->mesh_index,
+				.material_index = mesh_to_material[item->mesh_index],
+				.first_instance = index,
+			};
+		}
+		batches[batch_count - 1].instance_count++;
+
+		instances[index] = (InstanceData){ .world = worlds[item_index], .entity = (uint32_t)item->entity };
+	}
+
+	return batch_count;
+}
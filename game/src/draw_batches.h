@@ -0,0 +1,35 @@
+#ifndef DRAW_BATCHES_H_
+#define DRAW_BATCHES_H_
+
+#include "components.h"
+
+#include <common.h>
+#include <core/cmath.h>
+
+typedef struct {
+	Entity entity;
+	uint32_t mesh_index;
+} DrawItem;
+
+// Matches InstanceData in the vertex shaders (std430, 80 bytes)
+typedef struct {
+	float4x4 world;
+	uint32_t entity;
+	uint32_t padding[3];
+} InstanceData;
+
+// One instanced draw, instances [first_instance, first_instance + instance_count) of the pass instance buffer
+typedef struct {
+	uint32_t mesh_index, material_index;
+	uint32_t first_instance, instance_count;
+} DrawBatch;
+
+// Walks the items in order, already sorted by draw key. With instancing every run of one mesh becomes a single
+// batch, without it every item is a batch of its own. Either way instances[n] is the nth item in order, so both
+// draw the same instances. batches needs room for count entries, returns how many were written
+uint32_t draw_batches_group(
+	const DrawItem *items, const float4x4 *worlds, const uint32_t *mesh_to_material,
+	const uint32_t *order, uint32_t count, bool instancing,
+	DrawBatch *batches, InstanceData *instances);
+
+#endif /* DRAW_BATCHES_H_ */
@@ -6,81 +6,311 @@
 #include "core/logger.h"
 #include "platform/filesystem.h"
 
+#define ECS_RECORD_PAGE_SIZE 1024
+#define ECS_ARCHETYPE_TABLE_SIZE (ECS_MAX_ARCHETYPES * 2)
+#define ECS_COLUMN_ALIGN 16
+
+struct EcsChunk {
+	EcsChunk *next, *prev;
+	uint32_t archetype, count;
+};
+
+// NOTE: Entity ids live in the first column of every chunk, right after the header
+#define ECS_ENTITY_COLUMN ((sizeof(EcsChunk) + ECS_COLUMN_ALIGN - 1) & ~(size_t)(ECS_COLUMN_ALIGN - 1))
+
+typedef struct {
+	uint32_t mask, capacity;
+	// Byte offset of each column from the chunk base, 0 for components not in the mask
+	uint16_t columns[COMPONENT_TYPE_MAX];
+	// Archetype index + 1 reached by adding/removing a component, 0 until first looked up
+	uint16_t add_edges[COMPONENT_TYPE_MAX];
+	uint16_t remove_edges[COMPONENT_TYPE_MAX];
+
+	EcsChunk *first, *last;
+	uint32_t chunk_count, entity_count;
+} EcsArchetype;
+
+typedef struct {
+	EcsChunk *chunk; // NULL while the entity is dead
+	uint32_t row, next_free;
+} EntityRecord;
+
 struct ECS {
 	Arena *arena;
 
-	uint32_t flags[MAX_ENTITIES];
-	Buffer components[COMPONENT_TYPE_MAX];
+	EntityRecord *record_pages[MAX_ENTITIES / ECS_RECORD_PAGE_SIZE];
+	uint32_t entity_count, entity_high, entity_free;
+
+	EcsArchetype archetypes[ECS_MAX_ARCHETYPES];
+	uint16_t archetype_table[ECS_ARCHETYPE_TABLE_SIZE];
+	uint32_t archetype_count;
 
-	uint32_t entity_count, highest_valid;
+	EcsChunk *free_chunks;
 };
 
 static bool serialize_entity(ECS *world, JsonExporter *exporter, Entity entity);
 static Entity deserialize_entity(ECS *world, JsonNode *root);
 
+static inline bool component_valid(ComponentID type_id) {
+	if (type_id == 0 || type_id >= COMPONENT_TYPE_MAX)
+		return false;
+	return true;
+}
+
+static inline uint32_t component_flag(ComponentID id) {
+	ASSERT(id < INT32_MAX);
+	if (id == 0)
+		return 0;
+	return (1ULL << (id - 1));
+}
+
+static inline EntityRecord *entity_record(ECS *world, Entity entity) {
+	return &world->record_pages[entity / ECS_RECORD_PAGE_SIZE][entity % ECS_RECORD_PAGE_SIZE];
+}
+
+static inline Entity *chunk_entities(EcsChunk *chunk) {
+	return (Entity *)((uint8_t *)chunk + ECS_ENTITY_COLUMN);
+}
+
+static inline void *chunk_component(EcsArchetype *archetype, EcsChunk *chunk, uint32_t row, ComponentID type_id) {
+	return (uint8_t *)chunk + archetype->columns[type_id] + component_metadata[type_id].element_size * row;
+}
+
+static uint32_t archetype_find(ECS *world, uint32_t mask) {
+	uint32_t slot = (mask * 2654435761u) % ECS_ARCHETYPE_TABLE_SIZE;
+	while (world->archetype_table[slot]) {
+		uint32_t index = world->archetype_table[slot] - 1;
+		if (world->archetypes[index].mask == mask)
+			return index;
+		slot = (slot + 1) % ECS_ARCHETYPE_TABLE_SIZE;
+	}
+
+	ASSERT(world->archetype_count < ECS_MAX_ARCHETYPES);
+	uint32_t index = world->archetype_count++;
+	world->archetype_table[slot] = (uint16_t)(index + 1);
+
+	EcsArchetype *archetype = &world->archetypes[index];
+	memory_zero_struct(*archetype);
+	archetype->mask = mask;
+
+	size_t row_size = sizeof(Entity);
+	uint32_t column_count = 0;
+	for (uint32_t type_id = 1; type_id < COMPONENT_TYPE_MAX; ++type_id) {
+		if (FLAG_GET(mask, component_flag(type_id))) {
+			row_size += component_metadata[type_id].element_size;
+			column_count++;
+		}
+	}
+
+	// Worst case every column loses ECS_COLUMN_ALIGN - 1 bytes to padding
+	size_t available = ECS_CHUNK_SIZE - ECS_ENTITY_COLUMN - column_count * (ECS_COLUMN_ALIGN - 1);
+	archetype->capacity = (uint32_t)(available / row_size);
+	ASSERT(archetype->capacity > 0);
+
+	size_t offset = ECS_ENTITY_COLUMN + sizeof(Entity) * archetype->capacity;
+	for (uint32_t type_id = 1; type_id < COMPONENT_TYPE_MAX; ++type_id) {
+		if (FLAG_GET(mask, component_flag(type_id)) == false)
+			continue;
+
+		offset = (offset + ECS_COLUMN_ALIGN - 1) & ~(size_t)(ECS_COLUMN_ALIGN - 1);
+		archetype->columns[type_id] = (uint16_t)offset;
+		offset += component_metadata[type_id].element_size * archetype->capacity;
+	}
+	ASSERT(offset <= ECS_CHUNK_SIZE);
+
+	return index;
+}
+
+static uint32_t archetype_edge(ECS *world, uint32_t from, ComponentID type_id, bool add) {
+	EcsArchetype *archetype = &world->archetypes[from];
+	uint16_t *edges = add ? archetype->add_edges : archetype->remove_edges;
+
+	if (edges[type_id] == 0) {
+		uint32_t mask = add
+			? archetype->mask | component_flag(type_id)
+			: archetype->mask & ~component_flag(type_id);
+		// NOTE: archetype_find may append to world->archetypes, but never moves existing ones
+		edges[type_id] = (uint16_t)(archetype_find(world, mask) + 1);
+	}
+
+	return edges[type_id] - 1;
+}
+
+// Appends a row for entity to the archetype's last chunk, component data is left uninitialized
+static void archetype_push_row(ECS *world, uint32_t index, Entity entity) {
+	EcsArchetype *archetype = &world->archetypes[index];
+
+	EcsChunk *chunk = archetype->last;
+	if (chunk == NULL || chunk->count == archetype->capacity) {
+		chunk = world->free_chunks;
+		if (chunk)
+			world->free_chunks = chunk->next;
+		else
+			chunk = arena_push(world->arena, ECS_CHUNK_SIZE, 64, false);
+
+		chunk->archetype = index;
+		chunk->count = 0;
+		chunk->next = NULL;
+		chunk->prev = archetype->last;
+
+		if (archetype->last)
+			archetype->last->next = chunk;
+		else
+			archetype->first = chunk;
+		archetype->last = chunk;
+		archetype->chunk_count++;
+	}
+
+	uint32_t row = chunk->count++;
+	chunk_entities(chunk)[row] = entity;
+	archetype->entity_count++;
+
+	EntityRecord *record = entity_record(world, entity);
+	record->chunk = chunk;
+	record->row = row;
+}
+
+// Fills the hole with the archetype's very last row so chunks stay densely packed
+static void archetype_remove_row(ECS *world, EcsChunk *chunk, uint32_t row) {
+	EcsArchetype *archetype = &world->archetypes[chunk->archetype];
+	EcsChunk *last = archetype->last;
+	uint32_t last_row = last->count - 1;
+
+	if (last != chunk || last_row != row) {
+		Entity moved = chunk_entities(last)[last_row];
+		chunk_entities(chunk)[row] = moved;
+
+		for (uint32_t type_id = 1; type_id < COMPONENT_TYPE_MAX; ++type_id) {
+			if (archetype->columns[type_id])
+				memory_copy(
+					chunk_component(archetype, chunk, row, type_id),
+					chunk_component(archetype, last, last_row, type_id),
+					component_metadata[type_id].element_size);
+		}
+
+		EntityRecord *record = entity_record(world, moved);
+		record->chunk = chunk;
+		record->row = row;
+	}
+
+	archetype->entity_count--;
+	if (--last->count == 0) {
+		archetype->last = last->prev;
+		if (archetype->last)
+			archetype->last->next = NULL;
+		else
+			archetype->first = NULL;
+		archetype->chunk_count--;
+
+		last->next = world->free_chunks;
+		world->free_chunks = last;
+	}
+}
+
+// Moves entity into another archetype, shared components are copied and new ones zeroed
+static void entity_move(ECS *world, Entity entity, uint32_t to) {
+	EntityRecord *record = entity_record(world, entity);
+	EcsChunk *old_chunk = record->chunk;
+	uint32_t old_row = record->row;
+	EcsArchetype *source = &world->archetypes[old_chunk->archetype];
+
+	archetype_push_row(world, to, entity);
+	EcsArchetype *destination = &world->archetypes[to];
+
+	for (uint32_t type_id = 1; type_id < COMPONENT_TYPE_MAX; ++type_id) {
+		if (destination->columns[type_id] == 0)
+			continue;
+
+		void *dst = chunk_component(destination, record->chunk, record->row, type_id);
+		if (source->columns[type_id])
+			memory_copy(dst, chunk_component(source, old_chunk, old_row, type_id), component_metadata[type_id].element_size);
+		else
+			memory_zero(dst, component_metadata[type_id].element_size);
+	}
+
+	archetype_remove_row(world, old_chunk, old_row);
+}
+
+static inline EcsArchetype *entity_archetype(ECS *world, Entity entity) {
+	return &world->archetypes[entity_record(world, entity)->chunk->archetype];
+}
+
 ECS *ecs_make(Arena *arena) {
 	ECS *ecs = arena_push_struct(arena, ECS);
 	ecs->arena = arena;
+	ecs->entity_high = 1;
 
-	for (uint32_t index = 1; index < COMPONENT_TYPE_MAX; ++index) {
-		ComponentMetadata data = component_metadata[index];
-		ecs->components[index].size = data.element_size * MAX_ENTITIES;
-		ecs->components[index].pointer = arena_push(arena, ecs->components[index].size, data.element_align, true);
-	}
+	// NOTE: Archetype 0 is always the empty mask
+	archetype_find(ecs, 0);
 
 	return ecs;
 }
+
 ECS *ecs_make_copy(Arena *arena, ECS *src) {
-	ECS *result = ecs_make(arena);
-	result->entity_count = src->entity_count;
-	result->highest_valid = src->highest_valid;
+	ECS *result = arena_push_struct(arena, ECS);
+	memory_copy_struct(result, src);
+	result->arena = arena;
+	result->free_chunks = NULL;
+
+	for (uint32_t page = 0; page < countof(src->record_pages); ++page) {
+		if (src->record_pages[page])
+			result->record_pages[page] = arena_push_copy(arena, src->record_pages[page], sizeof(EntityRecord) * ECS_RECORD_PAGE_SIZE, alignof(EntityRecord));
+	}
 
-	for (uint32_t type_id = 1; type_id < COMPONENT_TYPE_MAX; ++type_id)
-		memory_copy(result->components[type_id].pointer, src->components[type_id].pointer, src->components[type_id].size);
+	for (uint32_t index = 0; index < result->archetype_count; ++index) {
+		EcsArchetype *archetype = &result->archetypes[index];
+		archetype->first = archetype->last = NULL;
 
-	memory_copy(result->flags, src->flags, sizeof(src->flags));
+		for (EcsChunk *source = src->archetypes[index].first; source; source = source->next) {
+			EcsChunk *chunk = arena_push_copy(arena, source, ECS_CHUNK_SIZE, 64);
+			chunk->next = NULL;
+			chunk->prev = archetype->last;
+
+			if (archetype->last)
+				archetype->last->next = chunk;
+			else
+				archetype->first = chunk;
+			archetype->last = chunk;
+
+			Entity *entities = chunk_entities(chunk);
+			for (uint32_t row = 0; row < chunk->count; ++row)
+				entity_record(result, entities[row])->chunk = chunk;
+		}
+	}
 
 	return result;
 }
 
 bool ecs_valid(ECS *world, Entity entity) {
-	if (entity != 0 && entity < MAX_ENTITIES && world->flags[entity] != 0)
+	if (entity != 0 && entity < world->entity_high && entity_record(world, entity)->chunk != NULL)
 		return true;
 	return false;
 }
 
-static inline bool component_valid(ComponentID type_id) {
-	if (type_id == 0 || type_id >= COMPONENT_TYPE_MAX)
-		return false;
-	return true;
-}
-
-static inline uint32_t component_flag(ComponentID id) {
-	ASSERT(id < INT32_MAX);
-	if (id == 0)
-		return 0;
-	return (1ULL << (id - 1));
-}
-
 Entity ecs_spawn(ECS *world, float3 position) {
-	for (Entity entity = 1; entity < MAX_ENTITIES; ++entity) {
-		if (world->flags[entity] == 0) {
-			world->flags[entity] = component_flag(COMPONENT_TYPE_TransformComponent);
-			ecs_put(world, entity, TransformComponent,
-				{
-				  .position = position,
-				  .scale = FLOAT3_ONE,
-				});
-
-			if (world->highest_valid < entity)
-				world->highest_valid = entity;
-			world->entity_count++;
-			return entity;
-		}
+	Entity entity = world->entity_free;
+	if (entity) {
+		world->entity_free = entity_record(world, entity)->next_free;
+	} else {
+		ASSERT(world->entity_high < MAX_ENTITIES);
+		if (world->entity_high >= MAX_ENTITIES)
+			return 0;
+
+		entity = world->entity_high++;
+		uint32_t page = entity / ECS_RECORD_PAGE_SIZE;
+		if (world->record_pages[page] == NULL)
+			world->record_pages[page] = arena_push_count(world->arena, ECS_RECORD_PAGE_SIZE, EntityRecord);
 	}
 
-	ASSERT(false);
-	return 0;
+	archetype_push_row(world, archetype_find(world, component_flag(COMPONENT_TYPE_TransformComponent)), entity);
+	ecs_put(world, entity, TransformComponent,
+		{
+		  .position = position,
+		  .scale = FLOAT3_ONE,
+		});
+
+	world->entity_count++;
+	return entity;
 }
 
 Entity ecs_copy(ECS *world, Entity target) {
@@ -90,15 +320,22 @@ Entity ecs_copy(ECS *world, Entity target) {
 	}
 	Entity entity = ecs_spawn(world, FLOAT3_ZERO);
 
+	uint32_t archetype_index = entity_record(world, target)->chunk->archetype;
+	entity_move(world, entity, archetype_index);
+
+	// NOTE: Looked up after the move, target may have been swapped into the row entity left behind
+	EcsArchetype *archetype = &world->archetypes[archetype_index];
+	EntityRecord *src = entity_record(world, target);
+	EntityRecord *dst = entity_record(world, entity);
+
 	for (uint32_t type_id = 1; type_id < COMPONENT_TYPE_MAX; ++type_id) {
-		if (FLAG_GET(world->flags[target], component_flag(type_id)) == false)
+		if (archetype->columns[type_id] == 0)
 			continue;
 
-		ComponentMetadata metadata = component_metadata[type_id];
-
-		void *dst = ecs_push_id(world, entity, type_id);
-		void *src = ecs_push_id(world, target, type_id);
-		memory_copy(dst, src, metadata.element_size);
+		memory_copy(
+			chunk_component(archetype, dst->chunk, dst->row, type_id),
+			chunk_component(archetype, src->chunk, src->row, type_id),
+			component_metadata[type_id].element_size);
 	}
 
 	return entity;
@@ -106,14 +343,12 @@ Entity ecs_copy(ECS *world, Entity target) {
 
 void ecs_despawn(ECS *world, Entity entity) {
 	if (ecs_valid(world, entity)) {
-		for (uint32_t index = 0; index < COMPONENT_TYPE_MAX; ++index) {
-			ComponentMetadata metadata = component_metadata[index];
-			void *pointer = world->components[index].pointer + metadata.element_size * entity;
+		EntityRecord *record = entity_record(world, entity);
+		archetype_remove_row(world, record->chunk, record->row);
 
-			memory_zero(pointer, metadata.element_size);
-		}
-
-		world->flags[entity] = 0;
+		record->chunk = NULL;
+		record->next_free = (uint32_t)world->entity_free;
+		world->entity_free = entity;
 		world->entity_count--;
 	}
 }
@@ -127,11 +362,12 @@ void *ecs_push_id(ECS *world, Entity entity, ComponentID type_id) {
 		return NULL;
 	}
 
-	ComponentMetadata metadata = component_metadata[type_id];
-	void *pointer = world->components[type_id].pointer + metadata.element_size * entity;
-	world->flags[entity] |= component_flag(type_id);
+	EntityRecord *record = entity_record(world, entity);
+	uint32_t from = record->chunk->archetype;
+	if (world->archetypes[from].columns[type_id] == 0)
+		entity_move(world, entity, archetype_edge(world, from, type_id, true));
 
-	return pointer;
+	return chunk_component(&world->archetypes[record->chunk->archetype], record->chunk, record->row, type_id);
 }
 
 void *ecs_find_id(ECS *world, Entity entity, ComponentID type_id) {
@@ -142,13 +378,12 @@ void *ecs_find_id(ECS *world, Entity entity, ComponentID type_id) {
 		return NULL;
 	}
 
-	if (FLAG_GET(world->flags[entity], component_flag(type_id)) == false)
+	EntityRecord *record = entity_record(world, entity);
+	EcsArchetype *archetype = &world->archetypes[record->chunk->archetype];
+	if (archetype->columns[type_id] == 0)
 		return NULL;
 
-	ComponentMetadata metadata = component_metadata[type_id];
-
-	void *pointer = world->components[type_id].pointer + metadata.element_size * entity;
-	return pointer;
+	return chunk_component(archetype, record->chunk, record->row, type_id);
 }
 
 void ecs_pop_id(ECS *world, Entity entity, ComponentID type_id) {
@@ -156,14 +391,11 @@ void ecs_pop_id(ECS *world, Entity entity, ComponentID type_id) {
 		LOG_WARN("ecs_push_id - invalid type_id of %d passed, aborting", type_id);
 		return;
 	}
-	if (ecs_valid(world, entity) == false || FLAG_GET(world->flags[entity], component_flag(type_id)) == false)
+	if (ecs_valid(world, entity) == false || entity_archetype(world, entity)->columns[type_id] == 0)
 		return;
 
-	ComponentMetadata metadata = component_metadata[type_id];
-	void *pointer = world->components[type_id].pointer + metadata.element_size * entity;
-	memory_zero(pointer, metadata.element_size);
-
-	world->flags[entity] &= ~component_flag(type_id);
+	uint32_t from = entity_record(world, entity)->chunk->archetype;
+	entity_move(world, entity, archetype_edge(world, from, type_id, false));
 }
 
 bool ecs_has_id(ECS *world, Entity entity, ComponentID type_id) {
@@ -171,23 +403,27 @@ bool ecs_has_id(ECS *world, Entity entity, ComponentID type_id) {
 		LOG_WARN("ecs_push_id - invalid type_id of %d passed, aborting", type_id);
 		return false;
 	}
-	if (ecs_valid(world, entity) == false || FLAG_GET(world->flags[entity], component_flag(type_id)) == false)
+	if (ecs_valid(world, entity) == false || entity_archetype(world, entity)->columns[type_id] == 0)
 		return false;
 
 	return true;
 }
 
 void ecs_hierarchy_parent(ECS *world, Entity parent_entity, Entity child_entity) {
-	HierarchyComponent *parent = ecs_has(world, parent_entity, HierarchyComponent)
-		? ecs_find(world, parent_entity, HierarchyComponent)
-		: ecs_push(world, parent_entity, HierarchyComponent);
+	if (ecs_valid(world, parent_entity) == false) {
+		ecs_hierarchy_unparent(world, child_entity);
+		return;
+	}
 
-	HierarchyComponent *child = ecs_has(world, child_entity, HierarchyComponent)
-		? ecs_find(world, child_entity, HierarchyComponent)
-		: ecs_push(world, child_entity, HierarchyComponent);
+	// NOTE: Both pushes may move entities between chunks, so only look the components up afterwards
+	ecs_push(world, parent_entity, HierarchyComponent);
+	ecs_push(world, child_entity, HierarchyComponent);
 
 	ecs_hierarchy_unparent(world, child_entity);
 
+	HierarchyComponent *parent = ecs_find(world, parent_entity, HierarchyComponent);
+	HierarchyComponent *child = ecs_find(world, child_entity, HierarchyComponent);
+
 	child->parent = parent_entity;
 	child->next_sibling = parent->first_child;
 
@@ -286,7 +522,7 @@ Entity ecs_deserialize_entity(ECS *world, String path) {
 }
 
 EcsIterator ecs_query_make(ECS *world, uint32_t count, ComponentID *component_ids) {
-	EcsIterator result = { .world = world, .current = 1 };
+	EcsIterator result = { .world = world };
 
 	for (uint32_t index = 0; index < count; ++index) {
 		ComponentID type_id = component_ids[index];
@@ -300,14 +536,39 @@ EcsIterator ecs_query_make(ECS *world, uint32_t count, ComponentID *component_id
 }
 
 Entity ecs_next(EcsIterator *it) {
-	while (it->current <= it->world->highest_valid) {
-		Entity entity = it->current++;
-		if (FLAG_GET(it->world->flags[entity], it->mask)) {
-			return entity;
+	ECS *world = it->world;
+
+	while (it->chunk == NULL || it->row >= it->chunk->count) {
+		if (it->chunk && it->chunk->next) {
+			it->chunk = it->chunk->next;
+			it->row = 0;
+			continue;
+		}
+
+		it->chunk = NULL;
+		while (it->archetype < world->archetype_count) {
+			EcsArchetype *archetype = &world->archetypes[it->archetype++];
+			if (archetype->first && FLAG_GET(archetype->mask, it->mask)) {
+				it->chunk = archetype->first;
+				it->row = 0;
+				break;
+			}
 		}
+
+		if (it->chunk == NULL)
+			return it->current = 0;
 	}
 
-	return 0;
+	return it->current = chunk_entities(it->chunk)[it->row++];
+}
+
+void *ecs_field_id(EcsIterator *it, ComponentID type_id) {
+	ASSERT(it->chunk && it->row > 0);
+	EcsArchetype *archetype = &it->world->archetypes[it->chunk->archetype];
+	if (component_valid(type_id) == false || archetype->columns[type_id] == 0)
+		return NULL;
+
+	return chunk_component(archetype, it->chunk, it->row - 1, type_id);
 }
 
 // Serialization
@@ -317,7 +578,7 @@ bool serialize_entity(ECS *world, JsonExporter *exporter, Entity entity) {
 	json_begin_map(exporter, S(""));
 	json_write_pair(exporter, S("name"), String, S("entity"));
 
-	if (world->flags[entity] != 0) {
+	if (entity_archetype(world, entity)->mask != 0) {
 		json_begin_map(exporter, S("componenets"));
 
 		if (ecs_has(world, entity, TransformComponent)) {
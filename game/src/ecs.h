@@ -4,7 +4,14 @@
 #include "components.h"
 #include "core/strings.h"
 
-#define MAX_ENTITIES 1024
+#define MAX_ENTITIES (1 << 20)
+
+// NOTE: Entities with the same component mask share an archetype, stored in fixed size chunks
+// with one tightly packed column per component. Adding or removing a component moves the entity
+// to another archetype, so pointers returned by ecs_find/ecs_push are only valid until the next
+// ecs_push/ecs_pop/ecs_spawn/ecs_despawn on the same world
+#define ECS_CHUNK_SIZE KiB(16)
+#define ECS_MAX_ARCHETYPES 256
 
 typedef enum {
 	COMPONENT_TYPE_NILL,
@@ -72,9 +79,14 @@ Entity ecs_deserialize_entity(ECS *world, String path);
 		*ecs_push(world, entity, T) = _val; \
 	} while (0)
 
+typedef struct EcsChunk EcsChunk;
+
 typedef struct {
 	ECS *world;
 	uint32_t mask;
+
+	uint32_t archetype, row;
+	EcsChunk *chunk;
 	Entity current;
 } EcsIterator;
 
@@ -83,3 +95,7 @@ EcsIterator ecs_query_make(ECS *world, uint32_t count, ComponentID *component_id
 	ecs_query_make((world), sizeof((ComponentID[]){ __VA_ARGS__ }) / sizeof(ComponentID), (ComponentID[]){ __VA_ARGS__ })
 
 Entity ecs_next(EcsIterator *it);
+
+// Component of the entity last returned by ecs_next, read straight from the chunk column
+void *ecs_field_id(EcsIterator *it, ComponentID type_id);
+#define ecs_field(it, T) ((T *)ecs_field_id((it), ecs_type_id(T)))
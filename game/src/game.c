@@ -9,10 +9,14 @@
 #include "core/arena.h"
 #include "core/cmath.h"
 #include "core/debug.h"
+#include "core/frustum.h"
 #include "core/identifiers.h"
+#include "core/jobs.h"
 #include "core/logger.h"
 #include "core/r_types.h"
+#include "core/sort.h"
 #include "core/strings.h"
+#include "draw_batches.h"
 #include "event.h"
 #include "events/platform_events.h"
 #include "game_interface.h"
@@ -29,6 +33,11 @@
 
 #include <stdint.h>
 
+// NOTE: Reloaded geometry never overwrites a range frames in flight may still read, the old one is retired
+// and only handed out again MAX_FRAMES_IN_FLIGHT frames later
+#define SCENE_GEOMETRY_CAPACITY MiB(128)
+#define MAX_RETIRED_GEOMETRY 64
+
 static MaterialProperty default_properties[] = {
 	{ .name = { .chars = "u_base_color_texture", .length = 20 }, .type = PROPERTY_TYPE_IMAGE, .as.uint32x1 = 0 },
 	{ .name = { .chars = "u_metallic_roughness_texture", .length = 28 }, .type = PROPERTY_TYPE_IMAGE, .as.uint32x1 = 0 },
@@ -52,6 +61,20 @@ typedef struct {
 	uint32_t start_index, count;
 } MeshGroup;
 
+typedef enum {
+	DRAW_PASS_SHADOW,
+	DRAW_PASS_MAIN,
+} DrawPass;
+
+// NOTE: Sort keys, ascending is submission order. Opaque draws group by shader, material and mesh, front to back
+// within each group, translucent ones go back to front and only group by state at equal depth:
+//   opaque      | pass:2 | 0 | shader:6 | material:16 | mesh:20 | depth:19 |
+//   translucent | pass:2 | 1 | ~depth:19 | shader:6 | material:16 | mesh:20 |
+#define DRAW_KEY_DEPTH_BITS 19
+#define DRAW_KEY_MESH_BITS 20
+#define DRAW_KEY_MATERIAL_BITS 16
+#define DRAW_KEY_SHADER_BITS 6
+
 // EDITOR
 typedef enum {
 	AXIS_MODE_XYZ,
@@ -123,6 +146,53 @@ typedef enum {
 	FONT_SIZE_MAX,
 } FontSize;
 
+// NOTE: Import jobs only touch their own arena, anything that talks to the GPU happens after job_wait
+typedef struct {
+	AssetStore *store;
+	String vertex_path, fragment_path;
+	ShaderSource source;
+	Arena arena;
+} ShaderImport;
+
+typedef struct {
+	AssetStore *store;
+	String path;
+	float size;
+	Font font;
+	Arena arena;
+} FontImport;
+
+typedef struct {
+	AssetStore *store;
+	String path;
+	SceneSource source;
+	Arena arena;
+} ModelImport;
+
+// Where a loaded model ended up, so an edit to it or any file it references can be re-imported in place
+typedef struct {
+	String path;
+	StringList dependencies;
+
+	uint32_t group_index;
+	uint32_t mesh_offset, mesh_count;
+	uint32_t texture_offset, texture_count;
+	// Vertices then indices in scene_geometry_buffer, starting on a whole vertex
+	size_t geometry_offset, geometry_size;
+	bool dirty;
+} ModelRecord;
+
+typedef struct {
+	size_t offset, size;
+	uint64_t retired_frame;
+} GeometryRange;
+
+typedef struct {
+	RhiShader shader;
+	String vertex_path, fragment_path;
+	bool dirty;
+} ShaderRecord;
+
 typedef struct {
 	Arena persistent_arena;
 	Arena *frame_arena;
@@ -166,10 +236,43 @@ typedef struct {
 
 		MeshGroup *mesh_groups;
 		Interval3 *mesh_group_bounds; // per model
+		Interval3 *mesh_bounds; // per mesh, local space
 	} assets;
 
+	// Rebuilt from the world every frame, each pass culls it into its own list of indices
+	struct {
+		DrawItem *items;
+		Interval3 *bounds;
+		float4x4 *worlds;
+		uint32_t count;
+
+		uint32_t *main_visible, *shadow_visible;
+		uint32_t main_count, shadow_count;
+		CullStats main_stats, shadow_stats;
+
+		DrawBatch *main_batches, *shadow_batches;
+		uint32_t main_batch_count, shadow_batch_count;
+	} draws;
+
 	AssetStore store;
 
+	// Edited assets are re-imported on the job system, one batch at a time, and replaced behind their handles
+	struct {
+		ModelRecord *models;
+		ShaderRecord *shaders;
+
+		Arena arena;
+		ModelImport *model_imports;
+		ShaderImport *shader_imports;
+		uint32_t *model_indices, *shader_indices;
+		JobCounter counter;
+		bool busy;
+
+		GeometryRange retired_geometry[MAX_RETIRED_GEOMETRY];
+		uint32_t retired_geometry_count;
+		uint64_t frame;
+	} reload;
+
 	Arena *scene_arena;
 	size_t editor_offset;
 
@@ -198,6 +301,8 @@ typedef struct {
 		bool playing;
 	} game;
 	bool debug_draw_collisions;
+	// One draw per item instead of one per run of a mesh, to check instancing against
+	bool debug_disable_instancing;
 
 } PermanentState;
 
@@ -206,9 +311,14 @@ void editor_update(PermanentState *state, Editor *editor, float dt);
 void editor_draw(PermanentState *state, Editor *editor);
 
 void load_assets(PermanentState *state);
+void hot_reload_update(PermanentState *pstate, AssetEntry **changes);
 
 void transform_system_update(ECS *world);
 void mesh_system_update(ECS *world, PermanentState *pstate);
+void draw_items_gather(PermanentState *pstate);
+uint32_t draw_batches_build(
+	PermanentState *pstate, DrawPass pass, float3 eye, float far,
+	uint32_t *visible, uint32_t visible_count, DrawBatch **out_batches, size_t *out_instance_offset);
 
 void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffer, DrawlistDesc desc);
 
@@ -232,6 +342,24 @@ bool window_resize(EventCode code, void *event, void *receiver) {
 	return false;
 }
 
+// NOTE: Every mesh lives in scene_geometry_buffer, bound once per pass at offset 0. Meshes are picked by
+// first_index and base_vertex, so each model's vertices have to start on a whole vertex
+static size_t geometry_vertex_align(size_t offset) {
+	return (offset + sizeof(Vertex3) - 1) / sizeof(Vertex3) * sizeof(Vertex3);
+}
+
+static void geometry_bind(PermanentState *pstate, VulkanRecorder *recorder, RhiBuffer buffer) {
+	vulkan_buffer_bind_vertex(pstate->context, recorder, buffer, 0);
+	vulkan_buffer_bind_index(pstate->context, recorder, buffer, 0);
+}
+
+static void mesh_draw_instanced(PermanentState *pstate, VulkanRecorder *recorder, Mesh *mesh, uint32_t instance_count, uint32_t first_instance) {
+	if (mesh->index_count > 0)
+		vulkan_renderer_draw_indexed_instanced_offset(pstate->context, recorder, mesh->index_count, mesh->first_index, mesh->base_vertex, instance_count, first_instance);
+	else
+		vulkan_renderer_draw_instanced_offset(pstate->context, recorder, (uint32_t)mesh->vertex_count, (uint32_t)mesh->base_vertex, instance_count, first_instance);
+}
+
 static float4x4 light_matrix = { 0 };
 void draw_shadow_pass(PermanentState *pstate) {
 	// :shadow
@@ -251,6 +379,19 @@ void draw_shadow_pass(PermanentState *pstate) {
 	float4x4 view = float4x4_lookat(camera->position, camera->target, camera->up);
 	light_matrix = float4x4_multiply(projection, view);
 
+	Frustum light_frustum = frustum_make(&light_matrix);
+	pstate->draws.shadow_stats = (CullStats){ 0 };
+	pstate->draws.shadow_count = frustum_cull_boxes(
+		&light_frustum,
+		pstate->draws.bounds, pstate->draws.worlds, pstate->draws.count,
+		pstate->draws.shadow_visible, &pstate->draws.shadow_stats);
+
+	size_t instance_offset = 0;
+	pstate->draws.shadow_batch_count = draw_batches_build(
+		pstate, DRAW_PASS_SHADOW, camera->position, 100.f,
+		pstate->draws.shadow_visible, pstate->draws.shadow_count,
+		&pstate->draws.shadow_batches, &instance_offset);
+
 	DrawlistDesc shadow_pass = {
 		.name = S("shadow_pass"),
 		.depth_attachment = {
@@ -262,37 +403,63 @@ void draw_shadow_pass(PermanentState *pstate) {
 		.use_depth = true,
 	};
 
-	if (vulkan_drawlist_begin(pstate->context, shadow_pass)) {
+	VulkanRecorder *recorder = vulkan_drawlist_begin(pstate->context, shadow_pass);
+	if (recorder) {
 		PipelineDesc pipeline = DEFAULT_PIPELINE;
 		pipeline.cull_mode = CULL_MODE_BACK;
-		vulkan_shader_bind(pstate->context, pstate->shadow_shader, pipeline);
+		vulkan_shader_bind(pstate->context, recorder, pstate->shadow_shader, pipeline);
+		vulkan_push_constants(pstate->context, recorder, 0, sizeof(float4x4), light_matrix.elements);
+
+		RhiUniformSet instance_set = vulkan_uniformset_push(pstate->context, recorder, pstate->shadow_shader, 0);
+		vulkan_uniformset_bind_buffer_range(
+			pstate->context, instance_set, 0,
+			instance_offset, MAX(pstate->draws.shadow_count, 1) * sizeof(InstanceData), pstate->frame_storage_buffer);
+		vulkan_uniformset_bind(pstate->context, recorder, instance_set);
+		geometry_bind(pstate, recorder, pstate->scene_geometry_buffer);
+
+		for (uint32_t batch_index = 0; batch_index < pstate->draws.shadow_batch_count; ++batch_index) {
+			DrawBatch *batch = &pstate->draws.shadow_batches[batch_index];
+			mesh_draw_instanced(pstate, recorder, &pstate->assets.meshes[batch->mesh_index], batch->instance_count, batch->first_instance);
+		}
 
-		EcsIterator iterator = ecs_query(pstate->world, ecs_type_id(TransformComponent), ecs_type_id(MeshComponent));
-		Entity entity = 0;
-		while ((entity = ecs_next(&iterator))) {
-			TransformComponent *transform = ecs_find(pstate->world, entity, TransformComponent);
-			MeshComponent *mesh_component = ecs_find(pstate->world, entity, MeshComponent);
+		vulkan_drawlist_end(pstate->context);
+	}
+}
 
-			if (mesh_component->mesh_group_index == 0 || mesh_component->mesh_group_index > arena_array_count(pstate->assets.mesh_groups))
-				continue;
-			MeshGroup group = pstate->assets.mesh_groups[mesh_component->mesh_group_index];
+// NOTE: Each batch is one instanced draw and costs the same to record however many instances it carries.
+// Instancing leaves scenes with tens of batches rather than thousands, tune against tests/bench_draw_recording.c
+#define MAIN_PASS_DRAWS_PER_RECORDER 32
+
+typedef struct {
+	PermanentState *pstate;
+	VulkanRecorder *recorder;
+	PipelineDesc pipeline;
+	uint32_t first_batch, batch_count;
+} MainPassSlice;
 
-			for (uint32_t mesh_index = group.start_index; mesh_index < group.start_index + group.count; ++mesh_index) {
-				Mesh *mesh = &pstate->assets.meshes[mesh_index];
+// Only per-draw calls on its own recorder, everything they read was written before the jobs started.
+// Batches arrive sorted by shader and material, the recorder drops shader and set binds that change nothing
+static void main_pass_record_job(void *user_data) {
+	MainPassSlice *slice = user_data;
+	PermanentState *pstate = slice->pstate;
+	VulkanRecorder *recorder = slice->recorder;
 
-				vulkan_push_constants(pstate->context, 0, sizeof(float4x4), float4x4_multiply(projection, view).elements);
-				vulkan_push_constants(pstate->context, sizeof(float4x4), sizeof(float4x4), transform->world_matrix.elements);
+	geometry_bind(pstate, recorder, pstate->scene_geometry_buffer);
 
-				vulkan_buffer_bind_vertex(pstate->context, mesh->handle, mesh->vertex_offset);
-				if (mesh->index_count > 0) {
-					vulkan_buffer_bind_index(pstate->context, mesh->handle, mesh->index_offset);
-					vulkan_renderer_draw_indexed(pstate->context, mesh->index_count);
-				} else
-					vulkan_renderer_draw(pstate->context, mesh->vertex_count);
-			}
-		}
+	for (uint32_t batch_index = slice->first_batch; batch_index < slice->first_batch + slice->batch_count; ++batch_index) {
+		DrawBatch *batch = &pstate->draws.main_batches[batch_index];
 
-		vulkan_drawlist_end(pstate->context);
+		Mesh *mesh = &pstate->assets.meshes[batch->mesh_index];
+		Material *material = &pstate->assets.materials[batch->material_index];
+
+		vulkan_shader_bind(pstate->context, recorder, material->shader, slice->pipeline);
+		vulkan_uniformset_bind(pstate->context, recorder, pstate->game_current_frame_global);
+
+		// NOTE: Textures are read through the bindless slots stored in the material parameters
+		ASSERT(material->set.id);
+		vulkan_uniformset_bind(pstate->context, recorder, material->set);
+
+		mesh_draw_instanced(pstate, recorder, mesh, batch->instance_count, batch->first_instance);
 	}
 }
 
@@ -313,6 +480,21 @@ void draw_main_pass(PermanentState *pstate) {
 	projection.elements[5] *= -1;
 	float4x4 view = float4x4_lookat(camera->position, camera->target, camera->up);
 
+	float4x4 view_projection;
+	float4x4_multiply_into(&view_projection, &projection, &view);
+	Frustum camera_frustum = frustum_make(&view_projection);
+	pstate->draws.main_stats = (CullStats){ 0 };
+	pstate->draws.main_count = frustum_cull_boxes(
+		&camera_frustum,
+		pstate->draws.bounds, pstate->draws.worlds, pstate->draws.count,
+		pstate->draws.main_visible, &pstate->draws.main_stats);
+
+	size_t instance_offset = 0;
+	pstate->draws.main_batch_count = draw_batches_build(
+		pstate, DRAW_PASS_MAIN, camera->position, 1000.f,
+		pstate->draws.main_visible, pstate->draws.main_count,
+		&pstate->draws.main_batches, &instance_offset);
+
 	typedef struct {
 		float4x4 projection, view;
 		float4 camera_position;
@@ -348,9 +530,12 @@ void draw_main_pass(PermanentState *pstate) {
 	};
 	size_t light_offset = vulkan_buffer_push(pstate->context, pstate->frame_storage_buffer, sizeof(LightData), &light);
 
-	pstate->game_current_frame_global = vulkan_uniformset_push(pstate->context, pstate->phong_shader, 0);
+	pstate->game_current_frame_global = vulkan_uniformset_push(pstate->context, vulkan_frame_recorder(pstate->context), pstate->phong_shader, 0);
 	vulkan_uniformset_bind_buffer_range(pstate->context, pstate->game_current_frame_global, 0, global_offset, sizeof(GlobalData), pstate->frame_uniform_buffer);
 	vulkan_uniformset_bind_buffer_range(pstate->context, pstate->game_current_frame_global, 1, light_offset, sizeof(LightData), pstate->frame_storage_buffer);
+	vulkan_uniformset_bind_buffer_range(
+		pstate->context, pstate->game_current_frame_global, 3,
+		instance_offset, MAX(pstate->draws.main_count, 1) * sizeof(InstanceData), pstate->frame_storage_buffer);
 
 	vulkan_texture_prepare_sample(pstate->context, pstate->shadow_depth_target);
 	vulkan_uniformset_bind_texture(pstate->context, pstate->game_current_frame_global, 2, pstate->shadow_depth_target, pstate->shadow_sampler);
@@ -370,71 +555,47 @@ void draw_main_pass(PermanentState *pstate) {
 		.msaa_level = 8,
 	};
 
-	if (vulkan_drawlist_begin(pstate->context, main_pass)) {
+	uint32_t batch_count = pstate->draws.main_batch_count;
+	uint32_t recorder_count = CLAMP(batch_count / MAIN_PASS_DRAWS_PER_RECORDER, 1, MIN(job_thread_count(), MAX_RECORDERS));
+
+	VulkanRecorder *recorders[MAX_RECORDERS];
+	if (vulkan_drawlist_begin_parallel(pstate->context, main_pass, recorder_count, recorders)) {
 		PipelineDesc pipeline = DEFAULT_PIPELINE;
 		/* pipeline.polygon_mode = POLYGON_MODE_LINE; */
 		pipeline.cull_mode = CULL_MODE_BACK;
 
 		// Entities
-		vulkan_shader_bind(pstate->context, pstate->phong_shader, pipeline);
-		vulkan_uniformset_bind(pstate->context, pstate->game_current_frame_global);
-		EcsIterator iterator = ecs_query(pstate->world, ecs_type_id(TransformComponent), ecs_type_id(MeshComponent));
-
-		Entity entity = 0;
-		while ((entity = ecs_next(&iterator))) {
-			TransformComponent *transform = ecs_find(pstate->world, entity, TransformComponent);
-			MeshComponent *mesh_component = ecs_find(pstate->world, entity, MeshComponent);
-
-			if (mesh_component->mesh_group_index == 0 || mesh_component->mesh_group_index > arena_array_count(pstate->assets.mesh_groups))
-				continue;
-			MeshGroup group = pstate->assets.mesh_groups[mesh_component->mesh_group_index];
-
-			for (uint32_t mesh_index = group.start_index; mesh_index < group.start_index + group.count; ++mesh_index) {
-				Mesh *mesh = &pstate->assets.meshes[mesh_index];
-				uint32_t material_index = pstate->assets.mesh_to_material[mesh_index];
-				Material *material = &pstate->assets.materials[material_index];
-
-				RhiShader shader = material->shader;
-
-				RhiUniformSet group = vulkan_uniformset_push(pstate->context, pstate->phong_shader, 1);
-
-				// TODO: ASSERT on this in the reflection code
-				vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, material->offset, material->size, material->uniform_buffer);
-				for (uint32_t texture_index = 0; texture_index < material->texture_count; ++texture_index) {
-					RhiTexture texture = material->textures[texture_index];
-					if (texture.id == 0)
-						texture = pstate->white;
-
-					vulkan_uniformset_bind_texture(
-						pstate->context,
-						group,
-						1 + texture_index,
-						texture,
-						pstate->nearest_sampler);
-				}
-
-				vulkan_uniformset_bind(pstate->context, group);
-
-				float4x4 model_matrix = transform->world_matrix;
-
-				ASSERT(material->uniform_buffer.id);
-				/* drawlist_push_mesh(list, model_matrix, *mesh, *material); */
-				vulkan_push_constants(pstate->context, 0, sizeof(float4x4), model_matrix.elements);
-
-				vulkan_buffer_bind_vertex(pstate->context, mesh->handle, mesh->vertex_offset);
-				if (mesh->index_count > 0) {
-					vulkan_buffer_bind_index(pstate->context, mesh->handle, mesh->index_offset);
-					vulkan_renderer_draw_indexed(pstate->context, mesh->index_count);
-				} else
-					vulkan_renderer_draw(pstate->context, mesh->vertex_count);
-			}
+		MainPassSlice slices[MAX_RECORDERS];
+		JobDecl jobs[MAX_RECORDERS];
+		for (uint32_t index = 0, first_batch = 0; index < recorder_count; ++index) {
+			uint32_t count = batch_count / recorder_count + (index < batch_count % recorder_count ? 1 : 0);
+			slices[index] = (MainPassSlice){
+				.pstate = pstate,
+				.recorder = recorders[index],
+				.pipeline = pipeline,
+				.first_batch = first_batch,
+				.batch_count = count,
+			};
+			jobs[index] = (JobDecl){ .function = main_pass_record_job, .user_data = &slices[index] };
+			first_batch += count;
 		}
 
-		// Collision shapes
+		JobCounter counter = { 0 };
+		job_run(jobs, recorder_count, &counter);
+		job_wait(&counter);
+
+		// Collision shapes, pushed to the frame buffers as they go so they stay on this thread and land last
+		VulkanRecorder *recorder = recorders[recorder_count - 1];
 		if (pstate->debug_draw_collisions) {
-			vulkan_shader_bind(pstate->context, pstate->screenline_shader, pipeline);
+			vulkan_shader_bind(pstate->context, recorder, pstate->screenline_shader, pipeline);
 			EcsIterator iterator = ecs_query(pstate->world, ecs_type_id(TransformComponent), ecs_type_id(ColliderComponent));
 
+			// NOTE: One set for every shape, each draw only moves its color and outline ranges
+			size_t outline_size = 24 * sizeof(float4);
+			RhiUniformSet group = vulkan_uniformset_push(pstate->context, recorder, pstate->screenline_shader, 1);
+			vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, 0, sizeof(float4), pstate->frame_uniform_buffer);
+			vulkan_uniformset_bind_buffer_range(pstate->context, group, 1, 0, outline_size, pstate->frame_storage_buffer);
+
 			Entity entity;
 			while ((entity = ecs_next(&iterator))) {
 				TransformComponent *transform = ecs_find(pstate->world, entity, TransformComponent);
@@ -484,6 +645,7 @@ void draw_main_pass(PermanentState *pstate) {
 				};
 
 				size_t size = sizeof(outline);
+				ASSERT(size == outline_size);
 
 				RhiBuffer buffer = pstate->frame_storage_buffer;
 				size_t storage_offset = vulkan_buffer_push(pstate->context, buffer, size, NULL);
@@ -496,14 +658,12 @@ void draw_main_pass(PermanentState *pstate) {
 					size, outline);
 
 				float4x4 model_matrix = transform->world_matrix;
-				vulkan_push_constants(pstate->context, 0, sizeof(float4x4), model_matrix.elements);
+				vulkan_push_constants(pstate->context, recorder, 0, sizeof(float4x4), model_matrix.elements);
 
-				RhiUniformSet group = vulkan_uniformset_push(pstate->context, pstate->screenline_shader, 1);
-				vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, uniform_offset, sizeof(float4), pstate->frame_uniform_buffer);
-				vulkan_uniformset_bind_buffer_range(pstate->context, group, 1, storage_offset, size, buffer);
-				vulkan_uniformset_bind(pstate->context, group);
+				uint32_t offsets[] = { (uint32_t)uniform_offset, (uint32_t)storage_offset };
+				vulkan_uniformset_bind_dynamic(pstate->context, recorder, group, offsets);
 
-				vulkan_renderer_draw(pstate->context, (sizeof(outline) / sizeof(float4)) * 6);
+				vulkan_renderer_draw(pstate->context, recorder, (sizeof(outline) / sizeof(float4)) * 6);
 			}
 		}
 
@@ -536,7 +696,7 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 		pstate->frame_storage_buffer = vulkan_buffer_make(pstate->context, BUFFER_USAGE_STORAGE, BUFFER_MEMORY_SHARED, MiB(32), NULL);
 
 		pstate->scene_uniform_buffer = vulkan_buffer_make(pstate->context, BUFFER_USAGE_UNIFORM, BUFFER_MEMORY_SHARED, MiB(32), NULL);
-		pstate->scene_geometry_buffer = vulkan_buffer_make(pstate->context, BUFFER_USAGE_INDEX | BUFFER_USAGE_VERTEX, BUFFER_MEMORY_DEVICE, MiB(128), NULL);
+		pstate->scene_geometry_buffer = vulkan_buffer_make(pstate->context, BUFFER_USAGE_INDEX | BUFFER_USAGE_VERTEX, BUFFER_MEMORY_DEVICE, SCENE_GEOMETRY_CAPACITY, NULL);
 
 		pstate->linear_sampler = vulkan_sampler_make(pstate->context, LINEAR_SAMPLER);
 		pstate->nearest_sampler = vulkan_sampler_make(pstate->context, NEAREST_SAMPLER);
@@ -604,6 +764,9 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 	}
 
 	ArenaTemp scratch = arena_scratch_begin(NULL);
+
+	hot_reload_update(pstate, asset_store_poll_changes(&pstate->store, scratch.arena));
+
 	DrawlistBuffer *drawlist_ui = drawlist_make(scratch.arena, MiB(1));
 	pstate->ui.mouse_left = input_mouse_down(MOUSE_BUTTON_LEFT);
 	pstate->ui.mouse_right = input_mouse_down(MOUSE_BUTTON_RIGHT);
@@ -614,6 +777,8 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 		pstate->game_camera.projection = !pstate->game_camera.projection;
 	if (input_key_pressed(KEY_CODE_M))
 		pstate->debug_draw_collisions = !pstate->debug_draw_collisions;
+	if (input_key_pressed(KEY_CODE_I))
+		pstate->debug_disable_instancing = !pstate->debug_disable_instancing;
 
 	if (input_key_pressed(KEY_CODE_TAB)) {
 		pstate->state = !pstate->state;
@@ -935,6 +1100,18 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 			String fps_text = string_format(scratch.arena, "%.1f", fps);
 			drawlist_push_text(drawlist_ui, &pstate->assets.font[FONT_SIZE_16], fps_text, (float2){ 10, 10 }, rgb(0, 0, 0));
 
+			String cull_text = string_format(
+				scratch.arena, "main %u/%u, shadow %u/%u",
+				pstate->draws.main_stats.visible, pstate->draws.main_stats.tested,
+				pstate->draws.shadow_stats.visible, pstate->draws.shadow_stats.tested);
+			drawlist_push_text(drawlist_ui, &pstate->assets.font[FONT_SIZE_16], cull_text, (float2){ 10, 30 }, rgb(0, 0, 0));
+
+			VulkanBindStats bind_stats = vulkan_bind_stats(pstate->context);
+			String bind_text = string_format(
+				scratch.arena, "binds %u, skipped %u, descriptor writes %u",
+				bind_stats.issued, bind_stats.skipped, bind_stats.descriptor_writes);
+			drawlist_push_text(drawlist_ui, &pstate->assets.font[FONT_SIZE_16], bind_text, (float2){ 10, 50 }, rgb(0, 0, 0));
+
 		} break;
 
 		case GAME_STATE_EDITOR: {
@@ -944,6 +1121,7 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 
 	// Update transforms
 	transform_system_update(pstate->world);
+	draw_items_gather(pstate);
 
 	float2 window_size = float2_from_uint2(window_size_pixel(context->display));
 	if (vulkan_frame_begin(pstate->context, window_size.x, window_size.y)) {
@@ -996,11 +1174,12 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 
 		vulkan_texture_prepare_sample(pstate->context, pstate->main_color_target);
 		vulkan_texture_prepare_sample(pstate->context, pstate->imgui_color_target);
-		if (vulkan_drawlist_begin(pstate->context, composite_pass)) {
+		VulkanRecorder *recorder = vulkan_drawlist_begin(pstate->context, composite_pass);
+		if (recorder) {
 			PipelineDesc pipeline = DEFAULT_PIPELINE;
-			vulkan_shader_bind(pstate->context, pstate->composite_shader, pipeline);
+			vulkan_shader_bind(pstate->context, recorder, pstate->composite_shader, pipeline);
 
-			RhiUniformSet set0 = vulkan_uniformset_push(pstate->context, pstate->composite_shader, 0);
+			RhiUniformSet set0 = vulkan_uniformset_push(pstate->context, recorder, pstate->composite_shader, 0);
 
 			/* RhiTexture output = pstate->imgui_color_target; */
 			/* RhiTexture output = pstate->shadow_depth_target; */
@@ -1009,9 +1188,9 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 			RhiTexture layer1 = pstate->imgui_color_target;
 			vulkan_uniformset_bind_texture(pstate->context, set0, 0, layer0, pstate->linear_sampler);
 			vulkan_uniformset_bind_texture(pstate->context, set0, 1, layer1, pstate->linear_sampler);
-			vulkan_uniformset_bind(pstate->context, set0);
+			vulkan_uniformset_bind(pstate->context, recorder, set0);
 
-			vulkan_renderer_draw(pstate->context, 6);
+			vulkan_renderer_draw(pstate->context, recorder, 6);
 
 			vulkan_drawlist_end(pstate->context);
 		}
@@ -1033,11 +1212,12 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 
 		vulkan_texture_prepare_sample(pstate->context, pstate->output_target);
 		vulkan_texture_prepare_sample(pstate->context, pstate->editor.main_color_target);
-		if (vulkan_drawlist_begin(pstate->context, present_pass)) {
+		recorder = vulkan_drawlist_begin(pstate->context, present_pass);
+		if (recorder) {
 			PipelineDesc pipeline = DEFAULT_PIPELINE;
-			vulkan_shader_bind(pstate->context, pstate->blit_shader, pipeline);
+			vulkan_shader_bind(pstate->context, recorder, pstate->blit_shader, pipeline);
 
-			RhiUniformSet set0 = vulkan_uniformset_push(pstate->context, pstate->blit_shader, 0);
+			RhiUniformSet set0 = vulkan_uniformset_push(pstate->context, recorder, pstate->blit_shader, 0);
 
 			/* RhiTexture output = pstate->imgui_color_target; */
 			/* RhiTexture output = pstate->shadow_depth_target; */
@@ -1046,9 +1226,9 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 			if (pstate->state == GAME_STATE_EDITOR)
 				output = pstate->editor.main_color_target;
 			vulkan_uniformset_bind_texture(pstate->context, set0, 0, output, pstate->linear_sampler);
-			vulkan_uniformset_bind(pstate->context, set0);
+			vulkan_uniformset_bind(pstate->context, recorder, set0);
 
-			vulkan_renderer_draw(pstate->context, 6);
+			vulkan_renderer_draw(pstate->context, recorder, 6);
 
 			vulkan_drawlist_end(pstate->context);
 		}
@@ -1068,9 +1248,18 @@ FrameInfo update_and_draw(GameContext *context, float dt) {
 	return (FrameInfo){ 0 };
 }
 
+void shutdown_game(GameContext *context) {
+	PermanentState *pstate = context->permanent_memory;
+	if (pstate->initialized == false)
+		return;
+
+	asset_store_unwatch(&pstate->store);
+}
+
 GameInterface game_hookup(void) {
 	GameInterface interface = (GameInterface){
 		.on_update = update_and_draw,
+		.on_shutdown = shutdown_game,
 	};
 	return interface;
 }
@@ -1531,35 +1720,17 @@ void editor_draw(PermanentState *pstate, Editor *editor) {
 		.use_depth = true,
 	};
 
-	if (vulkan_drawlist_begin(pstate->context, picker_pass)) {
+	VulkanRecorder *recorder = vulkan_drawlist_begin(pstate->context, picker_pass);
+	if (recorder) {
 		PipelineDesc pipeline = DEFAULT_PIPELINE;
-		vulkan_shader_bind(pstate->context, pstate->picker_shader, pipeline);
-		vulkan_uniformset_bind(pstate->context, pstate->game_current_frame_global);
-
-		EcsIterator iterator = ecs_query(pstate->world, ecs_type_id(TransformComponent), ecs_type_id(MeshComponent));
-		Entity entity;
-		while ((entity = ecs_next(&iterator))) {
-			TransformComponent *transform = ecs_find(pstate->world, entity, TransformComponent);
-			MeshComponent *mesh_component = ecs_find(pstate->world, entity, MeshComponent);
-
-			if (mesh_component->mesh_group_index == 0 || mesh_component->mesh_group_index > arena_array_count(pstate->assets.mesh_groups))
-				continue;
-			MeshGroup group = pstate->assets.mesh_groups[mesh_component->mesh_group_index];
-
-			vulkan_push_constants(pstate->context, sizeof(float4x4), sizeof(uint32_t), &entity);
-
-			for (uint32_t mesh_index = group.start_index; mesh_index < group.start_index + group.count; ++mesh_index) {
-				Mesh *mesh = &pstate->assets.meshes[mesh_index];
-				float4x4 model_matrix = transform->world_matrix;
-				vulkan_push_constants(pstate->context, 0, sizeof(float4x4), model_matrix.elements);
-
-				vulkan_buffer_bind_vertex(pstate->context, mesh->handle, mesh->vertex_offset);
-				if (mesh->index_count > 0) {
-					vulkan_buffer_bind_index(pstate->context, mesh->handle, mesh->index_offset);
-					vulkan_renderer_draw_indexed(pstate->context, mesh->index_count);
-				} else
-					vulkan_renderer_draw(pstate->context, mesh->vertex_count);
-			}
+		vulkan_shader_bind(pstate->context, recorder, pstate->picker_shader, pipeline);
+		vulkan_uniformset_bind(pstate->context, recorder, pstate->game_current_frame_global);
+		geometry_bind(pstate, recorder, pstate->scene_geometry_buffer);
+
+		// NOTE: Same camera as the main pass, its batches and instance buffer (bound in the global set) are reused
+		for (uint32_t batch_index = 0; batch_index < pstate->draws.main_batch_count; ++batch_index) {
+			DrawBatch *batch = &pstate->draws.main_batches[batch_index];
+			mesh_draw_instanced(pstate, recorder, &pstate->assets.meshes[batch->mesh_index], batch->instance_count, batch->first_instance);
 		}
 		vulkan_drawlist_end(pstate->context);
 	}
@@ -1593,10 +1764,18 @@ void editor_draw(PermanentState *pstate, Editor *editor) {
 		.viewport = pstate->viewport,
 		.color_attachment_count = 1,
 	};
-	if (vulkan_drawlist_begin(pstate->context, debug_lines_pass)) {
+	recorder = vulkan_drawlist_begin(pstate->context, debug_lines_pass);
+	if (recorder) {
 		PipelineDesc pipeline = DEFAULT_PIPELINE;
-		vulkan_shader_bind(pstate->context, pstate->screenline_shader, pipeline);
-		vulkan_uniformset_bind(pstate->context, pstate->game_current_frame_global);
+		vulkan_shader_bind(pstate->context, recorder, pstate->screenline_shader, pipeline);
+		vulkan_uniformset_bind(pstate->context, recorder, pstate->game_current_frame_global);
+
+		// NOTE: One set for every selection box, each draw only moves its color and point ranges
+		uint32_t line_segment_count = 24;
+		size_t line_segment_size = 2 * sizeof(float4);
+		RhiUniformSet selection_group = vulkan_uniformset_push(pstate->context, recorder, pstate->screenline_shader, 1);
+		vulkan_uniformset_bind_buffer_range(pstate->context, selection_group, 0, 0, sizeof(float4), pstate->frame_uniform_buffer);
+		vulkan_uniformset_bind_buffer_range(pstate->context, selection_group, 1, 0, line_segment_count * line_segment_size, pstate->frame_storage_buffer);
 
 		for (uint32_t index = 0; index < editor->selected_entity_count; ++index) {
 			Entity entity = editor->selected_entities[index];
@@ -1620,8 +1799,6 @@ void editor_draw(PermanentState *pstate, Editor *editor) {
 				max = float3_scale(transform->scale, 0.5f);
 			}
 
-			uint32_t line_segment_count = 24;
-			size_t line_segment_size = 2 * sizeof(float4);
 			size_t size = line_segment_count * line_segment_size;
 
 			RhiBuffer buffer = pstate->frame_storage_buffer;
@@ -1715,16 +1892,15 @@ void editor_draw(PermanentState *pstate, Editor *editor) {
 			float4x4 model_matrix = transform->world_matrix;
 			float4 color = entity == editor->active_entity ? (float4){ 1.0f, 0.2f, 0.2f, 1.0f } : (float4){ 1.0f, 0.5f, 0.3f, 1.0f };
 
-			vulkan_push_constants(pstate->context, 0, sizeof(float4x4), model_matrix.elements);
+			vulkan_push_constants(pstate->context, recorder, 0, sizeof(float4x4), model_matrix.elements);
 			size_t uniform_offset = vulkan_buffer_push(pstate->context, pstate->frame_uniform_buffer, sizeof(float4), &color);
-			size_t point_offset = vulkan_buffer_push(pstate->context, pstate->frame_storage_buffer, sizeof(selection), selection);
+			ASSERT(sizeof(selection) == size);
+			size_t point_offset = vulkan_buffer_push(pstate->context, buffer, size, selection);
 
-			RhiUniformSet group = vulkan_uniformset_push(pstate->context, pstate->screenline_shader, 1);
-			vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, uniform_offset, sizeof(float4), pstate->frame_uniform_buffer);
-			vulkan_uniformset_bind_buffer_range(pstate->context, group, 1, point_offset, sizeof(selection), pstate->frame_storage_buffer);
-			vulkan_uniformset_bind(pstate->context, group);
+			uint32_t offsets[] = { (uint32_t)uniform_offset, (uint32_t)point_offset };
+			vulkan_uniformset_bind_dynamic(pstate->context, recorder, selection_group, offsets);
 
-			vulkan_renderer_draw(pstate->context, line_segment_count * 2 * 6);
+			vulkan_renderer_draw(pstate->context, recorder, line_segment_count * 2 * 6);
 		}
 
 		if (editor->adding) {
@@ -1746,16 +1922,16 @@ void editor_draw(PermanentState *pstate, Editor *editor) {
 			float4x4 model_matrix = float4x4_identity();
 			float4 color = (float4){ 0.0f, 0.0f, 0.0f, 1.0f };
 
-			vulkan_push_constants(pstate->context, 0, sizeof(float4x4), model_matrix.elements);
+			vulkan_push_constants(pstate->context, recorder, 0, sizeof(float4x4), model_matrix.elements);
 			size_t uniform_offset = vulkan_buffer_push(pstate->context, pstate->frame_uniform_buffer, sizeof(float4), &color);
 			size_t point_offset = vulkan_buffer_push(pstate->context, pstate->frame_storage_buffer, size, scratch.arena->base);
 
-			RhiUniformSet group = vulkan_uniformset_push(pstate->context, pstate->screenline_shader, 1);
+			RhiUniformSet group = vulkan_uniformset_push(pstate->context, recorder, pstate->screenline_shader, 1);
 			vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, uniform_offset, sizeof(float4), pstate->frame_uniform_buffer);
 			vulkan_uniformset_bind_buffer_range(pstate->context, group, 1, point_offset, size, pstate->frame_storage_buffer);
-			vulkan_uniformset_bind(pstate->context, group);
+			vulkan_uniformset_bind(pstate->context, recorder, group);
 
-			vulkan_renderer_draw(pstate->context, (slices + 1) * 2 * 6);
+			vulkan_renderer_draw(pstate->context, recorder, (slices + 1) * 2 * 6);
 
 			arena_temp_end(scratch);
 		}
@@ -1766,7 +1942,9 @@ void editor_draw(PermanentState *pstate, Editor *editor) {
 
 static inline void calculate_transforms(ECS *world, Entity entity, float4x4 parent_global) {
 	TransformComponent *transform = ecs_find(world, entity, TransformComponent);
-	transform->world_matrix = float4x4_multiply(parent_global, float4x4_compose(transform->position, transform->rotation, transform->scale));
+	float4x4 local;
+	float4x4_compose_into(&local, transform->position, transform->rotation, transform->scale);
+	float4x4_multiply_into(&transform->world_matrix, &parent_global, &local);
 
 	HierarchyComponent *node = ecs_find(world, entity, HierarchyComponent);
 	if (node && node->first_child) {
@@ -1795,7 +1973,7 @@ void mesh_system_update(ECS *world, PermanentState *pstate) {
 	Entity entity;
 
 	while ((entity = ecs_next(&it))) {
-		MeshComponent *mesh = ecs_find(world, entity, MeshComponent);
+		MeshComponent *mesh = ecs_field(&it, MeshComponent);
 		if (mesh->mesh_group_index)
 			continue;
 
@@ -1811,22 +1989,153 @@ void mesh_system_update(ECS *world, PermanentState *pstate) {
 	}
 }
 
-static inline RhiShader load_shader(VulkanContext *context, String name, String vertex, String fragment) {
-	ArenaTemp scratch = arena_scratch_begin(NULL);
-	String vertex_path = string_format(scratch.arena, "assets/shaders/vertex/bin/%.*s.vertex.spv", SARG(vertex));
-	String fragment_path = string_format(scratch.arena, "assets/shaders/fragment/bin/%.*s.fragment.spv", SARG(fragment));
-	ShaderSource source = importer_load_shader(scratch.arena, vertex_path, fragment_path);
+void draw_items_gather(PermanentState *pstate) {
+	uint32_t group_count = arena_array_count(pstate->assets.mesh_groups);
+
+	uint32_t capacity = 0;
+	EcsIterator it = ecs_query(pstate->world, ecs_type_id(TransformComponent), ecs_type_id(MeshComponent));
+	while (ecs_next(&it)) {
+		MeshComponent *mesh_component = ecs_field(&it, MeshComponent);
+		if (mesh_component->mesh_group_index && mesh_component->mesh_group_index < group_count)
+			capacity += pstate->assets.mesh_groups[mesh_component->mesh_group_index].count;
+	}
+
+	pstate->draws.items = arena_push_count(pstate->frame_arena, capacity, DrawItem);
+	pstate->draws.bounds = arena_push_count(pstate->frame_arena, capacity, Interval3);
+	pstate->draws.worlds = arena_push_count(pstate->frame_arena, capacity, float4x4);
+	pstate->draws.main_visible = arena_push_count(pstate->frame_arena, capacity, uint32_t);
+	pstate->draws.shadow_visible = arena_push_count(pstate->frame_arena, capacity, uint32_t);
+	pstate->draws.count = pstate->draws.main_count = pstate->draws.shadow_count = 0;
+
+	it = ecs_query(pstate->world, ecs_type_id(TransformComponent), ecs_type_id(MeshComponent));
+	Entity entity;
+	while ((entity = ecs_next(&it))) {
+		TransformComponent *transform = ecs_field(&it, TransformComponent);
+		MeshComponent *mesh_component = ecs_field(&it, MeshComponent);
+
+		if (mesh_component->mesh_group_index == 0 || mesh_component->mesh_group_index >= group_count)
+			continue;
+		MeshGroup group = pstate->assets.mesh_groups[mesh_component->mesh_group_index];
+
+		for (uint32_t mesh_index = group.start_index; mesh_index < group.start_index + group.count; ++mesh_index) {
+			uint32_t index = pstate->draws.count++;
+			pstate->draws.items[index] = (DrawItem){ .entity = entity, .mesh_index = mesh_index };
+			pstate->draws.bounds[index] = pstate->assets.mesh_bounds[mesh_index];
+			pstate->draws.worlds[index] = transform->world_matrix;
+		}
+	}
+}
+
+static uint64_t draw_key_make(DrawPass pass, bool translucent, uint32_t shader, uint32_t material, uint32_t mesh, float depth) {
+	ASSERT(shader < (1u << DRAW_KEY_SHADER_BITS) && material < (1u << DRAW_KEY_MATERIAL_BITS) && mesh < (1u << DRAW_KEY_MESH_BITS));
+
+	uint64_t depth_max = (1ull << DRAW_KEY_DEPTH_BITS) - 1;
+	uint64_t quantized = (uint64_t)(CLAMP(depth, 0.0f, 1.0f) * (float)depth_max);
+
+	uint64_t state = ((uint64_t)shader << (DRAW_KEY_MATERIAL_BITS + DRAW_KEY_MESH_BITS)) |
+		((uint64_t)material << DRAW_KEY_MESH_BITS) | mesh;
+	uint64_t key = (uint64_t)pass << 62;
+	if (translucent)
+		return key | (1ull << 61) | ((depth_max - quantized) << 42) | state;
+
+	return key | (state << DRAW_KEY_DEPTH_BITS) | quantized;
+}
+
+// Radix sorts the visible items by key, every run of one mesh becomes a single instanced draw unless
+// debug_disable_instancing is set. Depth is the distance from eye to the center of the item's bounds over far
+uint32_t draw_batches_build(
+	PermanentState *pstate, DrawPass pass, float3 eye, float far,
+	uint32_t *visible, uint32_t visible_count, DrawBatch **out_batches, size_t *out_instance_offset) {
+	ArenaTemp scratch = arena_scratch_begin(pstate->frame_arena);
+
+	uint64_t *keys = arena_push_count(scratch.arena, MAX(visible_count, 1), uint64_t);
+	uint32_t *order = arena_push_count(scratch.arena, MAX(visible_count, 1), uint32_t);
+	for (uint32_t index = 0; index < visible_count; ++index) {
+		uint32_t item_index = visible[index];
+		uint32_t mesh_index = pstate->draws.items[item_index].mesh_index;
+
+		Interval3 bounds = pstate->draws.bounds[item_index];
+		float3 center = float4x4_transform_point(&pstate->draws.worlds[item_index], float3_scale(float3_add(bounds.min, bounds.max), 0.5f));
+		float depth = float3_length(float3_subtract(center, eye)) / far;
+
+		// NOTE: The shadow pass draws everything with one shader and no material, so it only groups by mesh.
+		// Materials have no blend mode yet, everything is sorted as opaque
+		uint32_t shader = 0, material = 0;
+		if (pass == DRAW_PASS_MAIN) {
+			material = pstate->assets.mesh_to_material[mesh_index];
+			shader = pstate->assets.materials[material].shader.id;
+		}
+
+		keys[index] = draw_key_make(pass, false, shader, material, mesh_index, depth);
+		order[index] = item_index;
+	}
+
+	radix_sort64(keys, order, visible_count);
+
+	DrawBatch *batches = arena_push_count(pstate->frame_arena, MAX(visible_count, 1), DrawBatch);
+	InstanceData *instances = arena_push_count(scratch.arena, MAX(visible_count, 1), InstanceData);
+	uint32_t batch_count = draw_batches_group(
+		pstate->draws.items, pstate->draws.worlds, pstate->assets.mesh_to_material,
+		order, visible_count, pstate->debug_disable_instancing == false,
+		batches, instances);
+
+	*out_batches = batches;
+	*out_instance_offset = vulkan_buffer_push(pstate->context, pstate->frame_storage_buffer, MAX(visible_count, 1) * sizeof(InstanceData), instances);
+
+	arena_scratch_end(scratch);
+	return batch_count;
+}
+
+static void shader_import_job(void *user_data) {
+	ShaderImport *import = user_data;
+	import->source = (ShaderSource){
+		.vertex_path = import->vertex_path,
+		.fragment_path = import->fragment_path,
+		.vertex = asset_store_read(import->store, &import->arena, import->vertex_path),
+		.fragment = asset_store_read(import->store, &import->arena, import->fragment_path),
+	};
+}
+
+static void font_import_job(void *user_data) {
+	FontImport *import = user_data;
+	Buffer file = asset_store_read(import->store, &import->arena, import->path);
+	import->font = importer_load_font_memory(&import->arena, file, import->size);
+}
+
+static void model_import_job(void *user_data) {
+	ModelImport *import = user_data;
+	Buffer file = asset_store_read(import->store, &import->arena, import->path);
+	import->source = importer_load_gltf_scene_memory(&import->arena, import->path, file);
+}
+
+static inline ShaderImport shader_import(Arena *arena, AssetStore *store, String vertex, String fragment) {
+	return (ShaderImport){
+		.store = store,
+		.vertex_path = string_format(arena, "assets/shaders/vertex/bin/%.*s.vertex.spv", SARG(vertex)),
+		.fragment_path = string_format(arena, "assets/shaders/fragment/bin/%.*s.fragment.spv", SARG(fragment)),
+		.arena = arena_reserve(MiB(64), ARENA_FLAG_NONE),
+	};
+}
+
+static inline RhiShader load_shader(VulkanContext *context, String name, ShaderImport *import) {
 	RhiShader result =
 		vulkan_shader_make(
 			NULL,
 			context,
 			name,
-			source.vertex, source.fragment,
+			import->source.vertex, import->source.fragment,
 			NULL);
 
-	arena_scratch_end(scratch);
+	arena_destroy(&import->arena);
 	return result;
 }
+
+// NOTE: Parameters only change on reload, which keeps their range, so the set is written once
+static void material_set_make(PermanentState *pstate, Material *material) {
+	material->set = vulkan_uniformset_make(pstate->context, material->shader, 1);
+	vulkan_uniformset_bind_buffer_range(pstate->context, material->set, 0, material->offset, material->size, material->uniform_buffer);
+}
+
 void load_assets(PermanentState *pstate) {
 	// :assets
 	ArenaTemp scratch = arena_scratch_begin(NULL);
@@ -1837,52 +2146,113 @@ void load_assets(PermanentState *pstate) {
 		asset_store_deserialize(store, S("assets/asset_manifest.json"));
 	else
 		asset_store_track_directory(store, S("assets/"));
+	if (file_exists(S("assets/assets.pak")))
+		asset_store_mount_pack(store, S("assets/assets.pak"));
+	asset_store_watch(store);
 
 	UUID unlit_generated = uuid_generate();
 	UUID unlit = asset_store_find(store, ASSET_TYPE_shader, S("shaders/bin/unlit.glsl"));
 
 	UUID wall = asset_store_find(store, ASSET_TYPE_geometry, S("assets/models/kenney/modular_dungeon/room-large.glb"));
 
-	ShaderSource source = { 0 };
-
-	pstate->shadow_shader = load_shader(pstate->context, S("shadow_shader"), S("shadow"), S("blank"));
+	double import_start = platform_time();
 
-	pstate->unlit_shader = load_shader(pstate->context, S("unlit_shader"), S("basic"), S("unlit"));
-	pstate->picker_shader = load_shader(pstate->context, S("picker_shader"), S("basic"), S("picker"));
+	// :shader
+	ShaderImport shaders[] = {
+		shader_import(scratch.arena, store, S("shadow"), S("blank")),
+		shader_import(scratch.arena, store, S("basic"), S("unlit")),
+		shader_import(scratch.arena, store, S("basic"), S("picker")),
+		shader_import(scratch.arena, store, S("base"), S("phong")),
+		shader_import(scratch.arena, store, S("line"), S("flat")),
+		shader_import(scratch.arena, store, S("quad"), S("postfx")),
+		shader_import(scratch.arena, store, S("quad"), S("blit")),
+		shader_import(scratch.arena, store, S("batch"), S("vertex_color")),
+		shader_import(scratch.arena, store, S("batch"), S("textured")),
+		shader_import(scratch.arena, store, S("quad"), S("composite")),
+	};
 
-	pstate->phong_shader = load_shader(pstate->context, S("phong_shader"), S("base"), S("phong"));
-	pstate->screenline_shader = load_shader(pstate->context, S("screenline_shader"), S("line"), S("flat"));
+	FontImport fonts[FONT_SIZE_MAX];
+	for (uint32_t index = FONT_SIZE_16; index < FONT_SIZE_MAX; ++index) {
+		fonts[index] = (FontImport){
+			.store = store,
+			.path = S("assets/pokemon/graphics/fonts/PixeloidSans.ttf"),
+			.size = 1 << (index + 4),
+			.arena = arena_reserve(MiB(64), ARENA_FLAG_NONE),
+		};
+	}
 
-	pstate->postfx_shader = load_shader(pstate->context, S("postfx_shader"), S("quad"), S("postfx"));
-	pstate->blit_shader = load_shader(pstate->context, S("blit_shader"), S("quad"), S("blit"));
-	pstate->quad_shader = load_shader(pstate->context, S("quad_shader"), S("batch"), S("vertex_color"));
-	pstate->quad_textured_shader = load_shader(pstate->context, S("textured_quad_shader"), S("batch"), S("textured"));
-	pstate->composite_shader = load_shader(pstate->context, S("composite_shader"), S("quad"), S("composite"));
-	// :shader
+	// TODO: Import the node transforms & cache shared textures
+	String model_paths[] = {
+		S("assets/models/kenney/modular_dungeon/room-large.glb"),
+		S("assets/models/kenney/modular_dungeon/room-small.glb"),
+		S("assets/models/kenney/modular_dungeon/corridor.glb"),
+		S("assets/models/kenney/modular_dungeon/gate-door.glb"),
+		S("assets/models/characters/gdbot.glb"),
+		S("assets/models/kenney/survival_kit/rock-a.glb"),
+		S("assets/models/kenney/survival_kit/rock-b.glb"),
+		S("assets/models/kenney/survival_kit/tool-pickaxe.glb"),
+		// :model
+	};
+	ModelImport imports[countof(model_paths)];
+	for (uint32_t index = 0; index < countof(model_paths); ++index)
+		imports[index] = (ModelImport){ .store = store, .path = model_paths[index], .arena = arena_reserve(GiB(1), ARENA_FLAG_NONE) };
+
+	JobDecl *jobs = NULL;
+	for (uint32_t index = 0; index < countof(imports); ++index)
+		arena_darray_put(scratch.arena, jobs, JobDecl, { model_import_job, &imports[index] });
+	for (uint32_t index = FONT_SIZE_16; index < FONT_SIZE_MAX; ++index)
+		arena_darray_put(scratch.arena, jobs, JobDecl, { font_import_job, &fonts[index] });
+	for (uint32_t index = 0; index < countof(shaders); ++index)
+		arena_darray_put(scratch.arena, jobs, JobDecl, { shader_import_job, &shaders[index] });
+
+	JobCounter import_counter = { 0 };
+	job_run(jobs, arena_array_count(jobs), &import_counter);
+	job_wait(&import_counter);
+
+	double upload_start = platform_time();
+
+	pstate->shadow_shader = load_shader(pstate->context, S("shadow_shader"), &shaders[0]);
+
+	pstate->unlit_shader = load_shader(pstate->context, S("unlit_shader"), &shaders[1]);
+	pstate->picker_shader = load_shader(pstate->context, S("picker_shader"), &shaders[2]);
+
+	pstate->phong_shader = load_shader(pstate->context, S("phong_shader"), &shaders[3]);
+	pstate->screenline_shader = load_shader(pstate->context, S("screenline_shader"), &shaders[4]);
+
+	pstate->postfx_shader = load_shader(pstate->context, S("postfx_shader"), &shaders[5]);
+	pstate->blit_shader = load_shader(pstate->context, S("blit_shader"), &shaders[6]);
+	pstate->quad_shader = load_shader(pstate->context, S("quad_shader"), &shaders[7]);
+	pstate->quad_textured_shader = load_shader(pstate->context, S("textured_quad_shader"), &shaders[8]);
+	pstate->composite_shader = load_shader(pstate->context, S("composite_shader"), &shaders[9]);
+
+	// Same order as shaders[] above
+	RhiShader loaded_shaders[countof(shaders)] = {
+		pstate->shadow_shader, pstate->unlit_shader, pstate->picker_shader, pstate->phong_shader, pstate->screenline_shader,
+		pstate->postfx_shader, pstate->blit_shader, pstate->quad_shader, pstate->quad_textured_shader, pstate->composite_shader
+	};
+	ShaderRecord *shader_records = NULL;
+	for (uint32_t index = 0; index < countof(shaders); ++index) {
+		arena_darray_put(scratch.arena, shader_records, ShaderRecord,
+			{
+			  .shader = loaded_shaders[index],
+			  .vertex_path = string_copy(&pstate->persistent_arena, shaders[index].vertex_path),
+			  .fragment_path = string_copy(&pstate->persistent_arena, shaders[index].fragment_path),
+			});
+	}
 
 	for (uint32_t index = FONT_SIZE_16; index < FONT_SIZE_MAX; ++index) {
 		Font *font = &pstate->assets.font[index];
-		*font = importer_load_font(&pstate->persistent_arena, S("assets/pokemon/graphics/fonts/PixeloidSans.ttf"), 1 << (index + 4));
+		*font = fonts[index].font;
+		font->glyphs = arena_push_copy(&pstate->persistent_arena, font->glyphs, sizeof(Glyph) * 128, alignof(Glyph));
 		font->atlas = vulkan_texture_make(
 			pstate->context,
 			font->atlas_src.width, font->atlas_src.height,
 			TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_SAMPLED,
 			font->atlas_src.pixels);
+		font->atlas_src.pixels = NULL;
+		arena_destroy(&fonts[index].arena);
 	}
 
-	// TODO: Import the node transforms & cache shared textures
-	SceneSource models[] = {
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/modular_dungeon/room-large.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/modular_dungeon/room-small.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/modular_dungeon/corridor.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/modular_dungeon/gate-door.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/characters/gdbot.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/survival_kit/rock-a.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/survival_kit/rock-b.glb")),
-		importer_load_gltf_scene(scratch.arena, S("assets/models/kenney/survival_kit/tool-pickaxe.glb")),
-		// :model
-	};
-
 	// Prep Upload
 	RhiTexture *textures = NULL;
 	Material *materials = NULL;
@@ -1890,7 +2260,9 @@ void load_assets(PermanentState *pstate) {
 	Mesh *meshes = NULL;
 	uint32_t *mesh_to_material = NULL;
 	Interval3 *mesh_group_bounds = NULL;
+	Interval3 *mesh_bounds = NULL;
 	MeshGroup *mesh_groups = NULL;
+	ModelRecord *model_records = NULL;
 
 	// Defaults
 	arena_darray_push(scratch.arena, mesh_groups, uint32x2); // 0 == invalid
@@ -1902,26 +2274,42 @@ void load_assets(PermanentState *pstate) {
 		.base_color_factor = default_properties[5].as.float32x4,
 		.metallic_factor = default_properties[6].as.float32x1,
 		.roughness_factor = default_properties[7].as.float32x1,
-		.emissive_factor = default_properties[8].as.float32x3
+		.emissive_factor = default_properties[8].as.float32x3,
+		.sampler = vulkan_sampler_bindless_index(pstate->context, pstate->nearest_sampler),
 	};
-	for (uint32_t texture_index = 0; texture_index < 5; ++texture_index) {
+	for (uint32_t texture_index = 0; texture_index < MATERIAL_TEXTURE_COUNT; ++texture_index) {
 		default_mat->textures[texture_index] = textures[0];
 		default_mat->texture_count++;
+
+		parameters.textures[texture_index] = vulkan_texture_bindless_index(pstate->context, pstate->white);
 	}
 	size_t size = sizeof(MaterialParameters);
 	default_mat->uniform_buffer = pstate->scene_uniform_buffer;
 	size_t offset = vulkan_buffer_push(pstate->context, default_mat->uniform_buffer, size, NULL);
 	default_mat->offset = offset, default_mat->size = size;
 	vulkan_buffer_write_all(pstate->context, default_mat->uniform_buffer, default_mat->offset, default_mat->size, &parameters);
+	material_set_make(pstate, default_mat);
 
 	Arena *geometry_upload_arena = arena_partition(scratch.arena, MiB(32));
-	for (uint32_t model_index = 0; model_index < countof(models); ++model_index) {
-		SceneSource *model = &models[model_index];
+	for (uint32_t model_index = 0; model_index < countof(imports); ++model_index) {
+		SceneSource *model = &imports[model_index].source;
 
 		uint32_t mesh_offset = arena_array_count(meshes);
 		uint32_t material_offset = arena_array_count(materials);
 		uint32_t texture_offset = arena_array_count(textures);
 
+		arena_darray_put(scratch.arena, model_records, ModelRecord,
+			{
+			  .path = string_copy(&pstate->persistent_arena, model->path),
+			  .dependencies = importer_gltf_dependencies(&pstate->persistent_arena, model->path),
+			  .group_index = arena_array_count(mesh_groups),
+			  .mesh_offset = mesh_offset,
+			  .mesh_count = model->mesh_count,
+			  .texture_offset = texture_offset,
+			  .texture_count = model->image_count,
+			  .geometry_size = model->vertices_size + model->indices_size,
+			});
+
 		for (uint32_t image_index = 0; image_index < model->image_count; ++image_index) {
 			ImageSource *src = &model->images[image_index];
 			RhiTexture *dst = arena_darray_push(scratch.arena, textures, RhiTexture);
@@ -1944,26 +2332,33 @@ void load_assets(PermanentState *pstate) {
 				.base_color_factor = src->properties[5].as.float32x4,
 				.metallic_factor = src->properties[6].as.float32x1,
 				.roughness_factor = src->properties[7].as.float32x1,
-				.emissive_factor = src->properties[8].as.float32x3
+				.emissive_factor = src->properties[8].as.float32x3,
+				.sampler = vulkan_sampler_bindless_index(pstate->context, pstate->nearest_sampler),
 			};
 
-			for (uint32_t texture_index = 0; texture_index < 5; ++texture_index) {
+			for (uint32_t texture_index = 0; texture_index < MATERIAL_TEXTURE_COUNT; ++texture_index) {
 				MaterialProperty *property = &src->properties[texture_index];
 				dst->textures[texture_index] = textures[0];
 				if (property->as.uint32x1)
 					dst->textures[texture_index] = textures[(property->as.uint32x1 - 1) + texture_offset];
 
 				dst->texture_count++;
+
+				RhiTexture texture = dst->textures[texture_index].id ? dst->textures[texture_index] : pstate->white;
+				parameters.textures[texture_index] = vulkan_texture_bindless_index(pstate->context, texture);
 			}
 
 			size_t size = sizeof(MaterialParameters);
 			size_t offset = vulkan_buffer_push(pstate->context, dst->uniform_buffer, size, NULL);
 			dst->offset = offset, dst->size = size;
 			vulkan_buffer_write_all(pstate->context, dst->uniform_buffer, dst->offset, dst->size, &parameters);
+			material_set_make(pstate, dst);
 		}
 
+		arena_push(geometry_upload_arena, geometry_vertex_align(geometry_upload_arena->offset) - geometry_upload_arena->offset, 1, true);
 		size_t vertex_offset = geometry_upload_arena->offset;
 		size_t index_offset = vertex_offset + model->vertices_size;
+		model_records[arena_array_count(model_records) - 1].geometry_offset = vertex_offset;
 		Interval3 largest = {
 			.min = float3_fill(FLOAT_MAX),
 			.max = float3_fill(FLOAT_MIN),
@@ -1971,6 +2366,7 @@ void load_assets(PermanentState *pstate) {
 		for (uint32_t mesh_index = 0; mesh_index < model->mesh_count; ++mesh_index) {
 			MeshSource *src = &model->meshes[mesh_index];
 			Mesh *dst = arena_darray_push(scratch.arena, meshes, Mesh);
+			arena_darray_put(scratch.arena, mesh_bounds, Interval3, model->bounding_boxes[mesh_index]);
 
 			size_t vertices_size = src->vertex_size * src->vertex_count;
 			size_t indices_size = src->index_size * src->index_count;
@@ -1982,6 +2378,8 @@ void load_assets(PermanentState *pstate) {
 
 			dst->vertex_offset = vertex_offset;
 			dst->index_offset = index_offset;
+			dst->base_vertex = (int32_t)(vertex_offset / sizeof(Vertex3));
+			dst->first_index = (uint32_t)(index_offset / sizeof(uint32_t));
 			vertex_offset += vertices_size;
 			index_offset += indices_size;
 
@@ -2027,11 +2425,14 @@ void load_assets(PermanentState *pstate) {
 		Mesh *cube_mesh = arena_darray_push(scratch.arena, meshes, Mesh);
 		cube_mesh->handle = pstate->scene_geometry_buffer;
 		cube_mesh->vertex_count = cube.vertex_count;
+		arena_push(geometry_upload_arena, geometry_vertex_align(geometry_upload_arena->offset) - geometry_upload_arena->offset, 1, true);
 		cube_mesh->vertex_offset = geometry_upload_arena->offset;
+		cube_mesh->base_vertex = (int32_t)(cube_mesh->vertex_offset / sizeof(Vertex3));
 		arena_push_copy(geometry_upload_arena, cube.vertices, cube.vertex_size * cube.vertex_count, 1);
 
 		arena_darray_put(scratch.arena, mesh_to_material, uint32_t, 0);
 		arena_darray_put(scratch.arena, mesh_group_bounds, Interval3, cube_bounds);
+		arena_darray_put(scratch.arena, mesh_bounds, Interval3, cube_bounds);
 	}
 	{
 		MeshSource quad_src = mesh_source_quad3(scratch.arena, (float3){ 0.0f, 0.5f, 0.0f }, 1.0f);
@@ -2050,11 +2451,14 @@ void load_assets(PermanentState *pstate) {
 		Mesh *quad_mesh = arena_darray_push(scratch.arena, meshes, Mesh);
 		quad_mesh->handle = pstate->scene_geometry_buffer;
 		quad_mesh->vertex_count = quad_src.vertex_count;
+		arena_push(geometry_upload_arena, geometry_vertex_align(geometry_upload_arena->offset) - geometry_upload_arena->offset, 1, true);
 		quad_mesh->vertex_offset = geometry_upload_arena->offset;
+		quad_mesh->base_vertex = (int32_t)(quad_mesh->vertex_offset / sizeof(Vertex3));
 		arena_push_copy(geometry_upload_arena, quad_src.vertices, quad_src.vertex_size * quad_src.vertex_count, 1);
 
 		arena_darray_put(scratch.arena, mesh_to_material, uint32_t, 0);
 		arena_darray_put(scratch.arena, mesh_group_bounds, Interval3, quad_bounds);
+		arena_darray_put(scratch.arena, mesh_bounds, Interval3, quad_bounds);
 	}
 	// :generated
 
@@ -2063,15 +2467,266 @@ void load_assets(PermanentState *pstate) {
 	pstate->assets.materials = arena_array_copy(&pstate->persistent_arena, materials, Material);
 	pstate->assets.mesh_to_material = arena_array_copy(&pstate->persistent_arena, mesh_to_material, uint32_t);
 	pstate->assets.mesh_group_bounds = arena_array_copy(&pstate->persistent_arena, mesh_group_bounds, Interval3);
+	pstate->assets.mesh_bounds = arena_array_copy(&pstate->persistent_arena, mesh_bounds, Interval3);
 	pstate->assets.mesh_groups = arena_array_copy(&pstate->persistent_arena, mesh_groups, MeshGroup);
 
+	pstate->reload.models = arena_array_copy(&pstate->persistent_arena, model_records, ModelRecord);
+	pstate->reload.shaders = arena_array_copy(&pstate->persistent_arena, shader_records, ShaderRecord);
+	pstate->reload.arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+
 	// Upload all geometry once
 	vulkan_buffer_push(pstate->context, pstate->scene_geometry_buffer, geometry_upload_arena->offset, geometry_upload_arena->base);
 
+	for (uint32_t model_index = 0; model_index < countof(imports); ++model_index) {
+		importer_unload_scene(&imports[model_index].source);
+		arena_destroy(&imports[model_index].arena);
+	}
+
+	double import_end = platform_time();
+	LOG_INFO("Assets: imported in %.2fms (cpu %.2fms, upload %.2fms) on %d threads",
+		(import_end - import_start) * 1000.0, (upload_start - import_start) * 1000.0,
+		(import_end - upload_start) * 1000.0, job_thread_count());
+
 	asset_store_serialize(store, S("assets/asset_manifest.json"));
 	arena_scratch_end(scratch);
 }
 
+static void model_reload_job(void *user_data) {
+	ModelImport *import = user_data;
+	import->source = importer_reload_gltf_scene(&import->arena, import->path);
+}
+
+// NOTE: Reads the loose files directly, the store's trie may be growing on the main thread while this runs
+static void shader_reload_job(void *user_data) {
+	ShaderImport *import = user_data;
+	import->source = (ShaderSource){
+		.vertex_path = import->vertex_path,
+		.fragment_path = import->fragment_path,
+		.vertex = filesystem_read(&import->arena, import->vertex_path),
+		.fragment = filesystem_read(&import->arena, import->fragment_path),
+	};
+}
+
+static void hot_reload_shader(PermanentState *pstate, ShaderRecord *record, ShaderSource *source) {
+	if (source->vertex.size == 0 || source->fragment.size == 0) {
+		LOG_WARN("Assets: Failed to reload '%.*s', keeping previous version", SARG(record->fragment_path));
+		return;
+	}
+
+	vulkan_shader_replace(pstate->context, record->shader, source->vertex, source->fragment);
+}
+
+// First fit among the retired ranges no frame in flight can read anymore, the buffer only grows when none fits.
+// Returns SIZE_MAX when the buffer is full
+static size_t geometry_allocate(PermanentState *pstate, size_t size) {
+	size_t aligned = geometry_vertex_align(size);
+	for (uint32_t index = 0; index < pstate->reload.retired_geometry_count; ++index) {
+		GeometryRange *range = &pstate->reload.retired_geometry[index];
+		if (range->retired_frame + MAX_FRAMES_IN_FLIGHT >= pstate->reload.frame || range->size < aligned)
+			continue;
+
+		size_t offset = range->offset;
+		range->offset += aligned, range->size -= aligned;
+		if (range->size == 0)
+			*range = pstate->reload.retired_geometry[--pstate->reload.retired_geometry_count];
+		return offset;
+	}
+
+	// NOTE: Room for one extra vertex, the push only guarantees the buffer's own alignment
+	if (vulkan_buffer_offset(pstate->context, pstate->scene_geometry_buffer) + size + sizeof(Vertex3) >= SCENE_GEOMETRY_CAPACITY)
+		return SIZE_MAX;
+
+	return geometry_vertex_align(vulkan_buffer_push(pstate->context, pstate->scene_geometry_buffer, size + sizeof(Vertex3), NULL));
+}
+
+// Neighbouring ranges are merged, so a model that grows between reloads can take back the space of the ones before
+static void geometry_retire(PermanentState *pstate, size_t offset, size_t size) {
+	size = geometry_vertex_align(size);
+	for (uint32_t index = 0; index < pstate->reload.retired_geometry_count; ++index) {
+		GeometryRange *range = &pstate->reload.retired_geometry[index];
+		if (range->offset + range->size == offset || offset + size == range->offset) {
+			range->offset = MIN(range->offset, offset);
+			range->size += size;
+			range->retired_frame = pstate->reload.frame;
+			return;
+		}
+	}
+
+	if (pstate->reload.retired_geometry_count == MAX_RETIRED_GEOMETRY) {
+		LOG_WARN("Assets: Too many retired geometry ranges, %zu bytes stay unused", size);
+		return;
+	}
+
+	pstate->reload.retired_geometry[pstate->reload.retired_geometry_count++] = (GeometryRange){
+		.offset = offset,
+		.size = size,
+		.retired_frame = pstate->reload.frame,
+	};
+}
+
+// Textures and geometry are replaced in place, materials and mesh groups keep pointing at the same indices.
+// A model that gained or lost meshes or images would need those tables rebuilt, so it waits for a restart
+static void hot_reload_model(PermanentState *pstate, ModelRecord *record, SceneSource *model) {
+	if (model->mesh_count == 0) {
+		LOG_WARN("Assets: Failed to reload '%.*s', keeping previous version", SARG(record->path));
+		return;
+	}
+	if (model->mesh_count != record->mesh_count || model->image_count != record->texture_count) {
+		LOG_WARN("Assets: '%.*s' changed its mesh or image count, restart to pick it up", SARG(record->path));
+		return;
+	}
+
+	for (uint32_t image_index = 0; image_index < model->image_count; ++image_index) {
+		ImageSource *src = &model->images[image_index];
+		RhiTexture texture = pstate->assets.textures[record->texture_offset + image_index];
+		if (src->pixels)
+			vulkan_texture_replace(pstate->context, texture, src->width, src->height, src->pixels);
+	}
+
+	size_t geometry_size = model->vertices_size + model->indices_size;
+	size_t vertex_offset = geometry_allocate(pstate, geometry_size);
+	if (vertex_offset == SIZE_MAX) {
+		LOG_WARN("Assets: Out of geometry space, '%.*s' keeps its previous meshes", SARG(record->path));
+		return;
+	}
+
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+	uint8_t *geometry = arena_push(scratch.arena, geometry_size, 16, false);
+	memory_copy(geometry, model->vertices, model->vertices_size);
+	memory_copy(geometry + model->vertices_size, model->indices, model->indices_size);
+
+	vulkan_buffer_write(pstate->context, pstate->scene_geometry_buffer, vertex_offset, geometry_size, geometry);
+	size_t index_offset = vertex_offset + model->vertices_size;
+	arena_scratch_end(scratch);
+
+	geometry_retire(pstate, record->geometry_offset, record->geometry_size);
+	record->geometry_offset = vertex_offset, record->geometry_size = geometry_size;
+
+	Interval3 largest = {
+		.min = float3_fill(FLOAT_MAX),
+		.max = float3_fill(FLOAT_MIN),
+	};
+	for (uint32_t mesh_index = 0; mesh_index < model->mesh_count; ++mesh_index) {
+		MeshSource *src = &model->meshes[mesh_index];
+		Mesh *dst = &pstate->assets.meshes[record->mesh_offset + mesh_index];
+		pstate->assets.mesh_bounds[record->mesh_offset + mesh_index] = model->bounding_boxes[mesh_index];
+
+		size_t vertices_size = src->vertex_size * src->vertex_count;
+		size_t indices_size = src->index_size * src->index_count;
+
+		if (vertices_size == 0 && indices_size == 0)
+			continue;
+
+		dst->vertex_offset = vertex_offset;
+		dst->index_offset = index_offset;
+		dst->base_vertex = (int32_t)(vertex_offset / sizeof(Vertex3));
+		dst->first_index = (uint32_t)(index_offset / sizeof(uint32_t));
+		vertex_offset += vertices_size;
+		index_offset += indices_size;
+
+		dst->index_count = src->index_count;
+		dst->vertex_count = src->vertex_count;
+
+		largest.min = float3_min(largest.min, model->bounding_boxes[mesh_index].min);
+		largest.max = float3_max(largest.max, model->bounding_boxes[mesh_index].max);
+	}
+	pstate->assets.mesh_group_bounds[record->group_index] = largest;
+
+	LOG_INFO("Assets: Reloaded '%.*s'", SARG(record->path));
+}
+
+static bool hot_reload_depends_on(ModelRecord *record, String path) {
+	if (string_equals(record->path, path))
+		return true;
+
+	for (StringNode *node = record->dependencies.first; node; node = node->next)
+		if (string_equals(node->string, path))
+			return true;
+
+	return false;
+}
+
+void hot_reload_update(PermanentState *pstate, AssetEntry **changes) {
+	pstate->reload.frame++;
+
+	for (uint32_t change_index = 0; change_index < arena_array_count(changes); ++change_index) {
+		String path = changes[change_index]->full_path;
+
+		for (uint32_t index = 0; index < arena_array_count(pstate->reload.models); ++index)
+			pstate->reload.models[index].dirty |= hot_reload_depends_on(&pstate->reload.models[index], path);
+
+		for (uint32_t index = 0; index < arena_array_count(pstate->reload.shaders); ++index) {
+			ShaderRecord *record = &pstate->reload.shaders[index];
+			record->dirty |= string_equals(record->vertex_path, path) || string_equals(record->fragment_path, path);
+		}
+	}
+
+	// NOTE: Imports run on the job system while frames keep going, the results are applied on the first
+	// frame after they all finished. The backend swaps them in once the old versions are out of flight
+	if (pstate->reload.busy) {
+		if (job_done(&pstate->reload.counter) == false)
+			return;
+
+		for (uint32_t index = 0; index < arena_array_count(pstate->reload.shader_imports); ++index) {
+			ShaderImport *import = &pstate->reload.shader_imports[index];
+			hot_reload_shader(pstate, &pstate->reload.shaders[pstate->reload.shader_indices[index]], &import->source);
+			arena_destroy(&import->arena);
+		}
+
+		for (uint32_t index = 0; index < arena_array_count(pstate->reload.model_imports); ++index) {
+			ModelImport *import = &pstate->reload.model_imports[index];
+			hot_reload_model(pstate, &pstate->reload.models[pstate->reload.model_indices[index]], &import->source);
+			importer_unload_scene(&import->source);
+			arena_destroy(&import->arena);
+		}
+
+		arena_rewind(&pstate->reload.arena, 0);
+		pstate->reload.model_imports = NULL, pstate->reload.model_indices = NULL;
+		pstate->reload.shader_imports = NULL, pstate->reload.shader_indices = NULL;
+		pstate->reload.busy = false;
+	}
+
+	// Edits that land while a batch is importing stay dirty and go out with the next one
+	Arena *arena = &pstate->reload.arena;
+	for (uint32_t index = 0; index < arena_array_count(pstate->reload.models); ++index) {
+		ModelRecord *record = &pstate->reload.models[index];
+		if (record->dirty == false)
+			continue;
+
+		arena_darray_put(arena, pstate->reload.model_imports, ModelImport, { .path = record->path, .arena = arena_reserve(GiB(1), ARENA_FLAG_NONE) });
+		arena_darray_put(arena, pstate->reload.model_indices, uint32_t, index);
+		record->dirty = false;
+	}
+	for (uint32_t index = 0; index < arena_array_count(pstate->reload.shaders); ++index) {
+		ShaderRecord *record = &pstate->reload.shaders[index];
+		if (record->dirty == false)
+			continue;
+
+		arena_darray_put(arena, pstate->reload.shader_imports, ShaderImport,
+			{
+			  .store = &pstate->store,
+			  .vertex_path = record->vertex_path,
+			  .fragment_path = record->fragment_path,
+			  .arena = arena_reserve(MiB(64), ARENA_FLAG_NONE),
+			});
+		arena_darray_put(arena, pstate->reload.shader_indices, uint32_t, index);
+		record->dirty = false;
+	}
+
+	// NOTE: Imports are pushed before the declarations so the arrays don't move under the jobs
+	JobDecl *jobs = NULL;
+	for (uint32_t index = 0; index < arena_array_count(pstate->reload.model_imports); ++index)
+		arena_darray_put(arena, jobs, JobDecl, { model_reload_job, &pstate->reload.model_imports[index] });
+	for (uint32_t index = 0; index < arena_array_count(pstate->reload.shader_imports); ++index)
+		arena_darray_put(arena, jobs, JobDecl, { shader_reload_job, &pstate->reload.shader_imports[index] });
+
+	if (jobs == NULL)
+		return;
+
+	job_run(jobs, arena_array_count(jobs), &pstate->reload.counter);
+	pstate->reload.busy = true;
+}
+
 static inline void push_textured_quad(Arena *arena, Rectangle src, Rectangle dst, uint2 image_size, uint32_t texture_index, Color tint) {
 	float x0 = dst.x;
 	float y0 = dst.y;
@@ -2102,7 +2757,7 @@ static inline void push_textured_quad(Arena *arena, Rectangle src, Rectangle dst
 }
 
 void batch2d_flush(
-	VulkanContext *context,
+	VulkanContext *context, VulkanRecorder *recorder,
 	RhiShader shader, RhiUniformSet global,
 	RhiBuffer storage_buffer, uint32_t quad_count, void *quads,
 	uint32_t texture_count, RhiTexture *textures, RhiSampler sampler) {
@@ -2113,19 +2768,19 @@ void batch2d_flush(
 	size_t vertex_data_size = quad_count * 6 * sizeof(Vertex2);
 	size_t vertex_offset = vulkan_buffer_push(context, storage_buffer, vertex_data_size, quads);
 
-	vulkan_shader_bind(context, shader, pipeline);
+	vulkan_shader_bind(context, recorder, shader, pipeline);
 
 	vulkan_uniformset_bind_buffer_range(context, global, 1, vertex_offset, vertex_data_size, storage_buffer);
-	vulkan_uniformset_bind(context, global);
+	vulkan_uniformset_bind(context, recorder, global);
 
-	RhiUniformSet set1 = vulkan_uniformset_push(context, shader, 1);
+	RhiUniformSet set1 = vulkan_uniformset_push(context, recorder, shader, 1);
 
 	for (uint32_t index = 0; index < texture_count; ++index)
 		vulkan_uniformset_bind_texture_index(context, set1, 0, index, textures[index], sampler);
 
-	vulkan_uniformset_bind(context, set1);
+	vulkan_uniformset_bind(context, recorder, set1);
 
-	vulkan_renderer_draw(context, quad_count * 6);
+	vulkan_renderer_draw(context, recorder, quad_count * 6);
 }
 
 void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffer, DrawlistDesc desc) {
@@ -2136,7 +2791,7 @@ void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffe
 	RhiTexture batch2d_textures[32] = { pstate->white };
 	uint32_t batch2d_texture_count = 1, batch2d_quad_count = 0;
 
-	RhiUniformSet batch2d_global = vulkan_uniformset_push(pstate->context, pstate->quad_textured_shader, 0);
+	RhiUniformSet batch2d_global = vulkan_uniformset_push(pstate->context, vulkan_frame_recorder(pstate->context), pstate->quad_textured_shader, 0);
 	{
 		uint2 window_size = window_size_pixel(pstate->display);
 		float4x4 projection = float4x4_orthographic(0.0f, window_size.x, 0.0f, window_size.y, -50, 50.f);
@@ -2148,7 +2803,8 @@ void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffe
 	}
 
 	vulkan_texture_prepare_sample(pstate->context, pstate->shadow_depth_target);
-	if (vulkan_drawlist_begin(pstate->context, desc)) {
+	VulkanRecorder *recorder = vulkan_drawlist_begin(pstate->context, desc);
+	if (recorder) {
 		for (size_t base_address = 0; base_address < buffer->offset;) {
 			DrawCommandBase *base = (DrawCommandBase *)buffer->push_buffer + base_address;
 			if (base->type == 0)
@@ -2156,7 +2812,7 @@ void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffe
 
 			if (batch2d_texture_count == countof(batch2d_textures) || batch2d_quad_count == max_quads_per_batch) {
 				batch2d_flush(
-					pstate->context,
+					pstate->context, recorder,
 					pstate->quad_textured_shader,
 					batch2d_global,
 					pstate->frame_storage_buffer,
@@ -2265,14 +2921,36 @@ void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffe
 					};
 					size_t light_offset = vulkan_buffer_push(pstate->context, pstate->frame_storage_buffer, sizeof(LightData), &light);
 
-					RhiUniformSet global_set = vulkan_uniformset_push(pstate->context, pstate->phong_shader, 0);
+					// One instance per command in this run, command N draws instance N
+					uint32_t instance_count = 0;
+					for (size_t address = base_address; address < buffer->capacity; ++instance_count) {
+						DrawCommandBase *next = (DrawCommandBase *)buffer->push_buffer + address;
+						if (next->type != DCT_DrawCommandMesh)
+							break;
+						address += next->size;
+					}
+
+					ArenaTemp instance_scratch = arena_scratch_begin(pstate->frame_arena);
+					InstanceData *instances = arena_push_count(instance_scratch.arena, instance_count, InstanceData);
+					size_t address = base_address;
+					for (uint32_t index = 0; index < instance_count; ++index) {
+						DrawCommandMesh *next = (DrawCommandMesh *)((DrawCommandBase *)buffer->push_buffer + address);
+						instances[index].world = next->world_from_model;
+						address += next->base.size;
+					}
+					size_t instance_offset = vulkan_buffer_push(pstate->context, pstate->frame_storage_buffer, instance_count * sizeof(InstanceData), instances);
+					arena_scratch_end(instance_scratch);
+
+					RhiUniformSet global_set = vulkan_uniformset_push(pstate->context, recorder, pstate->phong_shader, 0);
 					vulkan_uniformset_bind_buffer_range(pstate->context, global_set, 0, global_offset, sizeof(GlobalData), pstate->frame_uniform_buffer);
 					vulkan_uniformset_bind_buffer_range(pstate->context, global_set, 1, light_offset, sizeof(LightData), pstate->frame_storage_buffer);
+					vulkan_uniformset_bind_buffer_range(pstate->context, global_set, 3, instance_offset, instance_count * sizeof(InstanceData), pstate->frame_storage_buffer);
 					vulkan_uniformset_bind_texture(pstate->context, global_set, 2, pstate->shadow_depth_target, pstate->shadow_sampler);
 
 					PipelineDesc pipeline = DEFAULT_PIPELINE;
 					pipeline.cull_mode = CULL_MODE_BACK;
 
+					uint32_t instance_index = 0;
 					while (base_address < buffer->capacity && base->type == DCT_DrawCommandMesh) {
 						DrawCommandMesh *cmd = (DrawCommandMesh *)base;
 
@@ -2280,34 +2958,21 @@ void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffe
 						Material *material = &cmd->material;
 						Mesh *mesh = &cmd->mesh;
 
-						vulkan_shader_bind(pstate->context, material->shader, pipeline);
-						vulkan_uniformset_bind(pstate->context, global_set);
-
-						RhiUniformSet group = vulkan_uniformset_push(pstate->context, pstate->phong_shader, 1);
+						vulkan_shader_bind(pstate->context, recorder, material->shader, pipeline);
+						vulkan_uniformset_bind(pstate->context, recorder, global_set);
 
-						vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, material->offset, material->size, material->uniform_buffer);
-						for (uint32_t texture_index = 0; texture_index < material->texture_count; ++texture_index) {
-							RhiTexture texture = material->textures[texture_index];
-							if (texture.id == 0)
-								texture = pstate->white;
-
-							vulkan_uniformset_bind_texture(
-								pstate->context,
-								group,
-								1 + texture_index,
-								texture,
-								pstate->nearest_sampler);
+						// NOTE: Materials built outside of load_assets have no set of their own
+						RhiUniformSet group = material->set;
+						if (group.id == 0) {
+							group = vulkan_uniformset_push(pstate->context, recorder, pstate->phong_shader, 1);
+							vulkan_uniformset_bind_buffer_range(pstate->context, group, 0, material->offset, material->size, material->uniform_buffer);
 						}
+						vulkan_uniformset_bind(pstate->context, recorder, group);
 
-						vulkan_uniformset_bind(pstate->context, group);
-						vulkan_push_constants(pstate->context, 0, sizeof(float4x4), cmd->world_from_model.elements);
-
-						vulkan_buffer_bind_vertex(pstate->context, mesh->handle, mesh->vertex_offset);
-						if (mesh->index_count > 0) {
-							vulkan_buffer_bind_index(pstate->context, mesh->handle, mesh->index_offset);
-							vulkan_renderer_draw_indexed(pstate->context, mesh->index_count);
-						} else
-							vulkan_renderer_draw(pstate->context, mesh->vertex_count);
+						// NOTE: Commands all draw from the same geometry buffer, so only the first bind goes through
+						geometry_bind(pstate, recorder, mesh->handle);
+						mesh_draw_instanced(pstate, recorder, mesh, 1, instance_index);
+						instance_index++;
 
 						base_address += base->size;
 						base = (DrawCommandBase *)buffer->push_buffer + base_address;
@@ -2321,7 +2986,7 @@ void pass_submit(PermanentState *pstate, Camera3D *camera, DrawlistBuffer *buffe
 
 		if (batch2d_quad_count) {
 			batch2d_flush(
-				pstate->context,
+				pstate->context, recorder,
 				pstate->quad_textured_shader,
 				batch2d_global,
 				pstate->frame_storage_buffer,
@@ -0,0 +1,184 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Draws 10k textured quads two ways. The bindless path binds a persistent material set that names its texture
+// by slot, the per-draw path pushes a set and writes a combined image sampler into it for every draw the way
+// materials did before the bindless array
+#include "test.h"
+
+#include "core/logger.h"
+#include "renderer/backend/vulkan_api.h"
+#include "scene.h"
+
+#define DRAW_COUNT 10000
+// NOTE: A frame's descriptor pool holds 1000 sets, the per-draw path can't push more than that into one submit
+#define DRAWS_PER_SUBMIT 500
+#define SUBMIT_COUNT (DRAW_COUNT / DRAWS_PER_SUBMIT)
+#define TEXTURE_COUNT 64
+#define MATERIAL_STRIDE 256
+#define TEXTURE_SIZE 4
+#define TARGET_SIZE 32
+
+typedef struct {
+	VulkanContext *context;
+	RhiTexture target;
+	RhiSampler sampler;
+	RhiTexture textures[TEXTURE_COUNT];
+
+	RhiShader bindless_shader;
+	RhiUniformSet materials[TEXTURE_COUNT];
+
+	RhiShader per_draw_shader;
+} BenchState;
+
+typedef struct {
+	double submit_ms, record_ms;
+	uint32_t descriptor_writes;
+	uint32_t pixel;
+} PathResult;
+
+typedef void (*RecordFunction)(BenchState *state, VulkanRecorder *recorder, uint32_t first_draw);
+
+static uint32_t texture_pixel(uint32_t index) {
+	return 0xFF000000u | ((index * 37u) & 0xFF) | (((index * 91u) & 0xFF) << 8) | (((index * 151u) & 0xFF) << 16);
+}
+
+static void record_bindless(BenchState *state, VulkanRecorder *recorder, uint32_t first_draw) {
+	for (uint32_t draw = first_draw; draw < first_draw + DRAWS_PER_SUBMIT; ++draw) {
+		vulkan_uniformset_bind(state->context, recorder, state->materials[draw % TEXTURE_COUNT]);
+		vulkan_renderer_draw(state->context, recorder, 6);
+	}
+}
+
+static void record_per_draw(BenchState *state, VulkanRecorder *recorder, uint32_t first_draw) {
+	for (uint32_t draw = first_draw; draw < first_draw + DRAWS_PER_SUBMIT; ++draw) {
+		RhiUniformSet set = vulkan_uniformset_push(state->context, recorder, state->per_draw_shader, 0);
+		vulkan_uniformset_bind_texture(state->context, set, 0, state->textures[draw % TEXTURE_COUNT], state->sampler);
+		vulkan_uniformset_bind(state->context, recorder, set);
+		vulkan_renderer_draw(state->context, recorder, 6);
+	}
+}
+
+// Milliseconds spent recording the pass, frame_begin waiting on the frames in flight isn't part of it
+static double frame_record(BenchState *state, RhiShader shader, RecordFunction record, uint32_t first_draw) {
+	VulkanContext *context = state->context;
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+
+	DrawlistDesc pass = {
+		.name = S("bench_bindless"),
+		.color_attachments[0] = { .target = state->target, .load = CLEAR, .store = STORE },
+		.color_attachment_count = 1,
+		.viewport = { 0, 0, TARGET_SIZE, TARGET_SIZE },
+		.msaa_level = 1,
+	};
+
+	double milliseconds = 0.0;
+	VulkanRecorder *recorder = vulkan_drawlist_begin(context, pass);
+	if (recorder) {
+		double start = test_seconds();
+		PipelineDesc pipeline = DEFAULT_PIPELINE;
+		pipeline.depth_test_enable = pipeline.depth_write_enable = false;
+		vulkan_shader_bind(context, recorder, shader, pipeline);
+		record(state, recorder, first_draw);
+		milliseconds = (test_seconds() - start) * 1e3;
+
+		vulkan_drawlist_end(context);
+	}
+
+	vulkan_frame_end(context);
+	return milliseconds;
+}
+
+static PathResult path_run(BenchState *state, RhiShader shader, RecordFunction record) {
+	PathResult result = { 0 };
+
+	// NOTE: The first submit builds the pipeline, it stays out of the timing
+	frame_record(state, shader, record, 0);
+
+	double start = test_seconds();
+	for (uint32_t submit = 0; submit < SUBMIT_COUNT; ++submit) {
+		result.record_ms += frame_record(state, shader, record, submit * DRAWS_PER_SUBMIT);
+		result.descriptor_writes += vulkan_bind_stats(state->context).descriptor_writes;
+	}
+	result.submit_ms = (test_seconds() - start) * 1e3 / SUBMIT_COUNT;
+	result.record_ms /= SUBMIT_COUNT;
+
+	// Every draw covers the target, the last one decides what's left in it
+	TEST_CHECK(vulkan_texture_read_pixel(state->context, state->target, TARGET_SIZE / 2, TARGET_SIZE / 2, &result.pixel));
+	return result;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("bench_bindless: no usable Vulkan device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	Buffer vertex = filesystem_read(&arena, S(ASSETS_DIR "/shaders/vertex/bin/quad.vertex.spv"));
+	Buffer bindless_fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/unlit.fragment.spv"));
+	Buffer per_draw_fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/blit.fragment.spv"));
+	if (vertex.size == 0 || bindless_fragment.size == 0 || per_draw_fragment.size == 0) {
+		printf("bench_bindless: shaders aren't compiled, skipped\n");
+		vulkan_renderer_destroy(context);
+		return TEST_SKIPPED;
+	}
+
+	BenchState state = {
+		.context = context,
+		.target = vulkan_texture_make(context, TARGET_SIZE, TARGET_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_RENDER_TARGET | TEXTURE_USAGE_READBACK, NULL),
+		.sampler = vulkan_sampler_make(context, NEAREST_SAMPLER),
+		.bindless_shader = vulkan_shader_make(NULL, context, S("bench_bindless"), vertex, bindless_fragment, NULL),
+		.per_draw_shader = vulkan_shader_make(NULL, context, S("bench_per_draw"), vertex, per_draw_fragment, NULL),
+	};
+	TEST_CHECK(state.bindless_shader.id && state.per_draw_shader.id);
+
+	// One solid texture per material, each material block naming its texture's bindless slot
+	RhiBuffer uniforms = vulkan_buffer_make(context, BUFFER_USAGE_UNIFORM, BUFFER_MEMORY_SHARED, TEXTURE_COUNT * MATERIAL_STRIDE, NULL);
+	for (uint32_t index = 0; index < TEXTURE_COUNT; ++index) {
+		uint32_t pixels[TEXTURE_SIZE * TEXTURE_SIZE];
+		for (uint32_t pixel = 0; pixel < countof(pixels); ++pixel)
+			pixels[pixel] = texture_pixel(index);
+		state.textures[index] = vulkan_texture_make(context, TEXTURE_SIZE, TEXTURE_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_SAMPLED, pixels);
+
+		MaterialParameters parameters = {
+			.base_color_factor = { 1.0f, 1.0f, 1.0f, 1.0f },
+			.sampler = vulkan_sampler_bindless_index(context, state.sampler),
+		};
+		for (uint32_t texture = 0; texture < MATERIAL_TEXTURE_COUNT; ++texture)
+			parameters.textures[texture] = vulkan_texture_bindless_index(context, state.textures[index]);
+		vulkan_buffer_write_all(context, uniforms, index * MATERIAL_STRIDE, sizeof(parameters), &parameters);
+
+		state.materials[index] = vulkan_uniformset_make(context, state.bindless_shader, 1);
+		vulkan_uniformset_bind_buffer_range(context, state.materials[index], 0, index * MATERIAL_STRIDE, sizeof(parameters), uniforms);
+	}
+
+	PathResult bindless = path_run(&state, state.bindless_shader, record_bindless);
+	PathResult per_draw = path_run(&state, state.per_draw_shader, record_per_draw);
+
+	uint32_t expected = texture_pixel((DRAW_COUNT - 1) % TEXTURE_COUNT);
+	TEST_CHECK_FORMAT(bindless.pixel == expected, "bindless left 0x%08x, expected 0x%08x", bindless.pixel, expected);
+	TEST_CHECK_FORMAT(per_draw.pixel == expected, "per-draw left 0x%08x, expected 0x%08x", per_draw.pixel, expected);
+	TEST_CHECK_FORMAT(bindless.descriptor_writes == 0, "bindless wrote %u descriptors", bindless.descriptor_writes);
+	TEST_CHECK_FORMAT(per_draw.descriptor_writes >= DRAW_COUNT, "per-draw wrote %u descriptors", per_draw.descriptor_writes);
+
+	printf("%u draws in %u submits of %u\n", DRAW_COUNT, SUBMIT_COUNT, DRAWS_PER_SUBMIT);
+	printf("%-10s %12s %12s %18s %10s\n", "path", "submit ms", "record ms", "descriptor writes", "speedup");
+	printf("%-10s %12.3f %12.3f %18u %9.2fx\n", "per-draw", per_draw.submit_ms, per_draw.record_ms, per_draw.descriptor_writes, 1.0);
+	printf("%-10s %12.3f %12.3f %18u %9.2fx\n", "bindless", bindless.submit_ms, bindless.record_ms, bindless.descriptor_writes, per_draw.submit_ms / bindless.submit_ms);
+
+	for (uint32_t index = 0; index < TEXTURE_COUNT; ++index) {
+		vulkan_uniformset_destroy(context, state.materials[index]);
+		vulkan_texture_destroy(context, state.textures[index]);
+	}
+	vulkan_buffer_destroy(context, uniforms);
+	vulkan_shader_destroy(context, state.per_draw_shader);
+	vulkan_shader_destroy(context, state.bindless_shader);
+	vulkan_sampler_destroy(context, state.sampler);
+	vulkan_texture_destroy(context, state.target);
+	vulkan_renderer_destroy(context);
+	arena_destroy(&arena);
+
+	return test_result("bench_bindless");
+}
@@ -0,0 +1,59 @@
+#include "test.h"
+
+#include "cmath_scalar.h"
+
+#define MATRIX_COUNT 1024
+#define ROUNDS 256
+
+static float4x4 matrices[MATRIX_COUNT];
+static float4x4 results[MATRIX_COUNT];
+static float3 points[MATRIX_COUNT];
+
+typedef struct {
+	const char *name;
+	double engine_ns, reference_ns;
+} BenchRow;
+
+// NOTE: The checksum keeps the loops from being optimized away, ns is per call
+#define BENCH_LOOP(out_ns, body)                                          \
+	do {                                                                  \
+		double start = test_seconds();                                    \
+		for (uint32_t round = 0; round < ROUNDS; ++round)                 \
+			for (uint32_t index = 0; index < MATRIX_COUNT; ++index) {     \
+				uint32_t next = (index + 1) & (MATRIX_COUNT - 1);         \
+				body;                                                     \
+			}                                                             \
+		(out_ns) = (test_seconds() - start) * 1e9 / (ROUNDS * MATRIX_COUNT); \
+		checksum += results[round_robin++ & (MATRIX_COUNT - 1)].elements[5]; \
+	} while (0)
+
+int main(void) {
+	for (uint32_t index = 0; index < MATRIX_COUNT; ++index) {
+		float angle = (float)index;
+		float4x4_compose_into(&matrices[index], (float3){ angle, -angle, 0.5f * angle }, (float3){ angle, 2.0f * angle, 3.0f * angle }, (float3){ 1.0f, 2.0f, 0.5f });
+		points[index] = (float3){ angle, 1.0f, -angle };
+	}
+
+	volatile float checksum = 0.0f;
+	uint32_t round_robin = 0;
+	BenchRow rows[3] = { { .name = "multiply" }, { .name = "inverse" }, { .name = "compose" } };
+
+	// multiply and inverse against their plain C paths
+	BENCH_LOOP(rows[0].engine_ns, float4x4_multiply_into(&results[index], &matrices[index], &matrices[next]));
+	BENCH_LOOP(rows[0].reference_ns, scalar_float4x4_multiply_into(&results[index], &matrices[index], &matrices[next]));
+
+	BENCH_LOOP(rows[1].engine_ns, float4x4_inverse_into(&results[index], &matrices[index]));
+	BENCH_LOOP(rows[1].reference_ns, scalar_float4x4_inverse_into(&results[index], &matrices[index]));
+
+	// NOTE: compose has no SIMD path, the closed form is timed against the multiply chain it replaced.
+	// transform and transform_point are plain C, their SSE versions lost to it and were dropped
+	BENCH_LOOP(rows[2].engine_ns, float4x4_compose_into(&results[index], points[index], points[next], (float3){ 1.0f, 1.0f, 1.0f }));
+	BENCH_LOOP(rows[2].reference_ns, scalar_float4x4_compose_chain_into(&results[index], points[index], points[next], (float3){ 1.0f, 1.0f, 1.0f }));
+
+	printf("%-16s %12s %12s %10s\n", "function", "engine ns", "reference ns", "speedup");
+	for (uint32_t index = 0; index < countof(rows); ++index)
+		printf("%-16s %12.2f %12.2f %9.2fx\n", rows[index].name, rows[index].engine_ns, rows[index].reference_ns, rows[index].reference_ns / rows[index].engine_ns);
+
+	TEST_CHECK(checksum == checksum);
+	return test_result("bench_cmath");
+}
@@ -0,0 +1,159 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Records the main pass the way game.c does, 50k draws sorted by material, spread over 1, 2, 4 and 8 recorders.
+// The draws carry no instances, the GPU skips them and only the recording on the CPU is timed
+#include "test.h"
+
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "renderer/backend/vulkan_api.h"
+
+#define DRAW_COUNT 50000
+#define MATERIAL_COUNT 64
+#define DRAWS_PER_MATERIAL 8
+#define FRAME_COUNT 8
+#define TARGET_SIZE 64
+
+typedef struct {
+	VulkanContext *context;
+	VulkanRecorder *recorder;
+	RhiShader shader;
+	RhiBuffer geometry;
+	RhiUniformSet global;
+	RhiUniformSet *materials;
+	uint32_t first_draw, draw_count;
+} RecordSlice;
+
+static void record_job(void *user_data) {
+	RecordSlice *slice = user_data;
+	PipelineDesc pipeline = DEFAULT_PIPELINE;
+
+	vulkan_buffer_bind_vertex(slice->context, slice->recorder, slice->geometry, 0);
+	vulkan_buffer_bind_index(slice->context, slice->recorder, slice->geometry, 0);
+	for (uint32_t draw = slice->first_draw; draw < slice->first_draw + slice->draw_count; ++draw) {
+		vulkan_shader_bind(slice->context, slice->recorder, slice->shader, pipeline);
+		vulkan_uniformset_bind(slice->context, slice->recorder, slice->global);
+		vulkan_uniformset_bind(slice->context, slice->recorder, slice->materials[(draw / DRAWS_PER_MATERIAL) % MATERIAL_COUNT]);
+		vulkan_renderer_draw_indexed_instanced_offset(slice->context, slice->recorder, 36, 0, 0, 0, draw);
+	}
+}
+
+// Milliseconds spent recording the pass, from the first job handed out to the last one finished
+static double frame_record(VulkanContext *context, RecordSlice base, RhiTexture target, RhiBuffer uniforms, RhiBuffer storage, uint32_t recorder_count) {
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+
+	base.global = vulkan_uniformset_push(context, vulkan_frame_recorder(context), base.shader, 0);
+	vulkan_uniformset_bind_buffer_range(context, base.global, 0, 0, 256, uniforms);
+	vulkan_uniformset_bind_buffer_range(context, base.global, 1, 0, 256, storage);
+	vulkan_uniformset_bind_buffer_range(context, base.global, 3, 0, 256, storage);
+
+	DrawlistDesc pass = {
+		.name = S("bench_draw_recording"),
+		.color_attachments[0] = { .target = target, .load = CLEAR, .store = STORE },
+		.color_attachment_count = 1,
+		.viewport = { 0, 0, TARGET_SIZE, TARGET_SIZE },
+		.msaa_level = 1,
+	};
+
+	double milliseconds = 0.0;
+	VulkanRecorder *recorders[MAX_RECORDERS];
+	if (vulkan_drawlist_begin_parallel(context, pass, recorder_count, recorders)) {
+		RecordSlice slices[MAX_RECORDERS];
+		JobDecl jobs[MAX_RECORDERS];
+		for (uint32_t index = 0, first_draw = 0; index < recorder_count; ++index) {
+			uint32_t count = DRAW_COUNT / recorder_count + (index < DRAW_COUNT % recorder_count ? 1 : 0);
+			slices[index] = base;
+			slices[index].recorder = recorders[index];
+			slices[index].first_draw = first_draw;
+			slices[index].draw_count = count;
+			jobs[index] = (JobDecl){ .function = record_job, .user_data = &slices[index] };
+			first_draw += count;
+		}
+
+		double start = test_seconds();
+		JobCounter counter = { 0 };
+		job_run(jobs, recorder_count, &counter);
+		job_wait(&counter);
+		milliseconds = (test_seconds() - start) * 1e3;
+
+		vulkan_drawlist_end(context);
+	}
+
+	vulkan_frame_end(context);
+	return milliseconds;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("bench_draw_recording: no usable Vulkan device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	Buffer vertex = filesystem_read(&arena, S(ASSETS_DIR "/shaders/vertex/bin/basic.vertex.spv"));
+	Buffer fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/unlit.fragment.spv"));
+	if (vertex.size == 0 || fragment.size == 0) {
+		printf("bench_draw_recording: shaders aren't compiled, skipped\n");
+		vulkan_renderer_destroy(context);
+		return TEST_SKIPPED;
+	}
+
+	RhiTexture target = vulkan_texture_make(context, TARGET_SIZE, TARGET_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_RENDER_TARGET, NULL);
+	RhiBuffer uniforms = vulkan_buffer_make(context, BUFFER_USAGE_UNIFORM, BUFFER_MEMORY_SHARED, KiB(64), NULL);
+	RhiBuffer storage = vulkan_buffer_make(context, BUFFER_USAGE_STORAGE, BUFFER_MEMORY_SHARED, KiB(4), NULL);
+
+	RecordSlice base = {
+		.context = context,
+		.shader = vulkan_shader_make(NULL, context, S("bench"), vertex, fragment, NULL),
+		.geometry = vulkan_buffer_make(context, BUFFER_USAGE_VERTEX | BUFFER_USAGE_INDEX, BUFFER_MEMORY_DEVICE, KiB(4), NULL),
+		.materials = arena_push_count(&arena, MATERIAL_COUNT, RhiUniformSet),
+	};
+	TEST_CHECK(base.shader.id);
+	for (uint32_t index = 0; index < MATERIAL_COUNT; ++index) {
+		base.materials[index] = vulkan_uniformset_make(context, base.shader, 1);
+		vulkan_uniformset_bind_buffer_range(context, base.materials[index], 0, index * 256, 256, uniforms);
+	}
+
+	printf("%-10s %14s %10s\n", "recorders", "record ms", "speedup");
+
+	double single_recorder_ms = 0.0;
+	for (uint32_t recorder_count = 1; recorder_count <= MAX_RECORDERS; recorder_count *= 2) {
+		Arena job_arena = arena_reserve(MiB(16), ARENA_FLAG_NONE);
+		if (recorder_count > 1)
+			job_system_startup(&job_arena, recorder_count - 1, false);
+
+		// NOTE: The first frame grows the command pools and builds the pipeline, it stays out of the timing
+		frame_record(context, base, target, uniforms, storage, recorder_count);
+
+		double total_ms = 0.0;
+		for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame)
+			total_ms += frame_record(context, base, target, uniforms, storage, recorder_count);
+		double record_ms = total_ms / FRAME_COUNT;
+
+		// Three binds a draw, whether they were recorded or dropped as redundant
+		VulkanBindStats stats = vulkan_bind_stats(context);
+		TEST_CHECK_FORMAT(stats.issued + stats.skipped >= DRAW_COUNT * 3, "%u issued, %u skipped", stats.issued, stats.skipped);
+
+		if (recorder_count == 1)
+			single_recorder_ms = record_ms;
+		printf("%-10u %14.2f %9.2fx\n", recorder_count, record_ms, single_recorder_ms / record_ms);
+
+		if (recorder_count > 1)
+			job_system_shutdown();
+		arena_destroy(&job_arena);
+	}
+
+	for (uint32_t index = 0; index < MATERIAL_COUNT; ++index)
+		vulkan_uniformset_destroy(context, base.materials[index]);
+	vulkan_shader_destroy(context, base.shader);
+	vulkan_buffer_destroy(context, base.geometry);
+	vulkan_buffer_destroy(context, storage);
+	vulkan_buffer_destroy(context, uniforms);
+	vulkan_texture_destroy(context, target);
+	vulkan_renderer_destroy(context);
+	arena_destroy(&arena);
+
+	return test_result("bench_draw_recording");
+}
@@ -0,0 +1,116 @@
+#include "test.h"
+
+#include "core/logger.h"
+#include "ecs.h"
+
+#define ENTITY_COUNT 100000
+#define ARCHETYPE_COUNT 8
+#define QUERY_ROUNDS 16
+
+// Every entity has a transform, the three low bits pick which of the other components it also gets
+static void push_components(ECS *world, Entity entity, uint32_t archetype) {
+	if (archetype & 1)
+		ecs_put(world, entity, HierarchyComponent, { 0 });
+	if (archetype & 2)
+		ecs_put(world, entity, MeshComponent, { .mesh_group_index = (uint32_t)entity });
+	if (archetype & 4)
+		ecs_put(world, entity, ColliderComponent, { .aabb.extent = FLOAT3_ONE });
+}
+
+static uint32_t count_query(ECS *world, EcsIterator it) {
+	uint32_t result = 0;
+	while (ecs_next(&it))
+		result++;
+	return result;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_WARN);
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+	ECS *world = ecs_make(&arena);
+
+	Entity *entities = arena_push_count(&arena, ENTITY_COUNT, Entity);
+
+	double start = test_seconds();
+	for (uint32_t index = 0; index < ENTITY_COUNT; ++index) {
+		entities[index] = ecs_spawn(world, (float3){ (float)index, 0.0f, 0.0f });
+		push_components(world, entities[index], index % ARCHETYPE_COUNT);
+	}
+	double spawn_ns = (test_seconds() - start) * 1e9 / ENTITY_COUNT;
+
+	// Transform, hierarchy, mesh and collider queries see all, half, half and a quarter of the entities
+	TEST_CHECK(count_query(world, ecs_query(world, ecs_type_id(TransformComponent))) == ENTITY_COUNT);
+	TEST_CHECK(count_query(world, ecs_query(world, ecs_type_id(HierarchyComponent))) == ENTITY_COUNT / 2);
+	TEST_CHECK(count_query(world, ecs_query(world, ecs_type_id(MeshComponent))) == ENTITY_COUNT / 2);
+	TEST_CHECK(count_query(world, ecs_query(world, ecs_type_id(MeshComponent), ecs_type_id(ColliderComponent))) == ENTITY_COUNT / 4);
+
+	start = test_seconds();
+	for (uint32_t round = 0; round < QUERY_ROUNDS; ++round) {
+		EcsIterator it = ecs_query(world, ecs_type_id(TransformComponent));
+		while (ecs_next(&it)) {
+			TransformComponent *transform = ecs_field(&it, TransformComponent);
+			transform->world_matrix.elements[12] = transform->position.x;
+		}
+	}
+	double transform_ns = (test_seconds() - start) * 1e9 / ((double)QUERY_ROUNDS * ENTITY_COUNT);
+
+	uint32_t mismatches = 0;
+	start = test_seconds();
+	for (uint32_t round = 0; round < QUERY_ROUNDS; ++round) {
+		EcsIterator it = ecs_query(world, ecs_type_id(MeshComponent), ecs_type_id(ColliderComponent));
+		Entity entity;
+		while ((entity = ecs_next(&it))) {
+			MeshComponent *mesh = ecs_field(&it, MeshComponent);
+			ColliderComponent *collider = ecs_field(&it, ColliderComponent);
+			mismatches += mesh->mesh_group_index != (uint32_t)entity || collider->aabb.extent.x != 1.0f;
+		}
+	}
+	double selective_ns = (test_seconds() - start) * 1e9 / ((double)QUERY_ROUNDS * ENTITY_COUNT / 4);
+	TEST_CHECK(mismatches == 0);
+
+	// Random access through the entity records, stepping by a prime so consecutive lookups land in different chunks
+	float sum = 0.0f;
+	start = test_seconds();
+	for (uint32_t index = 0, cursor = 0; index < ENTITY_COUNT; ++index, cursor = (cursor + 7919) % ENTITY_COUNT)
+		sum += ecs_find(world, entities[cursor], TransformComponent)->position.x;
+	double find_ns = (test_seconds() - start) * 1e9 / ENTITY_COUNT;
+	TEST_CHECK(sum > 0.0f);
+
+	// Moves between archetypes, a collider on and off every mesh-less entity
+	start = test_seconds();
+	uint32_t moves = 0;
+	for (uint32_t index = 0; index < ENTITY_COUNT; ++index) {
+		if (index % ARCHETYPE_COUNT & 2)
+			continue;
+		bool had_collider = ecs_has(world, entities[index], ColliderComponent);
+		if (had_collider)
+			ecs_pop(world, entities[index], ColliderComponent);
+		else
+			ecs_put(world, entities[index], ColliderComponent, { .aabb.extent = FLOAT3_ONE });
+		TEST_CHECK(ecs_has(world, entities[index], ColliderComponent) != had_collider);
+		moves++;
+	}
+	double move_ns = (test_seconds() - start) * 1e9 / moves;
+	TEST_CHECK(count_query(world, ecs_query(world, ecs_type_id(TransformComponent))) == ENTITY_COUNT);
+
+	start = test_seconds();
+	for (uint32_t index = 0; index < ENTITY_COUNT; index += 2)
+		ecs_despawn(world, entities[index]);
+	for (uint32_t index = 0; index < ENTITY_COUNT; index += 2) {
+		entities[index] = ecs_spawn(world, (float3){ (float)index, 0.0f, 0.0f });
+		push_components(world, entities[index], index % ARCHETYPE_COUNT);
+	}
+	double churn_ns = (test_seconds() - start) * 1e9 / ENTITY_COUNT;
+	TEST_CHECK(count_query(world, ecs_query(world, ecs_type_id(TransformComponent))) == ENTITY_COUNT);
+
+	printf("%u entities over %u archetypes, ns per entity\n", ENTITY_COUNT, ARCHETYPE_COUNT);
+	printf("%-24s %10.1f\n", "spawn + push", spawn_ns);
+	printf("%-24s %10.2f\n", "query transform", transform_ns);
+	printf("%-24s %10.2f\n", "query mesh + collider", selective_ns);
+	printf("%-24s %10.1f\n", "ecs_find, scattered", find_ns);
+	printf("%-24s %10.1f\n", "push/pop collider", move_ns);
+	printf("%-24s %10.1f\n", "despawn + respawn", churn_ns);
+
+	arena_destroy(&arena);
+	return test_result("bench_ecs");
+}
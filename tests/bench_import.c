@@ -0,0 +1,66 @@
+#include "test.h"
+
+#include "assets/importer.h"
+#include "core/logger.h"
+
+#define ROUNDS 1
+
+typedef struct {
+	uint64_t vertices, indices;
+	double seconds;
+} ImportTotals;
+
+static ImportTotals import_all(Arena *arena, StringList *models, bool use_cache) {
+	ImportTotals totals = { 0 };
+	for (uint32_t round = 0; round < ROUNDS; ++round) {
+		for (StringNode *node = models->first; node; node = node->next) {
+			ArenaTemp temp = arena_temp_begin(arena);
+
+			double start = test_seconds();
+			SceneSource scene = use_cache ? importer_load_gltf_scene(temp.arena, node->string) : importer_reload_gltf_scene(temp.arena, node->string);
+			totals.seconds += test_seconds() - start;
+
+			for (uint32_t mesh = 0; mesh < scene.mesh_count; ++mesh) {
+				totals.vertices += scene.meshes[mesh].vertex_count;
+				totals.indices += scene.meshes[mesh].index_count;
+			}
+
+			importer_unload_scene(&scene);
+			arena_temp_end(temp);
+		}
+	}
+	return totals;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_WARN);
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+
+	// NOTE: Imported from a copy, the importer writes .mesh caches next to its sources
+	String directory = test_temp_directory(&arena, "bench_import");
+	TEST_CHECK(test_copy_tree(&arena, S(ASSETS_DIR "/models/kenney"), directory) > 0);
+
+	StringList files = filesystem_directory_files(&arena, directory, true);
+	StringList models = { 0 };
+	for (StringNode *node = files.first; node; node = node->next)
+		if (string_has_suffix(node->string, S(".glb")) || string_has_suffix(node->string, S(".gltf")))
+			stringlist_push(&arena, &models, node->string);
+	TEST_CHECK(models.count > 0);
+
+	ImportTotals parsed = import_all(&arena, &models, false);
+	ImportTotals cached = import_all(&arena, &models, true);
+
+	TEST_CHECK(parsed.vertices > 0);
+	TEST_CHECK_FORMAT(parsed.vertices == cached.vertices && parsed.indices == cached.indices,
+		"cgltf imported %lu vertices, the cache %lu", (unsigned long)parsed.vertices, (unsigned long)cached.vertices);
+
+	printf("%zu models x %d rounds, %lu vertices and %lu indices per round\n",
+		models.count, ROUNDS, (unsigned long)(parsed.vertices / ROUNDS), (unsigned long)(parsed.indices / ROUNDS));
+	printf("%-12s %10s %16s\n", "path", "ms", "vertices/s");
+	printf("%-12s %10.2f %16.0f\n", "cgltf", parsed.seconds * 1e3, parsed.vertices / parsed.seconds);
+	printf("%-12s %10.2f %16.0f\n", "mesh cache", cached.seconds * 1e3, cached.vertices / cached.seconds);
+
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	return test_result("bench_import");
+}
@@ -0,0 +1,65 @@
+#include "test.h"
+
+#include "core/jobs.h"
+
+#define EMPTY_JOBS 200000
+#define WORK_ITEMS 4096
+#define WORK_ROUNDS 8000
+
+static void job_empty(void *user_data) {}
+
+static void range_work(void *user_data, uint32_t start, uint32_t end) {
+	float *values = user_data;
+	for (uint32_t index = start; index < end; ++index) {
+		float value = values[index];
+		for (uint32_t round = 0; round < WORK_ROUNDS; ++round)
+			value = value * 0.999f + 0.001f;
+		values[index] = value;
+	}
+}
+
+int main(void) {
+	long core_count = sysconf(_SC_NPROCESSORS_ONLN);
+	uint32_t max_threads = core_count > 1 ? (uint32_t)core_count : 1;
+	if (max_threads < 4)
+		max_threads = 4;
+
+	printf("%-8s %16s %16s %10s\n", "threads", "ns per empty job", "parallel for ms", "speedup");
+
+	double single_thread_ms = 0.0;
+	for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+		Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+		if (threads > 1)
+			job_system_startup(&arena, threads - 1, false);
+
+		JobDecl *jobs = arena_push_count(&arena, EMPTY_JOBS, JobDecl);
+		for (uint32_t index = 0; index < EMPTY_JOBS; ++index)
+			jobs[index] = (JobDecl){ .function = job_empty };
+
+		// NOTE: Submitted in queue sized chunks, the time covers push, steal or pop, execute and counter updates
+		double start = test_seconds();
+		for (uint32_t first = 0; first < EMPTY_JOBS; first += JOB_QUEUE_CAPACITY) {
+			JobCounter counter = { 0 };
+			job_run(jobs + first, MIN(JOB_QUEUE_CAPACITY, EMPTY_JOBS - first), &counter);
+			job_wait(&counter);
+		}
+		double per_job_ns = (test_seconds() - start) * 1e9 / EMPTY_JOBS;
+
+		float *values = arena_push_count(&arena, WORK_ITEMS, float);
+		start = test_seconds();
+		job_parallel_for(WORK_ITEMS, 16, range_work, values);
+		double work_ms = (test_seconds() - start) * 1e3;
+		TEST_CHECK(values[0] > 0.0f && values[WORK_ITEMS - 1] > 0.0f);
+
+		if (threads == 1)
+			single_thread_ms = work_ms;
+		printf("%-8u %16.1f %16.2f %9.2fx\n", threads, per_job_ns, work_ms, single_thread_ms / work_ms);
+
+		if (threads > 1)
+			job_system_shutdown();
+		arena_destroy(&arena);
+	}
+
+	printf("online cores: %ld\n", core_count);
+	return test_result("bench_jobs");
+}
@@ -0,0 +1,105 @@
+// Imports every model under assets/models, one after the other and then as jobs the way load_assets does,
+// each model parsed by cgltf into an arena of its own
+#include "test.h"
+
+#include "assets/importer.h"
+#include "core/jobs.h"
+#include "core/logger.h"
+
+typedef struct {
+	String path;
+	Arena arena;
+	uint64_t vertices, indices;
+} ModelImport;
+
+static void model_import_job(void *user_data) {
+	ModelImport *import = user_data;
+	SceneSource scene = importer_reload_gltf_scene(&import->arena, import->path);
+
+	import->vertices = import->indices = 0;
+	for (uint32_t mesh = 0; mesh < scene.mesh_count; ++mesh) {
+		import->vertices += scene.meshes[mesh].vertex_count;
+		import->indices += scene.meshes[mesh].index_count;
+	}
+
+	importer_unload_scene(&scene);
+	arena_reset(&import->arena);
+}
+
+static double import_serial(ModelImport *imports, uint32_t count) {
+	double start = test_seconds();
+	for (uint32_t index = 0; index < count; ++index)
+		model_import_job(&imports[index]);
+	return test_seconds() - start;
+}
+
+static double import_jobs(Arena *arena, ModelImport *imports, uint32_t count) {
+	JobDecl *jobs = arena_push_count(arena, count, JobDecl);
+	for (uint32_t index = 0; index < count; ++index)
+		jobs[index] = (JobDecl){ .function = model_import_job, .user_data = &imports[index] };
+
+	double start = test_seconds();
+	JobCounter counter = { 0 };
+	job_run(jobs, count, &counter);
+	job_wait(&counter);
+	return test_seconds() - start;
+}
+
+static void import_totals(ModelImport *imports, uint32_t count, uint64_t *vertices, uint64_t *indices) {
+	*vertices = *indices = 0;
+	for (uint32_t index = 0; index < count; ++index) {
+		*vertices += imports[index].vertices;
+		*indices += imports[index].indices;
+	}
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_WARN);
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+
+	// NOTE: Imported from a copy, the importer writes .mesh caches next to its sources
+	String directory = test_temp_directory(&arena, "bench_startup_import");
+	TEST_CHECK(test_copy_tree(&arena, S(ASSETS_DIR "/models"), directory) > 0);
+
+	StringList files = filesystem_directory_files(&arena, directory, true);
+	StringList models = { 0 };
+	for (StringNode *node = files.first; node; node = node->next)
+		if (string_has_suffix(node->string, S(".glb")) || string_has_suffix(node->string, S(".gltf")))
+			stringlist_push(&arena, &models, node->string);
+	TEST_CHECK(models.count > 0);
+
+	uint32_t count = (uint32_t)models.count;
+	ModelImport *imports = arena_push_count(&arena, count, ModelImport);
+	uint32_t index = 0;
+	for (StringNode *node = models.first; node; node = node->next, ++index)
+		imports[index] = (ModelImport){ .path = node->string, .arena = arena_reserve(GiB(1), ARENA_FLAG_NONE) };
+
+	double serial_seconds = import_serial(imports, count);
+	uint64_t serial_vertices, serial_indices;
+	import_totals(imports, count, &serial_vertices, &serial_indices);
+
+	Arena job_arena = arena_reserve(MiB(16), ARENA_FLAG_NONE);
+	job_system_startup(&job_arena, 0, false);
+	double job_seconds = import_jobs(&arena, imports, count);
+	uint32_t thread_count = job_thread_count();
+	job_system_shutdown();
+	arena_destroy(&job_arena);
+
+	uint64_t job_vertices, job_indices;
+	import_totals(imports, count, &job_vertices, &job_indices);
+
+	TEST_CHECK(serial_vertices > 0);
+	TEST_CHECK_FORMAT(serial_vertices == job_vertices && serial_indices == job_indices,
+		"serial imported %lu vertices, the jobs %lu", (unsigned long)serial_vertices, (unsigned long)job_vertices);
+
+	printf("%u models, %lu vertices and %lu indices\n", count, (unsigned long)serial_vertices, (unsigned long)serial_indices);
+	printf("%-12s %8s %10s %10s\n", "path", "threads", "ms", "speedup");
+	printf("%-12s %8u %10.2f %9.2fx\n", "serial", 1, serial_seconds * 1e3, 1.0);
+	printf("%-12s %8u %10.2f %9.2fx\n", "job_run", thread_count, job_seconds * 1e3, serial_seconds / job_seconds);
+
+	for (index = 0; index < count; ++index)
+		arena_destroy(&imports[index].arena);
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	return test_result("bench_startup_import");
+}
@@ -0,0 +1,36 @@
+// Second copy of core/cmath.c with only the plain C paths. Everything it defines is static so it
+// doesn't clash with the SIMD build in test_engine, the scalar_ wrappers are what the tests call
+#include "common.h"
+#include "core/logger.h"
+
+#undef ENGINE_API
+#define ENGINE_API static
+#define CMATH_SCALAR
+#include "core/cmath.c"
+
+#include "cmath_scalar.h"
+
+void scalar_float4x4_multiply_into(float4x4 *out, const float4x4 *lhs, const float4x4 *rhs) {
+	float4x4_multiply_into(out, lhs, rhs);
+}
+
+bool scalar_float4x4_inverse_into(float4x4 *out, const float4x4 *m) {
+	return float4x4_inverse_into(out, m);
+}
+
+void scalar_float4x4_compose_into(float4x4 *out, float3 position, float3 rotation, float3 scale) {
+	float4x4_compose_into(out, position, rotation, scale);
+}
+
+// The T * Rz * Ry * Rx * S multiply chain float4x4_compose used to be
+void scalar_float4x4_compose_chain_into(float4x4 *out, float3 position, float3 rotation, float3 scale) {
+	float4x4 chain = float4x4_scaling(scale);
+	chain = float4x4_multiply(float4x4_rotation(deg2radf(rotation.x), FLOAT3_X), chain);
+	chain = float4x4_multiply(float4x4_rotation(deg2radf(rotation.y), FLOAT3_Y), chain);
+	chain = float4x4_multiply(float4x4_rotation(deg2radf(rotation.z), FLOAT3_Z), chain);
+	*out = float4x4_multiply(float4x4_translation(position), chain);
+}
+
+float3 scalar_float4x4_transform_point(const float4x4 *m, float3 point) {
+	return float4x4_transform_point(m, point);
+}
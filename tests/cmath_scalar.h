@@ -0,0 +1,9 @@
+#pragma once
+
+#include "core/cmath.h"
+
+void scalar_float4x4_multiply_into(float4x4 *out, const float4x4 *lhs, const float4x4 *rhs);
+bool scalar_float4x4_inverse_into(float4x4 *out, const float4x4 *m);
+void scalar_float4x4_compose_into(float4x4 *out, float3 position, float3 rotation, float3 scale);
+void scalar_float4x4_compose_chain_into(float4x4 *out, float3 position, float3 rotation, float3 scale);
+float3 scalar_float4x4_transform_point(const float4x4 *m, float3 point);
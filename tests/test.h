@@ -0,0 +1,97 @@
+#pragma once
+
+// NOTE: Include first, nftw and mkdtemp are POSIX extensions
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE
+#endif
+
+#include "common.h"
+
+#include "core/arena.h"
+#include "core/strings.h"
+#include "platform/filesystem.h"
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// NOTE: Checks stay active with NDEBUG, unlike ASSERT. A test's main returns test_result()
+static uint32_t test_failures = 0;
+
+#define TEST_CHECK(condition)                                                              \
+	do {                                                                                   \
+		if (!(condition)) {                                                                \
+			fprintf(stderr, "%s:%d: check failed: [%s]\n", __FILE__, __LINE__, #condition); \
+			test_failures++;                                                               \
+		}                                                                                  \
+	} while (0)
+
+#define TEST_CHECK_FORMAT(condition, fmt, ...)                                                                \
+	do {                                                                                                      \
+		if (!(condition)) {                                                                                   \
+			fprintf(stderr, "%s:%d: check failed: [%s] | " fmt "\n", __FILE__, __LINE__, #condition, __VA_ARGS__); \
+			test_failures++;                                                                                  \
+		}                                                                                                     \
+	} while (0)
+
+// Exit code for a test that couldn't run here, gpu_test() hands it to ctest as SKIP_RETURN_CODE
+#define TEST_SKIPPED 77
+
+static inline double test_seconds(void) {
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+}
+
+static inline int test_result(const char *name) {
+	if (test_failures)
+		fprintf(stderr, "%s: %u check(s) failed\n", name, test_failures);
+	else
+		printf("%s: passed\n", name);
+	return test_failures ? 1 : 0;
+}
+
+// Fresh directory under /tmp, removed again by test_remove_directory
+static inline String test_temp_directory(Arena *arena, const char *name) {
+	String path = string_format(arena, "/tmp/%s_XXXXXX", name);
+	if (mkdtemp(path.chars) == NULL)
+		return (String){ 0 };
+	return path;
+}
+
+static inline int test_remove_entry(const char *path, const struct stat *info, int flag, struct FTW *ftw) {
+	return remove(path);
+}
+
+static inline void test_remove_directory(String path) {
+	if (path.length)
+		nftw(path.chars, test_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// Copies every file below from into to, creating the directories in between. Returns the number of files copied
+static inline uint32_t test_copy_tree(Arena *arena, String from, String to) {
+	ArenaTemp temp = arena_temp_begin(arena);
+	StringList files = filesystem_directory_files(temp.arena, from, true);
+
+	uint32_t copied = 0;
+	for (StringNode *node = files.first; node; node = node->next) {
+		String relative = string_slice(node->string, (uint32_t)from.length, (uint32_t)(node->string.length - from.length));
+		String destination = string_concat(temp.arena, to, relative);
+
+		for (size_t index = to.length + 1; index < destination.length; ++index) {
+			if (destination.chars[index] != '/')
+				continue;
+			destination.chars[index] = '\0';
+			mkdir(destination.chars, 0700);
+			destination.chars[index] = '/';
+		}
+
+		copied += filesystem_file_copy(node->string, destination);
+	}
+
+	arena_temp_end(temp);
+	return copied;
+}
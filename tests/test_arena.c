@@ -0,0 +1,62 @@
+#include "test.h"
+
+#include "core/arena.h"
+
+#include <unistd.h>
+
+static size_t resident_bytes(void) {
+	FILE *file = fopen("/proc/self/statm", "r");
+	if (file == NULL)
+		return 0;
+
+	unsigned long size = 0, resident = 0;
+	if (fscanf(file, "%lu %lu", &size, &resident) != 2)
+		resident = 0;
+	fclose(file);
+
+	return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+int main(void) {
+	size_t baseline = resident_bytes();
+	TEST_CHECK(baseline > 0);
+
+	// Reserving address space alone costs nothing resident
+	Arena arena = arena_reserve(GiB(8), ARENA_FLAG_NONE);
+	TEST_CHECK(arena.base != NULL);
+	TEST_CHECK(arena.committed == 0);
+	TEST_CHECK(resident_bytes() < baseline + MiB(1));
+
+	// Well past the first commit granule, every page is written so it actually becomes resident
+	size_t size = MiB(256);
+	uint8_t *memory = arena_push(&arena, size, 16, false);
+	TEST_CHECK(memory != NULL);
+	memory_set(memory, 0xAB, size);
+	TEST_CHECK(arena.committed >= size);
+	TEST_CHECK(arena.committed < size + ARENA_COMMIT_GRANULE * 2);
+
+	size_t grown = resident_bytes();
+	TEST_CHECK_FORMAT(grown >= baseline + size - MiB(1), "resident grew by %zu bytes", grown - baseline);
+
+	// Rewinding keeps the threshold committed and hands the rest back
+	ArenaTemp temp = arena_temp_begin(&arena);
+	arena_push(&arena, MiB(128), 16, true);
+	arena_temp_end(temp);
+	TEST_CHECK(arena.committed <= size + ARENA_DECOMMIT_THRESHOLD + ARENA_COMMIT_GRANULE);
+
+	arena_reset(&arena);
+	TEST_CHECK(arena.offset == 0);
+	TEST_CHECK(arena.committed <= ARENA_DECOMMIT_THRESHOLD + ARENA_COMMIT_GRANULE);
+
+	size_t shrunk = resident_bytes();
+	TEST_CHECK_FORMAT(shrunk < baseline + ARENA_DECOMMIT_THRESHOLD + MiB(4), "resident still %zu bytes above baseline", shrunk - baseline);
+
+	// Memory handed out again after a reset is zeroed, decommitted or not
+	uint8_t *again = arena_push(&arena, MiB(96), 16, false);
+	TEST_CHECK(again[0] == 0 && again[MiB(96) - 1] == 0);
+
+	arena_destroy(&arena);
+	TEST_CHECK(arena.base == NULL);
+
+	return test_result("test_arena");
+}
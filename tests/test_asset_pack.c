@@ -0,0 +1,186 @@
+#include "test.h"
+
+#include "assets.h"
+#include "assets/asset_pack.h"
+#include "assets/importer.h"
+#include "core/hash.h"
+#include "core/logger.h"
+
+typedef struct {
+	UUID id;
+	Buffer data;
+	bool compressible;
+} PackBlob;
+
+static bool file_write_all(String path, Buffer data) {
+	File file = filesystem_open(path, FILE_MODE_WRITE_BINARY);
+	if (file.handle == NULL)
+		return false;
+	bool result = data.size == 0 || file_write(&file, data.size, 1, data.pointer) == 1;
+	file_close(&file);
+	return result;
+}
+
+static Buffer blob_make(Arena *arena, size_t size, bool compressible) {
+	uint8_t *data = arena_push(arena, MAX(size, 1), 16, false);
+	uint32_t state = 0x12345678u;
+	for (size_t index = 0; index < size; ++index) {
+		state = state * 1664525u + 1013904223u;
+		data[index] = compressible ? (uint8_t)('a' + index % 7) : (uint8_t)(state >> 24);
+	}
+	return buffer_make(data, size);
+}
+
+static void check_round_trip(Arena *arena, String directory, bool compress) {
+	ArenaTemp temp = arena_temp_begin(arena);
+
+	// Unsorted ids. The page sized blob has no padding of its own, so its terminator needs another page
+	Buffer text = buffer_wrap_string(S("hello pack"));
+	PackBlob blobs[] = {
+		{ 900, text, false },
+		{ 5, blob_make(arena, ASSET_PACK_ALIGNMENT, true), true },
+		{ 77, blob_make(arena, 10000, false), false },
+		{ 123456789, { 0 }, false },
+		{ 42, blob_make(arena, 50000, true), true },
+	};
+
+	AssetPackInput inputs[countof(blobs)];
+	for (uint32_t index = 0; index < countof(blobs); ++index)
+		inputs[index] = (AssetPackInput){ .id = blobs[index].id, .type = index, .data = blobs[index].data };
+
+	String path = stringpath_join(arena, directory, compress ? S("compressed.pak") : S("stored.pak"));
+	TEST_CHECK(asset_pack_write(path, inputs, countof(inputs), compress));
+
+	AssetPack pack;
+	TEST_CHECK(asset_pack_open(&pack, path));
+	TEST_CHECK(pack.entry_count == countof(blobs));
+	for (uint32_t index = 1; index < pack.entry_count; ++index)
+		TEST_CHECK(pack.entries[index - 1].id < pack.entries[index].id);
+
+	for (uint32_t index = 0; index < countof(blobs); ++index) {
+		PackBlob *blob = &blobs[index];
+		AssetPackEntry *entry = asset_pack_find(&pack, blob->id);
+		TEST_CHECK_FORMAT(entry != NULL, "asset %llu missing", (unsigned long long)blob->id);
+		if (entry == NULL)
+			continue;
+
+		TEST_CHECK(entry->type == index && entry->size == blob->data.size);
+		TEST_CHECK(entry->content_hash == hash64_content(blob->data.pointer, blob->data.size, 0));
+		TEST_CHECK(entry->offset % ASSET_PACK_ALIGNMENT == 0);
+		bool compressed = compress && blob->compressible;
+		TEST_CHECK_FORMAT((entry->compression == ASSET_PACK_COMPRESSION_LZ4) == compressed, "asset %llu compression", (unsigned long long)blob->id);
+
+		Buffer read = asset_pack_read(&pack, arena, blob->id);
+		TEST_CHECK(read.size == blob->data.size && memory_equals(read.pointer, blob->data.pointer, read.size));
+		// Same contract as filesystem_read whether it's a view into the mapping or decompressed
+		TEST_CHECK_FORMAT(read.pointer && read.pointer[read.size] == '\0', "asset %llu isn't null terminated", (unsigned long long)blob->id);
+
+		bool in_mapping = read.pointer >= pack.mapping.pointer && read.pointer < pack.mapping.pointer + pack.mapping.size;
+		TEST_CHECK(in_mapping != compressed);
+	}
+
+	TEST_CHECK(asset_pack_find(&pack, 6) == NULL);
+	TEST_CHECK(asset_pack_read(&pack, arena, 6).pointer == NULL);
+
+	// A stored blob whose terminator got overwritten is refused instead of handed out unterminated
+	AssetPackEntry *text_entry = asset_pack_find(&pack, 900);
+	uint64_t terminator_offset = text_entry ? text_entry->offset + text.size : 0;
+	Buffer bytes = filesystem_read(arena, path);
+	asset_pack_close(&pack);
+
+	String corrupt_path = stringpath_join(arena, directory, S("corrupt.pak"));
+	bytes.pointer[terminator_offset] = 'x';
+	TEST_CHECK(file_write_all(corrupt_path, bytes));
+	TEST_CHECK(asset_pack_open(&pack, corrupt_path));
+	TEST_CHECK(asset_pack_read(&pack, arena, 900).pointer == NULL);
+	TEST_CHECK(asset_pack_read(&pack, arena, 77).pointer != NULL);
+	asset_pack_close(&pack);
+
+	// Truncated file and wrong version
+	TEST_CHECK(file_write_all(corrupt_path, buffer_make(bytes.pointer, bytes.size - 1)));
+	TEST_CHECK(asset_pack_open(&pack, corrupt_path) == false);
+
+	((AssetPackHeader *)bytes.pointer)->version = ASSET_PACK_VERSION - 1;
+	TEST_CHECK(file_write_all(corrupt_path, bytes));
+	TEST_CHECK(asset_pack_open(&pack, corrupt_path) == false);
+
+	inputs[1].id = inputs[0].id;
+	TEST_CHECK(asset_pack_write(path, inputs, countof(inputs), compress) == false);
+
+	arena_temp_end(temp);
+}
+
+// Packs a tracked directory, then reads everything back through the store and the importers
+static void check_store(Arena *arena, String directory) {
+	ArenaTemp temp = arena_temp_begin(arena);
+
+	String root = stringpath_join(arena, directory, S("store"));
+	filesystem_make_directory(root);
+	String note = stringpath_join(arena, root, S("note.txt"));
+	String model = stringpath_join(arena, root, S("BoxTextured.glb"));
+	String uncooked = stringpath_join(arena, root, S("Uncooked.glb"));
+	String font = stringpath_join(arena, root, S("PixeloidSans.ttf"));
+	TEST_CHECK(file_write_all(note, buffer_wrap_string(S("packed note"))));
+	TEST_CHECK(filesystem_file_copy(S(ASSETS_DIR "/models/test/BoxTextured.glb"), model));
+	TEST_CHECK(filesystem_file_copy(S(ASSETS_DIR "/models/test/BoxTextured.glb"), uncooked));
+	TEST_CHECK(filesystem_file_copy(S(ASSETS_DIR "/pokemon/graphics/fonts/PixeloidSans.ttf"), font));
+
+	AssetStore store = asset_store_make(arena);
+	TEST_CHECK(asset_store_track_directory(&store, root));
+
+	// Loaded from the loose files before anything is packed, reference for what comes out of the pack.
+	// Importing cooks model, the other scene goes into the pack as its source
+	SceneSource loose_scene = importer_reload_gltf_scene(arena, model);
+	Font loose_font = importer_load_font(arena, font, 16.0f);
+	TEST_CHECK(loose_scene.mesh_count > 0 && loose_font.glyphs != NULL);
+	TEST_CHECK(file_exists(importer_mesh_cache_path(arena, model)) && file_exists(importer_mesh_cache_path(arena, uncooked)) == false);
+
+	String pack_path = stringpath_join(arena, root, S("assets.pak"));
+	TEST_CHECK(asset_store_pack(&store, pack_path, true));
+	TEST_CHECK(asset_store_mount_pack(&store, pack_path));
+
+	// Loose copies are gone, whatever is read now came out of the pack
+	TEST_CHECK(remove(note.chars) == 0 && remove(model.chars) == 0 && remove(font.chars) == 0);
+	TEST_CHECK(remove(importer_mesh_cache_path(arena, model).chars) == 0);
+
+	Buffer read = asset_store_read(&store, arena, note);
+	TEST_CHECK(read.size == S("packed note").length && memory_equals(read.pointer, "packed note", read.size) && read.pointer[read.size] == '\0');
+
+	Font packed_font = importer_load_font_memory(arena, asset_store_read(&store, arena, font), 16.0f);
+	TEST_CHECK(packed_font.glyphs && packed_font.line_height == loose_font.line_height);
+	TEST_CHECK(packed_font.glyphs && memory_equals(packed_font.glyphs, loose_font.glyphs, sizeof(Glyph) * 128));
+
+	// The cooked scene is read straight from the .mesh in the pack, the uncooked one is imported from its bytes
+	String scene_paths[] = { model, uncooked };
+	for (uint32_t index = 0; index < countof(scene_paths); ++index) {
+		Buffer file = asset_store_read(&store, arena, scene_paths[index]);
+		TEST_CHECK(file.size > 4 && memory_equals(file.pointer, "glTF", 4) == (index == 1));
+
+		SceneSource packed_scene = importer_load_gltf_scene_memory(arena, scene_paths[index], file);
+		TEST_CHECK(packed_scene.mapping.pointer == NULL);
+		TEST_CHECK(packed_scene.mesh_count == loose_scene.mesh_count && packed_scene.image_count == loose_scene.image_count);
+		TEST_CHECK(packed_scene.vertices_size == loose_scene.vertices_size && memory_equals(packed_scene.vertices, loose_scene.vertices, loose_scene.vertices_size));
+		TEST_CHECK(packed_scene.image_count && packed_scene.images[0].pixels != NULL);
+		importer_unload_scene(&packed_scene);
+	}
+	importer_unload_scene(&loose_scene);
+
+	asset_store_unmount_pack(&store);
+	TEST_CHECK(asset_store_read(&store, arena, note).pointer == NULL);
+
+	arena_temp_end(temp);
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+	String directory = test_temp_directory(&arena, "asset_pack");
+
+	check_round_trip(&arena, directory, false);
+	check_round_trip(&arena, directory, true);
+	check_store(&arena, directory);
+
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	return test_result("test_asset_pack");
+}
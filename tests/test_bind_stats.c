@@ -0,0 +1,141 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Records a known sequence of binds over two recorders and checks which of them the recorders dropped, then
+// counts the descriptor writes of a main pass that pushes a material set per draw against one binding made sets
+#include "test.h"
+
+#include "core/logger.h"
+#include "renderer/backend/vulkan_api.h"
+
+#define TARGET_SIZE 16
+#define DRAW_COUNT 64
+
+static bool pass_begin(VulkanContext *context, RhiTexture target, uint32_t recorder_count, VulkanRecorder **recorders) {
+	DrawlistDesc pass = {
+		.name = S("test_bind_stats"),
+		.color_attachments[0] = { .target = target, .load = CLEAR, .store = STORE },
+		.color_attachment_count = 1,
+		.viewport = { 0, 0, TARGET_SIZE, TARGET_SIZE },
+		.msaa_level = 1,
+	};
+	return vulkan_drawlist_begin_parallel(context, pass, recorder_count, recorders);
+}
+
+// One frame of DRAW_COUNT draws alternating between the two materials, returns the frame's descriptor writes
+static uint32_t main_pass_writes(VulkanContext *context, RhiTexture target, RhiShader shader, RhiBuffer uniforms, RhiUniformSet *materials) {
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+	VulkanRecorder *recorder;
+	if (pass_begin(context, target, 1, &recorder)) {
+		vulkan_shader_bind(context, recorder, shader, DEFAULT_PIPELINE);
+		for (uint32_t draw = 0; draw < DRAW_COUNT; ++draw) {
+			RhiUniformSet material = materials ? materials[draw % 2] : vulkan_uniformset_push(context, recorder, shader, 1);
+			if (materials == NULL)
+				vulkan_uniformset_bind_buffer_range(context, material, 0, (draw % 2) * 256, 256, uniforms);
+			vulkan_uniformset_bind(context, recorder, material);
+		}
+		vulkan_drawlist_end(context);
+	}
+	vulkan_frame_end(context);
+
+	return vulkan_bind_stats(context).descriptor_writes;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("test_bind_stats: no usable Vulkan device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	Buffer vertex = filesystem_read(&arena, S(ASSETS_DIR "/shaders/vertex/bin/basic.vertex.spv"));
+	Buffer fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/unlit.fragment.spv"));
+	if (vertex.size == 0 || fragment.size == 0) {
+		printf("test_bind_stats: shaders aren't compiled, skipped\n");
+		vulkan_renderer_destroy(context);
+		return TEST_SKIPPED;
+	}
+
+	RhiTexture target = vulkan_texture_make(context, TARGET_SIZE, TARGET_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_RENDER_TARGET, NULL);
+	RhiBuffer geometry = vulkan_buffer_make(context, BUFFER_USAGE_VERTEX | BUFFER_USAGE_INDEX, BUFFER_MEMORY_DEVICE, KiB(4), NULL);
+	RhiBuffer uniforms = vulkan_buffer_make(context, BUFFER_USAGE_UNIFORM, BUFFER_MEMORY_SHARED, KiB(4), NULL);
+	RhiShader shader = vulkan_shader_make(NULL, context, S("test_bind_stats"), vertex, fragment, NULL);
+	TEST_CHECK(shader.id);
+
+	RhiUniformSet materials[2];
+	for (uint32_t index = 0; index < countof(materials); ++index) {
+		materials[index] = vulkan_uniformset_make(context, shader, 1);
+		vulkan_uniformset_bind_buffer_range(context, materials[index], 0, index * 256, 256, uniforms);
+	}
+
+	PipelineDesc pipeline = DEFAULT_PIPELINE;
+	VulkanRecorder *recorders[2];
+
+	// Repeats are dropped, anything that changes the binding is recorded, and each recorder starts from nothing
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+	if (pass_begin(context, target, 2, recorders)) {
+		VulkanRecorder *first = recorders[0], *second = recorders[1];
+
+		vulkan_buffer_bind_vertex(context, first, geometry, 0);        // issued
+		vulkan_buffer_bind_vertex(context, first, geometry, 0);        // skipped
+		vulkan_buffer_bind_index(context, first, geometry, 0);         // issued
+		vulkan_buffer_bind_index(context, first, geometry, 0);         // skipped
+		vulkan_buffer_bind_index(context, first, geometry, 64);        // issued, new offset
+
+		vulkan_shader_bind(context, first, shader, pipeline);          // issued
+		vulkan_shader_bind(context, first, shader, pipeline);          // skipped
+		vulkan_uniformset_bind(context, first, materials[0]);          // issued
+		vulkan_uniformset_bind(context, first, materials[0]);          // skipped
+		vulkan_uniformset_bind(context, first, materials[1]);          // issued
+		vulkan_uniformset_bind(context, first, materials[0]);          // issued
+
+		vulkan_shader_bind(context, second, shader, pipeline);         // issued
+		vulkan_uniformset_bind(context, second, materials[1]);         // issued
+
+		vulkan_drawlist_end(context);
+	}
+	vulkan_frame_end(context);
+
+	VulkanBindStats stats = vulkan_bind_stats(context);
+	TEST_CHECK_FORMAT(stats.issued == 9, "%u issued", stats.issued);
+	TEST_CHECK_FORMAT(stats.skipped == 4, "%u skipped", stats.skipped);
+
+	// State doesn't carry over into the next pass, and the counters start over with the frame
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+	if (pass_begin(context, target, 1, recorders)) {
+		vulkan_shader_bind(context, recorders[0], shader, pipeline);   // issued
+		vulkan_uniformset_bind(context, recorders[0], materials[1]);   // issued
+		vulkan_uniformset_bind(context, recorders[0], materials[1]);   // skipped
+		vulkan_drawlist_end(context);
+	}
+	vulkan_frame_end(context);
+
+	stats = vulkan_bind_stats(context);
+	TEST_CHECK_FORMAT(stats.issued == 2 && stats.skipped == 1, "%u issued, %u skipped", stats.issued, stats.skipped);
+
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+	vulkan_frame_end(context);
+	stats = vulkan_bind_stats(context);
+	TEST_CHECK(stats.issued == 0 && stats.skipped == 0);
+
+	// Pushed sets are written on every draw, the made ones were written once up front and only get bound
+	uint32_t transient_writes = main_pass_writes(context, target, shader, uniforms, NULL);
+	uint32_t persistent_writes = main_pass_writes(context, target, shader, uniforms, materials);
+	printf("%-12s %18s\n", "materials", "descriptor writes");
+	printf("%-12s %18u\n", "pushed", transient_writes);
+	printf("%-12s %18u\n", "made", persistent_writes);
+	TEST_CHECK_FORMAT(transient_writes == DRAW_COUNT, "%u writes pushing a set per draw", transient_writes);
+	TEST_CHECK_FORMAT(persistent_writes == 0, "%u writes binding made sets", persistent_writes);
+
+	for (uint32_t index = 0; index < countof(materials); ++index)
+		vulkan_uniformset_destroy(context, materials[index]);
+	vulkan_shader_destroy(context, shader);
+	vulkan_buffer_destroy(context, uniforms);
+	vulkan_buffer_destroy(context, geometry);
+	vulkan_texture_destroy(context, target);
+	vulkan_renderer_destroy(context);
+	arena_destroy(&arena);
+
+	return test_result("test_bind_stats");
+}
@@ -0,0 +1,154 @@
+#include "test.h"
+
+#include "cmath_scalar.h"
+
+#include <float.h>
+
+#define MATRIX_COUNT 4096
+
+// NOTE: In ULPs of the largest magnitude involved, cancellation makes per-element ULPs meaningless near zero
+#define MULTIPLY_ULPS 4.0f
+#define TRANSFORM_ULPS 4.0f
+#define INVERSE_ULPS 64.0f
+
+static uint32_t random_state = 0x9E3779B9u;
+
+static float random_range(float min, float max) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return min + (max - min) * (float)(random_state >> 8) / (float)(1u << 24);
+}
+
+static float3 random_float3(float min, float max) {
+	return (float3){ random_range(min, max), random_range(min, max), random_range(min, max) };
+}
+
+// Translation, rotation and non-zero scale, the kind of matrix the renderer actually inverts
+static float4x4 random_transform(void) {
+	float3 scale = random_float3(0.25f, 4.0f);
+	if (random_range(0.0f, 1.0f) < 0.5f)
+		scale.y = -scale.y;
+
+	float4x4 result;
+	scalar_float4x4_compose_into(&result, random_float3(-100.0f, 100.0f), random_float3(-180.0f, 180.0f), scale);
+	return result;
+}
+
+static float4x4 random_matrix(void) {
+	float4x4 result;
+	for (uint32_t index = 0; index < 16; ++index)
+		result.elements[index] = random_range(-10.0f, 10.0f);
+	return result;
+}
+
+static float max_magnitude(const float *values, uint32_t count) {
+	float result = FLT_MIN;
+	for (uint32_t index = 0; index < count; ++index)
+		result = MAX(result, fabsf(values[index]));
+	return result;
+}
+
+static bool floats_within(const float *a, const float *b, uint32_t count, float ulps, float magnitude) {
+	float tolerance = ulps * FLT_EPSILON * magnitude;
+	for (uint32_t index = 0; index < count; ++index)
+		if (fabsf(a[index] - b[index]) > tolerance)
+			return false;
+	return true;
+}
+
+static bool floats_close(const float *a, const float *b, uint32_t count, float ulps) {
+	return floats_within(a, b, count, ulps, MAX(max_magnitude(a, count), max_magnitude(b, count)));
+}
+
+static void check_multiply(void) {
+	for (uint32_t index = 0; index < MATRIX_COUNT; ++index) {
+		float4x4 lhs = index & 1 ? random_matrix() : random_transform();
+		float4x4 rhs = index & 2 ? random_matrix() : random_transform();
+
+		float4x4 simd, scalar;
+		float4x4_multiply_into(&simd, &lhs, &rhs);
+		scalar_float4x4_multiply_into(&scalar, &lhs, &rhs);
+		TEST_CHECK_FORMAT(floats_close(simd.elements, scalar.elements, 16, MULTIPLY_ULPS), "multiply differs at matrix %u", index);
+
+		// Aliased output is allowed, the SIMD path loads lhs before storing any column
+		float4x4 aliased = lhs;
+		float4x4_multiply_into(&aliased, &aliased, &rhs);
+		TEST_CHECK_FORMAT(floats_close(aliased.elements, scalar.elements, 16, MULTIPLY_ULPS), "aliased multiply differs at matrix %u", index);
+	}
+}
+
+static void check_inverse(void) {
+	for (uint32_t index = 0; index < MATRIX_COUNT; ++index) {
+		float4x4 m = random_transform();
+
+		float4x4 simd, scalar;
+		TEST_CHECK(float4x4_inverse_into(&simd, &m));
+		TEST_CHECK(scalar_float4x4_inverse_into(&scalar, &m));
+		TEST_CHECK_FORMAT(floats_close(simd.elements, scalar.elements, 16, INVERSE_ULPS), "inverse differs at matrix %u", index);
+
+		float4x4 product;
+		float4x4 identity = float4x4_identity();
+		float4x4_multiply_into(&product, &m, &simd);
+		TEST_CHECK_FORMAT(floats_close(product.elements, identity.elements, 16, INVERSE_ULPS * 16.0f), "m * inverse(m) isn't identity at matrix %u", index);
+	}
+
+	// Singular input is reported by both paths and leaves out untouched
+	float4x4 singular = { 0 };
+	for (uint32_t column = 0; column < 4; ++column)
+		singular.elements[column * 4 + 0] = singular.elements[column * 4 + 1] = (float)(column + 1);
+
+	float4x4 simd = float4x4_identity(), scalar = float4x4_identity();
+	float4x4 identity = float4x4_identity();
+	TEST_CHECK(float4x4_inverse_into(&simd, &singular) == false);
+	TEST_CHECK(scalar_float4x4_inverse_into(&scalar, &singular) == false);
+	TEST_CHECK(memory_equals_struct(&simd, &identity) && memory_equals_struct(&scalar, &identity));
+}
+
+static void check_compose(void) {
+	for (uint32_t index = 0; index < MATRIX_COUNT; ++index) {
+		float3 position = random_float3(-100.0f, 100.0f), rotation = random_float3(-180.0f, 180.0f), scale = random_float3(0.25f, 4.0f);
+
+		float4x4 composed, scalar;
+		float4x4_compose_into(&composed, position, rotation, scale);
+		scalar_float4x4_compose_into(&scalar, position, rotation, scale);
+		TEST_CHECK_FORMAT(floats_close(composed.elements, scalar.elements, 16, MULTIPLY_ULPS), "compose differs at matrix %u", index);
+
+		// Same result as the T * Rz * Ry * Rx * S chain it replaces
+		float4x4 chain = float4x4_scale(float4x4_identity(), scale);
+		chain = float4x4_multiply(float4x4_rotate(float4x4_identity(), deg2radf(rotation.x), (float3){ 1.0f, 0.0f, 0.0f }), chain);
+		chain = float4x4_multiply(float4x4_rotate(float4x4_identity(), deg2radf(rotation.y), (float3){ 0.0f, 1.0f, 0.0f }), chain);
+		chain = float4x4_multiply(float4x4_rotate(float4x4_identity(), deg2radf(rotation.z), (float3){ 0.0f, 0.0f, 1.0f }), chain);
+		chain = float4x4_multiply(float4x4_translate(float4x4_identity(), position), chain);
+		TEST_CHECK_FORMAT(floats_close(composed.elements, chain.elements, 16, INVERSE_ULPS), "compose doesn't match the chain at matrix %u", index);
+	}
+}
+
+static void check_transform_point(void) {
+	for (uint32_t index = 0; index < MATRIX_COUNT; ++index) {
+		float4x4 m = index & 1 ? random_matrix() : random_transform();
+		float3 point = random_float3(-50.0f, 50.0f);
+
+		float3 simd = float4x4_transform_point(&m, point);
+		float3 scalar = scalar_float4x4_transform_point(&m, point);
+		float3 through_transform = float4x4_transform(m, (float4){ point.x, point.y, point.z, 1.0f });
+
+		float reference[3] = { scalar.x, scalar.y, scalar.z };
+		float simd_values[3] = { simd.x, simd.y, simd.z };
+		float transform_values[3] = { through_transform.x, through_transform.y, through_transform.z };
+		// Products can cancel, so the tolerance follows the terms rather than the result
+		float point_values[3] = { point.x, point.y, point.z };
+		float magnitude = max_magnitude(m.elements, 16) * MAX(max_magnitude(point_values, 3), 1.0f);
+		TEST_CHECK_FORMAT(floats_within(simd_values, reference, 3, TRANSFORM_ULPS, magnitude), "transform_point differs at matrix %u", index);
+		TEST_CHECK_FORMAT(floats_within(transform_values, reference, 3, TRANSFORM_ULPS, magnitude), "transform differs at matrix %u", index);
+	}
+}
+
+int main(void) {
+	check_multiply();
+	check_inverse();
+	check_compose();
+	check_transform_point();
+
+	return test_result("test_cmath");
+}
@@ -0,0 +1,110 @@
+#include "test.h"
+
+#include <stb/stb_image_write.h>
+#include <sys/wait.h>
+#include <utime.h>
+
+// Two dungeon scenes share one colormap, the rock has its own and the box embeds its texture
+static const char *scene_files[] = { "dungeon/corridor.glb", "dungeon/gate-door.glb", "survival/rock-a.glb", "BoxTextured.glb" };
+static const char *copied_files[][2] = {
+	{ "models/kenney/modular_dungeon/corridor.glb", "dungeon/corridor.glb" },
+	{ "models/kenney/modular_dungeon/gate-door.glb", "dungeon/gate-door.glb" },
+	{ "models/kenney/modular_dungeon/Textures/colormap.png", "dungeon/Textures/colormap.png" },
+	{ "models/kenney/survival_kit/rock-a.glb", "survival/rock-a.glb" },
+	{ "models/kenney/survival_kit/Textures/colormap.png", "survival/Textures/colormap.png" },
+	{ "models/test/BoxTextured.glb", "BoxTextured.glb" },
+};
+
+typedef struct {
+	ino_t inode;
+	bool exists;
+} OutputState;
+
+static bool cook(Arena *arena, String directory) {
+	ArenaTemp temp = arena_temp_begin(arena);
+	String command = string_format(temp.arena, "%s -j 2 '%.*s' > /dev/null 2>&1", ASSET_COOK, SARG(directory));
+	int status = system(command.chars);
+	arena_temp_end(temp);
+	return status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Outputs are written through a temporary and renamed into place, so a rewritten output has a new inode
+static OutputState output_state(Arena *arena, String directory, const char *relative) {
+	ArenaTemp temp = arena_temp_begin(arena);
+	String path = stringpath_join(temp.arena, directory, string_wrap((char *)relative));
+	struct stat info;
+	OutputState result = { 0 };
+	if (stat(path.chars, &info) == 0)
+		result = (OutputState){ .inode = info.st_ino, .exists = true };
+	arena_temp_end(temp);
+	return result;
+}
+
+static void snapshot(Arena *arena, String directory, OutputState *scenes, OutputState *pack) {
+	for (uint32_t index = 0; index < countof(scene_files); ++index) {
+		String cache = string_format(arena, "%.*s", (int)(strlen(scene_files[index]) - 4), scene_files[index]);
+		scenes[index] = output_state(arena, directory, string_format(arena, "%.*s.mesh", SARG(cache)).chars);
+	}
+	*pack = output_state(arena, directory, "assets.pak");
+}
+
+// Bit i set when scene i's cache was rewritten between the two snapshots
+static uint32_t rewritten_mask(OutputState *before, OutputState *after) {
+	uint32_t result = 0;
+	for (uint32_t index = 0; index < countof(scene_files); ++index)
+		if (before[index].exists == false || after[index].exists == false || before[index].inode != after[index].inode)
+			result |= 1u << index;
+	return result;
+}
+
+int main(void) {
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	String directory = test_temp_directory(&arena, "cook_graph");
+
+	for (uint32_t index = 0; index < countof(copied_files); ++index) {
+		String to = stringpath_join(&arena, directory, string_wrap((char *)copied_files[index][1]));
+		for (size_t cursor = directory.length + 1; cursor < to.length; ++cursor) {
+			if (to.chars[cursor] != '/')
+				continue;
+			to.chars[cursor] = '\0';
+			mkdir(to.chars, 0700);
+			to.chars[cursor] = '/';
+		}
+		TEST_CHECK(filesystem_file_copy(string_format(&arena, ASSETS_DIR "/%s", copied_files[index][0]), to));
+	}
+
+	OutputState scenes[4][countof(scene_files)], packs[4];
+
+	TEST_CHECK(cook(&arena, directory));
+	snapshot(&arena, directory, scenes[0], &packs[0]);
+	for (uint32_t index = 0; index < countof(scene_files); ++index)
+		TEST_CHECK_FORMAT(scenes[0][index].exists, "'%s' wasn't cooked", scene_files[index]);
+	TEST_CHECK(packs[0].exists);
+
+	// Nothing changed, nothing is written
+	TEST_CHECK(cook(&arena, directory));
+	snapshot(&arena, directory, scenes[1], &packs[1]);
+	TEST_CHECK_FORMAT(rewritten_mask(scenes[0], scenes[1]) == 0, "second cook rewrote 0x%x", rewritten_mask(scenes[0], scenes[1]));
+	TEST_CHECK(packs[1].inode == packs[0].inode);
+
+	// A newer timestamp on identical contents re-hashes the texture but still rebuilds nothing
+	String texture = stringpath_join(&arena, directory, S("dungeon/Textures/colormap.png"));
+	struct utimbuf times = { .actime = time(NULL) + 10, .modtime = time(NULL) + 10 };
+	TEST_CHECK(utime(texture.chars, &times) == 0);
+	TEST_CHECK(cook(&arena, directory));
+	snapshot(&arena, directory, scenes[2], &packs[2]);
+	TEST_CHECK_FORMAT(rewritten_mask(scenes[1], scenes[2]) == 0, "touching the texture rewrote 0x%x", rewritten_mask(scenes[1], scenes[2]));
+	TEST_CHECK(packs[2].inode == packs[1].inode);
+
+	// New contents for the shared dungeon texture, only the two scenes using it and the pack are rebuilt
+	uint8_t pixels[2 * 2 * 4] = { 255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 255 };
+	TEST_CHECK(stbi_write_png(texture.chars, 2, 2, 4, pixels, 2 * 4) != 0);
+	TEST_CHECK(cook(&arena, directory));
+	snapshot(&arena, directory, scenes[3], &packs[3]);
+	TEST_CHECK_FORMAT(rewritten_mask(scenes[2], scenes[3]) == 0x3, "editing the texture rewrote 0x%x, expected 0x3", rewritten_mask(scenes[2], scenes[3]));
+	TEST_CHECK(packs[3].inode != packs[2].inode);
+
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	return test_result("test_cook_graph");
+}
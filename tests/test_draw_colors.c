@@ -0,0 +1,175 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Draws four bands through one written set, each draw moving its color and line ranges with dynamic offsets,
+// then reads the target back to see every band came out in its own color. Only the per-material set's buffers
+// are reflected as dynamic, the global set is written plain
+#include "test.h"
+
+#include "core/logger.h"
+#include "renderer/backend/vulkan_api.h"
+
+#define TARGET_SIZE 16
+#define BAND_COUNT 4
+#define BAND_STRIDE 256
+
+typedef struct {
+	float4x4 projection, view;
+	float4 camera_position;
+	float2 viewport;
+	float padding[2];
+} GlobalData;
+
+static const float4 band_colors[BAND_COUNT] = {
+	{ 1.0f, 0.0f, 0.0f, 1.0f },
+	{ 0.0f, 1.0f, 0.0f, 1.0f },
+	{ 0.0f, 0.0f, 1.0f, 1.0f },
+	{ 1.0f, 1.0f, 0.0f, 1.0f },
+};
+static const uint32_t band_pixels[BAND_COUNT] = { 0xFF0000FF, 0xFF00FF00, 0xFFFF0000, 0xFF00FFFF };
+
+typedef struct {
+	VulkanContext *context;
+	RhiShader shader;
+	RhiTexture target;
+	RhiBuffer uniforms, storage;
+} DrawState;
+
+// Band n goes to the rows of band order[n], so the offsets alone decide where each color lands
+static void frame_draw(DrawState *state, RhiUniformSet persistent, const uint32_t order[BAND_COUNT]) {
+	VulkanContext *context = state->context;
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+
+	DrawlistDesc pass = {
+		.name = S("test_draw_colors"),
+		.color_attachments[0] = { .target = state->target, .load = CLEAR, .store = STORE },
+		.color_attachment_count = 1,
+		.msaa_level = 1,
+	};
+	VulkanRecorder *recorder = vulkan_drawlist_begin(context, pass);
+	if (recorder) {
+		PipelineDesc pipeline = DEFAULT_PIPELINE;
+		pipeline.depth_test_enable = pipeline.depth_write_enable = false;
+		vulkan_shader_bind(context, recorder, state->shader, pipeline);
+
+		float4x4 model = float4x4_identity();
+		vulkan_push_constants(context, recorder, 0, sizeof(float4x4), model.elements);
+
+		RhiUniformSet global = vulkan_uniformset_push(context, recorder, state->shader, 0);
+		vulkan_uniformset_bind_buffer_range(context, global, 0, 0, sizeof(GlobalData), state->uniforms);
+		vulkan_uniformset_bind_buffer_range(context, global, 1, 0, BAND_STRIDE, state->storage);
+		vulkan_uniformset_bind(context, recorder, global);
+
+		RhiUniformSet group = persistent;
+		if (group.id == 0) {
+			group = vulkan_uniformset_push(context, recorder, state->shader, 1);
+			vulkan_uniformset_bind_buffer_range(context, group, 0, BAND_STRIDE, sizeof(float4), state->uniforms);
+			vulkan_uniformset_bind_buffer_range(context, group, 1, 0, 2 * sizeof(float4), state->storage);
+		}
+
+		// NOTE: Offsets add to the written ranges, the colors start one stride in, past the global block
+		for (uint32_t band = 0; band < BAND_COUNT; ++band) {
+			uint32_t offsets[] = { band * BAND_STRIDE, order[band] * BAND_STRIDE };
+			vulkan_uniformset_bind_dynamic(context, recorder, group, offsets);
+			vulkan_renderer_draw(context, recorder, 6);
+		}
+
+		vulkan_drawlist_end(context);
+	}
+
+	vulkan_frame_end(context);
+}
+
+static void check_bands(DrawState *state, const uint32_t order[BAND_COUNT], const char *label) {
+	uint32_t pixels[TARGET_SIZE * TARGET_SIZE] = { 0 };
+	TEST_CHECK(vulkan_texture_read_pixels(state->context, state->target, 0, 0, pixels));
+
+	uint32_t rows_per_band = TARGET_SIZE / BAND_COUNT;
+	for (uint32_t band = 0; band < BAND_COUNT; ++band) {
+		for (uint32_t row = 1; row < rows_per_band - 1; ++row) {
+			uint32_t y = order[band] * rows_per_band + row;
+			uint32_t pixel = pixels[y * TARGET_SIZE + TARGET_SIZE / 2];
+			TEST_CHECK_FORMAT(pixel == band_pixels[band], "%s: row %u is 0x%08x, expected 0x%08x", label, y, pixel, band_pixels[band]);
+		}
+	}
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("test_draw_colors: no usable Vulkan device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	Buffer vertex = filesystem_read(&arena, S(ASSETS_DIR "/shaders/vertex/bin/line.vertex.spv"));
+	Buffer fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/flat.fragment.spv"));
+	if (vertex.size == 0 || fragment.size == 0) {
+		printf("test_draw_colors: shaders aren't compiled, skipped\n");
+		vulkan_renderer_destroy(context);
+		return TEST_SKIPPED;
+	}
+
+	ShaderReflection reflection = { 0 };
+	DrawState state = {
+		.context = context,
+		.shader = vulkan_shader_make(&arena, context, S("test_draw_colors"), vertex, fragment, &reflection),
+		.target = vulkan_texture_make(context, TARGET_SIZE, TARGET_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_RENDER_TARGET | TEXTURE_USAGE_READBACK, NULL),
+		.uniforms = vulkan_buffer_make(context, BUFFER_USAGE_UNIFORM, BUFFER_MEMORY_SHARED, (BAND_COUNT + 1) * BAND_STRIDE, NULL),
+		.storage = vulkan_buffer_make(context, BUFFER_USAGE_STORAGE, BUFFER_MEMORY_SHARED, BAND_COUNT * BAND_STRIDE, NULL),
+	};
+	TEST_CHECK(state.shader.id);
+
+	for (uint32_t set = 0; set < SHADER_UNIFORM_FREQUENCY_COUNT; ++set) {
+		for (uint32_t index = 0; index < reflection.sets[set].binding_count; ++index) {
+			ShaderBinding *binding = &reflection.sets[set].bindings[index];
+			bool buffer = binding->type == SHADER_BINDING_UNIFORM_BUFFER || binding->type == SHADER_BINDING_STORAGE_BUFFER;
+			bool expected = buffer && set == SHADER_UNIFORM_FREQUENCY_PER_MATERIAL;
+			TEST_CHECK_FORMAT(binding->dynamic == expected, "set %u binding %u dynamic is %d", set, binding->binding_number, binding->dynamic);
+		}
+	}
+	TEST_CHECK(reflection.sets[SHADER_UNIFORM_FREQUENCY_PER_MATERIAL].binding_count == 2);
+
+	// Identity camera, the lines are given in clip space. The global block sits in front of the colors
+	GlobalData global = {
+		.projection = float4x4_identity(),
+		.view = float4x4_identity(),
+		.viewport = { TARGET_SIZE, TARGET_SIZE },
+	};
+	vulkan_buffer_write_all(context, state.uniforms, 0, sizeof(global), &global);
+
+	// Band n spans the full width through the middle of its quarter, as thick as the quarter is tall
+	for (uint32_t band = 0; band < BAND_COUNT; ++band) {
+		float y = -1.0f + (2.0f * band + 1.0f) / BAND_COUNT;
+		float thickness = (float)TARGET_SIZE / BAND_COUNT;
+		float4 line[] = { { -2.0f, y, 0.5f, thickness }, { 2.0f, y, 0.5f, thickness } };
+
+		vulkan_buffer_write_all(context, state.storage, band * BAND_STRIDE, sizeof(line), line);
+		vulkan_buffer_write_all(context, state.uniforms, (band + 1) * BAND_STRIDE, sizeof(float4), (void *)&band_colors[band]);
+	}
+
+	static const uint32_t in_order[BAND_COUNT] = { 0, 1, 2, 3 };
+	static const uint32_t reversed[BAND_COUNT] = { 3, 2, 1, 0 };
+
+	frame_draw(&state, (RhiUniformSet){ 0 }, in_order);
+	check_bands(&state, in_order, "transient set");
+
+	// A persistent set written once, the same offsets have to move it across frames in flight
+	RhiUniformSet persistent = vulkan_uniformset_make(context, state.shader, 1);
+	vulkan_uniformset_bind_buffer_range(context, persistent, 0, BAND_STRIDE, sizeof(float4), state.uniforms);
+	vulkan_uniformset_bind_buffer_range(context, persistent, 1, 0, 2 * sizeof(float4), state.storage);
+	for (uint32_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT + 1; ++frame) {
+		frame_draw(&state, persistent, reversed);
+		check_bands(&state, reversed, "persistent set");
+	}
+
+	vulkan_uniformset_destroy(context, persistent);
+	vulkan_shader_destroy(context, state.shader);
+	vulkan_buffer_destroy(context, state.storage);
+	vulkan_buffer_destroy(context, state.uniforms);
+	vulkan_texture_destroy(context, state.target);
+	vulkan_renderer_destroy(context);
+	arena_destroy(&arena);
+
+	return test_result("test_draw_colors");
+}
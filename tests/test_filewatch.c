@@ -0,0 +1,153 @@
+// Scripted edits in a scratch directory, checked against what the watcher reports.
+// Builds its own copy of platform/filewatch.c so it can look at the pending arena
+#include "test.h"
+
+#include "core/logger.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#undef ENGINE_API
+#define ENGINE_API static
+#include "platform/filewatch.c"
+
+#define DEBOUNCE_MS 50
+
+static void script_write(Arena *arena, String directory, const char *name, const char *contents) {
+	String path = stringpath_join(arena, directory, string_wrap(name));
+	FILE *file = fopen(path.chars, "wb");
+	if (file == NULL)
+		return;
+	fputs(contents, file);
+	fclose(file);
+}
+
+static void sleep_ms(uint32_t milliseconds) {
+	struct timespec duration = { .tv_sec = milliseconds / 1000, .tv_nsec = (long)(milliseconds % 1000) * 1000000L };
+	nanosleep(&duration, NULL);
+}
+
+// Everything reported within seconds, the watcher thread gets the time to catch up
+static StringList drain(FileWatch *watch, Arena *arena, double seconds) {
+	StringList result = { 0 };
+	double end = test_seconds() + seconds;
+	while (test_seconds() < end) {
+		StringList changes = filewatch_poll(watch, arena);
+		for (StringNode *change = changes.first; change; change = change->next)
+			stringlist_push(arena, &result, change->string);
+		sleep_ms(5);
+	}
+	return result;
+}
+
+static uint32_t reported(StringList changes, String directory, const char *name) {
+	ArenaTemp scratch = arena_scratch_begin(NULL);
+	String path = stringpath_join(scratch.arena, directory, string_wrap(name));
+
+	uint32_t count = 0;
+	for (StringNode *change = changes.first; change; change = change->next)
+		count += string_equals(change->string, path);
+
+	arena_scratch_end(scratch);
+	return count;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_WARN);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	String directory = test_temp_directory(&arena, "test_filewatch");
+	TEST_CHECK(directory.length);
+
+	FileWatch *watch = filewatch_make(&arena, DEBOUNCE_MS);
+	TEST_CHECK(watch);
+	if (watch == NULL || directory.length == 0)
+		return test_result("test_filewatch");
+	TEST_CHECK(filewatch_add(watch, directory, true));
+
+	// A burst of writes settles once, and not before the debounce period
+	{
+		for (uint32_t attempt = 0; attempt < 5; ++attempt)
+			script_write(&arena, directory, "burst.txt", "burst");
+		sleep_ms(DEBOUNCE_MS / 5);
+		TEST_CHECK(filewatch_poll(watch, &arena).first == NULL);
+
+		StringList changes = drain(watch, &arena, 0.3);
+		TEST_CHECK(reported(changes, directory, "burst.txt") == 1);
+		TEST_CHECK(changes.count == 1);
+	}
+
+	// An editor's temporary moved into place is reported under its final name only
+	{
+		script_write(&arena, directory, "save.tmp", "saved");
+		String from = stringpath_join(&arena, directory, S("save.tmp"));
+		String to = stringpath_join(&arena, directory, S("saved.txt"));
+		TEST_CHECK(rename(from.chars, to.chars) == 0);
+
+		StringList changes = drain(watch, &arena, 0.3);
+		TEST_CHECK(reported(changes, directory, "saved.txt") == 1);
+		TEST_CHECK(reported(changes, directory, "save.tmp") == 0);
+	}
+
+	// Deleted before it settled, nothing is left to report
+	{
+		script_write(&arena, directory, "gone.txt", "gone");
+		TEST_CHECK(remove(stringpath_join(&arena, directory, S("gone.txt")).chars) == 0);
+
+		StringList changes = drain(watch, &arena, 0.3);
+		TEST_CHECK(changes.first == NULL);
+	}
+
+	// Directories created after the watch started are picked up, including files written before their watch existed
+	{
+		String nested = stringpath_join(&arena, directory, S("nested"));
+		TEST_CHECK(mkdir(nested.chars, 0755) == 0);
+		script_write(&arena, nested, "inner.txt", "inner");
+
+		StringList changes = drain(watch, &arena, 0.3);
+		TEST_CHECK(reported(changes, nested, "inner.txt") == 1);
+
+		script_write(&arena, nested, "inner.txt", "edited");
+		changes = drain(watch, &arena, 0.3);
+		TEST_CHECK(reported(changes, nested, "inner.txt") == 1);
+	}
+
+	// One file kept busy while others settle around it. The pending arena has to stay at what is still
+	// pending instead of growing with every change handed out
+	{
+		uint32_t written = 0, settled = 0;
+		size_t high_water = 0;
+
+		double end = test_seconds() + 1.5;
+		while (test_seconds() < end) {
+			char name[32];
+			snprintf(name, sizeof(name), "churn_%u.txt", written++);
+			script_write(&arena, directory, name, "churn");
+			script_write(&arena, directory, "busy.txt", "busy");
+
+			StringList changes = filewatch_poll(watch, &arena);
+			for (StringNode *change = changes.first; change; change = change->next)
+				settled += string_equals(stringpath_filename(change->string), S("busy.txt")) == false;
+
+			pthread_mutex_lock(&watch->mutex);
+			high_water = watch->pending_arena.offset > high_water ? watch->pending_arena.offset : high_water;
+			pthread_mutex_unlock(&watch->mutex);
+
+			sleep_ms(5);
+		}
+
+		StringList changes = drain(watch, &arena, 0.3);
+		for (StringNode *change = changes.first; change; change = change->next)
+			settled += string_equals(stringpath_filename(change->string), S("busy.txt")) == false;
+
+		TEST_CHECK_FORMAT(settled == written, "%u of %u settled", settled, written);
+		TEST_CHECK_FORMAT(high_water < KiB(4), "pending arena reached %zu bytes over %u changes", high_water, written);
+		TEST_CHECK(watch->pending_arena.offset == 0);
+	}
+
+	filewatch_destroy(watch);
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+
+	return test_result("test_filewatch");
+}
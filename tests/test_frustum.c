@@ -0,0 +1,147 @@
+#include "test.h"
+
+#include "core/frustum.h"
+
+#include <float.h>
+
+// NOTE: Not a multiple of 4, the last boxes go through the scalar remainder loop
+#define BOX_COUNT 10003
+
+static uint32_t random_state = 0x2545F491u;
+
+static float random_range(float min, float max) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 17;
+	random_state ^= random_state << 5;
+	return min + (max - min) * (float)(random_state >> 8) / (float)(1u << 24);
+}
+
+static float4 point_transform(const float4x4 *m, float3 p) {
+	const float *e = m->elements;
+	return (float4){
+		e[0] * p.x + e[4] * p.y + e[8] * p.z + e[12],
+		e[1] * p.x + e[5] * p.y + e[9] * p.z + e[13],
+		e[2] * p.x + e[6] * p.y + e[10] * p.z + e[14],
+		e[3] * p.x + e[7] * p.y + e[11] * p.z + e[15],
+	};
+}
+
+static float3 box_corner(Interval3 box, uint32_t corner) {
+	return (float3){
+		corner & 1 ? box.max.x : box.min.x,
+		corner & 2 ? box.max.y : box.min.y,
+		corner & 4 ? box.max.z : box.min.z,
+	};
+}
+
+// Brute force: world bounds from all 8 transformed corners, then every corner of those bounds against planes
+// taken from the clip space inequalities. The box is culled when all corners are outside the same plane.
+// Returns that plane's largest signed distance (negative means culled), *scale is the magnitude of the coordinates
+static float reference_margin(const float4x4 *view_projection, const float4x4 *world, Interval3 local, float *scale) {
+	Interval3 bounds = { .min = { FLT_MAX, FLT_MAX, FLT_MAX }, .max = { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+	for (uint32_t corner = 0; corner < 8; ++corner) {
+		float4 p = point_transform(world, box_corner(local, corner));
+		bounds.min = (float3){ MIN(bounds.min.x, p.x), MIN(bounds.min.y, p.y), MIN(bounds.min.z, p.z) };
+		bounds.max = (float3){ MAX(bounds.max.x, p.x), MAX(bounds.max.y, p.y), MAX(bounds.max.z, p.z) };
+	}
+
+	// -w <= x <= w, -w <= y <= w, 0 <= z <= w, each one as coefficients of (x, y, z, 1) in world space
+	const float *e = view_projection->elements;
+	float planes[FRUSTUM_PLANE_COUNT][4];
+	for (uint32_t column = 0; column < 4; ++column) {
+		float x = e[column * 4 + 0], y = e[column * 4 + 1], z = e[column * 4 + 2], w = e[column * 4 + 3];
+		planes[FRUSTUM_PLANE_LEFT][column] = w + x;
+		planes[FRUSTUM_PLANE_RIGHT][column] = w - x;
+		planes[FRUSTUM_PLANE_BOTTOM][column] = w + y;
+		planes[FRUSTUM_PLANE_TOP][column] = w - y;
+		planes[FRUSTUM_PLANE_NEAR][column] = z;
+		planes[FRUSTUM_PLANE_FAR][column] = w - z;
+	}
+
+	float result = FLT_MAX;
+	*scale = 1.0f;
+	for (uint32_t plane = 0; plane < FRUSTUM_PLANE_COUNT; ++plane) {
+		const float *p = planes[plane];
+		float length = sqrtf(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+		float nearest = -FLT_MAX;
+		for (uint32_t corner = 0; corner < 8; ++corner) {
+			float3 c = box_corner(bounds, corner);
+			nearest = MAX(nearest, (p[0] * c.x + p[1] * c.y + p[2] * c.z + p[3]) / length);
+			*scale = MAX(*scale, MAX(fabsf(c.x), MAX(fabsf(c.y), fabsf(c.z))));
+		}
+		result = MIN(result, nearest);
+	}
+
+	return result;
+}
+
+static void check_projection(Arena *arena, const char *name, float4x4 projection) {
+	ArenaTemp temp = arena_temp_begin(arena);
+
+	projection.elements[5] *= -1;
+	float4x4 view = float4x4_lookat((float3){ 3.0f, 4.0f, 12.0f }, (float3){ 0.0f, 0.0f, 0.0f }, (float3){ 0.0f, 1.0f, 0.0f });
+	float4x4 view_projection = float4x4_multiply(projection, view);
+	Frustum frustum = frustum_make(&view_projection);
+
+	Interval3 *bounds = arena_push_count(arena, BOX_COUNT, Interval3);
+	float4x4 *worlds = arena_push_count(arena, BOX_COUNT, float4x4);
+	for (uint32_t index = 0; index < BOX_COUNT; ++index) {
+		float3 extent = { random_range(0.05f, 3.0f), random_range(0.05f, 3.0f), random_range(0.05f, 3.0f) };
+		float3 offset = { random_range(-1.0f, 1.0f), random_range(-1.0f, 1.0f), random_range(-1.0f, 1.0f) };
+		bounds[index] = (Interval3){ .min = float3_subtract(offset, extent), .max = float3_add(offset, extent) };
+
+		float3 position = { random_range(-80.0f, 80.0f), random_range(-40.0f, 40.0f), random_range(-120.0f, 40.0f) };
+		float3 rotation = { random_range(-180.0f, 180.0f), random_range(-180.0f, 180.0f), random_range(-180.0f, 180.0f) };
+		float3 scale = { random_range(0.2f, 3.0f), random_range(0.2f, 3.0f), random_range(0.2f, 3.0f) };
+		float4x4_compose_into(&worlds[index], position, rotation, scale);
+	}
+
+	uint32_t *visible = arena_push_count(arena, BOX_COUNT, uint32_t);
+	CullStats stats = { .tested = 1, .visible = 1, .culled = 0 };
+	uint32_t visible_count = frustum_cull_boxes(&frustum, bounds, worlds, BOX_COUNT, visible, &stats);
+	TEST_CHECK(stats.tested == BOX_COUNT + 1 && stats.visible == visible_count + 1 && stats.culled == BOX_COUNT - visible_count);
+
+	uint32_t mismatches = 0, ambiguous = 0, culled = 0, cursor = 0;
+	for (uint32_t index = 0; index < BOX_COUNT; ++index) {
+		bool kept = cursor < visible_count && visible[cursor] == index;
+		if (kept)
+			cursor++;
+
+		// Scalar path, used for the remainder of the SIMD loop, must agree with it everywhere
+		bool scalar_kept = frustum_test_box(&frustum, interval3_transform(&worlds[index], bounds[index]));
+
+		float scale;
+		float margin = reference_margin(&view_projection, &worlds[index], bounds[index], &scale);
+		if (fabsf(margin) <= scale * 1e-4f) {
+			ambiguous++;
+			continue;
+		}
+
+		bool reference_kept = margin >= 0.0f;
+		culled += reference_kept == false;
+		if (kept != reference_kept || scalar_kept != reference_kept) {
+			if (mismatches++ < 8)
+				fprintf(stderr, "%s: box %u kept %d, scalar %d, reference %d (margin %g)\n", name, index, kept, scalar_kept, reference_kept, margin);
+		}
+	}
+
+	// Indices come out strictly increasing, so every one was matched in order
+	TEST_CHECK_FORMAT(cursor == visible_count, "%s: visible indices aren't in order", name);
+	TEST_CHECK_FORMAT(mismatches == 0, "%s: %u of %u boxes disagree with the reference", name, mismatches, BOX_COUNT);
+	TEST_CHECK_FORMAT(culled > BOX_COUNT / 10 && visible_count > BOX_COUNT / 10, "%s: scene doesn't exercise both outcomes", name);
+	printf("%-12s %u boxes, %u visible, %u culled, %u on a plane\n", name, BOX_COUNT, visible_count, BOX_COUNT - visible_count, ambiguous);
+
+	arena_temp_end(temp);
+}
+
+int main(void) {
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+
+	check_projection(&arena, "perspective", float4x4_perspective(deg2radf(60.0f), 16.0f / 9.0f, 0.01f, 100.0f));
+	check_projection(&arena, "orthographic", float4x4_orthographic(-30.0f, 30.0f, -20.0f, 20.0f, 0.1f, 80.0f));
+
+
+	arena_destroy(&arena);
+	return test_result("test_frustum");
+}
@@ -0,0 +1,132 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Edits a PNG under a scratch asset directory and checks the texture behind the same handle reads back
+// the new pixels once the swap landed, then feeds the shader replacement code it has to reject
+#include "test.h"
+
+#include "assets.h"
+#include "assets/importer.h"
+#include "core/logger.h"
+#include "platform.h"
+#include "renderer/backend/vulkan_api.h"
+
+#include <stb/stb_image_write.h>
+#include <string.h>
+
+#define IMAGE_SIZE 4
+
+static bool image_write(String path, uint32_t color) {
+	uint32_t pixels[IMAGE_SIZE * IMAGE_SIZE];
+	for (uint32_t index = 0; index < countof(pixels); ++index)
+		pixels[index] = color;
+	return stbi_write_png(path.chars, IMAGE_SIZE, IMAGE_SIZE, 4, pixels, IMAGE_SIZE * sizeof(uint32_t)) != 0;
+}
+
+static uint32_t texture_pixel(VulkanContext *context, RhiTexture texture) {
+	vulkan_upload_wait(context, vulkan_upload_ticket(context));
+
+	uint32_t pixel = 0;
+	vulkan_texture_read_pixel(context, texture, 1, 1, &pixel);
+	return pixel;
+}
+
+static void frame_run(VulkanContext *context) {
+	vulkan_frame_begin(context, IMAGE_SIZE, IMAGE_SIZE);
+	vulkan_frame_end(context);
+}
+
+static AssetEntry *change_wait(AssetStore *store, Arena *arena, double seconds) {
+	double end = test_seconds() + seconds;
+	while (test_seconds() < end) {
+		AssetEntry **changes = asset_store_poll_changes(store, arena);
+		if (arena_array_count(changes))
+			return changes[0];
+		platform_sleep(5);
+	}
+	return NULL;
+}
+
+static void test_texture_reload(Arena *arena, VulkanContext *context) {
+	const uint32_t red = 0xFF0000FF, green = 0xFF00FF00;
+
+	String directory = test_temp_directory(arena, "test_hot_reload");
+	String path = stringpath_join(arena, directory, S("albedo.png"));
+	TEST_CHECK(image_write(path, red));
+
+	AssetStore store = asset_store_make(arena);
+	TEST_CHECK(asset_store_track_directory(&store, directory));
+	TEST_CHECK(asset_store_watch(&store));
+
+	ImageSource image = importer_load_image(arena, path);
+	TEST_CHECK(image.pixels && image.width == IMAGE_SIZE);
+
+	RhiTexture texture = vulkan_texture_make(context, image.width, image.height, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_SAMPLED | TEXTURE_USAGE_READBACK, image.pixels);
+	uint32_t bindless_index = vulkan_texture_bindless_index(context, texture);
+	TEST_CHECK_FORMAT(texture_pixel(context, texture) == red, "0x%08x", texture_pixel(context, texture));
+
+	TEST_CHECK(image_write(path, green));
+	AssetEntry *entry = change_wait(&store, arena, 2.0);
+	TEST_CHECK(entry && string_equals(entry->full_path, path));
+
+	image = importer_load_image(arena, path);
+	TEST_CHECK(vulkan_texture_replace(context, texture, image.width, image.height, image.pixels));
+
+	// The old image stays until the next frame begins
+	TEST_CHECK(texture_pixel(context, texture) == red);
+	frame_run(context);
+	TEST_CHECK_FORMAT(texture_pixel(context, texture) == green, "0x%08x", texture_pixel(context, texture));
+	TEST_CHECK(vulkan_texture_bindless_index(context, texture) == bindless_index);
+
+	vulkan_texture_destroy(context, texture);
+	asset_store_unwatch(&store);
+	test_remove_directory(directory);
+}
+
+// False when the shaders aren't compiled and there was nothing to reload
+static bool test_shader_reload(Arena *arena, VulkanContext *context) {
+	Buffer vertex = filesystem_read(arena, S(ASSETS_DIR "/shaders/vertex/bin/basic.vertex.spv"));
+	Buffer fragment = filesystem_read(arena, S(ASSETS_DIR "/shaders/fragment/bin/unlit.fragment.spv"));
+	if (vertex.size == 0 || fragment.size == 0) {
+		printf("test_hot_reload: shaders aren't compiled, skipping the shader reload\n");
+		return false;
+	}
+
+	RhiShader shader = vulkan_shader_make(NULL, context, S("reload"), vertex, fragment, NULL);
+	TEST_CHECK(shader.id);
+
+	// A module the driver takes but reflection can't read, the shader in place has to survive it
+	Buffer broken = { .pointer = arena_push_copy(arena, fragment.pointer, fragment.size, 4), .size = fragment.size };
+	((uint32_t *)broken.pointer)[0] = 0xDEADBEEF;
+	TEST_CHECK(vulkan_shader_replace(context, shader, vertex, broken) == false);
+	TEST_CHECK(vulkan_shader_replace(context, shader, vertex, (Buffer){ 0 }) == false);
+
+	TEST_CHECK(vulkan_shader_replace(context, shader, vertex, fragment));
+	frame_run(context);
+
+	RhiUniformSet set = vulkan_uniformset_make(context, shader, 1);
+	TEST_CHECK(set.id);
+	vulkan_uniformset_destroy(context, set);
+
+	vulkan_shader_destroy(context, shader);
+	return true;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("test_hot_reload: no usable Vulkan device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	test_texture_reload(&arena, context);
+	bool shaders_reloaded = test_shader_reload(&arena, context);
+
+	vulkan_renderer_destroy(context);
+	arena_destroy(&arena);
+
+	// NOTE: A texture reload that went through still counts as skipped without the shader half
+	int result = test_result("test_hot_reload");
+	return result == 0 && shaders_reloaded == false ? TEST_SKIPPED : result;
+}
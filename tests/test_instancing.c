@@ -0,0 +1,190 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Groups a grid of quads and triangles the way draw_batches_build does, once as instanced runs and once as one
+// draw per item, renders each into an entity target and checks both read back the same entity under every item
+#include "test.h"
+
+#include "assets/asset_types.h"
+#include "core/logger.h"
+#include "core/sort.h"
+#include "draw_batches.h"
+#include "renderer/backend/vulkan_api.h"
+
+#define GRID_SIZE 4
+#define ITEM_COUNT (GRID_SIZE * GRID_SIZE)
+#define MESH_COUNT 2
+#define TARGET_SIZE 64
+#define FIRST_ENTITY 100
+
+typedef struct {
+	float4x4 projection, view;
+	float4 camera_position;
+	float2 viewport;
+	float padding[2];
+} GlobalData;
+
+// A quad and a triangle in one buffer, located by first index and base vertex like the game's meshes
+static const Vertex3 vertices[] = {
+	{ .position = { -1.0f, -1.0f, 0.0f } },
+	{ .position = { 1.0f, -1.0f, 0.0f } },
+	{ .position = { 1.0f, 1.0f, 0.0f } },
+	{ .position = { -1.0f, 1.0f, 0.0f } },
+	{ .position = { -1.0f, -1.0f, 0.0f } },
+	{ .position = { 1.0f, -1.0f, 0.0f } },
+	{ .position = { 0.0f, 1.0f, 0.0f } },
+};
+static const uint32_t indices[] = { 0, 1, 2, 2, 3, 0, 0, 1, 2 };
+
+static const struct {
+	uint32_t index_count, first_index;
+	int32_t base_vertex;
+} meshes[MESH_COUNT] = { { 6, 0, 0 }, { 3, 6, 4 } };
+
+typedef struct {
+	VulkanContext *context;
+	RhiShader shader;
+	RhiTexture target;
+	RhiBuffer geometry, uniforms;
+} DrawState;
+
+static void frame_draw(DrawState *state, RhiBuffer instances, const DrawBatch *batches, uint32_t batch_count) {
+	VulkanContext *context = state->context;
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+
+	DrawlistDesc pass = {
+		.name = S("test_instancing"),
+		.color_attachments[0] = { .target = state->target, .load = CLEAR, .store = STORE },
+		.color_attachment_count = 1,
+		.viewport = { 0, 0, TARGET_SIZE, TARGET_SIZE },
+		.msaa_level = 1,
+	};
+	VulkanRecorder *recorder = vulkan_drawlist_begin(context, pass);
+	if (recorder) {
+		PipelineDesc pipeline = DEFAULT_PIPELINE;
+		pipeline.depth_test_enable = pipeline.depth_write_enable = false;
+		vulkan_shader_bind(context, recorder, state->shader, pipeline);
+
+		RhiUniformSet global = vulkan_uniformset_push(context, recorder, state->shader, 0);
+		vulkan_uniformset_bind_buffer_range(context, global, 0, 0, sizeof(GlobalData), state->uniforms);
+		vulkan_uniformset_bind_buffer_range(context, global, 1, 0, 256, instances);
+		vulkan_uniformset_bind_buffer_range(context, global, 3, 0, ITEM_COUNT * sizeof(InstanceData), instances);
+		vulkan_uniformset_bind(context, recorder, global);
+
+		vulkan_buffer_bind_vertex(context, recorder, state->geometry, 0);
+		vulkan_buffer_bind_index(context, recorder, state->geometry, sizeof(vertices));
+		for (uint32_t index = 0; index < batch_count; ++index) {
+			const DrawBatch *batch = &batches[index];
+			vulkan_renderer_draw_indexed_instanced_offset(
+				context, recorder, meshes[batch->mesh_index].index_count, meshes[batch->mesh_index].first_index,
+				meshes[batch->mesh_index].base_vertex, batch->instance_count, batch->first_instance);
+		}
+
+		vulkan_drawlist_end(context);
+	}
+
+	vulkan_frame_end(context);
+}
+
+// Groups the items, uploads their instances and draws them, leaving the target's entities in pixels
+static uint32_t scene_draw(
+	DrawState *state, const DrawItem *items, const float4x4 *worlds, const uint32_t *order,
+	bool instancing, uint32_t *pixels) {
+	static const uint32_t mesh_to_material[MESH_COUNT] = { 0, 0 };
+
+	DrawBatch batches[ITEM_COUNT];
+	InstanceData instances[ITEM_COUNT];
+	uint32_t batch_count = draw_batches_group(items, worlds, mesh_to_material, order, ITEM_COUNT, instancing, batches, instances);
+
+	// NOTE: The readback waits on the graphics queue, the buffer is free to go once it returns
+	RhiBuffer buffer = vulkan_buffer_make(state->context, BUFFER_USAGE_STORAGE, BUFFER_MEMORY_SHARED, sizeof(instances), NULL);
+	vulkan_buffer_write_all(state->context, buffer, 0, sizeof(instances), instances);
+
+	frame_draw(state, buffer, batches, batch_count);
+	TEST_CHECK(vulkan_texture_read_pixels(state->context, state->target, 0, 0, pixels));
+
+	vulkan_buffer_destroy(state->context, buffer);
+	return batch_count;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("test_instancing: no usable Vulkan device, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	Buffer vertex = filesystem_read(&arena, S(ASSETS_DIR "/shaders/vertex/bin/basic.vertex.spv"));
+	Buffer fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/picker.fragment.spv"));
+	if (vertex.size == 0 || fragment.size == 0) {
+		printf("test_instancing: shaders aren't compiled, skipped\n");
+		vulkan_renderer_destroy(context);
+		return TEST_SKIPPED;
+	}
+
+	uint8_t geometry[sizeof(vertices) + sizeof(indices)];
+	memcpy(geometry, vertices, sizeof(vertices));
+	memcpy(geometry + sizeof(vertices), indices, sizeof(indices));
+
+	DrawState state = {
+		.context = context,
+		.shader = vulkan_shader_make(NULL, context, S("test_instancing"), vertex, fragment, NULL),
+		.target = vulkan_texture_make(context, TARGET_SIZE, TARGET_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_R32, TEXTURE_USAGE_RENDER_TARGET | TEXTURE_USAGE_READBACK, NULL),
+		.geometry = vulkan_buffer_make(context, BUFFER_USAGE_VERTEX | BUFFER_USAGE_INDEX, BUFFER_MEMORY_DEVICE, sizeof(geometry), geometry),
+		.uniforms = vulkan_buffer_make(context, BUFFER_USAGE_UNIFORM, BUFFER_MEMORY_SHARED, 256, NULL),
+	};
+	TEST_CHECK(state.shader.id);
+
+	// Identity camera, the items are placed in clip space
+	GlobalData global = {
+		.projection = float4x4_identity(),
+		.view = float4x4_identity(),
+		.viewport = { TARGET_SIZE, TARGET_SIZE },
+	};
+	vulkan_buffer_write_all(context, state.uniforms, 0, sizeof(global), &global);
+
+	// One item per grid cell, the meshes alternate so the sort has runs to gather
+	DrawItem items[ITEM_COUNT];
+	float4x4 worlds[ITEM_COUNT];
+	uint64_t keys[ITEM_COUNT];
+	uint32_t order[ITEM_COUNT];
+	float cell = 2.0f / GRID_SIZE;
+	for (uint32_t index = 0; index < ITEM_COUNT; ++index) {
+		float3 center = { -1.0f + cell * ((float)(index % GRID_SIZE) + 0.5f), -1.0f + cell * ((float)(index / GRID_SIZE) + 0.5f), 0.5f };
+		items[index] = (DrawItem){ .entity = FIRST_ENTITY + index, .mesh_index = index % MESH_COUNT };
+		worlds[index] = float4x4_scale(float4x4_translation(center), (float3){ cell * 0.4f, cell * 0.4f, 1.0f });
+		keys[index] = items[index].mesh_index;
+		order[index] = index;
+	}
+	radix_sort64(keys, order, ITEM_COUNT);
+
+	static uint32_t instanced[TARGET_SIZE * TARGET_SIZE], per_item[TARGET_SIZE * TARGET_SIZE];
+	uint32_t instanced_batches = scene_draw(&state, items, worlds, order, true, instanced);
+	uint32_t per_item_batches = scene_draw(&state, items, worlds, order, false, per_item);
+
+	TEST_CHECK_FORMAT(instanced_batches == MESH_COUNT, "%u instanced batches", instanced_batches);
+	TEST_CHECK_FORMAT(per_item_batches == ITEM_COUNT, "%u per-item batches", per_item_batches);
+
+	uint32_t differing = 0;
+	for (uint32_t pixel = 0; pixel < countof(instanced); ++pixel)
+		differing += instanced[pixel] != per_item[pixel];
+	TEST_CHECK_FORMAT(differing == 0, "%u pixels differ", differing);
+
+	// Both cover every cell center with the cell's own entity
+	for (uint32_t index = 0; index < ITEM_COUNT; ++index) {
+		uint32_t x = (index % GRID_SIZE) * (TARGET_SIZE / GRID_SIZE) + TARGET_SIZE / GRID_SIZE / 2;
+		uint32_t y = (index / GRID_SIZE) * (TARGET_SIZE / GRID_SIZE) + TARGET_SIZE / GRID_SIZE / 2;
+		uint32_t pixel = instanced[y * TARGET_SIZE + x];
+		TEST_CHECK_FORMAT(pixel == FIRST_ENTITY + index, "cell %u is %u, expected %u", index, pixel, FIRST_ENTITY + index);
+	}
+
+	vulkan_shader_destroy(context, state.shader);
+	vulkan_buffer_destroy(context, state.uniforms);
+	vulkan_buffer_destroy(context, state.geometry);
+	vulkan_texture_destroy(context, state.target);
+	vulkan_renderer_destroy(context);
+	arena_destroy(&arena);
+
+	return test_result("test_instancing");
+}
@@ -0,0 +1,107 @@
+#include "test.h"
+
+#include "core/jobs.h"
+
+#include <pthread.h>
+
+#define NESTED_PARENTS 64
+#define NESTED_CHILDREN 64
+
+static int32_t total = 0;
+
+static void job_increment(void *user_data) {
+	__atomic_add_fetch(&total, (int32_t)(uintptr_t)user_data, __ATOMIC_RELAXED);
+}
+
+// Each parent fans out and waits on its own children, waiting has to keep executing work or this deadlocks
+static void job_parent(void *user_data) {
+	JobDecl children[NESTED_CHILDREN];
+	for (uint32_t index = 0; index < NESTED_CHILDREN; ++index)
+		children[index] = (JobDecl){ .function = job_increment, .user_data = (void *)(uintptr_t)1 };
+
+	JobCounter counter = { 0 };
+	job_run(children, NESTED_CHILDREN, &counter);
+	job_wait(&counter);
+}
+
+static void range_mark(void *user_data, uint32_t start, uint32_t end) {
+	uint32_t *hits = user_data;
+	for (uint32_t index = start; index < end; ++index)
+		__atomic_add_fetch(&hits[index], 1, __ATOMIC_RELAXED);
+}
+
+static void *foreign_thread_main(void *user_data) {
+	JobDecl jobs[16];
+	for (uint32_t index = 0; index < countof(jobs); ++index)
+		jobs[index] = (JobDecl){ .function = job_increment, .user_data = (void *)(uintptr_t)1 };
+
+	JobCounter counter = { 0 };
+	job_run(jobs, countof(jobs), &counter);
+	*(bool *)user_data = job_done(&counter);
+	job_wait(&counter);
+	return NULL;
+}
+
+static void run_increments(uint32_t count) {
+	Arena arena = arena_reserve(MiB(16), ARENA_FLAG_NONE);
+	JobDecl *jobs = arena_push_count(&arena, count, JobDecl);
+	for (uint32_t index = 0; index < count; ++index)
+		jobs[index] = (JobDecl){ .function = job_increment, .user_data = (void *)(uintptr_t)1 };
+
+	total = 0;
+	JobCounter counter = { 0 };
+	job_run(jobs, count, &counter);
+	job_wait(&counter);
+
+	TEST_CHECK(job_done(&counter));
+	TEST_CHECK_FORMAT(total == (int32_t)count, "%d of %u jobs ran", total, count);
+	arena_destroy(&arena);
+}
+
+int main(void) {
+	// Without a job system everything runs inline
+	run_increments(100);
+	TEST_CHECK(job_thread_count() == 1);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	TEST_CHECK(job_system_startup(&arena, 3, false) != NULL);
+	TEST_CHECK(job_thread_count() == 4);
+	TEST_CHECK(job_thread_index() == 0);
+
+	run_increments(1000);
+	// More than one queue holds, the overflow runs on the submitting thread
+	run_increments(JOB_QUEUE_CAPACITY * 3);
+
+	total = 0;
+	JobDecl parents[NESTED_PARENTS];
+	for (uint32_t index = 0; index < NESTED_PARENTS; ++index)
+		parents[index] = (JobDecl){ .function = job_parent };
+	JobCounter counter = { 0 };
+	job_run(parents, NESTED_PARENTS, &counter);
+	job_wait(&counter);
+	TEST_CHECK(total == NESTED_PARENTS * NESTED_CHILDREN);
+
+	uint32_t count = 100003;
+	uint32_t *hits = arena_push_count(&arena, count, uint32_t);
+	job_parallel_for(count, 0, range_mark, hits);
+	job_parallel_for(count, 7, range_mark, hits);
+	uint32_t wrong = 0;
+	for (uint32_t index = 0; index < count; ++index)
+		wrong += hits[index] != 2;
+	TEST_CHECK_FORMAT(wrong == 0, "%u indices weren't visited exactly once per call", wrong);
+
+	// A thread the job system doesn't know about has no queue, its jobs are done by the time job_run returns
+	total = 0;
+	bool done_on_return = false;
+	pthread_t foreign;
+	TEST_CHECK(pthread_create(&foreign, NULL, foreign_thread_main, &done_on_return) == 0);
+	pthread_join(foreign, NULL);
+	TEST_CHECK(done_on_return);
+	TEST_CHECK(total == 16);
+
+	TEST_CHECK(job_system_shutdown());
+	TEST_CHECK(job_system_shutdown() == false);
+
+	arena_destroy(&arena);
+	return test_result("test_jobs");
+}
@@ -0,0 +1,100 @@
+#include "test.h"
+
+#include "assets/importer.h"
+#include "core/logger.h"
+
+#include <stb/stb_image_write.h>
+
+static void check_scenes_equal(SceneSource *a, SceneSource *b) {
+	TEST_CHECK(a->mesh_count == b->mesh_count);
+	TEST_CHECK(a->material_count == b->material_count);
+	TEST_CHECK(a->image_count == b->image_count);
+	TEST_CHECK(a->vertices_size == b->vertices_size && a->indices_size == b->indices_size);
+	if (test_failures)
+		return;
+
+	TEST_CHECK(memory_equals(a->vertices, b->vertices, a->vertices_size));
+	TEST_CHECK(memory_equals(a->indices, b->indices, a->indices_size));
+	TEST_CHECK(memory_equals(a->mesh_to_material, b->mesh_to_material, sizeof(uint32_t) * a->mesh_count));
+	TEST_CHECK(memory_equals(a->bounding_boxes, b->bounding_boxes, sizeof(Interval3) * a->mesh_count));
+
+	for (uint32_t index = 0; index < a->mesh_count; ++index) {
+		MeshSource *x = &a->meshes[index], *y = &b->meshes[index];
+		TEST_CHECK(x->vertices - a->vertices == y->vertices - b->vertices && x->indices - a->indices == y->indices - b->indices);
+		TEST_CHECK(x->vertex_count == y->vertex_count && x->vertex_size == y->vertex_size);
+		TEST_CHECK(x->index_count == y->index_count && x->index_size == y->index_size);
+	}
+
+	for (uint32_t index = 0; index < a->material_count; ++index) {
+		MaterialSource *x = &a->materials[index], *y = &b->materials[index];
+		TEST_CHECK(x->property_count == y->property_count);
+		for (uint32_t property = 0; property < MIN(x->property_count, y->property_count); ++property) {
+			TEST_CHECK(string_equals(x->properties[property].name, y->properties[property].name));
+			TEST_CHECK(x->properties[property].type == y->properties[property].type);
+			TEST_CHECK(memory_equals_struct(&x->properties[property].as, &y->properties[property].as));
+		}
+	}
+
+	for (uint32_t index = 0; index < a->image_count; ++index) {
+		ImageSource *x = &a->images[index], *y = &b->images[index];
+		TEST_CHECK(x->width == y->width && x->height == y->height && x->channels == y->channels);
+		TEST_CHECK((x->pixels == NULL) == (y->pixels == NULL));
+		if (x->pixels && y->pixels)
+			TEST_CHECK(memory_equals(x->pixels, y->pixels, (size_t)x->width * x->height * x->channels));
+	}
+}
+
+// Imports through cgltf, which writes the cache, then loads again and expects the cache to match it exactly
+static void check_round_trip(Arena *arena, String path) {
+	ArenaTemp temp = arena_temp_begin(arena);
+
+	SceneSource parsed = importer_reload_gltf_scene(arena, path);
+	TEST_CHECK(parsed.mesh_count > 0);
+	TEST_CHECK(parsed.mapping.pointer == NULL);
+
+	SceneSource cached = importer_load_gltf_scene(arena, path);
+	TEST_CHECK_FORMAT(cached.mapping.pointer != NULL, "'%s' wasn't loaded from its cache", path.chars);
+	check_scenes_equal(&parsed, &cached);
+
+	FileInfo info = filesystem_info(importer_mesh_cache_path(arena, path));
+	TEST_CHECK(info.exists && info.size % 16 == 0);
+
+	importer_unload_scene(&cached);
+	arena_temp_end(temp);
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_WARN);
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+
+	String directory = test_temp_directory(&arena, "mesh_cache");
+	TEST_CHECK(test_copy_tree(&arena, S(ASSETS_DIR "/models/kenney/modular_dungeon"), directory) > 0);
+	TEST_CHECK(filesystem_file_copy(S(ASSETS_DIR "/models/test/BoxTextured.glb"), stringpath_join(&arena, directory, S("BoxTextured.glb"))));
+
+	// Embedded images, and external ones referenced by URI
+	String embedded = stringpath_join(&arena, directory, S("BoxTextured.glb"));
+	String external = stringpath_join(&arena, directory, S("corridor.glb"));
+	check_round_trip(&arena, embedded);
+	check_round_trip(&arena, external);
+
+	StringList dependencies = importer_gltf_dependencies(&arena, external);
+	TEST_CHECK(dependencies.count == 1);
+	TEST_CHECK(dependencies.first && string_has_suffix(dependencies.first->string, S("Textures/colormap.png")));
+
+	// Editing only the external image has to miss the cache and rebuild it
+	uint8_t pixels[2 * 2 * 4] = { 255, 0, 0, 255, 0, 255, 0, 255, 0, 0, 255, 255, 255, 255, 255, 255 };
+	TEST_CHECK(stbi_write_png(dependencies.first->string.chars, 2, 2, 4, pixels, 2 * 4) != 0);
+
+	SceneSource edited = importer_load_gltf_scene(&arena, external);
+	TEST_CHECK_FORMAT(edited.mapping.pointer == NULL, "%s", "stale cache served after its texture changed");
+	TEST_CHECK(edited.image_count == 1 && edited.images[0].width == 2 && edited.images[0].height == 2);
+
+	SceneSource recached = importer_load_gltf_scene(&arena, external);
+	TEST_CHECK(recached.mapping.pointer != NULL);
+	TEST_CHECK(recached.image_count == 1 && recached.images[0].width == 2);
+	importer_unload_scene(&recached);
+
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	return test_result("test_mesh_cache");
+}
@@ -0,0 +1,88 @@
+// Needs a Vulkan device and runs headless, it is skipped when none is usable.
+// Builds a pipeline with no cache on disk, then makes the renderer again and checks it started from the cache
+// the first one wrote on destroy, with no temporary left behind
+#include "test.h"
+
+#include "core/logger.h"
+#include "renderer/backend/vulkan_api.h"
+
+#include <stdlib.h>
+
+#define TARGET_SIZE 16
+
+// One pass with the shader bound, enough for the driver to compile a pipeline into the cache
+static bool pipeline_build(VulkanContext *context, Buffer vertex, Buffer fragment) {
+	RhiShader shader = vulkan_shader_make(NULL, context, S("test_pipeline_cache"), vertex, fragment, NULL);
+	if (shader.id == 0)
+		return false;
+	RhiTexture target = vulkan_texture_make(context, TARGET_SIZE, TARGET_SIZE, TEXTURE_TYPE_2D, TEXTURE_FORMAT_RGBA8, TEXTURE_USAGE_RENDER_TARGET, NULL);
+
+	vulkan_frame_begin(context, TARGET_SIZE, TARGET_SIZE);
+	DrawlistDesc pass = {
+		.name = S("test_pipeline_cache"),
+		.color_attachments[0] = { .target = target, .load = CLEAR, .store = STORE },
+		.color_attachment_count = 1,
+		.msaa_level = 1,
+	};
+	VulkanRecorder *recorder = vulkan_drawlist_begin(context, pass);
+	if (recorder) {
+		PipelineDesc pipeline = DEFAULT_PIPELINE;
+		vulkan_shader_bind(context, recorder, shader, pipeline);
+		vulkan_drawlist_end(context);
+	}
+	vulkan_frame_end(context);
+
+	vulkan_shader_destroy(context, shader);
+	vulkan_texture_destroy(context, target);
+	return recorder != NULL;
+}
+
+int main(void) {
+	logger_set_level(LOG_LEVEL_FATAL);
+
+	Arena arena = arena_reserve(MiB(64), ARENA_FLAG_NONE);
+	Buffer vertex = filesystem_read(&arena, S(ASSETS_DIR "/shaders/vertex/bin/basic.vertex.spv"));
+	Buffer fragment = filesystem_read(&arena, S(ASSETS_DIR "/shaders/fragment/bin/unlit.fragment.spv"));
+	if (vertex.size == 0 || fragment.size == 0) {
+		printf("test_pipeline_cache: shaders aren't compiled, skipped\n");
+		return TEST_SKIPPED;
+	}
+
+	// NOTE: The renderer keeps its cache under XDG_CACHE_HOME, pointed at a scratch directory the test owns
+	String directory = test_temp_directory(&arena, "pipeline_cache");
+	TEST_CHECK(directory.length && setenv("XDG_CACHE_HOME", directory.chars, 1) == 0);
+	String cache_directory = stringpath_join(&arena, directory, S("starter_vulkan"));
+	String cache_path = stringpath_join(&arena, cache_directory, S("pipeline_cache.bin"));
+
+	VulkanContext *context = vulkan_renderer_make(&arena, NULL);
+	if (context == NULL) {
+		printf("test_pipeline_cache: no usable Vulkan device, skipped\n");
+		test_remove_directory(directory);
+		return TEST_SKIPPED;
+	}
+
+	TEST_CHECK(file_exists(cache_path) == false);
+	TEST_CHECK_FORMAT(vulkan_pipeline_cache_loaded(context) == 0, "%zu bytes loaded without a cache", vulkan_pipeline_cache_loaded(context));
+	TEST_CHECK(pipeline_build(context, vertex, fragment));
+	vulkan_renderer_destroy(context);
+
+	Buffer saved = filesystem_read(&arena, cache_path);
+	TEST_CHECK_FORMAT(saved.size > 0, "no cache at '%s'", cache_path.chars);
+
+	StringList files = filesystem_directory_files(&arena, cache_directory, false);
+	for (StringNode *node = files.first; node; node = node->next)
+		TEST_CHECK_FORMAT(string_has_suffix(node->string, S(".tmp")) == false, "'%s' left behind", node->string.chars);
+
+	// The second renderer starts from everything the first one saved
+	context = vulkan_renderer_make(&arena, NULL);
+	TEST_CHECK(context != NULL);
+	if (context) {
+		TEST_CHECK_FORMAT(vulkan_pipeline_cache_loaded(context) == saved.size, "%zu of %zu bytes loaded", vulkan_pipeline_cache_loaded(context), saved.size);
+		TEST_CHECK(pipeline_build(context, vertex, fragment));
+		vulkan_renderer_destroy(context);
+	}
+
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	return test_result("test_pipeline_cache");
+}
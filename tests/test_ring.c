@@ -0,0 +1,222 @@
+// The staging ring against a fake completion counter standing in for the upload timeline. Every live allocation
+// owns its bytes in a map of the buffer, an allocation landing on bytes whose value hasn't completed is a bug
+#include "test.h"
+
+#include "core/ring.h"
+
+#include <string.h>
+
+#define CAPACITY 4096
+
+typedef struct {
+	uint64_t offset, size, value;
+} Allocation;
+
+typedef struct {
+	Ring ring;
+	uint64_t completed, next_value;
+
+	uint8_t owned[CAPACITY];
+	Allocation live[4096];
+	uint32_t live_count, untagged_first;
+} Harness;
+
+static uint64_t random_state = 0x9E3779B97F4A7C15ull;
+static uint64_t random_next(void) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+static bool harness_alloc(Harness *harness, uint64_t size, uint64_t alignment) {
+	uint64_t offset = 0;
+	if (ring_alloc(&harness->ring, size, alignment, &offset) == false)
+		return false;
+
+	TEST_CHECK_FORMAT(offset % alignment == 0, "offset %llu, alignment %llu", (unsigned long long)offset, (unsigned long long)alignment);
+	TEST_CHECK_FORMAT(offset + size <= CAPACITY, "offset %llu + %llu", (unsigned long long)offset, (unsigned long long)size);
+
+	uint32_t overlapping = 0;
+	for (uint64_t byte = offset; byte < MIN(offset + size, CAPACITY); ++byte) {
+		overlapping += harness->owned[byte];
+		harness->owned[byte] = 1;
+	}
+	TEST_CHECK_FORMAT(overlapping == 0, "%u bytes at %llu still in flight", overlapping, (unsigned long long)offset);
+
+	if (harness->live_count < countof(harness->live))
+		harness->live[harness->live_count++] = (Allocation){ .offset = offset, .size = size, .value = UINT64_MAX };
+	return true;
+}
+
+static void harness_tag(Harness *harness) {
+	uint64_t value = ++harness->next_value;
+	ring_tag(&harness->ring, value);
+	for (uint32_t index = harness->untagged_first; index < harness->live_count; ++index)
+		harness->live[index].value = value;
+	harness->untagged_first = harness->live_count;
+}
+
+// The fake GPU finishes everything up to completed, the ring is told afterwards like upload_reserve does
+static void harness_complete(Harness *harness, uint64_t completed) {
+	harness->completed = completed;
+
+	uint32_t kept = 0;
+	for (uint32_t index = 0; index < harness->live_count; ++index) {
+		Allocation *allocation = &harness->live[index];
+		if (allocation->value <= completed) {
+			memset(harness->owned + allocation->offset, 0, allocation->size);
+			continue;
+		}
+		harness->live[kept++] = *allocation;
+	}
+	harness->untagged_first -= harness->live_count - kept;
+	harness->live_count = kept;
+
+	ring_reclaim(&harness->ring, completed);
+}
+
+static void harness_reset(Harness *harness) {
+	memset(harness, 0, sizeof(*harness));
+	harness->ring = ring_make(CAPACITY);
+}
+
+static void test_wrap_around(Harness *harness) {
+	harness_reset(harness);
+
+	// 3000 + 1000 leaves 96 bytes at the end, the next 512 can't fit there and starts over at 0
+	TEST_CHECK(harness_alloc(harness, 3000, 8));
+	harness_tag(harness);
+	TEST_CHECK(harness_alloc(harness, 1000, 8));
+	harness_tag(harness);
+	harness_complete(harness, 1);
+
+	uint64_t offset = 0;
+	TEST_CHECK(ring_alloc(&harness->ring, 512, 8, &offset));
+	TEST_CHECK_FORMAT(offset == 0, "wrapped to %llu", (unsigned long long)offset);
+	ring_tag(&harness->ring, ++harness->next_value);
+
+	// The 96 bytes skipped at the end stay taken until the span that jumped over them is reclaimed
+	TEST_CHECK(ring_contiguous(&harness->ring, 8) == CAPACITY - 1000 - 96 - 512);
+	ring_reclaim(&harness->ring, 2);
+	TEST_CHECK(ring_contiguous(&harness->ring, 8) == CAPACITY - 96 - 512);
+	ring_reclaim(&harness->ring, 3);
+
+	// Empty again, so the whole buffer is one piece
+	TEST_CHECK(ring_contiguous(&harness->ring, 8) == CAPACITY);
+	TEST_CHECK(ring_alloc(&harness->ring, CAPACITY, 8, &offset) && offset == 0);
+}
+
+static void test_fragmentation(Harness *harness) {
+	harness_reset(harness);
+
+	// Leaves 512 free bytes at the start and 1536 at the end, contiguous is the larger and nothing beyond it fits
+	TEST_CHECK(harness_alloc(harness, 512, 16));
+	harness_tag(harness);
+	TEST_CHECK(harness_alloc(harness, 2048, 16));
+	harness_tag(harness);
+	harness_complete(harness, 1);
+
+	uint64_t contiguous = ring_contiguous(&harness->ring, 16);
+	TEST_CHECK_FORMAT(contiguous == 1536, "%llu", (unsigned long long)contiguous);
+
+	Ring probe = harness->ring;
+	uint64_t offset = 0;
+	TEST_CHECK(ring_alloc(&probe, contiguous + 1, 16, &offset) == false);
+	TEST_CHECK(harness_alloc(harness, contiguous, 16));
+
+	// Alignment padding at the head counts against what's left at the end
+	harness_reset(harness);
+	TEST_CHECK(harness_alloc(harness, 4000, 1));
+	harness_tag(harness);
+	TEST_CHECK(ring_contiguous(&harness->ring, 64) == 96 - (4032 - 4000));
+}
+
+static void test_back_pressure(Harness *harness) {
+	harness_reset(harness);
+
+	uint32_t allocations = 0;
+	while (harness_alloc(harness, 256, 16)) {
+		allocations++;
+		if (allocations % 4 == 0)
+			harness_tag(harness);
+	}
+	TEST_CHECK(allocations == CAPACITY / 256);
+	TEST_CHECK(ring_contiguous(&harness->ring, 16) == 0);
+
+	// Nothing frees until the oldest value completes, and completing a later one frees everything before it
+	TEST_CHECK(ring_oldest_value(&harness->ring) == 1);
+	harness_complete(harness, 0);
+	TEST_CHECK(harness_alloc(harness, 256, 16) == false);
+	harness_complete(harness, 1);
+	TEST_CHECK(ring_contiguous(&harness->ring, 16) == 1024);
+	harness_complete(harness, 3);
+	TEST_CHECK(ring_oldest_value(&harness->ring) == 4);
+
+	// Untagged allocations are never reclaimed, whatever completes
+	harness_reset(harness);
+	TEST_CHECK(harness_alloc(harness, CAPACITY, 16));
+	TEST_CHECK(ring_untagged(&harness->ring) == CAPACITY);
+	TEST_CHECK(ring_oldest_value(&harness->ring) == 0);
+	harness_complete(harness, UINT64_MAX - 1);
+	TEST_CHECK(harness_alloc(harness, 16, 16) == false);
+}
+
+static void test_span_overflow(Harness *harness) {
+	harness_reset(harness);
+
+	// More tags than spans merge into the newest, which then waits for the latest value
+	for (uint32_t index = 0; index < RING_MAX_SPANS + 8; ++index) {
+		TEST_CHECK(harness_alloc(harness, 16, 16));
+		harness_tag(harness);
+	}
+	harness_complete(harness, RING_MAX_SPANS - 1);
+	TEST_CHECK(ring_oldest_value(&harness->ring) == RING_MAX_SPANS + 8);
+	harness_complete(harness, RING_MAX_SPANS + 8);
+	TEST_CHECK(ring_oldest_value(&harness->ring) == 0);
+	TEST_CHECK(ring_contiguous(&harness->ring, 16) == CAPACITY);
+}
+
+// Frames of uploads with random sizes, the GPU lagging a few values behind. Allocations that don't fit wait
+// for the oldest value the way upload_reserve does
+static void test_random(Harness *harness) {
+	harness_reset(harness);
+	static const uint64_t alignments[] = { 1, 4, 16, 64, 256 };
+
+	uint32_t allocations = 0, waits = 0;
+	for (uint32_t frame = 0; frame < 20000; ++frame) {
+		uint32_t count = (uint32_t)(random_next() % 6);
+		for (uint32_t index = 0; index < count; ++index) {
+			uint64_t size = 1 + random_next() % 1500;
+			uint64_t alignment = alignments[random_next() % countof(alignments)];
+
+			while (ring_contiguous(&harness->ring, alignment) < size) {
+				if (ring_oldest_value(&harness->ring) == 0)
+					harness_tag(harness);
+				harness_complete(harness, ring_oldest_value(&harness->ring));
+				waits++;
+			}
+			TEST_CHECK(harness_alloc(harness, size, alignment));
+			allocations++;
+		}
+
+		harness_tag(harness);
+		if (harness->next_value > 3 && random_next() % 2)
+			harness_complete(harness, harness->next_value - random_next() % 3);
+	}
+
+	TEST_CHECK(allocations > 0 && waits > 0);
+	printf("test_ring: %u allocations, %u waits for completion\n", allocations, waits);
+}
+
+int main(void) {
+	static Harness harness;
+
+	test_wrap_around(&harness);
+	test_fragmentation(&harness);
+	test_back_pressure(&harness);
+	test_span_overflow(&harness);
+	test_random(&harness);
+
+	return test_result("test_ring");
+}
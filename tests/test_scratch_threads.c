@@ -0,0 +1,137 @@
+#include "test.h"
+
+#include "assets/importer.h"
+#include "assets/json_parser.h"
+#include "core/hash.h"
+#include "platform/filesystem.h"
+
+#include <pthread.h>
+
+#define THREAD_COUNT 8
+#define ITERATIONS 8
+
+static const char *models[] = { "crate.glb", "barrel.glb", "walls_door.glb" };
+
+typedef struct {
+	uint64_t geometry_hash[countof(models)];
+	uint32_t json_count;
+	Buffer json;
+} Reference;
+
+typedef struct {
+	uint32_t index;
+	Reference *reference;
+	pthread_barrier_t *barrier;
+
+	void *scratch[2];
+	uint32_t failures;
+} Worker;
+
+static uint64_t scene_hash(SceneSource *scene) {
+	uint64_t hash = hash64_content(scene->vertices, scene->vertices_size, scene->mesh_count);
+	return hash64_content(scene->indices, scene->indices_size, hash);
+}
+
+static void *worker_main(void *user_data) {
+	Worker *worker = user_data;
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+
+	ArenaTemp first = arena_scratch_begin(NULL);
+	ArenaTemp second = arena_scratch_begin(first.arena);
+	worker->scratch[0] = first.arena;
+	worker->scratch[1] = second.arena;
+	if (first.arena == second.arena)
+		worker->failures++;
+
+	// NOTE: Held until the main thread has compared every pair, a finished thread's scratch could be handed to the next one
+	pthread_barrier_wait(worker->barrier);
+	pthread_barrier_wait(worker->barrier);
+	arena_scratch_end(second);
+	arena_scratch_end(first);
+
+	// NOTE: Models are copied into a directory of its own so the .mesh caches written next to them aren't shared
+	String directory = test_temp_directory(&arena, "scratch_threads");
+	for (uint32_t model = 0; model < countof(models); ++model) {
+		String from = string_format(&arena, "%s/models/%s", ASSETS_DIR, models[model]);
+		filesystem_file_copy(from, stringpath_join(&arena, directory, string_wrap(models[model])));
+	}
+
+	for (uint32_t iteration = 0; iteration < ITERATIONS; ++iteration) {
+		ArenaTemp temp = arena_temp_begin(&arena);
+
+		uint32_t model = (worker->index + iteration) % countof(models);
+		String path = stringpath_join(&arena, directory, string_wrap(models[model]));
+		SceneSource scene = (iteration & 1) ? importer_reload_gltf_scene(&arena, path) : importer_load_gltf_scene(&arena, path);
+		if (scene.mesh_count == 0 || scene_hash(&scene) != worker->reference->geometry_hash[model])
+			worker->failures++;
+		importer_unload_scene(&scene);
+
+		JsonNode *root = json_parse(&arena, string_wrap_buffer(worker->reference->json));
+		if (root == NULL || json_list_count(root, S("assets")) != worker->reference->json_count)
+			worker->failures++;
+
+		arena_temp_end(temp);
+	}
+
+	test_remove_directory(directory);
+	arena_destroy(&arena);
+	arena_scratch_release();
+	return NULL;
+}
+
+int main(void) {
+	Arena arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+	Reference reference = { 0 };
+
+	reference.json = filesystem_read(&arena, S(ASSETS_DIR "/asset_manifest.json"));
+	TEST_CHECK(reference.json.size > 0);
+	JsonNode *root = json_parse(&arena, string_wrap_buffer(reference.json));
+	TEST_CHECK(root != NULL);
+	reference.json_count = json_list_count(root, S("assets"));
+	TEST_CHECK(reference.json_count > 0);
+
+	String directory = test_temp_directory(&arena, "scratch_reference");
+	for (uint32_t model = 0; model < countof(models); ++model) {
+		String from = string_format(&arena, "%s/models/%s", ASSETS_DIR, models[model]);
+		String to = stringpath_join(&arena, directory, string_wrap(models[model]));
+		TEST_CHECK(filesystem_file_copy(from, to));
+
+		SceneSource scene = importer_reload_gltf_scene(&arena, to);
+		TEST_CHECK(scene.mesh_count > 0);
+		reference.geometry_hash[model] = scene_hash(&scene);
+	}
+	test_remove_directory(directory);
+
+	pthread_barrier_t barrier;
+	pthread_barrier_init(&barrier, NULL, THREAD_COUNT + 1);
+
+	pthread_t threads[THREAD_COUNT];
+	Worker workers[THREAD_COUNT] = { 0 };
+	for (uint32_t index = 0; index < THREAD_COUNT; ++index) {
+		workers[index] = (Worker){ .index = index, .reference = &reference, .barrier = &barrier };
+		if (pthread_create(&threads[index], NULL, worker_main, &workers[index]) != 0) {
+			fprintf(stderr, "test_scratch_threads: couldn't start worker %u\n", index);
+			return 1;
+		}
+	}
+
+	// Every thread got its own pair, distinct from the main thread's and from each other while all of them hold theirs
+	pthread_barrier_wait(&barrier);
+	ArenaTemp main_scratch = arena_scratch_begin(NULL);
+	for (uint32_t index = 0; index < THREAD_COUNT; ++index) {
+		TEST_CHECK(workers[index].scratch[0] != main_scratch.arena);
+		for (uint32_t other = 0; other < index; ++other)
+			TEST_CHECK(workers[index].scratch[0] != workers[other].scratch[0] && workers[index].scratch[1] != workers[other].scratch[1]);
+	}
+	arena_scratch_end(main_scratch);
+	pthread_barrier_wait(&barrier);
+
+	for (uint32_t index = 0; index < THREAD_COUNT; ++index) {
+		pthread_join(threads[index], NULL);
+		TEST_CHECK_FORMAT(workers[index].failures == 0, "worker %u failed %u times", index, workers[index].failures);
+	}
+	pthread_barrier_destroy(&barrier);
+
+	arena_destroy(&arena);
+	return test_result("test_scratch_threads");
+}
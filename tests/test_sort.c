@@ -0,0 +1,104 @@
+// radix_sort64 against a reference merge sort on (key, original position). Draw order is built from it every frame,
+// so the same keys have to come out in the same order whatever the input looks like
+#include "test.h"
+
+#include "core/sort.h"
+
+#include <string.h>
+
+#define MAX_COUNT 20000
+
+typedef struct {
+	uint64_t keys[MAX_COUNT], reference_keys[MAX_COUNT], merge_keys[MAX_COUNT];
+	uint32_t values[MAX_COUNT], reference_values[MAX_COUNT], merge_values[MAX_COUNT];
+} SortState;
+
+static uint64_t random_state = 0x2545F4914F6CDD1Dull;
+static uint64_t random_next(void) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+// Stable by construction, equal keys keep the order they came in
+static void reference_sort(SortState *state, uint32_t count) {
+	uint64_t *keys = state->reference_keys, *scratch_keys = state->merge_keys;
+	uint32_t *values = state->reference_values, *scratch_values = state->merge_values;
+
+	for (uint32_t width = 1; width < count; width *= 2) {
+		for (uint32_t start = 0; start < count; start += 2 * width) {
+			uint32_t middle = MIN(start + width, count), end = MIN(start + 2 * width, count);
+			uint32_t left = start, right = middle;
+			for (uint32_t index = start; index < end; ++index) {
+				bool take_left = left < middle && (right >= end || keys[left] <= keys[right]);
+				uint32_t from = take_left ? left++ : right++;
+				scratch_keys[index] = keys[from];
+				scratch_values[index] = values[from];
+			}
+		}
+		memcpy(keys, scratch_keys, count * sizeof(uint64_t));
+		memcpy(values, scratch_values, count * sizeof(uint32_t));
+	}
+}
+
+static void check_sort(SortState *state, uint32_t count, const char *label) {
+	for (uint32_t index = 0; index < count; ++index)
+		state->values[index] = index;
+	memcpy(state->reference_keys, state->keys, count * sizeof(uint64_t));
+	memcpy(state->reference_values, state->values, count * sizeof(uint32_t));
+
+	reference_sort(state, count);
+	radix_sort64(state->keys, state->values, count);
+
+	uint32_t mismatches = 0;
+	for (uint32_t index = 0; index < count; ++index)
+		mismatches += state->keys[index] != state->reference_keys[index] || state->values[index] != state->reference_values[index];
+	TEST_CHECK_FORMAT(mismatches == 0, "%s: %u of %u entries out of place", label, mismatches, count);
+
+	// Sorting the result again has to leave it untouched
+	memcpy(state->merge_values, state->values, count * sizeof(uint32_t));
+	radix_sort64(state->keys, state->values, count);
+	TEST_CHECK_FORMAT(memcmp(state->merge_values, state->values, count * sizeof(uint32_t)) == 0, "%s: resorting moved entries", label);
+}
+
+int main(void) {
+	static SortState state;
+
+	// Nothing to sort, the arrays stay as they are
+	state.keys[0] = 7, state.values[0] = 3;
+	radix_sort64(state.keys, state.values, 0);
+	radix_sort64(state.keys, state.values, 1);
+	TEST_CHECK(state.keys[0] == 7 && state.values[0] == 3);
+
+	for (uint32_t index = 0; index < MAX_COUNT; ++index)
+		state.keys[index] = random_next();
+	check_sort(&state, MAX_COUNT, "random");
+
+	// Draw keys, shader and material in the high bits and a coarse depth below, most bytes never change
+	for (uint32_t index = 0; index < MAX_COUNT; ++index)
+		state.keys[index] = (random_next() % 4) << 56 | (random_next() % 64) << 40 | (random_next() % 16);
+	check_sort(&state, MAX_COUNT, "sparse");
+
+	// Only ties, the order has to come out as it went in
+	for (uint32_t index = 0; index < MAX_COUNT; ++index)
+		state.keys[index] = 0xABCDull << 32;
+	check_sort(&state, MAX_COUNT, "equal");
+
+	// Only the top byte differs, and the other way around
+	for (uint32_t index = 0; index < MAX_COUNT; ++index)
+		state.keys[index] = (uint64_t)(MAX_COUNT - index) % 3 << 56;
+	check_sort(&state, MAX_COUNT, "top byte");
+	for (uint32_t index = 0; index < MAX_COUNT; ++index)
+		state.keys[index] = (MAX_COUNT - index) % 251;
+	check_sort(&state, MAX_COUNT, "bottom byte");
+
+	// Odd sizes around the point where a pass could be skipped by one key
+	for (uint32_t count = 2; count < 40; ++count) {
+		for (uint32_t index = 0; index < count; ++index)
+			state.keys[index] = index == count / 2 ? 1ull << 48 : 0;
+		check_sort(&state, count, "single outlier");
+	}
+
+	return test_result("test_sort");
+}
@@ -0,0 +1,236 @@
+#include "assets.h"
+#include "assets/importer.h"
+
+#include "common.h"
+#include "core/arena.h"
+#include "core/debug.h"
+#include "core/hash.h"
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "core/sort.h"
+#include "core/strings.h"
+
+#include "platform/filesystem.h"
+
+#include "cook_graph.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+	AssetEntry *entry;
+	uint32_t output;
+
+	bool up_to_date, succeeded;
+	Arena arena;
+} CookJob;
+
+typedef struct {
+	String input_directory;
+	String manifest_path, graph_path, pack_path;
+	uint32_t worker_count;
+	bool compress;
+} CookOptions;
+
+static void cook_job(void *user_data) {
+	CookJob *job = user_data;
+	job->succeeded = importer_cook_gltf_scene(&job->arena, job->entry->full_path);
+	if (job->succeeded == false)
+		LOG_ERROR("Cook: Failed to cook '%.*s'", SARG(job->entry->full_path));
+}
+
+// The mesh cache of a scene depends on the scene itself and every buffer and image it references
+static uint32_t cook_scene_output(Arena *arena, CookGraph *graph, CookGraph *previous, AssetEntry *entry) {
+	ArenaTemp scratch = arena_scratch_begin(arena);
+
+	StringList dependencies = importer_gltf_dependencies(scratch.arena, entry->full_path);
+	uint32_t *inputs = arena_push_count(scratch.arena, dependencies.count + 1, uint32_t);
+	uint32_t input_count = 0;
+
+	inputs[input_count++] = cook_graph_file(graph, previous, entry->full_path);
+	for (StringNode *node = dependencies.first; node; node = node->next)
+		inputs[input_count++] = cook_graph_file(graph, previous, node->string);
+
+	uint32_t result = cook_graph_output(graph, importer_mesh_cache_path(scratch.arena, entry->full_path), IMPORTER_VERSION, inputs, input_count);
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
+// Everything the manifest records, hashed in id order so it only changes when an id, type or path does
+static uint64_t cook_manifest_hash(Arena *arena, AssetStore *store) {
+	ArenaTemp scratch = arena_scratch_begin(arena);
+
+	uint32_t count = 0;
+	for (uint32_t type = 0; type < ASSET_TYPE_MAX; ++type)
+		count += store->asset_counts[type];
+
+	uint64_t *ids = arena_push_count(scratch.arena, count, uint64_t);
+	uint32_t *entries = arena_push_count(scratch.arena, count, uint32_t);
+	for (uint32_t type = 0, index = 0; type < ASSET_TYPE_MAX; ++type) {
+		for (uint32_t entry_index = 0; entry_index < store->asset_counts[type]; ++entry_index, ++index) {
+			ids[index] = store->assets[type][entry_index].id;
+			entries[index] = type * MAX_ASSETS + entry_index;
+		}
+	}
+	radix_sort64(ids, entries, count);
+
+	uint64_t result = count;
+	for (uint32_t index = 0; index < count; ++index) {
+		uint32_t type = entries[index] / MAX_ASSETS;
+		AssetEntry *entry = &store->assets[type][entries[index] % MAX_ASSETS];
+		result = hash64_combine(hash64_combine(result, entry->id), type);
+		result = hash64_content(entry->full_path.chars, entry->full_path.length, result);
+	}
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
+// The pack depends on every file it carries, the cooked .mesh for scenes, and ids are folded into the version since
+// entries are keyed by them. Scene outputs are already in the graph, so they're picked up as the same nodes
+static uint32_t cook_pack_output(Arena *arena, CookGraph *graph, CookGraph *previous, AssetStore *store, String path, bool compress) {
+	ArenaTemp scratch = arena_scratch_begin(arena);
+
+	uint64_t version = hash64_combine(ASSET_PACK_VERSION, compress);
+	uint32_t *inputs = NULL;
+	for (uint32_t type = 0; type < ASSET_TYPE_MAX; ++type) {
+		for (uint32_t index = 0; index < store->asset_counts[type]; ++index) {
+			AssetEntry *entry = store->assets[type] + index;
+			if (file_exists(entry->full_path) == false)
+				continue;
+
+			// Same choice asset_store_pack makes
+			String packed = entry->full_path;
+			if (type == ASSET_TYPE_geometry && file_exists(importer_mesh_cache_path(scratch.arena, entry->full_path)))
+				packed = importer_mesh_cache_path(scratch.arena, entry->full_path);
+
+			version = hash64_combine(version, entry->id);
+			arena_darray_put(scratch.arena, inputs, uint32_t, cook_graph_file(graph, previous, packed));
+		}
+	}
+
+	uint32_t result = cook_graph_output(graph, path, version, inputs, arena_array_count(inputs));
+
+	arena_scratch_end(scratch);
+	return result;
+}
+
+static bool cook_parse_options(int argc, char **argv, CookOptions *options) {
+	*options = (CookOptions){ .input_directory = S("assets"), .compress = true };
+
+	for (int index = 1; index < argc; ++index) {
+		String argument = string_wrap(argv[index]);
+		if (string_equals(argument, S("--no-compress")))
+			options->compress = false;
+		else if (string_equals(argument, S("-j")) && index + 1 < argc)
+			options->worker_count = (uint32_t)strtoul(argv[++index], NULL, 10);
+		else if (argument.length && argument.chars[0] != '-')
+			options->input_directory = argument;
+		else {
+			fprintf(stderr, "usage: %s [-j workers] [--no-compress] [input_directory]\n", argv[0]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char **argv) {
+	logger_set_level(LOG_LEVEL_INFO);
+
+	Arena arena = arena_reserve(GiB(4), ARENA_FLAG_NONE);
+
+	CookOptions options;
+	if (cook_parse_options(argc, argv, &options) == false)
+		return 2;
+
+	options.manifest_path = stringpath_join(&arena, options.input_directory, S("asset_manifest.json"));
+	options.graph_path = stringpath_join(&arena, options.input_directory, S("assets.cookdb"));
+	options.pack_path = stringpath_join(&arena, options.input_directory, S("assets.pak"));
+
+	// NOTE: workers + the main thread, 0 picks one per core
+	job_system_startup(&arena, options.worker_count ? options.worker_count - 1 : 0, false);
+
+	// Existing ids are kept so cooked data stays valid for anything referencing them
+	AssetStore store = asset_store_make(&arena);
+	bool manifest_exists = file_exists(options.manifest_path);
+	if (manifest_exists)
+		asset_store_deserialize(&store, options.manifest_path);
+
+	uint64_t known_hash = cook_manifest_hash(&arena, &store);
+
+	String tracked_directory = string_format(&arena, "%.*s/", SARG(options.input_directory));
+	asset_store_track_directory(&store, tracked_directory);
+
+	// Input hashes are carried over from the previous graph, only files whose size or timestamp moved are read
+	CookGraph previous = cook_graph_load(&arena, options.graph_path);
+	CookGraph graph = cook_graph_make(&arena);
+
+	CookJob *jobs = NULL;
+	for (uint32_t index = 0; index < store.asset_counts[ASSET_TYPE_geometry]; ++index) {
+		AssetEntry *entry = store.assets[ASSET_TYPE_geometry] + index;
+		if (file_exists(entry->full_path) == false)
+			continue;
+
+		CookJob *job = arena_darray_push(&arena, jobs, CookJob);
+		*job = (CookJob){ .entry = entry, .output = cook_scene_output(&arena, &graph, &previous, entry) };
+		job->up_to_date = cook_graph_up_to_date(&graph, &previous, job->output);
+	}
+	uint32_t job_count = arena_array_count(jobs);
+
+	JobDecl *decls = NULL;
+	for (uint32_t index = 0; index < job_count; ++index) {
+		if (jobs[index].up_to_date)
+			continue;
+
+		jobs[index].arena = arena_reserve(GiB(1), ARENA_FLAG_NONE);
+		arena_darray_put(&arena, decls, JobDecl, { cook_job, &jobs[index] });
+	}
+	uint32_t cook_count = arena_array_count(decls);
+
+	JobCounter counter = { 0 };
+	job_run(decls, cook_count, &counter);
+	job_wait(&counter);
+
+	// NOTE: Failed outputs stay unbuilt so the next run retries them
+	uint32_t failed_count = 0;
+	for (uint32_t index = 0; index < job_count; ++index) {
+		CookJob *job = &jobs[index];
+		if (job->up_to_date)
+			cook_graph_mark_reused(&graph, &previous, job->output);
+		else {
+			if (job->succeeded)
+				cook_graph_mark_built(&graph, job->output);
+			failed_count += job->succeeded == false;
+			arena_destroy(&job->arena);
+		}
+	}
+
+	// NOTE: Importing extracts embedded textures next to the scene, pick those up before writing the manifest
+	asset_store_track_directory(&store, tracked_directory);
+
+	bool manifest_changed = manifest_exists == false || cook_manifest_hash(&arena, &store) != known_hash;
+	if (manifest_changed)
+		asset_store_serialize(&store, options.manifest_path);
+
+	uint32_t pack = cook_pack_output(&arena, &graph, &previous, &store, options.pack_path, options.compress);
+	bool pack_changed = cook_graph_up_to_date(&graph, &previous, pack) == false;
+	bool pack_failed = pack_changed && asset_store_pack(&store, options.pack_path, options.compress) == false;
+	if (pack_changed == false)
+		cook_graph_mark_reused(&graph, &previous, pack);
+	else if (pack_failed == false)
+		cook_graph_mark_built(&graph, pack);
+
+	cook_graph_save(&graph, options.graph_path);
+
+	LOG_INFO("Cook: %u scenes cooked, %u up to date, %u failed%s%s",
+		cook_count - failed_count, job_count - cook_count, failed_count,
+		manifest_changed ? ", manifest written" : "", pack_changed && pack_failed == false ? ", pack written" : "");
+	if (pack_failed)
+		LOG_ERROR("Cook: Failed to write '%.*s'", SARG(options.pack_path));
+
+	job_system_shutdown();
+	return failed_count || pack_failed ? 1 : 0;
+}
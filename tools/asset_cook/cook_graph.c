@@ -0,0 +1,261 @@
+#include "cook_graph.h"
+
+#include "common.h"
+#include "core/arena.h"
+#include "core/hash.h"
+#include "core/logger.h"
+#include "core/strings.h"
+
+#include "platform/filesystem.h"
+
+typedef struct {
+	uint32_t magic, version;
+	uint32_t node_count, input_count;
+	uint32_t string_size, padding;
+} CookGraphHeader;
+
+typedef struct {
+	uint64_t size, last_modified, hash;
+	uint64_t version;
+	uint32_t path_offset, path_length;
+	uint32_t first_input, input_count;
+	uint32_t flags, padding;
+} CookGraphDiskNode;
+
+static uint64_t cook_file_hash(String path) {
+	Buffer file = filesystem_map(path);
+	uint64_t result = hash64_content(file.pointer, file.size, 0);
+	filesystem_unmap(file);
+	return result;
+}
+
+static inline CookNode *cook_graph_find(CookGraph *graph, String path) {
+	uint32_t *index = arena_trie_find(&graph->lookup, buffer_wrap_string(path), uint32_t);
+	return index ? &graph->nodes[*index] : NULL;
+}
+
+static uint32_t cook_graph_push(CookGraph *graph, String path) {
+	uint32_t *found = arena_trie_find(&graph->lookup, buffer_wrap_string(path), uint32_t);
+	if (found)
+		return *found;
+
+	uint32_t index = arena_array_count(graph->nodes);
+	CookNode *node = arena_darray_push(graph->arena, graph->nodes, CookNode);
+	*node = (CookNode){ .path = string_copy(graph->arena, path) };
+	arena_trie_put(&graph->lookup, buffer_wrap_string(node->path), uint32_t, index);
+
+	return index;
+}
+
+CookGraph cook_graph_make(Arena *arena) {
+	return (CookGraph){ .arena = arena, .lookup = arena_trie_make(arena) };
+}
+
+CookGraph cook_graph_load(Arena *arena, String path) {
+	CookGraph result = cook_graph_make(arena);
+	if (file_exists(path) == false)
+		return result;
+
+	Buffer file = filesystem_read(arena, path);
+	if (file.size < sizeof(CookGraphHeader))
+		return result;
+
+	CookGraphHeader *header = (CookGraphHeader *)file.pointer;
+	uint64_t nodes_offset = sizeof(CookGraphHeader);
+	uint64_t inputs_offset = nodes_offset + sizeof(CookGraphDiskNode) * (uint64_t)header->node_count;
+	uint64_t strings_offset = inputs_offset + sizeof(uint32_t) * (uint64_t)header->input_count;
+
+	bool valid = header->magic == COOK_GRAPH_MAGIC &&
+		header->version == COOK_GRAPH_VERSION &&
+		strings_offset + header->string_size == file.size;
+
+	CookGraphDiskNode *nodes = (CookGraphDiskNode *)(file.pointer + nodes_offset);
+	uint32_t *inputs = (uint32_t *)(file.pointer + inputs_offset);
+	for (uint32_t index = 0; valid && index < header->node_count; ++index) {
+		valid = (uint64_t)nodes[index].path_offset + nodes[index].path_length <= header->string_size &&
+			(uint64_t)nodes[index].first_input + nodes[index].input_count <= header->input_count;
+	}
+	for (uint32_t index = 0; valid && index < header->input_count; ++index)
+		valid = inputs[index] < header->node_count;
+
+	if (valid == false) {
+		LOG_WARN("Cook: Ignoring unreadable dependency graph '%.*s'", SARG(path));
+		return result;
+	}
+
+	char *strings = (char *)file.pointer + strings_offset;
+	for (uint32_t index = 0; index < header->node_count; ++index) {
+		CookGraphDiskNode *src = &nodes[index];
+		uint32_t node_index = cook_graph_push(&result, (String){ .chars = strings + src->path_offset, .length = src->path_length });
+		result.nodes[node_index] = (CookNode){
+			.path = result.nodes[node_index].path,
+			.size = src->size,
+			.last_modified = src->last_modified,
+			.hash = src->hash,
+			.version = src->version,
+			.first_input = src->first_input,
+			.input_count = src->input_count,
+			.flags = src->flags,
+		};
+	}
+
+	// NOTE: Paths are unique, so node indices on disk and in memory line up
+	if (arena_array_count(result.nodes) != header->node_count)
+		return cook_graph_make(arena);
+
+	for (uint32_t index = 0; index < header->input_count; ++index)
+		arena_darray_put(arena, result.inputs, uint32_t, inputs[index]);
+
+	return result;
+}
+
+bool cook_graph_save(CookGraph *graph, String path) {
+	ArenaTemp scratch = arena_scratch_begin(graph->arena);
+
+	uint32_t node_count = arena_array_count(graph->nodes);
+	uint32_t input_count = arena_array_count(graph->inputs);
+
+	uint32_t string_size = 0;
+	for (uint32_t index = 0; index < node_count; ++index)
+		string_size += graph->nodes[index].path.length;
+
+	size_t size = sizeof(CookGraphHeader) + sizeof(CookGraphDiskNode) * node_count + sizeof(uint32_t) * input_count + string_size;
+	uint8_t *base = arena_push(scratch.arena, size, alignof(CookGraphDiskNode), true);
+
+	CookGraphHeader *header = (CookGraphHeader *)base;
+	*header = (CookGraphHeader){
+		.magic = COOK_GRAPH_MAGIC,
+		.version = COOK_GRAPH_VERSION,
+		.node_count = node_count,
+		.input_count = input_count,
+		.string_size = string_size,
+	};
+
+	CookGraphDiskNode *nodes = (CookGraphDiskNode *)(header + 1);
+	uint32_t *inputs = (uint32_t *)(nodes + node_count);
+	char *strings = (char *)(inputs + input_count);
+
+	uint32_t string_offset = 0;
+	for (uint32_t index = 0; index < node_count; ++index) {
+		CookNode *src = &graph->nodes[index];
+		nodes[index] = (CookGraphDiskNode){
+			.size = src->size,
+			.last_modified = src->last_modified,
+			.hash = src->hash,
+			.version = src->version,
+			.path_offset = string_offset,
+			.path_length = (uint32_t)src->path.length,
+			.first_input = src->first_input,
+			.input_count = src->input_count,
+			.flags = src->flags,
+		};
+
+		memory_copy(strings + string_offset, src->path.chars, src->path.length);
+		string_offset += src->path.length;
+	}
+	if (input_count)
+		memory_copy(inputs, graph->inputs, sizeof(uint32_t) * input_count);
+
+	Buffer current = buffer_make(base, size);
+	Buffer existing = filesystem_map(path);
+	bool changed = buffer_equal(current, existing) == false;
+	filesystem_unmap(existing);
+
+	if (changed) {
+		String temp_path = string_format(scratch.arena, "%.*s.tmp", SARG(path));
+		File file = filesystem_open(temp_path, FILE_MODE_WRITE_BINARY);
+		bool written = file.handle && file_write(&file, size, 1, base) == 1;
+		file_close(&file);
+
+		if (written == false || filesystem_rename(temp_path, path) == false) {
+			LOG_ERROR("Cook: Failed to write dependency graph '%.*s'", SARG(path));
+			changed = false;
+		}
+	}
+
+	arena_scratch_end(scratch);
+	return changed;
+}
+
+uint32_t cook_graph_file(CookGraph *graph, CookGraph *previous, String path) {
+	uint32_t *found = arena_trie_find(&graph->lookup, buffer_wrap_string(path), uint32_t);
+	if (found)
+		return *found;
+
+	uint32_t index = cook_graph_push(graph, path);
+	CookNode *node = &graph->nodes[index];
+
+	FileInfo info = filesystem_info(path);
+	node->size = info.size;
+	node->last_modified = info.last_modified;
+
+	CookNode *old = cook_graph_find(previous, path);
+	if (info.exists == false)
+		node->hash = 0;
+	else if (old && old->size == info.size && old->last_modified == info.last_modified)
+		node->hash = old->hash;
+	else
+		node->hash = cook_file_hash(path);
+
+	return index;
+}
+
+uint32_t cook_graph_output(CookGraph *graph, String path, uint64_t version, uint32_t *inputs, uint32_t input_count) {
+	uint32_t index = cook_graph_push(graph, path);
+
+	uint32_t first_input = arena_array_count(graph->inputs);
+	for (uint32_t input_index = 0; input_index < input_count; ++input_index)
+		arena_darray_put(graph->arena, graph->inputs, uint32_t, inputs[input_index]);
+
+	CookNode *node = &graph->nodes[index];
+	node->version = version;
+	node->first_input = first_input;
+	node->input_count = input_count;
+	node->flags = COOK_NODE_FLAG_OUTPUT;
+
+	return index;
+}
+
+bool cook_graph_up_to_date(CookGraph *graph, CookGraph *previous, uint32_t output) {
+	CookNode *node = &graph->nodes[output];
+	CookNode *old = cook_graph_find(previous, node->path);
+	if (old == NULL || (old->flags & COOK_NODE_FLAG_BUILT) == 0 || old->version != node->version || old->input_count != node->input_count)
+		return false;
+
+	// The output on disk has to still be the one that was built
+	FileInfo info = filesystem_info(node->path);
+	if (info.exists == false || info.size != old->size || info.last_modified != old->last_modified)
+		return false;
+
+	for (uint32_t index = 0; index < node->input_count; ++index) {
+		CookNode *input = &graph->nodes[graph->inputs[node->first_input + index]];
+		CookNode *old_input = &previous->nodes[previous->inputs[old->first_input + index]];
+
+		if ((input->flags & COOK_NODE_FLAG_OUTPUT) && (input->flags & COOK_NODE_FLAG_BUILT) == 0)
+			return false;
+		if (string_equals(input->path, old_input->path) == false || input->hash != old_input->hash)
+			return false;
+	}
+
+	return true;
+}
+
+void cook_graph_mark_built(CookGraph *graph, uint32_t output) {
+	CookNode *node = &graph->nodes[output];
+
+	FileInfo info = filesystem_info(node->path);
+	node->size = info.size;
+	node->last_modified = info.last_modified;
+	node->hash = cook_file_hash(node->path);
+	node->flags |= COOK_NODE_FLAG_BUILT;
+}
+
+void cook_graph_mark_reused(CookGraph *graph, CookGraph *previous, uint32_t output) {
+	CookNode *node = &graph->nodes[output];
+	CookNode *old = cook_graph_find(previous, node->path);
+
+	node->size = old->size;
+	node->last_modified = old->last_modified;
+	node->hash = old->hash;
+	node->flags |= COOK_NODE_FLAG_BUILT;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "common.h"
+#include "core/arena.h"
+#include "core/strings.h"
+
+// NOTE: Bump whenever the on-disk layout changes, an unreadable graph just means cooking everything again
+#define COOK_GRAPH_VERSION 1
+#define COOK_GRAPH_MAGIC 0x42444B43 // "CKDB"
+
+typedef enum {
+	COOK_NODE_FLAG_OUTPUT = 1 << 0,
+	// Set once an output was produced successfully, failed outputs are kept without it so they're retried
+	COOK_NODE_FLAG_BUILT = 1 << 1,
+} CookNodeFlag;
+
+// A file in the graph. Outputs additionally list the inputs and the version they were built from
+typedef struct {
+	String path;
+	uint64_t size, last_modified, hash;
+
+	uint64_t version;
+	uint32_t first_input, input_count;
+	uint32_t flags;
+} CookNode;
+
+typedef struct {
+	Arena *arena;
+	ArenaTrie lookup;
+
+	CookNode *nodes;
+	uint32_t *inputs;
+} CookGraph;
+
+CookGraph cook_graph_make(Arena *arena);
+// Empty graph when the file is missing, stale or malformed
+CookGraph cook_graph_load(Arena *arena, String path);
+// Writes only when the contents differ from what is on disk, returns true if it wrote
+bool cook_graph_save(CookGraph *graph, String path);
+
+// Input node for path. Content is only re-hashed when size or modification time differ from previous
+uint32_t cook_graph_file(CookGraph *graph, CookGraph *previous, String path);
+uint32_t cook_graph_output(CookGraph *graph, String path, uint64_t version, uint32_t *inputs, uint32_t input_count);
+
+// True when previous built the output from the same version and inputs with identical contents.
+// Inputs that are outputs themselves must be marked built before their dependents are checked
+bool cook_graph_up_to_date(CookGraph *graph, CookGraph *previous, uint32_t output);
+// Hashes the freshly written output so anything depending on it sees whether it actually changed
+void cook_graph_mark_built(CookGraph *graph, uint32_t output);
+// Carries the hash of an output that was up to date over from previous
+void cook_graph_mark_reused(CookGraph *graph, CookGraph *previous, uint32_t output);